@@ -269,42 +269,63 @@ void duDebugDrawNavMeshNodes(struct duDebugDraw* dd, const dtNavMeshQuery& query
 	{
 		const float off = 0.5f;
 		dd->begin(DU_DRAW_POINTS, 4.0f);
-		for (int i = 0; i < pool->getHashSize(); ++i)
+		for (int i = 0; i < pool->getNodeCount(); ++i)
 		{
-			for (dtNodeIndex j = pool->getFirst(i); j != DT_NULL_IDX; j = pool->getNext(j))
-			{
-				const dtNode* node = pool->getNodeAtIdx(j+1);
-				if (!node) continue;
-				dd->vertex(node->pos[0],node->pos[1]+off,node->pos[2], duRGBA(255,192,0,255));
-			}
+			const dtNode* node = pool->getNodeAtIdx(i+1);
+			const float* pos = pool->getNodePos(node);
+			dd->vertex(pos[0],pos[1]+off,pos[2], duRGBA(255,192,0,255));
 		}
 		dd->end();
 		
 		dd->begin(DU_DRAW_LINES, 2.0f);
-		for (int i = 0; i < pool->getHashSize(); ++i)
+		for (int i = 0; i < pool->getNodeCount(); ++i)
 		{
-			for (dtNodeIndex j = pool->getFirst(i); j != DT_NULL_IDX; j = pool->getNext(j))
-			{
-				const dtNode* node = pool->getNodeAtIdx(j+1);
-				if (!node) continue;
-				if (!node->pidx) continue;
-				const dtNode* parent = pool->getNodeAtIdx(node->pidx);
-				if (!parent) continue;
-				dd->vertex(node->pos[0],node->pos[1]+off,node->pos[2], duRGBA(255,192,0,128));
-				dd->vertex(parent->pos[0],parent->pos[1]+off,parent->pos[2], duRGBA(255,192,0,128));
-			}
+			const dtNode* node = pool->getNodeAtIdx(i+1);
+			if (!node->pidx) continue;
+			const dtNode* parent = pool->getNodeAtIdx(node->pidx);
+			if (!parent) continue;
+			const float* pos = pool->getNodePos(node);
+			const float* parentPos = pool->getNodePos(parent);
+			dd->vertex(pos[0],pos[1]+off,pos[2], duRGBA(255,192,0,128));
+			dd->vertex(parentPos[0],parentPos[1]+off,parentPos[2], duRGBA(255,192,0,128));
 		}
 		dd->end();
 	}
 }
 
 
+template <int Width, class Node>
+static void drawWideBVTreeLeaves(duDebugDraw* dd, const dtMeshTile* tile, const Node* nodes)
+{
+	const float cs = 1.0f / tile->header->bvQuantFactor;
+	for (int i = 0; i < tile->header->bvNodeCount; ++i)
+	{
+		const Node* n = &nodes[i];
+		for (int j = 0; j < Width; ++j)
+		{
+			if (n->child[j] >= 0) // Leaf indices are negative.
+				continue;
+			duAppendBoxWire(dd, tile->header->bmin[0] + n->bmin[0][j]*cs,
+							tile->header->bmin[1] + n->bmin[1][j]*cs,
+							tile->header->bmin[2] + n->bmin[2][j]*cs,
+							tile->header->bmin[0] + n->bmax[0][j]*cs,
+							tile->header->bmin[1] + n->bmax[1][j]*cs,
+							tile->header->bmin[2] + n->bmax[2][j]*cs,
+							duRGBA(255,255,255,128));
+		}
+	}
+}
+
 static void drawMeshTileBVTree(duDebugDraw* dd, const dtMeshTile* tile)
 {
 	// Draw BV nodes.
 	const float cs = 1.0f / tile->header->bvQuantFactor;
 	dd->begin(DU_DRAW_LINES, 1.0f);
-	for (int i = 0; i < tile->header->bvNodeCount; ++i)
+	if (tile->bvTree4)
+		drawWideBVTreeLeaves<4>(dd, tile, tile->bvTree4);
+	else if (tile->bvTree8)
+		drawWideBVTreeLeaves<8>(dd, tile, tile->bvTree8);
+	for (int i = 0; tile->bvTree && i < tile->header->bvNodeCount; ++i)
 	{
 		const dtBVNode* n = &tile->bvTree[i];
 		if (n->i < 0) // Leaf indices are positive.
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURAREASAMPLER_H
+#define DETOURAREASAMPLER_H
+
+#include "DetourNavMesh.h"
+#include "DetourStatus.h"
+
+class dtQueryFilter;
+struct dtAreaSamplerTile;
+
+/// Cumulative polygon area tables used to pick random polygons weighted by area in
+/// logarithmic time.
+/// The tables follow the tile changes of the navigation mesh when the object is added as a
+/// listener with dtNavMesh::addListener, or when #addTile and #removeTile are called.
+/// @ingroup detour
+class dtNavMeshAreaSampler : public dtNavMeshListener
+{
+public:
+	dtNavMeshAreaSampler();
+	virtual ~dtNavMeshAreaSampler();
+
+	/// Computes the area tables of all the tiles in the navigation mesh.
+	///  @param[in]		nav				The navigation mesh to sample.
+	///  @param[in]		filter			The filter whose include and exclude flags select the polygons.
+	///  @param[in]		areaWeights		The weight of the polygon area per area id, zero excludes the
+	///  								area, or null to weight all areas by one. [(weight) * #DT_MAX_AREAS] [opt]
+	/// @returns The status flags for the operation.
+	dtStatus init(const dtNavMesh* nav, const dtQueryFilter* filter, const float* areaWeights = 0);
+
+	/// Computes the area table of a tile added to the navigation mesh, or replacing a tile.
+	/// Also used to update the table after the flags or areas of the tile polygons change.
+	///  @param[in]		ref		The reference of the tile.
+	/// @returns The status flags for the operation.
+	dtStatus addTile(dtTileRef ref);
+
+	/// Releases the area table of a tile removed from the navigation mesh.
+	///  @param[in]		ref		The reference of the removed tile.
+	void removeTile(dtTileRef ref);
+
+	/// Releases the tables of the removed tiles and computes the tables of the added tiles.
+	virtual void onTilesChanged(const dtNavMesh* nav, const dtTileRef* removed, const int nremoved,
+								const dtTileRef* added, const int nadded);
+
+	/// Picks a polygon with a probability proportional to its weighted area.
+	///  @param[in]		u		A random number. [Limits: 0 <= value < 1]
+	/// @return The reference of the polygon, or zero if no polygon has an area.
+	dtPolyRef findRandomPoly(const float u) const;
+
+	/// Returns true if the sampler selects the same polygons as the filter, as far as the
+	/// include and exclude flags of the default filter implementation go.
+	///  @param[in]		filter	The filter to compare.
+	bool matchesFilter(const dtQueryFilter* filter) const;
+
+	/// The weighted area of all the sampled polygons.
+	float getTotalArea() const { return m_tree ? m_tree[1] : 0.0f; }
+
+	/// The navigation mesh the tables are computed for.
+	const dtNavMesh* getNavMesh() const { return m_nav; }
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtNavMeshAreaSampler(const dtNavMeshAreaSampler&);
+	dtNavMeshAreaSampler& operator=(const dtNavMeshAreaSampler&);
+
+	void purge();
+	void freeTable(unsigned int it);
+	void setTileArea(unsigned int it, const float area);
+
+	const dtNavMesh* m_nav;					///< The navigation mesh the tables are computed for.
+	dtAreaSamplerTile* m_tables;			///< Area tables per tile index.
+	int m_maxTiles;							///< The number of entries in the tables array.
+	float* m_tree;							///< Sum tree of the tile areas, the root is at 1 and the tiles are the leaves. [(sum) * 2 * #m_leafCount]
+	int m_leafCount;						///< The number of leaves, the power of two at or above #m_maxTiles.
+	unsigned short m_includeFlags;			///< The include flags of the sampled polygons.
+	unsigned short m_excludeFlags;			///< The exclude flags of the sampled polygons.
+	float m_areaWeights[DT_MAX_AREAS];		///< The weight of the polygon area per area id.
+};
+
+/// Allocates an area sampler object using the Detour allocator.
+/// @return An area sampler object that is ready for initialization, or null on failure.
+///  @ingroup detour
+dtNavMeshAreaSampler* dtAllocNavMeshAreaSampler();
+
+/// Frees the specified area sampler object using the Detour allocator.
+///  @param[in]		sampler		An area sampler object allocated using #dtAllocNavMeshAreaSampler
+///  @ingroup detour
+void dtFreeNavMeshAreaSampler(dtNavMeshAreaSampler* sampler);
+
+#endif // DETOURAREASAMPLER_H
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURLANDMARKS_H
+#define DETOURLANDMARKS_H
+
+#include "DetourNavMesh.h"
+#include "DetourStatus.h"
+
+/// The maximum number of landmarks a dtNavMeshLandmarks object can hold.
+/// @ingroup detour
+static const int DT_MAX_LANDMARKS = 16;
+
+struct dtLandmarkTile;
+struct dtLandmarkHeapItem;
+
+/// Precomputed landmark distances used to tighten the path finding heuristic. (ALT)
+/// The tables follow the tile changes of the navigation mesh when the object is added as a
+/// listener with dtNavMesh::addListener, or when #addTile and #removeTile are called.
+/// @ingroup detour
+class dtNavMeshLandmarks : public dtNavMeshListener
+{
+public:
+	dtNavMeshLandmarks();
+	virtual ~dtNavMeshLandmarks();
+
+	/// Picks the landmarks and computes the distance tables of all the tiles in the navigation mesh.
+	///  @param[in]		nav				The navigation mesh the distances are computed for.
+	///  @param[in]		landmarkCount	The number of landmarks. [Limits: 0 < value <= #DT_MAX_LANDMARKS]
+	///  @param[in]		costScale		The traversal cost per unit of distance used for the bounds.
+	///  								[Limit: > 0]
+	///  @param[in]		landmarks		The polygons to use as landmarks, or null to pick them
+	///  								automatically. [(polyRef) * @p landmarkCount] [opt]
+	/// @returns The status flags for the operation.
+	dtStatus init(const dtNavMesh* nav, const int landmarkCount, const float costScale = 1.0f,
+				  const dtPolyRef* landmarks = 0);
+
+	/// Computes the distance table of a tile added to the navigation mesh, or replacing a tile.
+	///  @param[in]		ref		The reference of the tile.
+	/// @returns The status flags for the operation.
+	dtStatus addTile(dtTileRef ref);
+
+	/// Releases the distance table of a tile removed from the navigation mesh.
+	///  @param[in]		ref		The reference of the removed tile.
+	void removeTile(dtTileRef ref);
+
+	/// Releases the tables of the removed tiles and computes the tables of the added tiles.
+	virtual void onTilesChanged(const dtNavMesh* nav, const dtTileRef* removed, const int nremoved,
+								const dtTileRef* added, const int nadded);
+
+	/// Gets the landmark distance bounds of a polygon, used as the goal of a heuristic query.
+	///  @param[in]		ref		The reference of the polygon.
+	///  @param[out]	bounds	The distance bounds. [(min, max) * #getLandmarkCount()]
+	/// @return True if the polygon has landmark distances.
+	bool getPolyBounds(dtPolyRef ref, float* bounds) const;
+
+	/// Returns a lower bound of the traversal cost between a polygon and a goal polygon.
+	///  @param[in]		ref			The reference of the polygon.
+	///  @param[in]		goalBounds	The bounds of the goal polygon, see #getPolyBounds.
+	/// @return The lower bound of the traversal cost.
+	float getCostBound(dtPolyRef ref, const float* goalBounds) const;
+
+	/// The navigation mesh the distances are computed for.
+	const dtNavMesh* getNavMesh() const { return m_nav; }
+
+	/// The number of landmarks.
+	int getLandmarkCount() const { return m_landmarkCount; }
+
+	/// Gets the polygon reference of a landmark.
+	///  @param[in]		i	The landmark index. [Limits: 0 <= value < #getLandmarkCount()]
+	dtPolyRef getLandmark(int i) const { return m_landmarks[i]; }
+
+	/// The traversal cost per unit of distance used for the bounds.
+	float getCostScale() const { return m_costScale; }
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtNavMeshLandmarks(const dtNavMeshLandmarks&);
+	dtNavMeshLandmarks& operator=(const dtNavMeshLandmarks&);
+
+	void purge();
+	dtLandmarkTile* getTable(unsigned int it) const;
+	void freeTable(unsigned int it);
+	bool allocTable(unsigned int it);
+	bool buildEndPoints(unsigned int it);
+	void resetLandmark(const int landmark);
+	void seedPoly(const int landmark, const dtPolyRef ref);
+	void seedTile(const int landmark, unsigned int it);
+	bool propagate(const int landmark);
+	void visit(const int landmark, unsigned int it, const int slot, const float dist);
+	void visitFromPoint(const int landmark, const float* pt, const dtPolyRef ref,
+						const dtPolyRef skipCon, const float dist);
+	void updateBounds(unsigned int it);
+	void updateDirtyBounds();
+	dtPolyRef findFurthestPoly(const int landmarkCount) const;
+	bool pushHeap(const float dist, const unsigned int tile, const int slot);
+	void popHeap(dtLandmarkHeapItem& item);
+
+	const dtNavMesh* m_nav;					///< The navigation mesh the distances are computed for.
+	dtLandmarkTile* m_tables;				///< Distance tables per tile index.
+	int m_maxTiles;							///< The number of entries in the tables array.
+	dtPolyRef m_landmarks[DT_MAX_LANDMARKS];	///< Landmark polygons.
+	int m_landmarkCount;					///< The number of landmarks.
+	float m_costScale;						///< The traversal cost per unit of distance.
+
+	dtLandmarkHeapItem* m_heap;				///< Priority queue of the distance propagation.
+	int m_heapSize;
+	int m_heapCapacity;
+	bool m_heapOverflow;					///< True if the queue could not be grown during the propagation.
+};
+
+/// Allocates a landmark object using the Detour allocator.
+/// @return A landmark object that is ready for initialization, or null on failure.
+///  @ingroup detour
+dtNavMeshLandmarks* dtAllocNavMeshLandmarks();
+
+/// Frees the specified landmark object using the Detour allocator.
+///  @param[in]		landmarks		A landmark object allocated using #dtAllocNavMeshLandmarks
+///  @ingroup detour
+void dtFreeNavMeshLandmarks(dtNavMeshLandmarks* landmarks);
+
+#endif // DETOURLANDMARKS_H
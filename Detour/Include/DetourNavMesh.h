@@ -40,6 +40,7 @@
 /// A handle to a polygon within a navigation mesh tile.
 /// @ingroup detour
 #ifdef DT_POLYREF64
+// The default number of bits of each part of a polygon reference. (See: dtPolyRefBits)
 static const unsigned int DT_SALT_BITS = 16;
 static const unsigned int DT_TILE_BITS = 28;
 static const unsigned int DT_POLY_BITS = 20;
@@ -70,7 +71,7 @@ static const int DT_VERTS_PER_POLYGON = 6;
 static const int DT_NAVMESH_MAGIC = 'D'<<24 | 'N'<<16 | 'A'<<8 | 'V';
 
 /// A version number used to detect compatibility of navigation tile data.
-static const int DT_NAVMESH_VERSION = 7;
+static const int DT_NAVMESH_VERSION = 9;
 
 /// A magic number used to detect the compatibility of navigation tile states.
 static const int DT_NAVMESH_STATE_MAGIC = 'D'<<24 | 'N'<<16 | 'M'<<8 | 'S';
@@ -118,10 +119,12 @@ enum dtStraightPathOptions
 };
 
 
-/// Options for dtNavMeshQuery::initSlicedFindPath and updateSlicedFindPath
+/// Options for dtNavMeshQuery::findPath, initSlicedFindPath and updateSlicedFindPath
 enum dtFindPathOptions
 {
-	DT_FINDPATH_ANY_ANGLE	= 0x02		///< use raycasts during pathfind to "shortcut" (raycast still consider costs)
+	DT_FINDPATH_ANY_ANGLE		= 0x02,	///< use raycasts during pathfind to "shortcut" (raycast still consider costs). Sliced queries only.
+	DT_FINDPATH_FIRST_PATH		= 0x04,	///< stop as soon as the first complete path is found instead of proving it is the cheapest one.
+	DT_FINDPATH_BIDIRECTIONAL	= 0x08	///< search from the start and the end at the same time. dtNavMeshQuery::findPath only.
 };
 
 /// Options for dtNavMeshQuery::raycast
@@ -219,6 +222,85 @@ struct dtBVNode
 	int i;							///< The node's index. (Negative for escape sequence.)
 };
 
+/// The maximum depth of a wide bounding volume tree. (See: #dtBVNode4, #dtBVNode8)
+static const int DT_BVTREE_MAX_WIDE_DEPTH = 24;
+
+/// Bounding volume node of a 4-wide tree. The children's bounds are stored per axis so that
+/// all of them can be tested at once.
+/// @note This structure is rarely if ever used by the end user.
+/// @see dtMeshTile
+struct dtBVNode4
+{
+	unsigned short bmin[3][4];		///< Minimum bounds of the children's AABBs. [(x, y, z)][child]
+	unsigned short bmax[3][4];		///< Maximum bounds of the children's AABBs. [(x, y, z)][child]
+	int child[4];					///< The child node index, ~polygon index for leaves, or zero if unused.
+};
+
+/// Bounding volume node of an 8-wide tree.
+/// @note This structure is rarely if ever used by the end user.
+/// @see dtBVNode4, dtMeshTile
+struct dtBVNode8
+{
+	unsigned short bmin[3][8];		///< Minimum bounds of the children's AABBs. [(x, y, z)][child]
+	unsigned short bmax[3][8];		///< Maximum bounds of the children's AABBs. [(x, y, z)][child]
+	int child[8];					///< The child node index, ~polygon index for leaves, or zero if unused.
+};
+
+/// Returns the size of the bounding volume nodes of a tree, or zero if the width is not supported.
+///  @param[in]		width	The number of children per node. (See: dtMeshHeader::bvTreeWidth)
+inline int dtGetBVNodeSize(const int width)
+{
+	switch (width)
+	{
+	case 2: return (int)sizeof(dtBVNode);
+	case 4: return (int)sizeof(dtBVNode4);
+	case 8: return (int)sizeof(dtBVNode8);
+	default: return 0;
+	}
+}
+
+/// Calls @p visitor with the index of every polygon whose bounds overlap the quantized box, using a
+/// wide bounding volume tree.
+///  @param[in]		nodes		The tree nodes, #dtBVNode4 or #dtBVNode8.
+///  @param[in]		bmin		The minimum bounds of the box. [(x, y, z)]
+///  @param[in]		bmax		The maximum bounds of the box. [(x, y, z)]
+///  @param[in]		visitor		Called as visitor(polyIndex).
+template <int Width, class Node, class Visitor>
+void dtQueryWideBVTree(const Node* nodes, const unsigned short* bmin, const unsigned short* bmax, Visitor& visitor)
+{
+	int stack[DT_BVTREE_MAX_WIDE_DEPTH*(Width-1) + 1];
+	int nstack = 0;
+	stack[nstack++] = 0;
+	while (nstack > 0)
+	{
+		const Node& node = nodes[stack[--nstack]];
+
+		// Test all the children without branching.
+		unsigned int mask = 0;
+		for (int j = 0; j < Width; ++j)
+		{
+			const unsigned int overlap =
+				(unsigned int)(bmin[0] <= node.bmax[0][j]) & (unsigned int)(bmax[0] >= node.bmin[0][j]) &
+				(unsigned int)(bmin[1] <= node.bmax[1][j]) & (unsigned int)(bmax[1] >= node.bmin[1][j]) &
+				(unsigned int)(bmin[2] <= node.bmax[2][j]) & (unsigned int)(bmax[2] >= node.bmin[2][j]) &
+				(unsigned int)(node.child[j] != 0);
+			mask |= overlap << j;
+		}
+
+		// Visit the leaves and push the child nodes, in reverse so that the nodes are popped in order.
+		for (int j = Width-1; j >= 0; --j)
+		{
+			if (!(mask & (1u << j)))
+				continue;
+			const int child = node.child[j];
+			if (child < 0)
+				visitor(~child);
+			else
+				stack[nstack++] = child;
+		}
+	}
+}
+
 /// Defines an navigation mesh off-mesh connection within a dtMeshTile object.
 /// An off-mesh connection is a user defined traversable connection made up to two vertices.
 struct dtOffMeshConnection
@@ -244,6 +326,24 @@ struct dtOffMeshConnection
 	unsigned int userId;
 };
 
+/// Defines a polygon edge on a tile border, which is connected to the polygons of the neighbour tile on that side.
+/// The border edges of a tile are sorted by side and then by their start along the border.
+/// @see dtMeshTile::borderEdges
+struct dtBorderEdge
+{
+	/// The end points of the edge in the plane of the border, the start first. [(u, y) * 2]
+	/// u is the z-coordinate on sides 0 and 4, and the x-coordinate on sides 2 and 6.
+	float bmin[2];
+	float bmax[2];
+
+	/// The position of the border. (The x-coordinate on sides 0 and 4, and the z-coordinate on sides 2 and 6.)
+	float pos;
+
+	unsigned short poly;	///< The index of the polygon within the tile.
+	unsigned char edge;		///< The index of the edge within the polygon.
+	unsigned char side;		///< The side of the tile the edge is on. (0, 2, 4 or 6)
+};
+
 /// Provides high level information related to a dtMeshTile object.
 /// @ingroup detour
 struct dtMeshHeader
@@ -264,8 +364,10 @@ struct dtMeshHeader
 	
 	int detailTriCount;			///< The number of triangles in the detail mesh.
 	int bvNodeCount;			///< The number of bounding volume nodes. (Zero if bounding volumes are disabled.)
+	int bvTreeWidth;			///< The number of children per bounding volume node. (2, 4 or 8)
 	int offMeshConCount;		///< The number of off-mesh connections.
 	int offMeshBase;			///< The index of the first polygon which is an off-mesh connection.
+	int borderEdgeCount;		///< The number of polygon edges on the tile borders.
 	float walkableHeight;		///< The height of the agents using the tile.
 	float walkableRadius;		///< The radius of the agents using the tile.
 	float walkableClimb;		///< The maximum climb height of the agents using the tile.
@@ -297,15 +399,22 @@ struct dtMeshTile
 	unsigned char* detailTris;	
 
 	/// The tile bounding volume nodes. [Size: dtMeshHeader::bvNodeCount]
-	/// (Will be null if bounding volumes are disabled.)
+	/// (Will be null if bounding volumes are disabled or the tree is wide.)
 	dtBVNode* bvTree;
 
+	/// The tile 4-wide bounding volume nodes, used if dtMeshHeader::bvTreeWidth is 4. [Size: dtMeshHeader::bvNodeCount]
+	dtBVNode4* bvTree4;
+
+	/// The tile 8-wide bounding volume nodes, used if dtMeshHeader::bvTreeWidth is 8. [Size: dtMeshHeader::bvNodeCount]
+	dtBVNode8* bvTree8;
+
 	dtOffMeshConnection* offMeshCons;		///< The tile off-mesh connections. [Size: dtMeshHeader::offMeshConCount]
+	dtBorderEdge* borderEdges;				///< The polygon edges on the tile borders. [Size: dtMeshHeader::borderEdgeCount]
 		
 	unsigned char* data;					///< The tile data. (Not directly accessed under normal situations.)
 	int dataSize;							///< Size of the tile data.
 	int flags;								///< Tile flags. (See: #dtTileFlags)
-	dtMeshTile* next;						///< The next free tile, or the next tile in the spatial grid.
+	dtMeshTile* next;						///< The next free tile, or the next tile at the same tile location.
 private:
 	dtMeshTile(const dtMeshTile&);
 	dtMeshTile& operator=(const dtMeshTile&);
@@ -333,6 +442,61 @@ struct dtNavMeshParams
 	int maxPolys;					///< The maximum number of polygons each tile can contain. This and maxTiles are used to calculate how many bits are needed to identify tiles and polygons uniquely.
 };
 
+/// The structures used to find the tiles at a tile grid location.
+/// @see dtTileLookupParams
+enum dtTileLookupType
+{
+	DT_TILE_LOOKUP_HASH = 0,		///< An open addressing hash table. Tile locations are unbounded. (Default)
+	DT_TILE_LOOKUP_GRID = 1,		///< A dense array covering a bounded range of tile locations.
+};
+
+/// Configures how a navigation mesh finds the tiles at a tile grid location.
+/// @see dtNavMesh::init
+/// @ingroup detour
+struct dtTileLookupParams
+{
+	int type;						///< The lookup structure. (See: #dtTileLookupType)
+	int minX;						///< The smallest tile x-location of the grid. (#DT_TILE_LOOKUP_GRID only)
+	int minY;						///< The smallest tile y-location of the grid. (#DT_TILE_LOOKUP_GRID only)
+	int width;						///< The number of tile locations along the x-axis. (#DT_TILE_LOOKUP_GRID only) [Limit: > 0]
+	int height;						///< The number of tile locations along the y-axis. (#DT_TILE_LOOKUP_GRID only) [Limit: > 0]
+};
+
+/// The number of bits used by each part of the polygon references of a navigation mesh.
+/// @see dtNavMesh::init
+/// @ingroup detour
+struct dtPolyRefBits
+{
+	int saltBits;					///< The bits of the tile salt. [Limit: 10 <= value <= 31]
+	int tileBits;					///< The bits of the tile index. [Limit: Enough for dtNavMeshParams::maxTiles]
+	int polyBits;					///< The bits of the polygon index. [Limit: Enough for dtNavMeshParams::maxPolys]
+};
+
+/// The maximum number of listeners of a navigation mesh.
+/// @ingroup detour
+static const int DT_MAX_NAVMESH_LISTENERS = 8;
+
+class dtNavMesh;
+
+/// Receives the tile changes of a navigation mesh, to keep data derived from its tiles up to date.
+/// @see dtNavMesh::addListener
+/// @ingroup detour
+class dtNavMeshListener
+{
+public:
+	virtual ~dtNavMeshListener() {}
+
+	/// Called after tiles have been added and removed, once per dtNavMesh::addTile or
+	/// dtNavMesh::removeTile outside of a tile batch, and once per dtNavMesh::commitTileBatch.
+	///  @param[in]	nav			The navigation mesh.
+	///  @param[in]	removed		The references of the removed tiles, which are no longer valid. [(tileRef) * @p nremoved]
+	///  @param[in]	nremoved	The number of removed tiles.
+	///  @param[in]	added		The references of the added tiles. [(tileRef) * @p nadded]
+	///  @param[in]	nadded		The number of added tiles.
+	virtual void onTilesChanged(const dtNavMesh* nav, const dtTileRef* removed, const int nremoved,
+								const dtTileRef* added, const int nadded) = 0;
+};
+
 /// A navigation mesh based on tiles of convex polygons.
 /// @ingroup detour
 class dtNavMesh
@@ -349,6 +513,19 @@ public:
 	/// @return The status flags for the operation.
 	dtStatus init(const dtNavMeshParams* params);
 
+	/// Initializes the navigation mesh for tiled use with the specified tile lookup.
+	///  @param[in]	params		Initialization parameters.
+	///  @param[in]	lookup		The tile lookup parameters. [opt]
+	/// @return The status flags for the operation.
+	dtStatus init(const dtNavMeshParams* params, const dtTileLookupParams* lookup);
+
+	/// Initializes the navigation mesh for tiled use with the specified tile lookup and polygon reference layout.
+	///  @param[in]	params		Initialization parameters.
+	///  @param[in]	lookup		The tile lookup parameters. [opt]
+	///  @param[in]	refBits		The number of bits of each part of the polygon references. [opt]
+	/// @return The status flags for the operation.
+	dtStatus init(const dtNavMeshParams* params, const dtTileLookupParams* lookup, const dtPolyRefBits* refBits);
+
 	/// Initializes the navigation mesh for single tile use.
 	///  @param[in]	data		Data of the new tile. (See: #dtCreateNavMeshData)
 	///  @param[in]	dataSize	The data size of the new tile.
@@ -360,6 +537,9 @@ public:
 	/// The navigation mesh initialization params.
 	const dtNavMeshParams* getParams() const;
 
+	/// The number of bits of each part of the polygon references.
+	dtPolyRefBits getPolyRefBits() const;
+
 	/// Adds a tile to the navigation mesh.
 	///  @param[in]		data		Data for the new tile mesh. (See: #dtCreateNavMeshData)
 	///  @param[in]		dataSize	Data size of the new tile mesh.
@@ -376,6 +556,28 @@ public:
 	/// @return The status flags for the operation.
 	dtStatus removeTile(dtTileRef ref, unsigned char** data, int* dataSize);
 
+	/// Starts a batch of tile changes. The tiles added and removed until #commitTileBatch
+	/// are connected to and disconnected from their neighbours when the batch is committed.
+	/// @return The status flags for the operation.
+	dtStatus beginTileBatch();
+
+	/// Connects the tiles added and disconnects the tiles removed since #beginTileBatch,
+	/// then notifies the listeners of the changes.
+	/// @return The status flags for the operation.
+	dtStatus commitTileBatch();
+
+	/// Returns true if a tile batch has been started and not yet committed.
+	bool isTileBatchOpen() const { return m_batchOpen; }
+
+	/// Adds a listener which is notified of the tiles added and removed.
+	///  @param[in]	listener	The listener. It must stay valid until it is removed or the mesh is freed.
+	/// @return The status flags for the operation.
+	dtStatus addListener(dtNavMeshListener* listener);
+
+	/// Removes a listener added with #addListener.
+	///  @param[in]	listener	The listener.
+	void removeListener(dtNavMeshListener* listener);
+
 	/// @}
 
 	/// @{
@@ -528,11 +730,7 @@ public:
 	///  @param[in]	ip		The index of the polygon within the tile.
 	inline dtPolyRef encodePolyId(unsigned int salt, unsigned int it, unsigned int ip) const
 	{
-#ifdef DT_POLYREF64
-		return ((dtPolyRef)salt << (DT_POLY_BITS+DT_TILE_BITS)) | ((dtPolyRef)it << DT_POLY_BITS) | (dtPolyRef)ip;
-#else
 		return ((dtPolyRef)salt << (m_polyBits+m_tileBits)) | ((dtPolyRef)it << m_polyBits) | (dtPolyRef)ip;
-#endif
 	}
 	
 	/// Decodes a standard polygon reference.
@@ -544,21 +742,12 @@ public:
 	///  @see #encodePolyId
 	inline void decodePolyId(dtPolyRef ref, unsigned int& salt, unsigned int& it, unsigned int& ip) const
 	{
-#ifdef DT_POLYREF64
-		const dtPolyRef saltMask = ((dtPolyRef)1<<DT_SALT_BITS)-1;
-		const dtPolyRef tileMask = ((dtPolyRef)1<<DT_TILE_BITS)-1;
-		const dtPolyRef polyMask = ((dtPolyRef)1<<DT_POLY_BITS)-1;
-		salt = (unsigned int)((ref >> (DT_POLY_BITS+DT_TILE_BITS)) & saltMask);
-		it = (unsigned int)((ref >> DT_POLY_BITS) & tileMask);
-		ip = (unsigned int)(ref & polyMask);
-#else
 		const dtPolyRef saltMask = ((dtPolyRef)1<<m_saltBits)-1;
 		const dtPolyRef tileMask = ((dtPolyRef)1<<m_tileBits)-1;
 		const dtPolyRef polyMask = ((dtPolyRef)1<<m_polyBits)-1;
 		salt = (unsigned int)((ref >> (m_polyBits+m_tileBits)) & saltMask);
 		it = (unsigned int)((ref >> m_polyBits) & tileMask);
 		ip = (unsigned int)(ref & polyMask);
-#endif
 	}
 
 	/// Extracts a tile's salt value from the specified polygon reference.
@@ -567,13 +756,8 @@ public:
 	///  @see #encodePolyId
 	inline unsigned int decodePolyIdSalt(dtPolyRef ref) const
 	{
-#ifdef DT_POLYREF64
-		const dtPolyRef saltMask = ((dtPolyRef)1<<DT_SALT_BITS)-1;
-		return (unsigned int)((ref >> (DT_POLY_BITS+DT_TILE_BITS)) & saltMask);
-#else
 		const dtPolyRef saltMask = ((dtPolyRef)1<<m_saltBits)-1;
 		return (unsigned int)((ref >> (m_polyBits+m_tileBits)) & saltMask);
-#endif
 	}
 	
 	/// Extracts the tile's index from the specified polygon reference.
@@ -582,13 +766,8 @@ public:
 	///  @see #encodePolyId
 	inline unsigned int decodePolyIdTile(dtPolyRef ref) const
 	{
-#ifdef DT_POLYREF64
-		const dtPolyRef tileMask = ((dtPolyRef)1<<DT_TILE_BITS)-1;
-		return (unsigned int)((ref >> DT_POLY_BITS) & tileMask);
-#else
 		const dtPolyRef tileMask = ((dtPolyRef)1<<m_tileBits)-1;
 		return (unsigned int)((ref >> m_polyBits) & tileMask);
-#endif
 	}
 	
 	/// Extracts the polygon's index (within its tile) from the specified polygon reference.
@@ -597,13 +776,8 @@ public:
 	///  @see #encodePolyId
 	inline unsigned int decodePolyIdPoly(dtPolyRef ref) const
 	{
-#ifdef DT_POLYREF64
-		const dtPolyRef polyMask = ((dtPolyRef)1<<DT_POLY_BITS)-1;
-		return (unsigned int)(ref & polyMask);
-#else
 		const dtPolyRef polyMask = ((dtPolyRef)1<<m_polyBits)-1;
 		return (unsigned int)(ref & polyMask);
-#endif
 	}
 
 	/// @}
@@ -624,11 +798,6 @@ private:
 	int getNeighbourTilesAt(const int x, const int y, const int side,
 							dtMeshTile** tiles, const int maxTiles) const;
 	
-	/// Returns all polygons in neighbour tile based on portal defined by the segment.
-	int findConnectingPolys(const float* va, const float* vb,
-							const dtMeshTile* tile, int side,
-							dtPolyRef* con, float* conarea, int maxcon) const;
-	
 	/// Builds internal polygons links for a tile.
 	void connectIntLinks(dtMeshTile* tile);
 	/// Builds internal polygons links for a tile.
@@ -639,8 +808,15 @@ private:
 	/// Builds external polygon links for a tile.
 	void connectExtOffMeshLinks(dtMeshTile* tile, dtMeshTile* target, int side);
 	
-	/// Removes external links at specified side.
-	void unconnectLinks(dtMeshTile* tile, dtMeshTile* target);
+	/// Removes the links to the tiles removed in the current tile batch.
+	void unconnectRemovedLinks(dtMeshTile* tile);
+
+	/// Adds a tile without connecting it to the neighbour tiles.
+	dtStatus addBatchTile(unsigned char* data, int dataSize, int flags, dtTileRef lastRef, dtTileRef* result);
+	/// Removes a tile without disconnecting the neighbour tiles from it.
+	dtStatus removeBatchTile(dtTileRef ref, unsigned char** data, int* dataSize);
+	/// Connects a tile added in the current tile batch with its neighbours.
+	void connectBatchTile(dtMeshTile* tile);
 	
 
 	// TODO: These methods are duplicates from dtNavMeshQuery, but are needed for off-mesh connection finding.
@@ -660,18 +836,42 @@ private:
 	float m_orig[3];					///< Origin of the tile (0,0)
 	float m_tileWidth, m_tileHeight;	///< Dimensions of each tile.
 	int m_maxTiles;						///< Max number of tiles.
-	int m_tileLutSize;					///< Tile hash lookup size (must be pot).
+
+	/// A tile location in the position lookup. The tiles of all the layers at the location are
+	/// chained through dtMeshTile::next.
+	struct dtTileLookupSlot
+	{
+		int x, y;
+		dtMeshTile* tiles;
+	};
+
+	dtTileLookupSlot* findTileSlot(const int x, const int y) const;
+	dtTileLookupSlot* insertTileSlot(const int x, const int y);
+	void removeTileSlot(dtTileLookupSlot* slot);
+
+	dtTileLookupParams m_lookup;		///< Tile lookup parameters.
+	int m_tileLutSize;					///< Tile lookup size (must be pot for the hash table).
 	int m_tileLutMask;					///< Tile hash lookup mask.
 
-	dtMeshTile** m_posLookup;			///< Tile hash lookup.
+	dtTileLookupSlot* m_posLookup;		///< Tile lookup, a hash table or a grid of tile locations.
 	dtMeshTile* m_nextFree;				///< Freelist of tiles.
 	dtMeshTile* m_tiles;				///< List of tiles.
 		
-#ifndef DT_POLYREF64
 	unsigned int m_saltBits;			///< Number of salt bits in the tile ID.
 	unsigned int m_tileBits;			///< Number of tile bits in the tile ID.
 	unsigned int m_polyBits;			///< Number of poly bits in the tile ID.
-#endif
+
+	bool m_batchOpen;					///< True while a tile batch is open.
+	unsigned char* m_batchFlags;		///< The batch state of each tile. [Size: #m_maxTiles]
+	dtTileRef* m_batchAdded;			///< The tiles added in the batch. [Size: #m_maxTiles]
+	int m_batchAddedCount;
+	dtTileRef* m_batchRemoved;			///< The tiles removed in the batch.
+	int* m_batchRemovedLocs;			///< The locations of the removed tiles. [(x, y) * #m_batchRemovedCount]
+	int m_batchRemovedCount;
+	int m_batchRemovedCapacity;
+
+	dtNavMeshListener* m_listeners[DT_MAX_NAVMESH_LISTENERS];	///< The listeners notified of the tile changes.
+	int m_listenerCount;
 
 	friend class dtNavMeshQuery;
 };
@@ -21,6 +21,14 @@
 
 #include "DetourAlloc.h"
 
+/// Strategies used to split the bounding volume tree nodes in #dtCreateNavMeshData.
+/// @ingroup detour
+enum dtBVTreeSplit
+{
+	DT_BVTREE_SPLIT_MEDIAN = 0,	///< Split at the median polygon along the longest axis of the node.
+	DT_BVTREE_SPLIT_SAH = 1		///< Split where the binned surface area heuristic is the lowest. Gives tighter trees for elongated polygons.
+};
+
 /// Represents the source data used to build an navigation mesh tile.
 /// @ingroup detour
 struct dtNavMeshCreateParams
@@ -101,6 +109,13 @@ struct dtNavMeshCreateParams
 	/// @note The BVTree is not normally needed for layered navigation meshes.
 	bool buildBvTree;
 
+	/// How the bounding volume tree nodes are split. (See: #dtBVTreeSplit)
+	int bvTreeSplit;
+
+	/// The number of children per bounding volume tree node: 2 (or 0) for a binary tree, 4 or 8 for
+	/// a wide tree that tests all the children of a node at once. (See: #dtBVNode4, #dtBVNode8)
+	int bvTreeWidth;
+
 	/// @}
 };
 
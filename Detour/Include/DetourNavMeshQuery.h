@@ -20,6 +20,8 @@
 #define DETOURNAVMESHQUERY_H
 
 #include "DetourNavMesh.h"
+#include "DetourLandmarks.h"
+#include "DetourAreaSampler.h"
 #include "DetourStatus.h"
 
 
@@ -30,6 +32,19 @@
 
 //#define DT_VIRTUAL_QUERYFILTER 1
 
+/// Scale applied to the path search heuristic, slightly below one so that rounding
+/// errors do not make it overestimate the remaining cost.
+/// @ingroup detour
+static const float DT_HEURISTIC_SCALE = 0.999f;
+
+/// Names the filter type of the templated queries. The type is not deduced from the
+/// filter argument, so the filter class has to be given explicitly, e.g. findPath<MyFilter>().
+template <class Filter>
+struct dtFilterType
+{
+	typedef Filter Type;
+};
+
 /// Defines polygon filtering and traversal costs for navigation mesh query operations.
 /// @ingroup detour
 class dtQueryFilter
@@ -119,6 +134,7 @@ public:
 
 };
 
+
 /// Provides information about raycast hit
 /// filled by dtNavMeshQuery::raycast
 /// @ingroup detour
@@ -170,7 +186,7 @@ public:
 	
 	/// Initializes the query object.
 	///  @param[in]		nav			Pointer to the dtNavMesh object to use for all queries.
-	///  @param[in]		maxNodes	Maximum number of search nodes. [Limits: 0 < value <= 65535]
+	///  @param[in]		maxNodes	Maximum number of search nodes. [Limits: 0 < value < 2^24]
 	/// @returns The status flags for the query.
 	dtStatus init(const dtNavMesh* nav, const int maxNodes);
 	
@@ -192,6 +208,50 @@ public:
 					  const dtQueryFilter* filter,
 					  dtPolyRef* path, int* pathCount, const int maxPath) const;
 
+	/// Finds a path from the start polygon to the end polygon using the specified search strategy.
+	///  @param[in]		startRef		The reference id of the start polygon.
+	///  @param[in]		endRef			The reference id of the end polygon.
+	///  @param[in]		startPos		A position within the start polygon. [(x, y, z)]
+	///  @param[in]		endPos			A position within the end polygon. [(x, y, z)]
+	///  @param[in]		filter			The polygon filter to apply to the query.
+	///  @param[out]	path			An ordered list of polygon references representing the path. (Start to end.) 
+	///  								[(polyRef) * @p pathCount]
+	///  @param[out]	pathCount		The number of polygons returned in the @p path array.
+	///  @param[in]		maxPath			The maximum number of polygons the @p path array can hold. [Limit: >= 1]
+	///  @param[in]		options			Search options. (see: #dtFindPathOptions)
+	///  @param[in]		heuristicWeight	The weight applied to the distance heuristic. Values above one expand
+	///  								fewer nodes at the expense of path optimality. [Limit: >= 0]
+	/// @returns The status flags for the query.
+	dtStatus findPath(dtPolyRef startRef, dtPolyRef endRef,
+					  const float* startPos, const float* endPos,
+					  const dtQueryFilter* filter,
+					  dtPolyRef* path, int* pathCount, const int maxPath,
+					  const unsigned int options, const float heuristicWeight = 1.0f) const;
+
+	/// Finds a path from the start polygon to the end polygon, using a filter type known at compile time.
+	///
+	/// The filter calls are bound statically and can be inlined into the search loop, which avoids the 
+	/// cost of virtual calls when using custom filters. @p Filter has to provide passFilter() and getCost()
+	/// with the same signatures as dtQueryFilter, but does not need to derive from it. If it does derive
+	/// from dtQueryFilter with #DT_VIRTUAL_QUERYFILTER defined, declare the class final so that the calls
+	/// are not dispatched virtually.
+	///
+	/// The filter type is not deduced from the arguments, it has to be specified explicitly:
+	/// @code
+	/// query->findPath<MyFilter>(startRef, endRef, startPos, endPos, &myFilter, path, &pathCount, maxPath);
+	/// @endcode
+	///
+	/// The implementation is in DetourNavMeshQueryTemplate.inl, which has to be included by the
+	/// source files that instantiate it for their own filter types.
+	///
+	/// See the non-template overload for the description of the parameters.
+	template <class Filter>
+	dtStatus findPath(dtPolyRef startRef, dtPolyRef endRef,
+					  const float* startPos, const float* endPos,
+					  const typename dtFilterType<Filter>::Type* filter,
+					  dtPolyRef* path, int* pathCount, const int maxPath,
+					  const unsigned int options = 0, const float heuristicWeight = 1.0f) const;
+
 	/// Finds the straight path from the start to the end position within the polygon corridor.
 	///  @param[in]		startPos			Path start position. [(x, y, z)]
 	///  @param[in]		endPos				Path end position. [(x, y, z)]
@@ -224,10 +284,13 @@ public:
 	///  @param[in]		endPos		A position within the end polygon. [(x, y, z)]
 	///  @param[in]		filter		The polygon filter to apply to the query.
 	///  @param[in]		options		query options (see: #dtFindPathOptions)
+	///  @param[in]		heuristicWeight	The weight applied to the distance heuristic. Values above one expand
+	///  							fewer nodes at the expense of path optimality. [Limit: >= 0]
 	/// @returns The status flags for the query.
 	dtStatus initSlicedFindPath(dtPolyRef startRef, dtPolyRef endRef,
 								const float* startPos, const float* endPos,
-								const dtQueryFilter* filter, const unsigned int options = 0);
+								const dtQueryFilter* filter, const unsigned int options = 0,
+								const float heuristicWeight = 1.0f);
 
 	/// Updates an in-progress sliced path query.
 	///  @param[in]		maxIter		The maximum number of iterations to perform.
@@ -369,11 +432,14 @@ public:
 	///  								Zero if a result polygon has no parent. [opt]
 	///  @param[out]	resultCount		The number of polygons found.
 	///  @param[in]		maxResult		The maximum number of polygons the result arrays can hold.
+	///  @param[in]		scratch			The scratch space of the search, or null to use the one of
+	///  								the query object. [opt]
 	/// @returns The status flags for the query.
 	dtStatus findLocalNeighbourhood(dtPolyRef startRef, const float* centerPos, const float radius,
 									const dtQueryFilter* filter,
 									dtPolyRef* resultRef, dtPolyRef* resultParent,
-									int* resultCount, const int maxResult) const;
+									int* resultCount, const int maxResult,
+									class dtLocalSearchScratch* scratch = 0) const;
 
 	/// Moves from the start to the end position constrained to the navigation mesh.
 	///  @param[in]		startRef		The reference id of the start polygon.
@@ -384,10 +450,13 @@ public:
 	///  @param[out]	visited			The reference ids of the polygons visited during the move.
 	///  @param[out]	visitedCount	The number of polygons visited during the move.
 	///  @param[in]		maxVisitedSize	The maximum number of polygons the @p visited array can hold.
+	///  @param[in]		scratch			The scratch space of the search, or null to use the one of
+	///  								the query object. [opt]
 	/// @returns The status flags for the query.
 	dtStatus moveAlongSurface(dtPolyRef startRef, const float* startPos, const float* endPos,
 							  const dtQueryFilter* filter,
-							  float* resultPos, dtPolyRef* visited, int* visitedCount, const int maxVisitedSize) const;
+							  float* resultPos, dtPolyRef* visited, int* visitedCount, const int maxVisitedSize,
+							  class dtLocalSearchScratch* scratch = 0) const;
 	
 	/// Casts a 'walkability' ray along the surface of the navigation mesh from 
 	/// the start position toward the end position.
@@ -422,6 +491,24 @@ public:
 					 const dtQueryFilter* filter, const unsigned int options,
 					 dtRaycastHit* hit, dtPolyRef prevRef = 0) const;
 
+	/// Casts many 'walkability' rays along the surface of the navigation mesh, with the
+	/// same results as casting each ray with #raycast.
+	///  @param[in]		startRefs	The reference ids of the start polygons. [(polyRef) * @p nrays]
+	///  @param[in]		startPos	The positions within the start polygons representing
+	///  							the starts of the rays. [(x, y, z) * @p nrays]
+	///  @param[in]		endPos		The positions to cast the rays toward. [(x, y, z) * @p nrays]
+	///  @param[in]		nrays		The number of rays.
+	///  @param[in]		filter		The polygon filter to apply to the query.
+	///  @param[in]		options		govern how the raycasts behave. See dtRaycastOptions
+	///  @param[out]	hits		The raycast hit structures filled by the results, with the path
+	///  							buffers of each ray set by the caller. [(hit) * @p nrays]
+	///  @param[out]	statuses	The status flags of each ray. [opt] [(status) * @p nrays]
+	///  @param[in]		prevRefs	The parents of the start refs. Used for cost calculation. [opt] [(polyRef) * @p nrays]
+	/// @returns The status flags for the query.
+	dtStatus raycastBatch(const dtPolyRef* startRefs, const float* startPos, const float* endPos, const int nrays,
+						  const dtQueryFilter* filter, const unsigned int options,
+						  dtRaycastHit* hits, dtStatus* statuses = 0, const dtPolyRef* prevRefs = 0) const;
+
 
 	/// Finds the distance from the specified position to the nearest polygon wall.
 	///  @param[in]		startRef		The reference id of the polygon containing @p centerPos.
@@ -451,7 +538,8 @@ public:
 								 const int maxSegments) const;
 
 	/// Returns random location on navmesh.
-	/// Polygons are chosen weighted by area. The search runs in linear related to number of polygon.
+	/// Polygons are chosen weighted by area. The search runs in linear related to number of polygon,
+	/// or in logarithmic time with an area sampler that matches the filter. (See: #setAreaSampler)
 	///  @param[in]		filter			The polygon filter to apply to the query.
 	///  @param[in]		frand			Function returning a random number [0..1).
 	///  @param[out]	randomRef		The reference id of the random location.
@@ -520,12 +608,33 @@ public:
 	/// @return The navigation mesh the query object is using.
 	const dtNavMesh* getAttachedNavMesh() const { return m_nav; }
 
+	/// Sets the landmark distances used to improve the path finding heuristic.
+	///  @param[in]		landmarks	The landmarks computed for the attached navigation mesh, or null
+	///  							to use the straight line distance only.
+	void setLandmarks(const dtNavMeshLandmarks* landmarks) { m_landmarks = landmarks; }
+
+	/// Gets the landmark distances used by the path finding heuristic.
+	/// @return The landmarks, or null if not set.
+	const dtNavMeshLandmarks* getLandmarks() const { return m_landmarks; }
+
+	/// Sets the area tables used by #findRandomPoint for the filters that match them.
+	///  @param[in]		sampler		The area sampler computed for the attached navigation mesh, or null
+	///  							to visit every polygon.
+	void setAreaSampler(const dtNavMeshAreaSampler* sampler) { m_areaSampler = sampler; }
+
+	/// Gets the area tables used by #findRandomPoint.
+	/// @return The area sampler, or null if not set.
+	const dtNavMeshAreaSampler* getAreaSampler() const { return m_areaSampler; }
+
 	/// @}
 	
 private:
 	// Explicitly disabled copy constructor and copy assignment operator
 	dtNavMeshQuery(const dtNavMeshQuery&);
 	dtNavMeshQuery& operator=(const dtNavMeshQuery&);
+
+	// Queries the portals of the corridors it iterates.
+	friend class dtStraightPathIterator;
 	
 	/// Queries polygons within a tile.
 	void queryPolygonsInTile(const dtMeshTile* tile, const float* qmin, const float* qmax,
@@ -556,8 +665,31 @@ private:
 
 	// Gets the path leading to the specified end node.
 	dtStatus getPathToNode(struct dtNode* endNode, dtPolyRef* path, int* pathCount, int maxPath) const;
+
+	// Bidirectional variant of findPath.
+	template <class Filter>
+	dtStatus findPathBidirectional(dtPolyRef startRef, dtPolyRef endRef,
+								   const float* startPos, const float* endPos,
+								   const Filter* filter,
+								   dtPolyRef* path, int* pathCount, const int maxPath,
+								   const unsigned int options, const float heuristicScale) const;
 	
+	/// Returns the landmark bounds of the goal polygon, or null if the landmarks do not cover it.
+	const float* getGoalBounds(dtPolyRef ref, float* bounds) const;
+
+	// Estimates the remaining cost to the goal, tightened by the landmark bounds when available.
+	float getHeuristic(const float* goalBounds, dtPolyRef ref, const float* pos, const float* goalPos) const;
+
+	// Node states used to tell the two frontiers of a bidirectional search apart.
+	enum dtSearchDirection
+	{
+		DT_SEARCH_FORWARD = 0,
+		DT_SEARCH_BACKWARD = 1
+	};
+
 	const dtNavMesh* m_nav;				///< Pointer to navmesh data.
+	const dtNavMeshLandmarks* m_landmarks;	///< Landmark distances for the search heuristic. [opt]
+	const dtNavMeshAreaSampler* m_areaSampler;	///< Area tables for random points. [opt]
 
 	struct dtQueryData
 	{
@@ -569,12 +701,16 @@ private:
 		const dtQueryFilter* filter;
 		unsigned int options;
 		float raycastLimitSqr;
+		float heuristicScale;
+		bool useLandmarks;
+		float goalBounds[DT_MAX_LANDMARKS*2];
 	};
 	dtQueryData m_query;				///< Sliced query state.
 
-	class dtNodePool* m_tinyNodePool;	///< Pointer to small node pool.
+	class dtLocalSearchScratch* m_localScratch;	///< Scratch space of the local searches.
 	class dtNodePool* m_nodePool;		///< Pointer to node pool.
 	class dtNodeQueue* m_openList;		///< Pointer to open list queue.
+	class dtNodeQueue* m_backOpenList;	///< Pointer to the open list queue of the backward search.
 };
 
 /// Allocates a query object using the Detour allocator.
@@ -0,0 +1,545 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURNAVMESHQUERYTEMPLATE_INL
+#define DETOURNAVMESHQUERYTEMPLATE_INL
+
+// Implementation of the path searches templated on the query filter.
+// Include this file in the source files that call dtNavMeshQuery::findPath<Filter>() with
+// another filter type than dtQueryFilter.
+
+#include <float.h>
+#include "DetourNavMeshQuery.h"
+#include "DetourNode.h"
+#include "DetourCommon.h"
+#include "DetourMath.h"
+#include "DetourAssert.h"
+
+#ifndef DT_VIRTUAL_QUERYFILTER
+// Defined here so that the findPath<dtQueryFilter> instances compiled outside of the
+// library can inline them too.
+inline bool dtQueryFilter::passFilter(const dtPolyRef /*ref*/,
+									  const dtMeshTile* /*tile*/,
+									  const dtPoly* poly) const
+{
+	return (poly->flags & m_includeFlags) != 0 && (poly->flags & m_excludeFlags) == 0;
+}
+
+inline float dtQueryFilter::getCost(const float* pa, const float* pb,
+									const dtPolyRef /*prevRef*/, const dtMeshTile* /*prevTile*/, const dtPoly* /*prevPoly*/,
+									const dtPolyRef /*curRef*/, const dtMeshTile* /*curTile*/, const dtPoly* curPoly,
+									const dtPolyRef /*nextRef*/, const dtMeshTile* /*nextTile*/, const dtPoly* /*nextPoly*/) const
+{
+	return dtVdist(pa, pb) * m_areaCost[curPoly->getArea()];
+}
+#endif
+
+inline float dtNavMeshQuery::getHeuristic(const float* goalBounds, dtPolyRef ref, const float* pos, const float* goalPos) const
+{
+	const float h = dtVdist(pos, goalPos);
+	if (!goalBounds)
+		return h;
+	return dtMax(h, m_landmarks->getCostBound(ref, goalBounds));
+}
+
+template <class Filter>
+dtStatus dtNavMeshQuery::findPath(dtPolyRef startRef, dtPolyRef endRef,
+								  const float* startPos, const float* endPos,
+								  const typename dtFilterType<Filter>::Type* filter,
+								  dtPolyRef* path, int* pathCount, const int maxPath,
+								  const unsigned int options, const float heuristicWeight) const
+{
+	dtAssert(m_nav);
+	dtAssert(m_nodePool);
+	dtAssert(m_openList);
+
+	if (!pathCount)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	*pathCount = 0;
+	
+	// Validate input
+	if (!m_nav->isValidPolyRef(startRef) || !m_nav->isValidPolyRef(endRef) ||
+		!startPos || !dtVisfinite(startPos) ||
+		!endPos || !dtVisfinite(endPos) ||
+		!filter || !path || maxPath <= 0 ||
+		!dtMathIsfinite(heuristicWeight) || heuristicWeight < 0.0f)
+	{
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+
+	if (startRef == endRef)
+	{
+		path[0] = startRef;
+		*pathCount = 1;
+		return DT_SUCCESS;
+	}
+
+	const float heuristicScale = DT_HEURISTIC_SCALE * heuristicWeight;
+
+	if (options & DT_FINDPATH_BIDIRECTIONAL)
+	{
+		return findPathBidirectional<Filter>(startRef, endRef, startPos, endPos, filter,
+									 path, pathCount, maxPath, options, heuristicScale);
+	}
+	
+	m_nodePool->clear();
+	m_openList->clear();
+
+	float goalBoundsData[DT_MAX_LANDMARKS*2];
+	const float* goalBounds = getGoalBounds(endRef, goalBoundsData);
+	
+	dtNode* startNode = m_nodePool->getNode(startRef);
+	dtVcopy(m_nodePool->getNodePos(startNode), startPos);
+	startNode->pidx = 0;
+	startNode->cost = 0;
+	startNode->total = getHeuristic(goalBounds, startRef, startPos, endPos) * heuristicScale;
+	startNode->id = startRef;
+	startNode->flags = DT_NODE_OPEN;
+	m_openList->push(startNode);
+	
+	dtNode* lastBestNode = startNode;
+	float lastBestNodeCost = startNode->total;
+	
+	bool outOfNodes = false;
+	
+	while (!m_openList->empty())
+	{
+		// Remove node from open list and put it in closed list.
+		dtNode* bestNode = m_openList->pop();
+		bestNode->flags &= ~DT_NODE_OPEN;
+		bestNode->flags |= DT_NODE_CLOSED;
+		
+		// Reached the goal, stop searching.
+		if (bestNode->id == endRef)
+		{
+			lastBestNode = bestNode;
+			break;
+		}
+		
+		// Get current poly and tile.
+		// The API input has been checked already, skip checking internal data.
+		const dtPolyRef bestRef = bestNode->id;
+		const dtMeshTile* bestTile = 0;
+		const dtPoly* bestPoly = 0;
+		m_nav->getTileAndPolyByRefUnsafe(bestRef, &bestTile, &bestPoly);
+		
+		// Get parent poly and tile.
+		dtPolyRef parentRef = 0;
+		const dtMeshTile* parentTile = 0;
+		const dtPoly* parentPoly = 0;
+		if (bestNode->pidx)
+			parentRef = m_nodePool->getNodeAtIdx(bestNode->pidx)->id;
+		if (parentRef)
+			m_nav->getTileAndPolyByRefUnsafe(parentRef, &parentTile, &parentPoly);
+		
+		for (unsigned int i = bestPoly->firstLink; i != DT_NULL_LINK; i = bestTile->links[i].next)
+		{
+			dtPolyRef neighbourRef = bestTile->links[i].ref;
+			
+			// Skip invalid ids and do not expand back to where we came from.
+			if (!neighbourRef || neighbourRef == parentRef)
+				continue;
+			
+			// Get neighbour poly and tile.
+			// The API input has been checked already, skip checking internal data.
+			const dtMeshTile* neighbourTile = 0;
+			const dtPoly* neighbourPoly = 0;
+			m_nav->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);			
+			
+			if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
+				continue;
+
+			// deal explicitly with crossing tile boundaries
+			unsigned char crossSide = 0;
+			if (bestTile->links[i].side != 0xff)
+				crossSide = bestTile->links[i].side >> 1;
+
+			// get the node
+			dtNode* neighbourNode = m_nodePool->getNode(neighbourRef, crossSide);
+			if (!neighbourNode)
+			{
+				outOfNodes = true;
+				continue;
+			}
+			
+			// If the node is visited the first time, calculate node position.
+			if (neighbourNode->flags == 0)
+			{
+				getEdgeMidPoint(bestRef, bestPoly, bestTile,
+								neighbourRef, neighbourPoly, neighbourTile,
+								m_nodePool->getNodePos(neighbourNode));
+			}
+
+			// Calculate cost and heuristic.
+			float cost = 0;
+			float heuristic = 0;
+			
+			// Special case for last node.
+			if (neighbourRef == endRef)
+			{
+				// Cost
+				const float curCost = filter->getCost(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
+													  parentRef, parentTile, parentPoly,
+													  bestRef, bestTile, bestPoly,
+													  neighbourRef, neighbourTile, neighbourPoly);
+				const float endCost = filter->getCost(m_nodePool->getNodePos(neighbourNode), endPos,
+													  bestRef, bestTile, bestPoly,
+													  neighbourRef, neighbourTile, neighbourPoly,
+													  0, 0, 0);
+				
+				cost = bestNode->cost + curCost + endCost;
+				heuristic = 0;
+			}
+			else
+			{
+				// Cost
+				const float curCost = filter->getCost(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
+													  parentRef, parentTile, parentPoly,
+													  bestRef, bestTile, bestPoly,
+													  neighbourRef, neighbourTile, neighbourPoly);
+				cost = bestNode->cost + curCost;
+				heuristic = getHeuristic(goalBounds, neighbourRef, m_nodePool->getNodePos(neighbourNode), endPos)*heuristicScale;
+			}
+
+			const float total = cost + heuristic;
+			
+			// The node is already in open list and the new result is worse, skip.
+			if ((neighbourNode->flags & DT_NODE_OPEN) && total >= neighbourNode->total)
+				continue;
+			// The node is already visited and process, and the new result is worse, skip.
+			if ((neighbourNode->flags & DT_NODE_CLOSED) && total >= neighbourNode->total)
+				continue;
+			
+			// Add or update the node.
+			neighbourNode->pidx = m_nodePool->getNodeIdx(bestNode);
+			neighbourNode->id = neighbourRef;
+			neighbourNode->flags = (neighbourNode->flags & ~DT_NODE_CLOSED);
+			neighbourNode->cost = cost;
+			neighbourNode->total = total;
+			
+			if (neighbourNode->flags & DT_NODE_OPEN)
+			{
+				// Already in open, update node location.
+				m_openList->modify(neighbourNode);
+			}
+			else
+			{
+				// Put the node in open list.
+				neighbourNode->flags |= DT_NODE_OPEN;
+				m_openList->push(neighbourNode);
+			}
+			
+			// Update nearest node to target so far.
+			if (heuristic < lastBestNodeCost)
+			{
+				lastBestNodeCost = heuristic;
+				lastBestNode = neighbourNode;
+			}
+
+			// Reached the goal and the caller does not need the cheapest path, stop searching.
+			if (neighbourRef == endRef && (options & DT_FINDPATH_FIRST_PATH))
+			{
+				lastBestNode = neighbourNode;
+				m_openList->clear();
+				break;
+			}
+		}
+	}
+
+	dtStatus status = getPathToNode(lastBestNode, path, pathCount, maxPath);
+
+	if (lastBestNode->id != endRef)
+		status |= DT_PARTIAL_RESULT;
+
+	if (outOfNodes)
+		status |= DT_OUT_OF_NODES;
+	
+	return status;
+}
+
+template <class Filter>
+dtStatus dtNavMeshQuery::findPathBidirectional(dtPolyRef startRef, dtPolyRef endRef,
+											   const float* startPos, const float* endPos,
+											   const Filter* filter,
+											   dtPolyRef* path, int* pathCount, const int maxPath,
+											   const unsigned int options, const float heuristicScale) const
+{
+	m_nodePool->clear();
+	m_openList->clear();
+	m_backOpenList->clear();
+
+	float endBoundsData[DT_MAX_LANDMARKS*2];
+	float startBoundsData[DT_MAX_LANDMARKS*2];
+	const float* endBounds = getGoalBounds(endRef, endBoundsData);
+	const float* startBounds = getGoalBounds(startRef, startBoundsData);
+
+	// Both searches share the node pool. The forward nodes store the cost from the start,
+	// the backward nodes store the cost to the end and point to the next polygon towards the end.
+	dtNode* startNode = m_nodePool->getNode(startRef, DT_SEARCH_FORWARD);
+	dtVcopy(m_nodePool->getNodePos(startNode), startPos);
+	startNode->pidx = 0;
+	startNode->cost = 0;
+	startNode->total = getHeuristic(endBounds, startRef, startPos, endPos) * heuristicScale;
+	startNode->id = startRef;
+	startNode->flags = DT_NODE_OPEN;
+	m_openList->push(startNode);
+
+	dtNode* endNode = m_nodePool->getNode(endRef, DT_SEARCH_BACKWARD);
+	dtVcopy(m_nodePool->getNodePos(endNode), endPos);
+	endNode->pidx = 0;
+	endNode->cost = 0;
+	endNode->total = startNode->total;
+	endNode->id = endRef;
+	endNode->flags = DT_NODE_OPEN;
+	m_backOpenList->push(endNode);
+
+	dtNode* lastBestNode = startNode;
+	float lastBestNodeCost = startNode->total;
+
+	// Cheapest complete path found so far, joined at a polygon reached by both searches.
+	dtNode* meetForward = 0;
+	dtNode* meetBackward = 0;
+	float meetCost = FLT_MAX;
+
+	bool outOfNodes = false;
+	bool done = false;
+
+	while (!done && (!m_openList->empty() || !m_backOpenList->empty()))
+	{
+		// Any path cheaper than the best one found so far has to pass through the open nodes 
+		// of both searches, stop when either of them cannot improve it.
+		if ((!m_openList->empty() && m_openList->top()->total >= meetCost) ||
+			(!m_backOpenList->empty() && m_backOpenList->top()->total >= meetCost))
+			break;
+		// The forward search visited every reachable polygon without meeting the backward search.
+		if (m_openList->empty() && !meetForward)
+			break;
+
+		// Expand the search with the smaller frontier. The backward search skips one-way links
+		// and can run out of nodes while the end is still reachable, then the forward search
+		// continues on its own until it reaches a polygon the backward search has visited.
+		const bool backward = m_openList->empty() ||
+			(!m_backOpenList->empty() && m_backOpenList->getSize() < m_openList->getSize());
+		dtNodeQueue* openList = backward ? m_backOpenList : m_openList;
+		const float* goalPos = backward ? startPos : endPos;
+		const float* goalBounds = backward ? startBounds : endBounds;
+
+		// Remove node from open list and put it in closed list.
+		dtNode* bestNode = openList->pop();
+		bestNode->flags &= ~DT_NODE_OPEN;
+		bestNode->flags |= DT_NODE_CLOSED;
+
+		// Get current poly and tile.
+		// The API input has been checked already, skip checking internal data.
+		const dtPolyRef bestRef = bestNode->id;
+		const dtMeshTile* bestTile = 0;
+		const dtPoly* bestPoly = 0;
+		m_nav->getTileAndPolyByRefUnsafe(bestRef, &bestTile, &bestPoly);
+
+		// Get parent poly and tile.
+		// For the backward search this is the next polygon towards the end.
+		dtPolyRef parentRef = 0;
+		const dtMeshTile* parentTile = 0;
+		const dtPoly* parentPoly = 0;
+		if (bestNode->pidx)
+			parentRef = m_nodePool->getNodeAtIdx(bestNode->pidx)->id;
+		if (parentRef)
+			m_nav->getTileAndPolyByRefUnsafe(parentRef, &parentTile, &parentPoly);
+
+		for (unsigned int i = bestPoly->firstLink; i != DT_NULL_LINK; i = bestTile->links[i].next)
+		{
+			dtPolyRef neighbourRef = bestTile->links[i].ref;
+
+			// Skip invalid ids and do not expand back to where we came from.
+			if (!neighbourRef || neighbourRef == parentRef)
+				continue;
+
+			// Get neighbour poly and tile.
+			// The API input has been checked already, skip checking internal data.
+			const dtMeshTile* neighbourTile = 0;
+			const dtPoly* neighbourPoly = 0;
+			m_nav->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);
+
+			if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
+				continue;
+
+			// The backward search follows the links in reverse, skip one-way links.
+			if (backward)
+			{
+				bool linksBack = false;
+				for (unsigned int j = neighbourPoly->firstLink; j != DT_NULL_LINK; j = neighbourTile->links[j].next)
+				{
+					if (neighbourTile->links[j].ref == bestRef)
+					{
+						linksBack = true;
+						break;
+					}
+				}
+				if (!linksBack)
+					continue;
+			}
+
+			// get the node
+			dtNode* neighbourNode = m_nodePool->getNode(neighbourRef, bestNode->state);
+			if (!neighbourNode)
+			{
+				outOfNodes = true;
+				continue;
+			}
+
+			// If the node is visited the first time, calculate node position.
+			if (neighbourNode->flags == 0)
+			{
+				getEdgeMidPoint(bestRef, bestPoly, bestTile,
+								neighbourRef, neighbourPoly, neighbourTile,
+								m_nodePool->getNodePos(neighbourNode));
+			}
+
+			// Calculate cost and heuristic.
+			// Costs are always evaluated in the direction of travel, the backward search
+			// moves from the neighbour across the current polygon towards its parent.
+			float curCost;
+			if (backward)
+			{
+				curCost = filter->getCost(m_nodePool->getNodePos(neighbourNode), m_nodePool->getNodePos(bestNode),
+										  neighbourRef, neighbourTile, neighbourPoly,
+										  bestRef, bestTile, bestPoly,
+										  parentRef, parentTile, parentPoly);
+			}
+			else
+			{
+				curCost = filter->getCost(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
+										  parentRef, parentTile, parentPoly,
+										  bestRef, bestTile, bestPoly,
+										  neighbourRef, neighbourTile, neighbourPoly);
+			}
+			const float cost = bestNode->cost + curCost;
+			const float heuristic = getHeuristic(goalBounds, neighbourRef, m_nodePool->getNodePos(neighbourNode), goalPos)*heuristicScale;
+			const float total = cost + heuristic;
+
+			// The node is already in open list and the new result is worse, skip.
+			if ((neighbourNode->flags & DT_NODE_OPEN) && total >= neighbourNode->total)
+				continue;
+			// The node is already visited and process, and the new result is worse, skip.
+			if ((neighbourNode->flags & DT_NODE_CLOSED) && total >= neighbourNode->total)
+				continue;
+
+			// Add or update the node.
+			neighbourNode->pidx = m_nodePool->getNodeIdx(bestNode);
+			neighbourNode->id = neighbourRef;
+			neighbourNode->flags = (neighbourNode->flags & ~DT_NODE_CLOSED);
+			neighbourNode->cost = cost;
+			neighbourNode->total = total;
+
+			if (neighbourNode->flags & DT_NODE_OPEN)
+			{
+				// Already in open, update node location.
+				openList->modify(neighbourNode);
+			}
+			else
+			{
+				// Put the node in open list.
+				neighbourNode->flags |= DT_NODE_OPEN;
+				openList->push(neighbourNode);
+			}
+
+			// Update nearest node to target so far.
+			if (!backward && heuristic < lastBestNodeCost)
+			{
+				lastBestNodeCost = heuristic;
+				lastBestNode = neighbourNode;
+			}
+
+			// If the other search has reached the polygon too, join the two halves.
+			dtNode* otherNode = m_nodePool->findNode(neighbourRef, backward ? DT_SEARCH_FORWARD : DT_SEARCH_BACKWARD);
+			if (!otherNode || otherNode->flags == 0)
+				continue;
+
+			dtNode* forwardNode = backward ? otherNode : neighbourNode;
+			dtNode* backwardNode = backward ? neighbourNode : otherNode;
+
+			dtPolyRef prevRef = 0, nextRef = 0;
+			const dtMeshTile* prevTile = 0;
+			const dtPoly* prevPoly = 0;
+			const dtMeshTile* nextTile = 0;
+			const dtPoly* nextPoly = 0;
+			if (forwardNode->pidx)
+			{
+				prevRef = m_nodePool->getNodeAtIdx(forwardNode->pidx)->id;
+				m_nav->getTileAndPolyByRefUnsafe(prevRef, &prevTile, &prevPoly);
+			}
+			if (backwardNode->pidx)
+			{
+				nextRef = m_nodePool->getNodeAtIdx(backwardNode->pidx)->id;
+				m_nav->getTileAndPolyByRefUnsafe(nextRef, &nextTile, &nextPoly);
+			}
+
+			const float joinCost = filter->getCost(m_nodePool->getNodePos(forwardNode), m_nodePool->getNodePos(backwardNode),
+												   prevRef, prevTile, prevPoly,
+												   neighbourRef, neighbourTile, neighbourPoly,
+												   nextRef, nextTile, nextPoly);
+			const float pathCost = forwardNode->cost + joinCost + backwardNode->cost;
+			if (pathCost < meetCost)
+			{
+				meetCost = pathCost;
+				meetForward = forwardNode;
+				meetBackward = backwardNode;
+			}
+
+			// The caller does not need the cheapest path, stop searching.
+			if (options & DT_FINDPATH_FIRST_PATH)
+			{
+				done = true;
+				break;
+			}
+		}
+	}
+
+	dtStatus status;
+	if (meetForward)
+	{
+		// Path from the start to the meeting polygon, followed by the path from the
+		// meeting polygon to the end.
+		int n = 0;
+		status = getPathToNode(meetForward, path, &n, maxPath);
+		for (dtNode* node = m_nodePool->getNodeAtIdx(meetBackward->pidx); node; node = m_nodePool->getNodeAtIdx(node->pidx))
+		{
+			if (n >= maxPath)
+			{
+				status |= DT_BUFFER_TOO_SMALL;
+				break;
+			}
+			path[n++] = node->id;
+		}
+		*pathCount = n;
+	}
+	else
+	{
+		// The searches did not meet, return the path towards the nearest polygon to the end.
+		status = getPathToNode(lastBestNode, path, pathCount, maxPath);
+		status |= DT_PARTIAL_RESULT;
+	}
+
+	if (outOfNodes)
+		status |= DT_OUT_OF_NODES;
+
+	return status;
+}
+
+#endif // DETOURNAVMESHQUERYTEMPLATE_INL
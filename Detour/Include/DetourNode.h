@@ -28,14 +28,16 @@ enum dtNodeFlags
 	DT_NODE_PARENT_DETACHED = 0x04 // parent of the node is not adjacent. Found using raycast.
 };
 
-typedef unsigned short dtNodeIndex;
+typedef unsigned int dtNodeIndex;
 static const dtNodeIndex DT_NULL_IDX = (dtNodeIndex)~0;
 
 static const int DT_NODE_PARENT_BITS = 24;
 static const int DT_NODE_STATE_BITS = 2;
+
+/// A search node. Holds only the fields touched by the open list and the node expansion,
+/// the node position is stored separately by the pool. (See: dtNodePool::getNodePos)
 struct dtNode
 {
-	float pos[3];								///< Position of the node.
 	float cost;									///< Cost from previous node to current node.
 	float total;								///< Cost up to the node.
 	unsigned int pidx : DT_NODE_PARENT_BITS;	///< Index to parent node.
@@ -76,33 +78,125 @@ public:
 		if (!idx) return 0;
 		return &m_nodes[idx - 1];
 	}
+
+	/// Returns the position of a node. [(x, y, z)]
+	inline float* getNodePos(const dtNode* node)
+	{
+		return &m_nodePos[(node - m_nodes) * 3];
+	}
+
+	inline const float* getNodePos(const dtNode* node) const
+	{
+		return &m_nodePos[(node - m_nodes) * 3];
+	}
 	
 	inline int getMemUsed() const
 	{
 		return sizeof(*this) +
 			sizeof(dtNode)*m_maxNodes +
-			sizeof(dtNodeIndex)*m_maxNodes +
-			sizeof(dtNodeIndex)*m_hashSize;
+			sizeof(float)*3*m_maxNodes +
+			sizeof(dtNodeSlot)*m_hashSize;
 	}
 	
 	inline int getMaxNodes() const { return m_maxNodes; }
 	
+	/// The number of slots in the hash table.
 	inline int getHashSize() const { return m_hashSize; }
-	inline dtNodeIndex getFirst(int bucket) const { return m_first[bucket]; }
-	inline dtNodeIndex getNext(int i) const { return m_next[i]; }
+
+	/// Returns the index of the node in a hash table slot, or #DT_NULL_IDX if the slot is empty.
+	/// Each slot holds at most one node, the nodes can also be visited with #getNodeCount and #getNodeAtIdx.
+	inline dtNodeIndex getFirst(int bucket) const
+	{
+		return m_slots[bucket].stamp == m_stamp ? m_slots[bucket].idx : DT_NULL_IDX;
+	}
+	inline dtNodeIndex getNext(int /*i*/) const { return DT_NULL_IDX; }
 	inline int getNodeCount() const { return m_nodeCount; }
 	
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
 	dtNodePool(const dtNodePool&);
 	dtNodePool& operator=(const dtNodePool&);
+
+	/// Open addressing hash table entry.
+	struct dtNodeSlot
+	{
+		dtPolyRef id;			///< Polygon ref of the node.
+		unsigned int stamp;		///< The slot is in use if it matches the pool stamp.
+		dtNodeIndex idx;		///< Index of the node.
+	};
 	
 	dtNode* m_nodes;
-	dtNodeIndex* m_first;
-	dtNodeIndex* m_next;
+	float* m_nodePos;
+	dtNodeSlot* m_slots;
 	const int m_maxNodes;
 	const int m_hashSize;
 	int m_nodeCount;
+	unsigned int m_stamp;	///< Current generation, bumped by clear() to empty all the slots.
+};
+
+/// Growable list of the polygons visited by a local graph traversal, in visit order, with
+/// their parents. Used as scratch space by dtNavMeshQuery::moveAlongSurface and
+/// dtNavMeshQuery::findLocalNeighbourhood, which walk the list in order as their queue.
+/// The storage grows as needed and is kept between the traversals.
+class dtLocalSearchScratch
+{
+public:
+	dtLocalSearchScratch();
+	~dtLocalSearchScratch();
+
+	/// Empties the list, keeping the storage.
+	void clear();
+
+	/// Returns the index of a visited polygon, or -1 if it has not been visited.
+	int find(dtPolyRef ref) const;
+
+	/// Adds a polygon that has not been visited yet. The polygon is open.
+	///  @param[in]	ref		The polygon reference.
+	///  @param[in]	parent	The index of the polygon it was reached from, or -1.
+	/// @return The index of the polygon, or -1 if the storage could not grow.
+	int add(dtPolyRef ref, int parent);
+
+	/// Marks a visited polygon as not to be expanded further.
+	inline void close(int i) { m_open[i] = 0; }
+
+	/// Returns true if the visited polygon is to be expanded.
+	inline bool isOpen(int i) const { return m_open[i] != 0; }
+
+	inline dtPolyRef getRef(int i) const { return m_refs[i]; }
+	inline int getParent(int i) const { return m_parents[i]; }
+	inline int getCount() const { return m_count; }
+	inline int getCapacity() const { return m_capacity; }
+
+	inline int getMemUsed() const
+	{
+		return sizeof(*this) +
+			(sizeof(dtPolyRef) + sizeof(int) + sizeof(unsigned char))*m_capacity +
+			sizeof(dtLocalSlot)*m_hashSize;
+	}
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtLocalSearchScratch(const dtLocalSearchScratch&);
+	dtLocalSearchScratch& operator=(const dtLocalSearchScratch&);
+
+	bool grow();
+
+	/// Open addressing hash table entry.
+	struct dtLocalSlot
+	{
+		dtPolyRef ref;			///< Polygon ref of the entry.
+		unsigned int stamp;		///< The slot is in use if it matches the list stamp.
+		int idx;				///< Index of the entry.
+	};
+
+	dtPolyRef* m_refs;
+	int* m_parents;
+	unsigned char* m_open;
+	dtLocalSlot* m_slots;
+	int m_count;
+	int m_capacity;
+	int m_hashSize;
+	unsigned int m_stamp;	///< Current generation, bumped by clear() to empty all the slots.
 };
 
 class dtNodeQueue
@@ -142,6 +236,8 @@ public:
 	}
 	
 	inline bool empty() const { return m_size == 0; }
+
+	inline int getSize() const { return m_size; }
 	
 	inline int getMemUsed() const
 	{
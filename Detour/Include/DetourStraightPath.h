@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef DETOURSTRAIGHTPATH_H
+#define DETOURSTRAIGHTPATH_H
+
+#include "DetourNavMesh.h"
+#include "DetourStatus.h"
+
+class dtNavMeshQuery;
+
+/// A cached portal between two consecutive corridor polygons.
+/// @ingroup detour
+struct dtStraightPathPortal
+{
+	dtPolyRef from;				///< The polygon the portal leaves. (Zero if the entry is unused.)
+	dtPolyRef to;				///< The polygon the portal enters.
+	float left[3];				///< The left portal vertex.
+	float right[3];				///< The right portal vertex.
+	unsigned char toType;		///< The type of the entered polygon. (See: #dtPolyTypes)
+};
+
+/// Computes the straight path of a polygon corridor one vertex at a time. (String pulling.)
+/// The portals between the corridor polygons are cached and reused by the following queries.
+/// @ingroup detour
+class dtStraightPathIterator
+{
+public:
+	dtStraightPathIterator();
+	~dtStraightPathIterator();
+
+	/// Allocates the portal cache.
+	///  @param[in]		maxPortals	The number of portals from the start of the corridor that are cached.
+	///  							[Limit: >= 0]
+	/// @return True if the initialization succeeded.
+	bool init(const int maxPortals);
+
+	/// Uses a portal cache owned by the caller, such as a part of a buffer shared by many iterators.
+	///  @param[in]		portals		The portal cache. Must outlive the iterator. [(portal) * @p maxPortals] [opt]
+	///  @param[in]		maxPortals	The number of portals from the start of the corridor that are cached.
+	///  							Ignored if @p portals is null. [Limit: >= 0]
+	void init(dtStraightPathPortal* portals, const int maxPortals);
+
+	/// Drops the cached portals.
+	void reset();
+
+	/// Starts iterating the straight path of a corridor.
+	///  @param[in]		query		The query object used to get the portals.
+	///  @param[in]		startPos	Path start position. [(x, y, z)]
+	///  @param[in]		endPos		Path end position. [(x, y, z)]
+	///  @param[in]		path		An array of polygon references that represent the path corridor.
+	///  							Must stay unchanged until the iteration is done.
+	///  @param[in]		pathSize	The number of polygons in the @p path array.
+	/// @returns The status flags for the operation.
+	dtStatus begin(const dtNavMeshQuery* query, const float* startPos, const float* endPos,
+				   const dtPolyRef* path, const int pathSize);
+
+	/// Gets the next vertex of the straight path.
+	///  @param[out]	pos		The vertex position. [(x, y, z)]
+	///  @param[out]	flags	The vertex flags. (See: #dtStraightPathFlags) [opt]
+	///  @param[out]	ref		The reference id of the polygon that is entered at the vertex. [opt]
+	/// @returns The status flags for the operation. #DT_IN_PROGRESS if more vertices follow.
+	dtStatus next(float* pos, unsigned char* flags, dtPolyRef* ref);
+
+	/// Gets the remaining vertices of the straight path. Equal consecutive vertices are merged the same
+	/// way as in dtNavMeshQuery::findStraightPath.
+	///  @param[out]	straightPath		Points describing the straight path. [(x, y, z) * @p straightPathCount].
+	///  @param[out]	straightPathFlags	Flags describing each point. (See: #dtStraightPathFlags) [opt]
+	///  @param[out]	straightPathRefs	The reference id of the polygon that is being entered at each point. [opt]
+	///  @param[out]	straightPathCount	The number of points in the straight path.
+	///  @param[in]		maxStraightPath		The maximum number of points the straight path arrays can hold.  [Limit: > 0]
+	/// @returns The status flags for the operation.
+	dtStatus getStraightPath(float* straightPath, unsigned char* straightPathFlags, dtPolyRef* straightPathRefs,
+							 int* straightPathCount, const int maxStraightPath);
+
+	/// True if all the vertices of the straight path have been returned.
+	bool isDone() const { return m_state == DT_STRAIGHTPATH_STATE_DONE; }
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtStraightPathIterator(const dtStraightPathIterator&);
+	dtStraightPathIterator& operator=(const dtStraightPathIterator&);
+
+	enum dtStraightPathState
+	{
+		DT_STRAIGHTPATH_STATE_START,
+		DT_STRAIGHTPATH_STATE_FUNNEL,
+		DT_STRAIGHTPATH_STATE_END,
+		DT_STRAIGHTPATH_STATE_DONE
+	};
+
+	dtStatus getPortal(const int i, float* left, float* right, unsigned char& toType);
+	dtStatus advanceApex(const float* pos, const dtPolyRef ref, const unsigned char type, const int index,
+						 float* outPos, unsigned char* outFlags, dtPolyRef* outRef);
+
+	dtStraightPathPortal* m_portals;	///< Cached portals, indexed by the position in the corridor.
+	int m_maxPortals;					///< The number of cached portals.
+	bool m_ownsPortals;					///< True if the portal cache is freed by the iterator.
+	const dtNavMesh* m_nav;				///< The navigation mesh of the cached portals.
+
+	const dtNavMeshQuery* m_query;
+	const dtPolyRef* m_path;
+	int m_pathSize;
+	float m_endPos[3];
+	float m_closestEndPos[3];
+
+	// Funnel state, kept between the calls to next().
+	dtStraightPathState m_state;
+	float m_portalApex[3], m_portalLeft[3], m_portalRight[3];
+	int m_apexIndex, m_leftIndex, m_rightIndex;
+	unsigned char m_leftPolyType, m_rightPolyType;
+	dtPolyRef m_leftPolyRef, m_rightPolyRef;
+	int m_portalIndex;					///< The next portal to process.
+};
+
+#endif // DETOURSTRAIGHTPATH_H
@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#ifndef DETOURTILESTREAMER_H
+#define DETOURTILESTREAMER_H
+
+#include "DetourNavMesh.h"
+#include "DetourStatus.h"
+
+/// A tile of a tile set that is streamed into a navigation mesh by #dtTileStreamer.
+/// @ingroup detour
+struct dtStreamTile
+{
+	int x;						///< The tile's x-location.
+	int y;						///< The tile's y-location.
+	int layer;					///< The tile's layer.
+	float bmin[3];				///< The minimum bounds of the tile. [(x, y, z)]
+	float bmax[3];				///< The maximum bounds of the tile. [(x, y, z)]
+	int dataSize;				///< The size of the tile data.
+	unsigned int offset;		///< The offset of the tile data in the tile set file. (Only used by the reader.)
+};
+
+/// Reads tile data for #dtTileStreamer.
+///
+/// The streamer calls the reader only from the thread that updates it. An implementation
+/// typically queues the reads to a background I/O thread in #beginRead and hands the
+/// finished reads back in #pollRead, so the updates never wait for the I/O.
+/// @ingroup detour
+class dtTileStreamReader
+{
+public:
+	virtual ~dtTileStreamReader() {}
+
+	/// Starts reading the data of a tile.
+	///  @param[in]		index	The index of the tile in the tile set.
+	///  @param[in]		tile	The tile to read.
+	/// @return False if the read cannot be started now. It is retried by a later update.
+	virtual bool beginRead(const int index, const dtStreamTile& tile) = 0;
+
+	/// Returns a finished read.
+	///  @param[out]	index		The index of the tile in the tile set.
+	///  @param[out]	data		The tile data allocated with #dtAlloc, or null if the read failed.
+	///  							The streamer takes the ownership of the data.
+	///  @param[out]	dataSize	The size of the tile data.
+	/// @return False if there are no finished reads.
+	virtual bool pollRead(int* index, unsigned char** data, int* dataSize) = 0;
+};
+
+struct dtStreamTileStatus;
+struct dtStreamWantedTile;
+
+/// Keeps the tiles of a tile set around a set of interest points resident in a navigation mesh.
+///
+/// The tiles are read with a #dtTileStreamReader and added to the navigation mesh by #update,
+/// which commits a bounded number of tile adds and removes per call. The resident tile data is
+/// kept within a memory budget and the tile slots of the navigation mesh by removing the least
+/// recently used tiles outside the interest points, where a tile is used while it is around an
+/// interest point or its polygons are reported with #touchPoly. The state of a removed tile
+/// (see dtNavMesh::storeTileState) is restored when the tile is added back.
+/// @ingroup detour
+class dtTileStreamer
+{
+public:
+	dtTileStreamer();
+	~dtTileStreamer();
+
+	/// Initializes the streamer.
+	///  @param[in]		nav				The navigation mesh the tiles are added to.
+	///  @param[in]		tiles			The tiles of the tile set. [Size: @p tileCount]
+	///  @param[in]		tileCount		The number of tiles in the tile set.
+	///  @param[in]		reader			The reader of the tile data.
+	///  @param[in]		memoryBudget	The maximum size of the tile data that is resident or being read.
+	/// @returns The status flags for the operation.
+	dtStatus init(dtNavMesh* nav, const dtStreamTile* tiles, const int tileCount,
+				  dtTileStreamReader* reader, const int memoryBudget);
+
+	/// Sets the points around which the tiles should be resident.
+	/// If there are more tiles around the points than tiles in the navigation mesh, only the nearest
+	/// dtNavMesh::getMaxTiles() tiles are made resident.
+	///  @param[in]		points		The interest points. [(x, y, z) * @p pointCount]
+	///  @param[in]		pointCount	The number of interest points.
+	///  @param[in]		radius		The distance on the xz-plane from a point to the tiles that should be resident.
+	/// @returns The status flags for the operation.
+	dtStatus setInterestPoints(const float* points, const int pointCount, const float radius);
+
+	/// Marks the tile of a polygon as used, so that it is removed after the tiles that were used earlier.
+	///  @param[in]		ref		The reference of a polygon returned by a query.
+	void touchPoly(dtPolyRef ref);
+
+	/// Handles the finished reads, starts new reads and commits tile adds and removes.
+	///  @param[in]		maxCommits	The maximum number of tiles to add or remove. [Limit: > 0]
+	///  @param[out]	upToDate	True if every tile around the interest points that fits the
+	///  							memory budget is resident. [opt]
+	/// @returns The status flags for the operation.
+	dtStatus update(const int maxCommits, bool* upToDate = 0);
+
+	/// Returns true if the tile is in the navigation mesh.
+	///  @param[in]		index	The index of the tile in the tile set.
+	bool isTileResident(const int index) const;
+
+	/// The number of tiles in the navigation mesh.
+	int getResidentTileCount() const { return m_residentCount; }
+
+	/// The size of the tile data that is resident or being read.
+	int getUsedMemory() const { return m_usedMemory; }
+
+	/// The number of reads that have not been handled yet.
+	int getPendingReadCount() const { return m_pendingReads; }
+
+	/// The navigation mesh the tiles are added to.
+	dtNavMesh* getNavMesh() const { return m_nav; }
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	dtTileStreamer(const dtTileStreamer&);
+	dtTileStreamer& operator=(const dtTileStreamer&);
+
+	void purge();
+	void pollReads();
+	dtTileRef findFreeTileRef();
+	bool hasFreeTileSlot() const;
+	bool addTile(const int index);
+	bool removeTile(const int index);
+	int findEvictable() const;
+
+	dtNavMesh* m_nav;						///< The navigation mesh the tiles are added to.
+	dtTileStreamReader* m_reader;			///< The reader of the tile data.
+	dtStreamTile* m_tiles;					///< The tiles of the tile set.
+	dtStreamTileStatus* m_status;			///< The streaming status of each tile.
+	int m_tileCount;						///< The number of tiles in the tile set.
+	int* m_navTiles;						///< The tile set index of the tile in each navigation mesh tile slot,
+											///< or of the removed tile whose state reserves the slot, or -1.
+	int m_maxNavTiles;
+
+	dtStreamWantedTile* m_wanted;			///< The tiles around the interest points, nearest first.
+	int m_wantedCount;
+
+	int m_memoryBudget;
+	int m_usedMemory;
+	int m_residentCount;
+	int m_pendingReads;
+	unsigned int m_frame;					///< The number of updates, used for the least recently used order.
+};
+
+/// Allocates a tile streamer object using the Detour allocator.
+/// @return A tile streamer that is ready for initialization, or null on failure.
+///  @ingroup detour
+dtTileStreamer* dtAllocTileStreamer();
+
+/// Frees the specified tile streamer object using the Detour allocator.
+///  @param[in]		streamer		A tile streamer allocated using #dtAllocTileStreamer
+///  @ingroup detour
+void dtFreeTileStreamer(dtTileStreamer* streamer);
+
+#endif // DETOURTILESTREAMER_H
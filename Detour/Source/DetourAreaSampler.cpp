@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <string.h>
+#include <new>
+#include "DetourAreaSampler.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourCommon.h"
+#include "DetourMath.h"
+#include "DetourAlloc.h"
+#include "DetourAssert.h"
+
+/// The sampled polygons of a single tile.
+struct dtAreaSamplerTile
+{
+	unsigned int salt;				///< The salt of the tile the table was computed for.
+	int count;						///< The number of sampled polygons.
+	float* cumArea;					///< The weighted area of the sampled polygons up to and including each one. [(area) * #count]
+	unsigned int* polys;			///< The index of each sampled polygon in the tile. [(index) * #count]
+};
+
+dtNavMeshAreaSampler* dtAllocNavMeshAreaSampler()
+{
+	void* mem = dtAlloc(sizeof(dtNavMeshAreaSampler), DT_ALLOC_PERM);
+	if (!mem) return 0;
+	return new(mem) dtNavMeshAreaSampler;
+}
+
+void dtFreeNavMeshAreaSampler(dtNavMeshAreaSampler* sampler)
+{
+	if (!sampler) return;
+	sampler->~dtNavMeshAreaSampler();
+	dtFree(sampler);
+}
+
+/// @class dtNavMeshAreaSampler
+///
+/// dtNavMeshQuery::findRandomPoint visits every polygon of the navigation mesh to pick
+/// one. With a sampler set with dtNavMeshQuery::setAreaSampler, it picks the polygon with
+/// a binary search in the cumulative area table of a tile, found by descending a sum tree
+/// of the tile areas.
+///
+/// The tables store the polygons that pass the include and exclude flags of the filter
+/// given to #init, weighted by the area weights. When the flags or areas of polygons change,
+/// call #addTile for their tile to update its table.
+///
+/// @see dtNavMeshQuery::setAreaSampler
+
+dtNavMeshAreaSampler::dtNavMeshAreaSampler() :
+	m_nav(0),
+	m_tables(0),
+	m_maxTiles(0),
+	m_tree(0),
+	m_leafCount(0),
+	m_includeFlags(0),
+	m_excludeFlags(0)
+{
+	for (int i = 0; i < DT_MAX_AREAS; ++i)
+		m_areaWeights[i] = 1.0f;
+}
+
+dtNavMeshAreaSampler::~dtNavMeshAreaSampler()
+{
+	purge();
+}
+
+void dtNavMeshAreaSampler::purge()
+{
+	for (int i = 0; i < m_maxTiles; ++i)
+		freeTable((unsigned int)i);
+	dtFree(m_tables);
+	dtFree(m_tree);
+	m_tables = 0;
+	m_tree = 0;
+	m_maxTiles = 0;
+	m_leafCount = 0;
+	m_nav = 0;
+}
+
+void dtNavMeshAreaSampler::freeTable(unsigned int it)
+{
+	dtAreaSamplerTile& table = m_tables[it];
+	dtFree(table.cumArea);
+	memset(&table, 0, sizeof(dtAreaSamplerTile));
+}
+
+// Sets the area of a tile and updates the sums of its parents.
+void dtNavMeshAreaSampler::setTileArea(unsigned int it, const float area)
+{
+	int node = m_leafCount + (int)it;
+	m_tree[node] = area;
+	for (node /= 2; node >= 1; node /= 2)
+		m_tree[node] = m_tree[node*2] + m_tree[node*2+1];
+}
+
+/// @par
+///
+/// This function can be used multiple times.
+dtStatus dtNavMeshAreaSampler::init(const dtNavMesh* nav, const dtQueryFilter* filter, const float* areaWeights)
+{
+	purge();
+
+	if (!nav || !filter)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	if (areaWeights)
+	{
+		for (int i = 0; i < DT_MAX_AREAS; ++i)
+		{
+			if (!dtMathIsfinite(areaWeights[i]) || areaWeights[i] < 0.0f)
+				return DT_FAILURE | DT_INVALID_PARAM;
+		}
+	}
+
+	m_nav = nav;
+	m_includeFlags = filter->getIncludeFlags();
+	m_excludeFlags = filter->getExcludeFlags();
+	for (int i = 0; i < DT_MAX_AREAS; ++i)
+		m_areaWeights[i] = areaWeights ? areaWeights[i] : 1.0f;
+
+	m_maxTiles = nav->getMaxTiles();
+	m_leafCount = 1;
+	while (m_leafCount < m_maxTiles)
+		m_leafCount *= 2;
+	m_tables = (dtAreaSamplerTile*)dtAlloc(sizeof(dtAreaSamplerTile) * m_maxTiles, DT_ALLOC_PERM);
+	m_tree = (float*)dtAlloc(sizeof(float) * m_leafCount * 2, DT_ALLOC_PERM);
+	if (!m_tables || !m_tree)
+	{
+		purge();
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	memset(m_tables, 0, sizeof(dtAreaSamplerTile) * m_maxTiles);
+	memset(m_tree, 0, sizeof(float) * m_leafCount * 2);
+
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		const dtMeshTile* tile = nav->getTile(i);
+		if (!tile->header)
+			continue;
+		const dtStatus status = addTile(nav->getTileRef(tile));
+		if (dtStatusFailed(status))
+		{
+			purge();
+			return status;
+		}
+	}
+
+	return DT_SUCCESS;
+}
+
+/// @par
+///
+/// Must be called after the tile has been added to the navigation mesh.
+/// When the tile replaces an existing tile, there is no need to call #removeTile first.
+dtStatus dtNavMeshAreaSampler::addTile(dtTileRef ref)
+{
+	if (!m_nav || !m_tables)
+		return DT_FAILURE;
+
+	const dtMeshTile* tile = m_nav->getTileByRef(ref);
+	if (!tile || !tile->header)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	const unsigned int it = m_nav->decodePolyIdTile((dtPolyRef)ref);
+
+	freeTable(it);
+	setTileArea(it, 0.0f);
+
+	int count = 0;
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		const dtPoly* p = &tile->polys[i];
+		if (p->getType() == DT_POLYTYPE_GROUND && (p->flags & m_includeFlags) != 0 &&
+			(p->flags & m_excludeFlags) == 0 && m_areaWeights[p->getArea()] > 0.0f)
+		{
+			count++;
+		}
+	}
+	if (!count)
+		return DT_SUCCESS;
+
+	// The polygon indices follow the areas in the same allocation.
+	dtAreaSamplerTile& table = m_tables[it];
+	table.cumArea = (float*)dtAlloc((sizeof(float) + sizeof(unsigned int)) * count, DT_ALLOC_PERM);
+	if (!table.cumArea)
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	table.polys = (unsigned int*)(table.cumArea + count);
+	table.salt = tile->salt;
+
+	float areaSum = 0.0f;
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		const dtPoly* p = &tile->polys[i];
+		if (p->getType() != DT_POLYTYPE_GROUND || (p->flags & m_includeFlags) == 0 ||
+			(p->flags & m_excludeFlags) != 0 || m_areaWeights[p->getArea()] <= 0.0f)
+		{
+			continue;
+		}
+
+		float polyArea = 0.0f;
+		for (int j = 2; j < p->vertCount; ++j)
+		{
+			const float* va = &tile->verts[p->verts[0]*3];
+			const float* vb = &tile->verts[p->verts[j-1]*3];
+			const float* vc = &tile->verts[p->verts[j]*3];
+			polyArea += dtTriArea2D(va,vb,vc);
+		}
+		areaSum += dtMax(polyArea, 0.0f) * m_areaWeights[p->getArea()];
+		table.cumArea[table.count] = areaSum;
+		table.polys[table.count] = (unsigned int)i;
+		table.count++;
+	}
+	setTileArea(it, areaSum);
+
+	return DT_SUCCESS;
+}
+
+void dtNavMeshAreaSampler::removeTile(dtTileRef ref)
+{
+	if (!m_tables || !ref)
+		return;
+	const unsigned int it = m_nav->decodePolyIdTile((dtPolyRef)ref);
+	if ((int)it >= m_maxTiles)
+		return;
+	freeTable(it);
+	setTileArea(it, 0.0f);
+}
+
+void dtNavMeshAreaSampler::onTilesChanged(const dtNavMesh* nav, const dtTileRef* removed, const int nremoved,
+										  const dtTileRef* added, const int nadded)
+{
+	if (nav != m_nav)
+		return;
+	for (int i = 0; i < nremoved; ++i)
+		removeTile(removed[i]);
+	for (int i = 0; i < nadded; ++i)
+		addTile(added[i]);
+}
+
+dtPolyRef dtNavMeshAreaSampler::findRandomPoly(const float u) const
+{
+	if (!m_tree || !(m_tree[1] > 0.0f))
+		return 0;
+
+	// Descend to the tile, skipping empty subtrees the rounding of the sums could lead to.
+	float r = dtClamp(u, 0.0f, 1.0f) * m_tree[1];
+	int node = 1;
+	while (node < m_leafCount)
+	{
+		const float left = m_tree[node*2];
+		if (r < left || !(m_tree[node*2+1] > 0.0f))
+		{
+			node = node*2;
+		}
+		else
+		{
+			r -= left;
+			node = node*2+1;
+		}
+	}
+	const unsigned int it = (unsigned int)(node - m_leafCount);
+	const dtAreaSamplerTile& table = m_tables[it];
+	if (!table.count || m_nav->getTile((int)it)->salt != table.salt)
+		return 0;
+
+	// First polygon whose cumulative area is above the remaining area.
+	int lo = 0, hi = table.count - 1;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (table.cumArea[mid] > r)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return m_nav->encodePolyId(table.salt, it, table.polys[lo]);
+}
+
+bool dtNavMeshAreaSampler::matchesFilter(const dtQueryFilter* filter) const
+{
+	return filter && filter->getIncludeFlags() == m_includeFlags && filter->getExcludeFlags() == m_excludeFlags;
+}
@@ -0,0 +1,878 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <float.h>
+#include <string.h>
+#include <new>
+#include "DetourLandmarks.h"
+#include "DetourCommon.h"
+#include "DetourMath.h"
+#include "DetourAlloc.h"
+#include "DetourAssert.h"
+
+// Distance of portals that have not been reached from a landmark.
+static const float DT_LANDMARK_UNREACHED = FLT_MAX;
+
+/// An off-mesh connection end point located on a polygon of the tile.
+struct dtLandmarkEndPoint
+{
+	dtPolyRef con;				///< The off-mesh connection polygon.
+	unsigned short poly;		///< The index of the polygon the end point is on.
+	unsigned char side;			///< The end point of the connection. (0 = start, 1 = end)
+};
+
+/// Landmark distances of a single tile.
+///
+/// Each polygon has #DT_VERTS_PER_POLYGON portal slots. The slots of ground polygons are
+/// their edges, off-mesh connections use the first two slots for their end points.
+struct dtLandmarkTile
+{
+	unsigned int salt;				///< The salt of the tile the table was computed for.
+	int polyCount;					///< The number of polygons in the tile.
+	float* dist;					///< Distance from each landmark to each slot. [(slot * landmarkCount + landmark)]
+	float* bounds;					///< Polygon distance bounds. [(poly * landmarkCount + landmark) * (min, max)]
+	dtLandmarkEndPoint* endPoints;	///< Off-mesh connection end points on the tile polygons.
+	int endPointCount;
+	int endPointCapacity;
+	bool dirty;						///< True if the bounds need to be updated.
+};
+
+struct dtLandmarkHeapItem
+{
+	float dist;
+	unsigned int tile;
+	int slot;
+};
+
+dtNavMeshLandmarks* dtAllocNavMeshLandmarks()
+{
+	void* mem = dtAlloc(sizeof(dtNavMeshLandmarks), DT_ALLOC_PERM);
+	if (!mem) return 0;
+	return new(mem) dtNavMeshLandmarks;
+}
+
+void dtFreeNavMeshLandmarks(dtNavMeshLandmarks* landmarks)
+{
+	if (!landmarks) return;
+	landmarks->~dtNavMeshLandmarks();
+	dtFree(landmarks);
+}
+
+// Shortest distance between two segments on the xz-plane.
+static float distSegSeg2D(const float* ap, const float* aq, const float* bp, const float* bq)
+{
+	float s, t;
+	if (dtIntersectSegSeg2D(ap, aq, bp, bq, s, t) && s >= 0.0f && s <= 1.0f && t >= 0.0f && t <= 1.0f)
+		return 0.0f;
+	float d = dtDistancePtSegSqr2D(ap, bp, bq, t);
+	d = dtMin(d, dtDistancePtSegSqr2D(aq, bp, bq, t));
+	d = dtMin(d, dtDistancePtSegSqr2D(bp, ap, aq, t));
+	d = dtMin(d, dtDistancePtSegSqr2D(bq, ap, aq, t));
+	return dtMathSqrtf(d);
+}
+
+static float distPtSeg2D(const float* pt, const float* p, const float* q)
+{
+	float t;
+	return dtMathSqrtf(dtDistancePtSegSqr2D(pt, p, q, t));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/// @class dtNavMeshLandmarks
+///
+/// Landmarks speed up path searches on levels with long detours, such as mazes,
+/// where the straight line distance to the goal is a poor estimate of the remaining cost.
+///
+/// For every landmark the object stores the cost of reaching each polygon portal from
+/// the landmark over a graph whose edges are lower bounds of the traversal cost between
+/// the portals of a polygon. By the triangle inequality, the difference of the distances
+/// of two polygons to a landmark is then a lower bound of the cost between them, which
+/// dtNavMeshQuery uses as its search heuristic in addition to the straight line distance.
+///
+/// The bounds hold for query filters whose area costs are all at least the cost scale.
+/// Polygons excluded by a filter only make the actual costs higher, so any filter can
+/// be used with the heuristic.
+///
+/// The distances are stored per tile. When a tile is added to the navigation mesh, or
+/// replaces a tile, call #addTile to compute its table. The distances of the rest of the
+/// mesh are lowered where the new tile creates shortcuts. Removing a tile leaves the other
+/// tables valid, but looser than a full rebuild with #init would make them.
+///
+/// @see dtNavMeshQuery::setLandmarks
+
+dtNavMeshLandmarks::dtNavMeshLandmarks() :
+	m_nav(0),
+	m_tables(0),
+	m_maxTiles(0),
+	m_landmarkCount(0),
+	m_costScale(1.0f),
+	m_heap(0),
+	m_heapSize(0),
+	m_heapCapacity(0),
+	m_heapOverflow(false)
+{
+	memset(m_landmarks, 0, sizeof(m_landmarks));
+}
+
+dtNavMeshLandmarks::~dtNavMeshLandmarks()
+{
+	purge();
+}
+
+void dtNavMeshLandmarks::purge()
+{
+	for (int i = 0; i < m_maxTiles; ++i)
+		freeTable((unsigned int)i);
+	dtFree(m_tables);
+	dtFree(m_heap);
+	m_tables = 0;
+	m_maxTiles = 0;
+	m_heap = 0;
+	m_heapSize = 0;
+	m_heapCapacity = 0;
+	m_heapOverflow = false;
+	m_landmarkCount = 0;
+	m_nav = 0;
+}
+
+/// @par
+///
+/// The landmarks are picked one by one as the polygon furthest away from
+/// the previous landmarks. This tends to place them at the extremities of the
+/// mesh, where they give the best bounds.
+///
+/// This function can be used multiple times.
+dtStatus dtNavMeshLandmarks::init(const dtNavMesh* nav, const int landmarkCount, const float costScale,
+								  const dtPolyRef* landmarks)
+{
+	purge();
+
+	if (!nav || landmarkCount <= 0 || landmarkCount > DT_MAX_LANDMARKS ||
+		!dtMathIsfinite(costScale) || costScale <= 0.0f)
+	{
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+	if (landmarks)
+	{
+		for (int i = 0; i < landmarkCount; ++i)
+		{
+			if (!nav->isValidPolyRef(landmarks[i]))
+				return DT_FAILURE | DT_INVALID_PARAM;
+		}
+	}
+
+	m_nav = nav;
+	m_costScale = costScale;
+	m_landmarkCount = landmarkCount;
+	m_maxTiles = nav->getMaxTiles();
+	m_tables = (dtLandmarkTile*)dtAlloc(sizeof(dtLandmarkTile) * m_maxTiles, DT_ALLOC_PERM);
+	if (!m_tables)
+	{
+		purge();
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	memset(m_tables, 0, sizeof(dtLandmarkTile) * m_maxTiles);
+
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		if (!nav->getTile(i)->header)
+			continue;
+		if (!allocTable((unsigned int)i))
+		{
+			purge();
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+		}
+	}
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		if (m_tables[i].dist && !buildEndPoints((unsigned int)i))
+		{
+			purge();
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+		}
+	}
+
+	if (landmarks)
+	{
+		for (int i = 0; i < landmarkCount; ++i)
+		{
+			m_landmarks[i] = landmarks[i];
+			resetLandmark(i);
+			seedPoly(i, m_landmarks[i]);
+			if (!propagate(i))
+			{
+				purge();
+				return DT_FAILURE | DT_OUT_OF_MEMORY;
+			}
+		}
+		updateDirtyBounds();
+		return DT_SUCCESS;
+	}
+
+	// Start from the polygon furthest away from an arbitrary polygon.
+	dtPolyRef seed = 0;
+	for (int i = 0; i < m_maxTiles && !seed; ++i)
+	{
+		const dtMeshTile* tile = nav->getTile(i);
+		if (tile->header && tile->header->polyCount > 0)
+			seed = nav->getPolyRefBase(tile);
+	}
+	if (!seed)
+	{
+		purge();
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+
+	resetLandmark(0);
+	seedPoly(0, seed);
+	if (!propagate(0))
+	{
+		purge();
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	updateDirtyBounds();
+
+	int count = 0;
+	for (int i = 0; i < landmarkCount; ++i)
+	{
+		const dtPolyRef ref = findFurthestPoly(i == 0 ? 1 : i);
+		if (!ref)
+			break;
+		m_landmarks[i] = ref;
+		resetLandmark(i);
+		seedPoly(i, ref);
+		if (!propagate(i))
+		{
+			purge();
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+		}
+		updateDirtyBounds();
+		count++;
+	}
+
+	// Small meshes may not have enough distinct landmarks, rebuild the tables with fewer.
+	if (count < landmarkCount)
+	{
+		dtPolyRef picked[DT_MAX_LANDMARKS];
+		memcpy(picked, m_landmarks, sizeof(dtPolyRef) * count);
+		if (!count)
+			picked[count++] = seed;
+		return init(nav, count, costScale, picked);
+	}
+
+	return DT_SUCCESS;
+}
+
+/// @par
+///
+/// Must be called after the tile has been added to the navigation mesh.
+/// When the tile replaces an existing tile, there is no need to call #removeTile first.
+dtStatus dtNavMeshLandmarks::addTile(dtTileRef ref)
+{
+	if (!m_nav || !m_tables)
+		return DT_FAILURE;
+
+	const dtMeshTile* tile = m_nav->getTileByRef(ref);
+	if (!tile || !tile->header)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	const unsigned int it = m_nav->decodePolyIdTile((dtPolyRef)ref);
+
+	if (!allocTable(it))
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+
+	// Off-mesh connections of the tile may land on the neighbours and vice versa.
+	static const int MAX_NEIS = 32;
+	const dtMeshTile* neis[MAX_NEIS];
+	const dtMeshTile* around[MAX_NEIS*9];
+	int naround = 0;
+	for (int y = tile->header->y-1; y <= tile->header->y+1; ++y)
+	{
+		for (int x = tile->header->x-1; x <= tile->header->x+1; ++x)
+		{
+			const int nneis = m_nav->getTilesAt(x, y, neis, MAX_NEIS);
+			for (int j = 0; j < nneis; ++j)
+				around[naround++] = neis[j];
+		}
+	}
+	for (int i = 0; i < naround; ++i)
+	{
+		const unsigned int ni = m_nav->decodePolyIdTile(m_nav->getTileRef(around[i]));
+		dtLandmarkTile* table = getTable(ni);
+		if (!table)
+			continue;
+		if (!buildEndPoints(ni))
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+		table->dirty = true;
+	}
+
+	for (int l = 0; l < m_landmarkCount; ++l)
+	{
+		// Continue the propagation from the distances of the surrounding tiles,
+		// the new portals are reached through them.
+		for (int i = 0; i < naround; ++i)
+		{
+			if (around[i] != tile)
+				seedTile(l, m_nav->decodePolyIdTile(m_nav->getTileRef(around[i])));
+		}
+		if (m_nav->isValidPolyRef(m_landmarks[l]) && m_nav->decodePolyIdTile(m_landmarks[l]) == it)
+			seedPoly(l, m_landmarks[l]);
+		if (!propagate(l))
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+
+	m_tables[it].dirty = true;
+	updateDirtyBounds();
+
+	return DT_SUCCESS;
+}
+
+void dtNavMeshLandmarks::removeTile(dtTileRef ref)
+{
+	if (!m_tables || !ref)
+		return;
+	const unsigned int it = m_nav->decodePolyIdTile((dtPolyRef)ref);
+	if ((int)it >= m_maxTiles)
+		return;
+	freeTable(it);
+}
+
+void dtNavMeshLandmarks::onTilesChanged(const dtNavMesh* nav, const dtTileRef* removed, const int nremoved,
+										const dtTileRef* added, const int nadded)
+{
+	if (nav != m_nav)
+		return;
+	for (int i = 0; i < nremoved; ++i)
+		removeTile(removed[i]);
+	for (int i = 0; i < nadded; ++i)
+		addTile(added[i]);
+}
+
+bool dtNavMeshLandmarks::getPolyBounds(dtPolyRef ref, float* bounds) const
+{
+	if (!m_tables || !m_landmarkCount)
+		return false;
+	unsigned int salt, it, ip;
+	m_nav->decodePolyId(ref, salt, it, ip);
+	const dtLandmarkTile* table = getTable(it);
+	if (!table || table->salt != salt || (int)ip >= table->polyCount)
+		return false;
+	memcpy(bounds, &table->bounds[ip * m_landmarkCount * 2], sizeof(float) * m_landmarkCount * 2);
+	return true;
+}
+
+float dtNavMeshLandmarks::getCostBound(dtPolyRef ref, const float* goalBounds) const
+{
+	if (!m_tables)
+		return 0.0f;
+	unsigned int salt, it, ip;
+	m_nav->decodePolyId(ref, salt, it, ip);
+	const dtLandmarkTile* table = getTable(it);
+	if (!table || table->salt != salt || (int)ip >= table->polyCount)
+		return 0.0f;
+
+	const float* bounds = &table->bounds[ip * m_landmarkCount * 2];
+	float h = 0.0f;
+	for (int i = 0; i < m_landmarkCount; ++i)
+	{
+		const float* a = &bounds[i*2];
+		const float* b = &goalBounds[i*2];
+		if (a[0] == DT_LANDMARK_UNREACHED || b[0] == DT_LANDMARK_UNREACHED)
+			continue;
+		h = dtMax(h, dtMax(b[0] - a[1], a[0] - b[1]));
+	}
+	return h;
+}
+
+dtLandmarkTile* dtNavMeshLandmarks::getTable(unsigned int it) const
+{
+	if ((int)it >= m_maxTiles)
+		return 0;
+	dtLandmarkTile* table = &m_tables[it];
+	if (!table->dist)
+		return 0;
+	const dtMeshTile* tile = m_nav->getTile((int)it);
+	if (!tile->header || tile->salt != table->salt)
+		return 0;
+	return table;
+}
+
+void dtNavMeshLandmarks::freeTable(unsigned int it)
+{
+	dtLandmarkTile& table = m_tables[it];
+	dtFree(table.dist);
+	dtFree(table.endPoints);
+	memset(&table, 0, sizeof(dtLandmarkTile));
+}
+
+bool dtNavMeshLandmarks::allocTable(unsigned int it)
+{
+	freeTable(it);
+
+	const dtMeshTile* tile = m_nav->getTile((int)it);
+	const int polyCount = tile->header->polyCount;
+	const int distCount = polyCount * DT_VERTS_PER_POLYGON * m_landmarkCount;
+	const int boundsCount = polyCount * m_landmarkCount * 2;
+
+	dtLandmarkTile& table = m_tables[it];
+	table.dist = (float*)dtAlloc(sizeof(float) * (distCount + boundsCount + 1), DT_ALLOC_PERM);
+	if (!table.dist)
+		return false;
+	table.bounds = table.dist + distCount;
+	table.salt = tile->salt;
+	table.polyCount = polyCount;
+	for (int i = 0; i < distCount + boundsCount; ++i)
+		table.dist[i] = DT_LANDMARK_UNREACHED;
+
+	return true;
+}
+
+bool dtNavMeshLandmarks::buildEndPoints(unsigned int it)
+{
+	dtLandmarkTile& table = m_tables[it];
+	table.endPointCount = 0;
+
+	const dtMeshTile* tile = m_nav->getTile((int)it);
+
+	// Collect the off-mesh connections of the tile and its neighbours linked to the tile polygons.
+	static const int MAX_NEIS = 32;
+	const dtMeshTile* neis[MAX_NEIS];
+	for (int y = tile->header->y-1; y <= tile->header->y+1; ++y)
+	{
+		for (int x = tile->header->x-1; x <= tile->header->x+1; ++x)
+		{
+			const int nneis = m_nav->getTilesAt(x, y, neis, MAX_NEIS);
+			for (int j = 0; j < nneis; ++j)
+			{
+				const dtMeshTile* nei = neis[j];
+				const dtPolyRef base = m_nav->getPolyRefBase(nei);
+				for (int k = 0; k < nei->header->offMeshConCount; ++k)
+				{
+					const unsigned short ip = nei->offMeshCons[k].poly;
+					const dtPoly* con = &nei->polys[ip];
+					for (unsigned int i = con->firstLink; i != DT_NULL_LINK; i = nei->links[i].next)
+					{
+						const dtLink& link = nei->links[i];
+						if (m_nav->decodePolyIdTile(link.ref) != it)
+							continue;
+						if (table.endPointCount == table.endPointCapacity)
+						{
+							const int capacity = table.endPointCapacity ? table.endPointCapacity * 2 : 8;
+							dtLandmarkEndPoint* endPoints = (dtLandmarkEndPoint*)dtAlloc(sizeof(dtLandmarkEndPoint) * capacity, DT_ALLOC_PERM);
+							if (!endPoints)
+								return false;
+							if (table.endPointCount)
+								memcpy(endPoints, table.endPoints, sizeof(dtLandmarkEndPoint) * table.endPointCount);
+							dtFree(table.endPoints);
+							table.endPoints = endPoints;
+							table.endPointCapacity = capacity;
+						}
+						dtLandmarkEndPoint& ep = table.endPoints[table.endPointCount++];
+						ep.con = base | (dtPolyRef)ip;
+						ep.poly = (unsigned short)m_nav->decodePolyIdPoly(link.ref);
+						ep.side = link.edge;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+void dtNavMeshLandmarks::resetLandmark(const int landmark)
+{
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		dtLandmarkTile& table = m_tables[i];
+		if (!table.dist)
+			continue;
+		const int slotCount = table.polyCount * DT_VERTS_PER_POLYGON;
+		for (int j = 0; j < slotCount; ++j)
+			table.dist[j * m_landmarkCount + landmark] = DT_LANDMARK_UNREACHED;
+		table.dirty = true;
+	}
+}
+
+void dtNavMeshLandmarks::seedPoly(const int landmark, const dtPolyRef ref)
+{
+	const dtMeshTile* tile = 0;
+	const dtPoly* poly = 0;
+	if (dtStatusFailed(m_nav->getTileAndPolyByRef(ref, &tile, &poly)))
+		return;
+	const unsigned int it = m_nav->decodePolyIdTile(ref);
+	const int ip = (int)m_nav->decodePolyIdPoly(ref);
+
+	// All the portals of the landmark polygon are at zero distance.
+	if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+	{
+		visit(landmark, it, ip * DT_VERTS_PER_POLYGON + 0, 0.0f);
+		visit(landmark, it, ip * DT_VERTS_PER_POLYGON + 1, 0.0f);
+		return;
+	}
+	for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+	{
+		if (tile->links[i].edge != 0xff)
+			visit(landmark, it, ip * DT_VERTS_PER_POLYGON + tile->links[i].edge, 0.0f);
+	}
+	const dtLandmarkTile* table = getTable(it);
+	for (int i = 0; table && i < table->endPointCount; ++i)
+	{
+		const dtLandmarkEndPoint& ep = table->endPoints[i];
+		if (ep.poly == ip)
+			visit(landmark, m_nav->decodePolyIdTile(ep.con), (int)m_nav->decodePolyIdPoly(ep.con) * DT_VERTS_PER_POLYGON + ep.side, 0.0f);
+	}
+}
+
+void dtNavMeshLandmarks::seedTile(const int landmark, unsigned int it)
+{
+	const dtLandmarkTile* table = getTable(it);
+	if (!table)
+		return;
+	const int slotCount = table->polyCount * DT_VERTS_PER_POLYGON;
+	for (int i = 0; i < slotCount; ++i)
+	{
+		const float d = table->dist[i * m_landmarkCount + landmark];
+		if (d != DT_LANDMARK_UNREACHED && !pushHeap(d, it, i))
+			m_heapOverflow = true;
+	}
+}
+
+void dtNavMeshLandmarks::visit(const int landmark, unsigned int it, const int slot, const float dist)
+{
+	dtLandmarkTile* table = getTable(it);
+	if (!table)
+		return;
+	float& cur = table->dist[slot * m_landmarkCount + landmark];
+	if (dist >= cur)
+		return;
+	cur = dist;
+	table->dirty = true;
+	if (!pushHeap(dist, it, slot))
+		m_heapOverflow = true;
+
+	// The bounds of the polygon an off-mesh connection lands on depend on the end point.
+	const dtMeshTile* tile = m_nav->getTile((int)it);
+	const dtPoly* poly = &tile->polys[slot / DT_VERTS_PER_POLYGON];
+	if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+	{
+		for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+		{
+			dtLandmarkTile* other = getTable(m_nav->decodePolyIdTile(tile->links[i].ref));
+			if (other)
+				other->dirty = true;
+		}
+	}
+}
+
+// Relaxes the portals and off-mesh connection end points of a ground polygon
+// from a point on the polygon.
+void dtNavMeshLandmarks::visitFromPoint(const int landmark, const float* pt, const dtPolyRef ref,
+										const dtPolyRef skipCon, const float dist)
+{
+	const dtMeshTile* tile = 0;
+	const dtPoly* poly = 0;
+	m_nav->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+	const unsigned int it = m_nav->decodePolyIdTile(ref);
+	const int ip = (int)m_nav->decodePolyIdPoly(ref);
+
+	for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+	{
+		const unsigned char edge = tile->links[i].edge;
+		if (edge == 0xff)
+			continue;
+		const float* va = &tile->verts[poly->verts[edge]*3];
+		const float* vb = &tile->verts[poly->verts[(edge+1) % poly->vertCount]*3];
+		visit(landmark, it, ip * DT_VERTS_PER_POLYGON + edge, dist + distPtSeg2D(pt, va, vb) * m_costScale);
+	}
+
+	const dtLandmarkTile* table = getTable(it);
+	for (int i = 0; table && i < table->endPointCount; ++i)
+	{
+		const dtLandmarkEndPoint& ep = table->endPoints[i];
+		if (ep.poly != ip || ep.con == skipCon)
+			continue;
+		const dtMeshTile* conTile = 0;
+		const dtPoly* con = 0;
+		m_nav->getTileAndPolyByRefUnsafe(ep.con, &conTile, &con);
+		const float* cp = &conTile->verts[con->verts[ep.side]*3];
+		visit(landmark, m_nav->decodePolyIdTile(ep.con), (int)m_nav->decodePolyIdPoly(ep.con) * DT_VERTS_PER_POLYGON + ep.side,
+			  dist + dtVdist2D(pt, cp) * m_costScale);
+	}
+}
+
+bool dtNavMeshLandmarks::propagate(const int landmark)
+{
+	dtLandmarkHeapItem item;
+	while (m_heapSize > 0)
+	{
+		popHeap(item);
+
+		const dtLandmarkTile* table = getTable(item.tile);
+		if (!table)
+			continue;
+		// Skip stale queue entries.
+		if (item.dist > table->dist[item.slot * m_landmarkCount + landmark])
+			continue;
+
+		const dtMeshTile* tile = m_nav->getTile((int)item.tile);
+		const int ip = item.slot / DT_VERTS_PER_POLYGON;
+		const int side = item.slot % DT_VERTS_PER_POLYGON;
+		const dtPoly* poly = &tile->polys[ip];
+		const dtPolyRef ref = m_nav->getPolyRefBase(tile) | (dtPolyRef)ip;
+
+		if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+		{
+			// Across the connection, in either direction.
+			const float* v0 = &tile->verts[poly->verts[0]*3];
+			const float* v1 = &tile->verts[poly->verts[1]*3];
+			visit(landmark, item.tile, ip * DT_VERTS_PER_POLYGON + (1 - side), item.dist + dtVdist(v0, v1) * m_costScale);
+
+			// To the portals of the polygon the end point is on.
+			const float* pt = side == 0 ? v0 : v1;
+			for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+			{
+				if (tile->links[i].edge == side)
+					visitFromPoint(landmark, pt, tile->links[i].ref, ref, item.dist);
+			}
+			continue;
+		}
+
+		const float* va = &tile->verts[poly->verts[side]*3];
+		const float* vb = &tile->verts[poly->verts[(side+1) % poly->vertCount]*3];
+
+		for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+		{
+			const dtLink& link = tile->links[i];
+			if (link.edge == 0xff)
+				continue;
+
+			if (link.edge == side)
+			{
+				// Through the portal, to the matching edge of the neighbour.
+				const dtMeshTile* neiTile = 0;
+				const dtPoly* nei = 0;
+				m_nav->getTileAndPolyByRefUnsafe(link.ref, &neiTile, &nei);
+				for (unsigned int j = nei->firstLink; j != DT_NULL_LINK; j = neiTile->links[j].next)
+				{
+					if (neiTile->links[j].ref == ref && neiTile->links[j].edge != 0xff)
+					{
+						visit(landmark, m_nav->decodePolyIdTile(link.ref),
+							  (int)m_nav->decodePolyIdPoly(link.ref) * DT_VERTS_PER_POLYGON + neiTile->links[j].edge,
+							  item.dist);
+						break;
+					}
+				}
+			}
+			else
+			{
+				// Across the polygon, to another portal.
+				const float* wa = &tile->verts[poly->verts[link.edge]*3];
+				const float* wb = &tile->verts[poly->verts[(link.edge+1) % poly->vertCount]*3];
+				visit(landmark, item.tile, ip * DT_VERTS_PER_POLYGON + link.edge,
+					  item.dist + distSegSeg2D(va, vb, wa, wb) * m_costScale);
+			}
+		}
+
+		// Across the polygon, to the off-mesh connections landing on it.
+		for (int i = 0; i < table->endPointCount; ++i)
+		{
+			const dtLandmarkEndPoint& ep = table->endPoints[i];
+			if (ep.poly != ip)
+				continue;
+			const dtMeshTile* conTile = 0;
+			const dtPoly* con = 0;
+			m_nav->getTileAndPolyByRefUnsafe(ep.con, &conTile, &con);
+			const float* cp = &conTile->verts[con->verts[ep.side]*3];
+			visit(landmark, m_nav->decodePolyIdTile(ep.con), (int)m_nav->decodePolyIdPoly(ep.con) * DT_VERTS_PER_POLYGON + ep.side,
+				  item.dist + distPtSeg2D(cp, va, vb) * m_costScale);
+		}
+	}
+
+	const bool ok = !m_heapOverflow;
+	m_heapOverflow = false;
+	return ok;
+}
+
+void dtNavMeshLandmarks::updateBounds(unsigned int it)
+{
+	dtLandmarkTile& table = m_tables[it];
+	const dtMeshTile* tile = m_nav->getTile((int)it);
+	const int nl = m_landmarkCount;
+
+	for (int ip = 0; ip < table.polyCount; ++ip)
+	{
+		const dtPoly* poly = &tile->polys[ip];
+		float* bounds = &table.bounds[ip * nl * 2];
+		for (int l = 0; l < nl; ++l)
+		{
+			bounds[l*2+0] = FLT_MAX;
+			bounds[l*2+1] = -FLT_MAX;
+		}
+
+		bool complete = true;
+		int count = 0;
+		if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+		{
+			for (int side = 0; side < 2; ++side)
+			{
+				const float* d = &table.dist[(ip * DT_VERTS_PER_POLYGON + side) * nl];
+				for (int l = 0; l < nl; ++l)
+				{
+					bounds[l*2+0] = dtMin(bounds[l*2+0], d[l]);
+					bounds[l*2+1] = dtMax(bounds[l*2+1], d[l]);
+				}
+				count++;
+			}
+		}
+		else
+		{
+			for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+			{
+				if (tile->links[i].edge == 0xff)
+					continue;
+				const float* d = &table.dist[(ip * DT_VERTS_PER_POLYGON + tile->links[i].edge) * nl];
+				for (int l = 0; l < nl; ++l)
+				{
+					bounds[l*2+0] = dtMin(bounds[l*2+0], d[l]);
+					bounds[l*2+1] = dtMax(bounds[l*2+1], d[l]);
+				}
+				count++;
+			}
+			for (int i = 0; i < table.endPointCount; ++i)
+			{
+				const dtLandmarkEndPoint& ep = table.endPoints[i];
+				if (ep.poly != ip)
+					continue;
+				const dtLandmarkTile* conTable = getTable(m_nav->decodePolyIdTile(ep.con));
+				if (!conTable)
+				{
+					complete = false;
+					continue;
+				}
+				const float* d = &conTable->dist[((int)m_nav->decodePolyIdPoly(ep.con) * DT_VERTS_PER_POLYGON + ep.side) * nl];
+				for (int l = 0; l < nl; ++l)
+				{
+					bounds[l*2+0] = dtMin(bounds[l*2+0], d[l]);
+					bounds[l*2+1] = dtMax(bounds[l*2+1], d[l]);
+				}
+				count++;
+			}
+		}
+
+		// Unreached portals give no bounds for the landmark.
+		for (int l = 0; l < nl; ++l)
+		{
+			if (!count || !complete || bounds[l*2+1] == DT_LANDMARK_UNREACHED)
+			{
+				bounds[l*2+0] = DT_LANDMARK_UNREACHED;
+				bounds[l*2+1] = DT_LANDMARK_UNREACHED;
+			}
+		}
+	}
+
+	table.dirty = false;
+}
+
+void dtNavMeshLandmarks::updateDirtyBounds()
+{
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		if (getTable((unsigned int)i) && m_tables[i].dirty)
+			updateBounds((unsigned int)i);
+	}
+}
+
+dtPolyRef dtNavMeshLandmarks::findFurthestPoly(const int landmarkCount) const
+{
+	// Find the polygon maximizing the distance to the nearest landmark.
+	dtPolyRef bestRef = 0;
+	float bestDist = 0.0f;
+	for (int i = 0; i < m_maxTiles; ++i)
+	{
+		const dtLandmarkTile* table = getTable((unsigned int)i);
+		if (!table)
+			continue;
+		const dtPolyRef base = m_nav->getPolyRefBase(m_nav->getTile(i));
+		for (int ip = 0; ip < table->polyCount; ++ip)
+		{
+			const float* bounds = &table->bounds[ip * m_landmarkCount * 2];
+			float d = FLT_MAX;
+			for (int l = 0; l < landmarkCount; ++l)
+				d = dtMin(d, bounds[l*2+0]);
+			if (d != DT_LANDMARK_UNREACHED && d > bestDist)
+			{
+				bestDist = d;
+				bestRef = base | (dtPolyRef)ip;
+			}
+		}
+	}
+	return bestRef;
+}
+
+bool dtNavMeshLandmarks::pushHeap(const float dist, const unsigned int tile, const int slot)
+{
+	if (m_heapSize == m_heapCapacity)
+	{
+		const int capacity = m_heapCapacity ? m_heapCapacity * 2 : 256;
+		dtLandmarkHeapItem* heap = (dtLandmarkHeapItem*)dtAlloc(sizeof(dtLandmarkHeapItem) * capacity, DT_ALLOC_TEMP);
+		if (!heap)
+			return false;
+		if (m_heapSize)
+			memcpy(heap, m_heap, sizeof(dtLandmarkHeapItem) * m_heapSize);
+		dtFree(m_heap);
+		m_heap = heap;
+		m_heapCapacity = capacity;
+	}
+
+	int i = m_heapSize++;
+	while (i > 0)
+	{
+		const int parent = (i - 1) / 2;
+		if (m_heap[parent].dist <= dist)
+			break;
+		m_heap[i] = m_heap[parent];
+		i = parent;
+	}
+	m_heap[i].dist = dist;
+	m_heap[i].tile = tile;
+	m_heap[i].slot = slot;
+	return true;
+}
+
+void dtNavMeshLandmarks::popHeap(dtLandmarkHeapItem& item)
+{
+	dtAssert(m_heapSize > 0);
+	item = m_heap[0];
+	const dtLandmarkHeapItem last = m_heap[--m_heapSize];
+	int i = 0;
+	for (;;)
+	{
+		int child = i * 2 + 1;
+		if (child >= m_heapSize)
+			break;
+		if (child + 1 < m_heapSize && m_heap[child + 1].dist < m_heap[child].dist)
+			child++;
+		if (last.dist <= m_heap[child].dist)
+			break;
+		m_heap[i] = m_heap[child];
+		i = child;
+	}
+	if (m_heapSize > 0)
+		m_heap[i] = last;
+}
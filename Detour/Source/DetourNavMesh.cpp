@@ -27,6 +27,12 @@
 #include "DetourAssert.h"
 #include <new>
 
+// The state of a tile in the current tile batch.
+static const unsigned char DT_BATCH_ADDED = 1;		// Added in the batch, not connected to its neighbours yet.
+static const unsigned char DT_BATCH_REMOVED = 2;	// Removed in the batch, the links of the neighbours to it are removed on commit.
+static const unsigned char DT_BATCH_CONNECTED = 4;	// Connected to its neighbours during the commit.
+static const unsigned char DT_BATCH_VISITED = 8;	// Links to the removed tiles already removed during the commit.
+
 
 inline bool overlapSlabs(const float* amin, const float* amax,
 						 const float* bmin, const float* bmax,
@@ -64,53 +70,6 @@ inline bool overlapSlabs(const float* amin, const float* amax,
 	return false;
 }
 
-static float getSlabCoord(const float* va, const int side)
-{
-	if (side == 0 || side == 4)
-		return va[0];
-	else if (side == 2 || side == 6)
-		return va[2];
-	return 0;
-}
-
-static void calcSlabEndPoints(const float* va, const float* vb, float* bmin, float* bmax, const int side)
-{
-	if (side == 0 || side == 4)
-	{
-		if (va[2] < vb[2])
-		{
-			bmin[0] = va[2];
-			bmin[1] = va[1];
-			bmax[0] = vb[2];
-			bmax[1] = vb[1];
-		}
-		else
-		{
-			bmin[0] = vb[2];
-			bmin[1] = vb[1];
-			bmax[0] = va[2];
-			bmax[1] = va[1];
-		}
-	}
-	else if (side == 2 || side == 6)
-	{
-		if (va[0] < vb[0])
-		{
-			bmin[0] = va[0];
-			bmin[1] = va[1];
-			bmax[0] = vb[0];
-			bmax[1] = vb[1];
-		}
-		else
-		{
-			bmin[0] = vb[0];
-			bmin[1] = vb[1];
-			bmax[0] = va[0];
-			bmax[1] = va[1];
-		}
-	}
-}
-
 inline int computeTileHash(int x, int y, const int mask)
 {
 	const unsigned int h1 = 0x8da6b343; // Large multiplicative constants;
@@ -193,14 +152,22 @@ dtNavMesh::dtNavMesh() :
 	m_tileLutMask(0),
 	m_posLookup(0),
 	m_nextFree(0),
-	m_tiles(0)
+	m_tiles(0),
+	m_batchOpen(false),
+	m_batchFlags(0),
+	m_batchAdded(0),
+	m_batchAddedCount(0),
+	m_batchRemoved(0),
+	m_batchRemovedLocs(0),
+	m_batchRemovedCount(0),
+	m_batchRemovedCapacity(0),
+	m_listenerCount(0)
 {
-#ifndef DT_POLYREF64
 	m_saltBits = 0;
 	m_tileBits = 0;
 	m_polyBits = 0;
-#endif
 	memset(&m_params, 0, sizeof(dtNavMeshParams));
+	memset(&m_lookup, 0, sizeof(dtTileLookupParams));
 	m_orig[0] = 0;
 	m_orig[1] = 0;
 	m_orig[2] = 0;
@@ -219,29 +186,111 @@ dtNavMesh::~dtNavMesh()
 	}
 	dtFree(m_posLookup);
 	dtFree(m_tiles);
+	dtFree(m_batchFlags);
+	dtFree(m_batchAdded);
+	dtFree(m_batchRemoved);
+	dtFree(m_batchRemovedLocs);
 }
 		
 dtStatus dtNavMesh::init(const dtNavMeshParams* params)
 {
+	return init(params, 0, 0);
+}
+
+dtStatus dtNavMesh::init(const dtNavMeshParams* params, const dtTileLookupParams* lookup)
+{
+	return init(params, lookup, 0);
+}
+
+/// @par
+///
+/// #DT_TILE_LOOKUP_GRID finds the tiles at a location with a single array access, but
+/// the tiles outside of the grid cannot be added and the grid memory grows with its area.
+/// #DT_TILE_LOOKUP_HASH accepts any tile location and its memory only depends on
+/// dtNavMeshParams::maxTiles. The hash table is used if @p lookup is null.
+///
+/// By default the polygon references use just enough bits for dtNavMeshParams::maxTiles
+/// and dtNavMeshParams::maxPolys and the remaining bits, at most 31, for the salt. (With DT_POLYREF64,
+/// #DT_SALT_BITS, #DT_TILE_BITS and #DT_POLY_BITS.) @p refBits sets the layout explicitly,
+/// for example to keep more salt bits than the default, so that the references to removed
+/// tiles are less likely to become valid again. The tiles must be added to a navigation
+/// mesh with the same layout to restore their references.
+///
+/// @see dtTileLookupParams, dtPolyRefBits
+dtStatus dtNavMesh::init(const dtNavMeshParams* params, const dtTileLookupParams* lookup, const dtPolyRefBits* refBits)
+{
+	// Init ID generator values.
+	const unsigned int minTileBits = dtIlog2(dtNextPow2((unsigned int)params->maxTiles));
+	const unsigned int minPolyBits = dtIlog2(dtNextPow2((unsigned int)params->maxPolys));
+	if (refBits)
+	{
+		if (refBits->saltBits < 0 || refBits->tileBits < 0 || refBits->polyBits < 0)
+			return DT_FAILURE | DT_INVALID_PARAM;
+		m_saltBits = (unsigned int)refBits->saltBits;
+		m_tileBits = (unsigned int)refBits->tileBits;
+		m_polyBits = (unsigned int)refBits->polyBits;
+	}
+	else
+	{
+#ifdef DT_POLYREF64
+		m_saltBits = DT_SALT_BITS;
+		m_tileBits = DT_TILE_BITS;
+		m_polyBits = DT_POLY_BITS;
+#else
+		m_tileBits = minTileBits;
+		m_polyBits = minPolyBits;
+		m_saltBits = m_tileBits + m_polyBits < 32 ? dtMin(31u, 32 - m_tileBits - m_polyBits) : 0;
+#endif
+	}
+	// Only allow 31 salt bits, since the salt mask is calculated using 32bit uint and it will overflow.
+	if (m_saltBits < 10 || m_saltBits > 31 ||
+		m_tileBits < minTileBits || m_tileBits > 31 ||
+		m_polyBits < minPolyBits || m_polyBits > 31 ||
+		m_saltBits + m_tileBits + m_polyBits > sizeof(dtPolyRef)*8)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
 	memcpy(&m_params, params, sizeof(dtNavMeshParams));
 	dtVcopy(m_orig, params->orig);
 	m_tileWidth = params->tileWidth;
 	m_tileHeight = params->tileHeight;
 	
 	// Init tiles
+	memset(&m_lookup, 0, sizeof(dtTileLookupParams));
+	if (lookup)
+		memcpy(&m_lookup, lookup, sizeof(dtTileLookupParams));
+	if (m_lookup.type == DT_TILE_LOOKUP_GRID)
+	{
+		if (m_lookup.width <= 0 || m_lookup.height <= 0 || m_lookup.width > 0x7fffffff / m_lookup.height)
+			return DT_FAILURE | DT_INVALID_PARAM;
+		m_tileLutSize = m_lookup.width * m_lookup.height;
+		m_tileLutMask = 0;
+	}
+	else if (m_lookup.type == DT_TILE_LOOKUP_HASH)
+	{
+		// There are at most maxTiles locations, so at least half of the slots stay empty
+		// and every probe sequence ends at an empty slot.
+		m_tileLutSize = (int)dtNextPow2((unsigned int)dtMax(params->maxTiles, 1) * 2);
+		m_tileLutMask = m_tileLutSize-1;
+	}
+	else
+	{
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
 	m_maxTiles = params->maxTiles;
-	m_tileLutSize = dtNextPow2(params->maxTiles/4);
-	if (!m_tileLutSize) m_tileLutSize = 1;
-	m_tileLutMask = m_tileLutSize-1;
 	
 	m_tiles = (dtMeshTile*)dtAlloc(sizeof(dtMeshTile)*m_maxTiles, DT_ALLOC_PERM);
 	if (!m_tiles)
 		return DT_FAILURE | DT_OUT_OF_MEMORY;
-	m_posLookup = (dtMeshTile**)dtAlloc(sizeof(dtMeshTile*)*m_tileLutSize, DT_ALLOC_PERM);
+	m_posLookup = (dtTileLookupSlot*)dtAlloc(sizeof(dtTileLookupSlot)*m_tileLutSize, DT_ALLOC_PERM);
 	if (!m_posLookup)
 		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	m_batchFlags = (unsigned char*)dtAlloc(sizeof(unsigned char)*dtMax(m_maxTiles, 1), DT_ALLOC_PERM);
+	m_batchAdded = (dtTileRef*)dtAlloc(sizeof(dtTileRef)*dtMax(m_maxTiles, 1), DT_ALLOC_PERM);
+	if (!m_batchFlags || !m_batchAdded)
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
 	memset(m_tiles, 0, sizeof(dtMeshTile)*m_maxTiles);
-	memset(m_posLookup, 0, sizeof(dtMeshTile*)*m_tileLutSize);
+	memset(m_posLookup, 0, sizeof(dtTileLookupSlot)*m_tileLutSize);
+	memset(m_batchFlags, 0, sizeof(unsigned char)*dtMax(m_maxTiles, 1));
 	m_nextFree = 0;
 	for (int i = m_maxTiles-1; i >= 0; --i)
 	{
@@ -250,21 +299,6 @@ dtStatus dtNavMesh::init(const dtNavMeshParams* params)
 		m_nextFree = &m_tiles[i];
 	}
 	
-	// Init ID generator values.
-#ifndef DT_POLYREF64
-	m_tileBits = dtIlog2(dtNextPow2((unsigned int)params->maxTiles));
-	m_polyBits = dtIlog2(dtNextPow2((unsigned int)params->maxPolys));
-
-    // Ensure that the bits of poly ref do not overflow.
-    dtAssert(m_tileBits + m_polyBits <= 31);
-
-	// Only allow 31 salt bits, since the salt mask is calculated using 32bit uint and it will overflow.
-	m_saltBits = dtMin((unsigned int)31, 32 - m_tileBits - m_polyBits);
-
-	if (m_saltBits < 10)
-		return DT_FAILURE | DT_INVALID_PARAM;
-#endif
-	
 	return DT_SUCCESS;
 }
 
@@ -300,65 +334,23 @@ const dtNavMeshParams* dtNavMesh::getParams() const
 	return &m_params;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-int dtNavMesh::findConnectingPolys(const float* va, const float* vb,
-								   const dtMeshTile* tile, int side,
-								   dtPolyRef* con, float* conarea, int maxcon) const
+dtPolyRefBits dtNavMesh::getPolyRefBits() const
 {
-	if (!tile) return 0;
-	
-	float amin[2], amax[2];
-	calcSlabEndPoints(va, vb, amin, amax, side);
-	const float apos = getSlabCoord(va, side);
-
-	// Remove links pointing to 'side' and compact the links array. 
-	float bmin[2], bmax[2];
-	unsigned short m = DT_EXT_LINK | (unsigned short)side;
-	int n = 0;
-	
-	dtPolyRef base = getPolyRefBase(tile);
-	
-	for (int i = 0; i < tile->header->polyCount; ++i)
-	{
-		dtPoly* poly = &tile->polys[i];
-		const int nv = poly->vertCount;
-		for (int j = 0; j < nv; ++j)
-		{
-			// Skip edges which do not point to the right side.
-			if (poly->neis[j] != m) continue;
-			
-			const float* vc = &tile->verts[poly->verts[j]*3];
-			const float* vd = &tile->verts[poly->verts[(j+1) % nv]*3];
-			const float bpos = getSlabCoord(vc, side);
-			
-			// Segments are not close enough.
-			if (dtAbs(apos-bpos) > 0.01f)
-				continue;
-			
-			// Check if the segments touch.
-			calcSlabEndPoints(vc,vd, bmin,bmax, side);
-			
-			if (!overlapSlabs(amin,amax, bmin,bmax, 0.01f, tile->header->walkableClimb)) continue;
-			
-			// Add return value.
-			if (n < maxcon)
-			{
-				conarea[n*2+0] = dtMax(amin[0], bmin[0]);
-				conarea[n*2+1] = dtMin(amax[0], bmax[0]);
-				con[n] = base | (dtPolyRef)i;
-				n++;
-			}
-			break;
-		}
-	}
-	return n;
+	dtPolyRefBits bits;
+	bits.saltBits = (int)m_saltBits;
+	bits.tileBits = (int)m_tileBits;
+	bits.polyBits = (int)m_polyBits;
+	return bits;
 }
 
-void dtNavMesh::unconnectLinks(dtMeshTile* tile, dtMeshTile* target)
+//////////////////////////////////////////////////////////////////////////////////////////
+void dtNavMesh::unconnectRemovedLinks(dtMeshTile* tile)
 {
-	if (!tile || !target) return;
+	if (!tile) return;
 
-	const unsigned int targetNum = decodePolyIdTile(getTileRef(target));
+	const unsigned char* batchFlags = m_batchFlags;
+	const unsigned int polyBits = m_polyBits;
+	const dtPolyRef tileMask = ((dtPolyRef)1<<m_tileBits)-1;
 
 	for (int i = 0; i < tile->header->polyCount; ++i)
 	{
@@ -367,7 +359,7 @@ void dtNavMesh::unconnectLinks(dtMeshTile* tile, dtMeshTile* target)
 		unsigned int pj = DT_NULL_LINK;
 		while (j != DT_NULL_LINK)
 		{
-			if (decodePolyIdTile(tile->links[j].ref) == targetNum)
+			if (batchFlags[(tile->links[j].ref >> polyBits) & tileMask] & DT_BATCH_REMOVED)
 			{
 				// Remove link.
 				unsigned int nj = tile->links[j].next;
@@ -388,42 +380,133 @@ void dtNavMesh::unconnectLinks(dtMeshTile* tile, dtMeshTile* target)
 	}
 }
 
+// Returns the range of the border edges of the tile on the side.
+static void getBorderEdgeRange(const dtMeshTile* tile, const int side, int& first, int& last)
+{
+	// The edges are sorted by side.
+	int lo = 0, hi = tile->header->borderEdgeCount;
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (tile->borderEdges[mid].side < side)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	first = lo;
+	last = lo;
+	while (last < tile->header->borderEdgeCount && tile->borderEdges[last].side == side)
+		last++;
+}
+
+namespace
+{
+// The neighbour polygons of a border edge, in the order a scan of the neighbour polygons finds them:
+// the polygons with the lowest indices, each with its first edge that touches the border edge.
+struct dtBorderConnections
+{
+	static const int MAX_CONNECTIONS = 4;
+
+	unsigned short poly[MAX_CONNECTIONS];
+	unsigned char edge[MAX_CONNECTIONS];
+	float area[MAX_CONNECTIONS*2];
+	int count;
+
+	dtBorderConnections() : count(0) {}
+
+	void add(const dtBorderEdge& e, const float amin, const float amax)
+	{
+		int i = 0;
+		while (i < count && poly[i] < e.poly)
+			i++;
+		if (i < count && poly[i] == e.poly)
+		{
+			if (e.edge < edge[i])
+				set(i, e, amin, amax);
+			return;
+		}
+		if (i == MAX_CONNECTIONS)
+			return;
+		if (count == MAX_CONNECTIONS)
+			count--;
+		for (int j = count; j > i; --j)
+		{
+			poly[j] = poly[j-1];
+			edge[j] = edge[j-1];
+			area[j*2+0] = area[(j-1)*2+0];
+			area[j*2+1] = area[(j-1)*2+1];
+		}
+		set(i, e, amin, amax);
+		count++;
+	}
+
+	void set(const int i, const dtBorderEdge& e, const float amin, const float amax)
+	{
+		poly[i] = e.poly;
+		edge[i] = e.edge;
+		area[i*2+0] = dtMax(amin, e.bmin[0]);
+		area[i*2+1] = dtMin(amax, e.bmax[0]);
+	}
+};
+}
+
 void dtNavMesh::connectExtLinks(dtMeshTile* tile, dtMeshTile* target, int side)
 {
-	if (!tile) return;
-	
-	// Connect border links.
-	for (int i = 0; i < tile->header->polyCount; ++i)
+	if (!tile || !target) return;
+
+	const dtPolyRef base = getPolyRefBase(target);
+
+	for (int dir = 0; dir < 8; dir += 2)
 	{
-		dtPoly* poly = &tile->polys[i];
+		if (side != -1 && dir != side)
+			continue;
 
-		// Create new links.
-//		unsigned short m = DT_EXT_LINK | (unsigned short)side;
-		
-		const int nv = poly->vertCount;
-		for (int j = 0; j < nv; ++j)
+		// Both edge lists are sorted by their start along the border, so they are connected with a linear merge.
+		int first, last, targetFirst, targetLast;
+		getBorderEdgeRange(tile, dir, first, last);
+		getBorderEdgeRange(target, dtOppositeTile(dir), targetFirst, targetLast);
+		if (first == last || targetFirst == targetLast)
+			continue;
+
+		for (int i = first; i < last; ++i)
 		{
-			// Skip non-portal edges.
-			if ((poly->neis[j] & DT_EXT_LINK) == 0)
-				continue;
-			
-			const int dir = (int)(poly->neis[j] & 0xff);
-			if (side != -1 && dir != side)
-				continue;
-			
-			// Create new links
+			const dtBorderEdge& ea = tile->borderEdges[i];
+
+			// The target edges before 'targetFirst' end before the start of this and the following edges.
+			while (targetFirst < targetLast && target->borderEdges[targetFirst].bmax[0] < ea.bmin[0])
+				targetFirst++;
+
+			dtBorderConnections cons;
+			for (int k = targetFirst; k < targetLast; ++k)
+			{
+				const dtBorderEdge& eb = target->borderEdges[k];
+				if (eb.bmin[0] > ea.bmax[0])
+					break;
+
+				// Segments are not close enough.
+				if (dtAbs(ea.pos - eb.pos) > 0.01f)
+					continue;
+
+				// Check if the segments touch.
+				if (!overlapSlabs(ea.bmin, ea.bmax, eb.bmin, eb.bmax, 0.01f, target->header->walkableClimb))
+					continue;
+
+				cons.add(eb, ea.bmin[0], ea.bmax[0]);
+			}
+
+			// Create new links.
+			dtPoly* poly = &tile->polys[ea.poly];
+			const int j = ea.edge;
+			const int nv = poly->vertCount;
 			const float* va = &tile->verts[poly->verts[j]*3];
 			const float* vb = &tile->verts[poly->verts[(j+1) % nv]*3];
-			dtPolyRef nei[4];
-			float neia[4*2];
-			int nnei = findConnectingPolys(va,vb, target, dtOppositeTile(dir), nei,neia,4);
-			for (int k = 0; k < nnei; ++k)
+			for (int k = 0; k < cons.count; ++k)
 			{
 				unsigned int idx = allocLink(tile);
 				if (idx != DT_NULL_LINK)
 				{
 					dtLink* link = &tile->links[idx];
-					link->ref = nei[k];
+					link->ref = base | (dtPolyRef)cons.poly[k];
 					link->edge = (unsigned char)j;
 					link->side = (unsigned char)dir;
 					
@@ -433,8 +516,8 @@ void dtNavMesh::connectExtLinks(dtMeshTile* tile, dtMeshTile* target, int side)
 					// Compress portal limits to a byte value.
 					if (dir == 0 || dir == 4)
 					{
-						float tmin = (neia[k*2+0]-va[2]) / (vb[2]-va[2]);
-						float tmax = (neia[k*2+1]-va[2]) / (vb[2]-va[2]);
+						float tmin = (cons.area[k*2+0]-va[2]) / (vb[2]-va[2]);
+						float tmax = (cons.area[k*2+1]-va[2]) / (vb[2]-va[2]);
 						if (tmin > tmax)
 							dtSwap(tmin,tmax);
 						link->bmin = (unsigned char)roundf(dtClamp(tmin, 0.0f, 1.0f)*255.0f);
@@ -442,8 +525,8 @@ void dtNavMesh::connectExtLinks(dtMeshTile* tile, dtMeshTile* target, int side)
 					}
 					else if (dir == 2 || dir == 6)
 					{
-						float tmin = (neia[k*2+0]-va[0]) / (vb[0]-va[0]);
-						float tmax = (neia[k*2+1]-va[0]) / (vb[0]-va[0]);
+						float tmin = (cons.area[k*2+0]-va[0]) / (vb[0]-va[0]);
+						float tmax = (cons.area[k*2+1]-va[0]) / (vb[0]-va[0]);
 						if (tmin > tmax)
 							dtSwap(tmin,tmax);
 						link->bmin = (unsigned char)roundf(dtClamp(tmin, 0.0f, 1.0f)*255.0f);
@@ -809,13 +892,29 @@ dtPolyRef dtNavMesh::findNearestPolyInTile(const dtMeshTile* tile,
 	return nearest;
 }
 
+namespace
+{
+	// Collects the polygons found in a wide bounding volume tree.
+	struct CollectWideBVPolys
+	{
+		dtPolyRef base;
+		dtPolyRef* polys;
+		int maxPolys;
+		int n;
+
+		void operator()(const int i)
+		{
+			if (n < maxPolys)
+				polys[n++] = base | (dtPolyRef)i;
+		}
+	};
+}
+
 int dtNavMesh::queryPolygonsInTile(const dtMeshTile* tile, const float* qmin, const float* qmax,
 								   dtPolyRef* polys, const int maxPolys) const
 {
-	if (tile->bvTree)
+	if (tile->bvTree || tile->bvTree4 || tile->bvTree8)
 	{
-		const dtBVNode* node = &tile->bvTree[0];
-		const dtBVNode* end = &tile->bvTree[tile->header->bvNodeCount];
 		const float* tbmin = tile->header->bmin;
 		const float* tbmax = tile->header->bmax;
 		const float qfac = tile->header->bvQuantFactor;
@@ -839,6 +938,22 @@ int dtNavMesh::queryPolygonsInTile(const dtMeshTile* tile, const float* qmin, co
 		
 		// Traverse tree
 		dtPolyRef base = getPolyRefBase(tile);
+		if (tile->bvTree4 || tile->bvTree8)
+		{
+			CollectWideBVPolys collect;
+			collect.base = base;
+			collect.polys = polys;
+			collect.maxPolys = maxPolys;
+			collect.n = 0;
+			if (tile->bvTree4)
+				dtQueryWideBVTree<4>(tile->bvTree4, bmin, bmax, collect);
+			else
+				dtQueryWideBVTree<8>(tile->bvTree8, bmin, bmax, collect);
+			return collect.n;
+		}
+
+		const dtBVNode* node = &tile->bvTree[0];
+		const dtBVNode* end = &tile->bvTree[tile->header->bvNodeCount];
 		int n = 0;
 		while (node < end)
 		{
@@ -911,6 +1026,20 @@ int dtNavMesh::queryPolygonsInTile(const dtMeshTile* tile, const float* qmin, co
 /// @see dtCreateNavMeshData, #removeTile
 dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 							dtTileRef lastRef, dtTileRef* result)
+{
+	if (m_batchOpen)
+		return addBatchTile(data, dataSize, flags, lastRef, result);
+
+	dtStatus status = beginTileBatch();
+	if (dtStatusFailed(status))
+		return status;
+	status = addBatchTile(data, dataSize, flags, lastRef, result);
+	commitTileBatch();
+	return status;
+}
+
+dtStatus dtNavMesh::addBatchTile(unsigned char* data, int dataSize, int flags,
+								 dtTileRef lastRef, dtTileRef* result)
 {
 	// Make sure the data is in right format.
 	dtMeshHeader* header = (dtMeshHeader*)data;
@@ -918,17 +1047,22 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 		return DT_FAILURE | DT_WRONG_MAGIC;
 	if (header->version != DT_NAVMESH_VERSION)
 		return DT_FAILURE | DT_WRONG_VERSION;
+	if (header->bvNodeCount && !dtGetBVNodeSize(header->bvTreeWidth))
+		return DT_FAILURE | DT_INVALID_PARAM;
 
-#ifndef DT_POLYREF64
 	// Do not allow adding more polygons than specified in the NavMesh's maxPolys constraint.
 	// Otherwise, the poly ID cannot be represented with the given number of bits.
 	if (m_polyBits < dtIlog2(dtNextPow2((unsigned int)header->polyCount)))
 		return DT_FAILURE | DT_INVALID_PARAM;
-#endif
 		
 	// Make sure the location is free.
 	if (getTileAt(header->x, header->y, header->layer))
 		return DT_FAILURE | DT_ALREADY_OCCUPIED;
+
+	// Find the location in the position lookup. The slot stays empty until the tile is linked to it.
+	dtTileLookupSlot* slot = insertTileSlot(header->x, header->y);
+	if (!slot)
+		return DT_FAILURE | DT_INVALID_PARAM;
 		
 	// Allocate a tile.
 	dtMeshTile* tile = 0;
@@ -974,9 +1108,8 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 		return DT_FAILURE | DT_OUT_OF_MEMORY;
 	
 	// Insert tile into the position lut.
-	int h = computeTileHash(header->x, header->y, m_tileLutMask);
-	tile->next = m_posLookup[h];
-	m_posLookup[h] = tile;
+	tile->next = slot->tiles;
+	slot->tiles = tile;
 	
 	// Patch header pointers.
 	const int headerSize = dtAlign4(sizeof(dtMeshHeader));
@@ -986,8 +1119,9 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 	const int detailMeshesSize = dtAlign4(sizeof(dtPolyDetail)*header->detailMeshCount);
 	const int detailVertsSize = dtAlign4(sizeof(float)*3*header->detailVertCount);
 	const int detailTrisSize = dtAlign4(sizeof(unsigned char)*4*header->detailTriCount);
-	const int bvtreeSize = dtAlign4(sizeof(dtBVNode)*header->bvNodeCount);
+	const int bvtreeSize = dtAlign4(dtGetBVNodeSize(header->bvTreeWidth)*header->bvNodeCount);
 	const int offMeshLinksSize = dtAlign4(sizeof(dtOffMeshConnection)*header->offMeshConCount);
+	const int borderEdgesSize = dtAlign4(sizeof(dtBorderEdge)*header->borderEdgeCount);
 	
 	unsigned char* d = data + headerSize;
 	tile->verts = dtGetThenAdvanceBufferPointer<float>(d, vertsSize);
@@ -996,12 +1130,14 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 	tile->detailMeshes = dtGetThenAdvanceBufferPointer<dtPolyDetail>(d, detailMeshesSize);
 	tile->detailVerts = dtGetThenAdvanceBufferPointer<float>(d, detailVertsSize);
 	tile->detailTris = dtGetThenAdvanceBufferPointer<unsigned char>(d, detailTrisSize);
-	tile->bvTree = dtGetThenAdvanceBufferPointer<dtBVNode>(d, bvtreeSize);
+	unsigned char* bvtree = dtGetThenAdvanceBufferPointer<unsigned char>(d, bvtreeSize);
 	tile->offMeshCons = dtGetThenAdvanceBufferPointer<dtOffMeshConnection>(d, offMeshLinksSize);
+	tile->borderEdges = dtGetThenAdvanceBufferPointer<dtBorderEdge>(d, borderEdgesSize);
 
-	// If there are no items in the bvtree, reset the tree pointer.
-	if (!bvtreeSize)
-		tile->bvTree = 0;
+	// Only the pointer matching the tree width is set, and none if there are no items in the bvtree.
+	tile->bvTree = (bvtreeSize && header->bvTreeWidth == 2) ? (dtBVNode*)bvtree : 0;
+	tile->bvTree4 = (bvtreeSize && header->bvTreeWidth == 4) ? (dtBVNode4*)bvtree : 0;
+	tile->bvTree8 = (bvtreeSize && header->bvTreeWidth == 8) ? (dtBVNode8*)bvtree : 0;
 
 	// Build links freelist
 	tile->linksFreeList = 0;
@@ -1021,7 +1157,22 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 	baseOffMeshLinks(tile);
 	connectExtOffMeshLinks(tile, tile, -1);
 
-	// Create connections with neighbour tiles.
+	// The tile is connected with its neighbours when the batch is committed.
+	const dtTileRef ref = getTileRef(tile);
+	m_batchFlags[tile - m_tiles] |= DT_BATCH_ADDED;
+	m_batchAdded[m_batchAddedCount++] = ref;
+	
+	if (result)
+		*result = ref;
+	
+	return DT_SUCCESS;
+}
+
+void dtNavMesh::connectBatchTile(dtMeshTile* tile)
+{
+	const dtMeshHeader* header = tile->header;
+
+	// The tiles connected earlier in the commit have already been connected with this one.
 	static const int MAX_NEIS = 32;
 	dtMeshTile* neis[MAX_NEIS];
 	int nneis;
@@ -1030,7 +1181,7 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 	nneis = getTilesAt(header->x, header->y, neis, MAX_NEIS);
 	for (int j = 0; j < nneis; ++j)
 	{
-		if (neis[j] == tile)
+		if (neis[j] == tile || (m_batchFlags[neis[j] - m_tiles] & DT_BATCH_CONNECTED))
 			continue;
 	
 		connectExtLinks(tile, neis[j], -1);
@@ -1045,34 +1196,209 @@ dtStatus dtNavMesh::addTile(unsigned char* data, int dataSize, int flags,
 		nneis = getNeighbourTilesAt(header->x, header->y, i, neis, MAX_NEIS);
 		for (int j = 0; j < nneis; ++j)
 		{
+			if (m_batchFlags[neis[j] - m_tiles] & DT_BATCH_CONNECTED)
+				continue;
+
 			connectExtLinks(tile, neis[j], i);
 			connectExtLinks(neis[j], tile, dtOppositeTile(i));
 			connectExtOffMeshLinks(tile, neis[j], i);
 			connectExtOffMeshLinks(neis[j], tile, dtOppositeTile(i));
 		}
 	}
-	
-	if (result)
-		*result = getTileRef(tile);
-	
+}
+
+/// @par
+///
+/// Adding a tile outside of a batch connects it to its neighbours right away, and removing
+/// one disconnects them. In a batch, the tiles are added to and removed from the tile lookup
+/// right away, but the links between the tiles are only updated by #commitTileBatch: each
+/// pair of added neighbour tiles is connected once, and the links of each remaining
+/// neighbour to all the removed tiles are removed in a single pass. The listeners are
+/// notified once per batch.
+///
+/// The links between the tiles are incomplete until the batch is committed, so queries should
+/// not run while a batch is open.
+///
+/// @see #commitTileBatch, #addListener
+dtStatus dtNavMesh::beginTileBatch()
+{
+	if (!m_batchFlags)
+		return DT_FAILURE;
+	if (m_batchOpen)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	m_batchOpen = true;
 	return DT_SUCCESS;
 }
 
-const dtMeshTile* dtNavMesh::getTileAt(const int x, const int y, const int layer) const
+/// @par
+///
+/// A tile that is added and removed in the same batch is not reported to the listeners.
+/// A tile that is removed and added back with the same reference is reported as both
+/// removed and added. The listeners must not add or remove tiles.
+dtStatus dtNavMesh::commitTileBatch()
+{
+	if (!m_batchOpen)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	// Remove the links to the removed tiles, one pass over the links of each neighbour.
+	static const int MAX_NEIS = 32;
+	dtMeshTile* neis[MAX_NEIS];
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int i = 0; i < m_batchRemovedCount; ++i)
+		{
+			const int x = m_batchRemovedLocs[i*2+0];
+			const int y = m_batchRemovedLocs[i*2+1];
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					const int nneis = getTilesAt(x + dx, y + dy, neis, MAX_NEIS);
+					for (int j = 0; j < nneis; ++j)
+					{
+						unsigned char& flags = m_batchFlags[neis[j] - m_tiles];
+						if (pass == 1)
+						{
+							flags &= ~DT_BATCH_VISITED;
+							continue;
+						}
+						// The added tiles are not connected yet.
+						if (flags & (DT_BATCH_ADDED | DT_BATCH_VISITED))
+							continue;
+						flags |= DT_BATCH_VISITED;
+						unconnectRemovedLinks(neis[j]);
+					}
+				}
+			}
+		}
+	}
+
+	// Connect the added tiles.
+	for (int i = 0; i < m_batchAddedCount; ++i)
+	{
+		const unsigned int it = decodePolyIdTile((dtPolyRef)m_batchAdded[i]);
+		connectBatchTile(&m_tiles[it]);
+		m_batchFlags[it] |= DT_BATCH_CONNECTED;
+	}
+
+	for (int i = 0; i < m_batchAddedCount; ++i)
+		m_batchFlags[decodePolyIdTile((dtPolyRef)m_batchAdded[i])] &= ~(DT_BATCH_ADDED | DT_BATCH_CONNECTED);
+	for (int i = 0; i < m_batchRemovedCount; ++i)
+		m_batchFlags[decodePolyIdTile((dtPolyRef)m_batchRemoved[i])] &= ~DT_BATCH_REMOVED;
+	m_batchOpen = false;
+
+	if (m_batchAddedCount || m_batchRemovedCount)
+	{
+		for (int i = 0; i < m_listenerCount; ++i)
+			m_listeners[i]->onTilesChanged(this, m_batchRemoved, m_batchRemovedCount, m_batchAdded, m_batchAddedCount);
+	}
+	m_batchAddedCount = 0;
+	m_batchRemovedCount = 0;
+
+	return DT_SUCCESS;
+}
+
+dtStatus dtNavMesh::addListener(dtNavMeshListener* listener)
 {
-	// Find tile based on hash.
-	int h = computeTileHash(x,y,m_tileLutMask);
-	dtMeshTile* tile = m_posLookup[h];
-	while (tile)
+	if (!listener)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	for (int i = 0; i < m_listenerCount; ++i)
 	{
-		if (tile->header &&
-			tile->header->x == x &&
-			tile->header->y == y &&
-			tile->header->layer == layer)
+		if (m_listeners[i] == listener)
+			return DT_SUCCESS;
+	}
+	if (m_listenerCount >= DT_MAX_NAVMESH_LISTENERS)
+		return DT_FAILURE | DT_BUFFER_TOO_SMALL;
+	m_listeners[m_listenerCount++] = listener;
+	return DT_SUCCESS;
+}
+
+void dtNavMesh::removeListener(dtNavMeshListener* listener)
+{
+	for (int i = 0; i < m_listenerCount; ++i)
+	{
+		if (m_listeners[i] == listener)
 		{
-			return tile;
+			for (int j = i+1; j < m_listenerCount; ++j)
+				m_listeners[j-1] = m_listeners[j];
+			m_listenerCount--;
+			return;
+		}
+	}
+}
+
+dtNavMesh::dtTileLookupSlot* dtNavMesh::findTileSlot(const int x, const int y) const
+{
+	if (m_lookup.type == DT_TILE_LOOKUP_GRID)
+	{
+		const unsigned int gx = (unsigned int)(x - m_lookup.minX);
+		const unsigned int gy = (unsigned int)(y - m_lookup.minY);
+		if (gx >= (unsigned int)m_lookup.width || gy >= (unsigned int)m_lookup.height)
+			return 0;
+		return &m_posLookup[gx + gy*(unsigned int)m_lookup.width];
+	}
+
+	// Linear probing. The table always has empty slots.
+	int h = computeTileHash(x, y, m_tileLutMask);
+	while (m_posLookup[h].tiles)
+	{
+		if (m_posLookup[h].x == x && m_posLookup[h].y == y)
+			return &m_posLookup[h];
+		h = (h+1) & m_tileLutMask;
+	}
+	return 0;
+}
+
+dtNavMesh::dtTileLookupSlot* dtNavMesh::insertTileSlot(const int x, const int y)
+{
+	if (m_lookup.type == DT_TILE_LOOKUP_GRID)
+		return findTileSlot(x, y);
+
+	int h = computeTileHash(x, y, m_tileLutMask);
+	while (m_posLookup[h].tiles)
+	{
+		if (m_posLookup[h].x == x && m_posLookup[h].y == y)
+			return &m_posLookup[h];
+		h = (h+1) & m_tileLutMask;
+	}
+	m_posLookup[h].x = x;
+	m_posLookup[h].y = y;
+	return &m_posLookup[h];
+}
+
+void dtNavMesh::removeTileSlot(dtTileLookupSlot* slot)
+{
+	slot->tiles = 0;
+	if (m_lookup.type == DT_TILE_LOOKUP_GRID)
+		return;
+
+	// Move the following slots of the probe sequence back, so that no lookup stops early
+	// at the emptied slot.
+	int i = (int)(slot - m_posLookup);
+	int j = i;
+	for (;;)
+	{
+		j = (j+1) & m_tileLutMask;
+		if (!m_posLookup[j].tiles)
+			break;
+		// The entry can move to i if i is between its home slot and j.
+		const int h = computeTileHash(m_posLookup[j].x, m_posLookup[j].y, m_tileLutMask);
+		if (((j - h) & m_tileLutMask) >= ((j - i) & m_tileLutMask))
+		{
+			m_posLookup[i] = m_posLookup[j];
+			m_posLookup[j].tiles = 0;
+			i = j;
 		}
-		tile = tile->next;
+	}
+}
+
+const dtMeshTile* dtNavMesh::getTileAt(const int x, const int y, const int layer) const
+{
+	const dtTileLookupSlot* slot = findTileSlot(x, y);
+	for (const dtMeshTile* tile = slot ? slot->tiles : 0; tile; tile = tile->next)
+	{
+		if (tile->header->layer == layer)
+			return tile;
 	}
 	return 0;
 }
@@ -1098,22 +1424,9 @@ int dtNavMesh::getNeighbourTilesAt(const int x, const int y, const int side, dtM
 int dtNavMesh::getTilesAt(const int x, const int y, dtMeshTile** tiles, const int maxTiles) const
 {
 	int n = 0;
-	
-	// Find tile based on hash.
-	int h = computeTileHash(x,y,m_tileLutMask);
-	dtMeshTile* tile = m_posLookup[h];
-	while (tile)
-	{
-		if (tile->header &&
-			tile->header->x == x &&
-			tile->header->y == y)
-		{
-			if (n < maxTiles)
-				tiles[n++] = tile;
-		}
-		tile = tile->next;
-	}
-	
+	const dtTileLookupSlot* slot = findTileSlot(x, y);
+	for (dtMeshTile* tile = slot ? slot->tiles : 0; tile && n < maxTiles; tile = tile->next)
+		tiles[n++] = tile;
 	return n;
 }
 
@@ -1124,43 +1437,16 @@ int dtNavMesh::getTilesAt(const int x, const int y, dtMeshTile** tiles, const in
 int dtNavMesh::getTilesAt(const int x, const int y, dtMeshTile const** tiles, const int maxTiles) const
 {
 	int n = 0;
-	
-	// Find tile based on hash.
-	int h = computeTileHash(x,y,m_tileLutMask);
-	dtMeshTile* tile = m_posLookup[h];
-	while (tile)
-	{
-		if (tile->header &&
-			tile->header->x == x &&
-			tile->header->y == y)
-		{
-			if (n < maxTiles)
-				tiles[n++] = tile;
-		}
-		tile = tile->next;
-	}
-	
+	const dtTileLookupSlot* slot = findTileSlot(x, y);
+	for (const dtMeshTile* tile = slot ? slot->tiles : 0; tile && n < maxTiles; tile = tile->next)
+		tiles[n++] = tile;
 	return n;
 }
 
 
 dtTileRef dtNavMesh::getTileRefAt(const int x, const int y, const int layer) const
 {
-	// Find tile based on hash.
-	int h = computeTileHash(x,y,m_tileLutMask);
-	dtMeshTile* tile = m_posLookup[h];
-	while (tile)
-	{
-		if (tile->header &&
-			tile->header->x == x &&
-			tile->header->y == y &&
-			tile->header->layer == layer)
-		{
-			return getTileRef(tile);
-		}
-		tile = tile->next;
-	}
-	return 0;
+	return getTileRef(getTileAt(x, y, layer));
 }
 
 const dtMeshTile* dtNavMesh::getTileByRef(dtTileRef ref) const
@@ -1242,6 +1528,19 @@ bool dtNavMesh::isValidPolyRef(dtPolyRef ref) const
 ///
 /// @see #addTile
 dtStatus dtNavMesh::removeTile(dtTileRef ref, unsigned char** data, int* dataSize)
+{
+	if (m_batchOpen)
+		return removeBatchTile(ref, data, dataSize);
+
+	dtStatus status = beginTileBatch();
+	if (dtStatusFailed(status))
+		return status;
+	status = removeBatchTile(ref, data, dataSize);
+	commitTileBatch();
+	return status;
+}
+
+dtStatus dtNavMesh::removeBatchTile(dtTileRef ref, unsigned char** data, int* dataSize)
 {
 	if (!ref)
 		return DT_FAILURE | DT_INVALID_PARAM;
@@ -1250,46 +1549,63 @@ dtStatus dtNavMesh::removeTile(dtTileRef ref, unsigned char** data, int* dataSiz
 	if ((int)tileIndex >= m_maxTiles)
 		return DT_FAILURE | DT_INVALID_PARAM;
 	dtMeshTile* tile = &m_tiles[tileIndex];
-	if (tile->salt != tileSalt)
+	if (tile->salt != tileSalt || !tile->header)
 		return DT_FAILURE | DT_INVALID_PARAM;
-	
-	// Remove tile from hash lookup.
-	int h = computeTileHash(tile->header->x,tile->header->y,m_tileLutMask);
-	dtMeshTile* prev = 0;
-	dtMeshTile* cur = m_posLookup[h];
-	while (cur)
+
+	if (m_batchFlags[tileIndex] & DT_BATCH_ADDED)
 	{
-		if (cur == tile)
-		{
-			if (prev)
-				prev->next = cur->next;
-			else
-				m_posLookup[h] = cur->next;
-			break;
-		}
-		prev = cur;
-		cur = cur->next;
+		// Added in this batch, so no other tile is connected to it yet.
+		int i = 0;
+		while (m_batchAdded[i] != ref)
+			i++;
+		for (++i; i < m_batchAddedCount; ++i)
+			m_batchAdded[i-1] = m_batchAdded[i];
+		m_batchAddedCount--;
+		m_batchFlags[tileIndex] &= ~DT_BATCH_ADDED;
 	}
-	
-	// Remove connections to neighbour tiles.
-	static const int MAX_NEIS = 32;
-	dtMeshTile* neis[MAX_NEIS];
-	int nneis;
-	
-	// Disconnect from other layers in current tile.
-	nneis = getTilesAt(tile->header->x, tile->header->y, neis, MAX_NEIS);
-	for (int j = 0; j < nneis; ++j)
+	else
 	{
-		if (neis[j] == tile) continue;
-		unconnectLinks(neis[j], tile);
+		// The links of the neighbours to the tile are removed when the batch is committed.
+		if (m_batchRemovedCount == m_batchRemovedCapacity)
+		{
+			const int capacity = dtMax(m_batchRemovedCapacity*2, 16);
+			dtTileRef* removed = (dtTileRef*)dtAlloc(sizeof(dtTileRef)*capacity, DT_ALLOC_PERM);
+			int* locs = (int*)dtAlloc(sizeof(int)*2*capacity, DT_ALLOC_PERM);
+			if (!removed || !locs)
+			{
+				dtFree(removed);
+				dtFree(locs);
+				return DT_FAILURE | DT_OUT_OF_MEMORY;
+			}
+			if (m_batchRemovedCount)
+			{
+				memcpy(removed, m_batchRemoved, sizeof(dtTileRef)*m_batchRemovedCount);
+				memcpy(locs, m_batchRemovedLocs, sizeof(int)*2*m_batchRemovedCount);
+			}
+			dtFree(m_batchRemoved);
+			dtFree(m_batchRemovedLocs);
+			m_batchRemoved = removed;
+			m_batchRemovedLocs = locs;
+			m_batchRemovedCapacity = capacity;
+		}
+		m_batchRemoved[m_batchRemovedCount] = ref;
+		m_batchRemovedLocs[m_batchRemovedCount*2+0] = tile->header->x;
+		m_batchRemovedLocs[m_batchRemovedCount*2+1] = tile->header->y;
+		m_batchRemovedCount++;
+		m_batchFlags[tileIndex] |= DT_BATCH_REMOVED;
 	}
 	
-	// Disconnect from neighbour tiles.
-	for (int i = 0; i < 8; ++i)
+	// Remove tile from position lookup.
+	dtTileLookupSlot* slot = findTileSlot(tile->header->x, tile->header->y);
+	if (slot)
 	{
-		nneis = getNeighbourTilesAt(tile->header->x, tile->header->y, i, neis, MAX_NEIS);
-		for (int j = 0; j < nneis; ++j)
-			unconnectLinks(neis[j], tile);
+		dtMeshTile** cur = &slot->tiles;
+		while (*cur && *cur != tile)
+			cur = &(*cur)->next;
+		if (*cur)
+			*cur = tile->next;
+		if (!slot->tiles)
+			removeTileSlot(slot);
 	}
 		
 	// Reset tile.
@@ -1318,14 +1634,13 @@ dtStatus dtNavMesh::removeTile(dtTileRef ref, unsigned char** data, int* dataSiz
 	tile->detailVerts = 0;
 	tile->detailTris = 0;
 	tile->bvTree = 0;
+	tile->bvTree4 = 0;
+	tile->bvTree8 = 0;
 	tile->offMeshCons = 0;
+	tile->borderEdges = 0;
 
 	// Update salt, salt should never be zero.
-#ifdef DT_POLYREF64
-	tile->salt = (tile->salt+1) & ((1<<DT_SALT_BITS)-1);
-#else
-	tile->salt = (tile->salt+1) & ((1<<m_saltBits)-1);
-#endif
+	tile->salt = (tile->salt+1) & ((1u<<m_saltBits)-1);
 	if (tile->salt == 0)
 		tile->salt++;
 
@@ -37,37 +37,39 @@ struct BVItem
 	int i;
 };
 
-static int compareItemX(const void* va, const void* vb)
+// Reorders items[0..n) so that the item at k has the k-th smallest bmin along the axis, the items before it
+// are not greater and the items after it are not smaller. (Quickselect.)
+static void selectItem(BVItem* items, int n, const int k, const int axis)
 {
-	const BVItem* a = (const BVItem*)va;
-	const BVItem* b = (const BVItem*)vb;
-	if (a->bmin[0] < b->bmin[0])
-		return -1;
-	if (a->bmin[0] > b->bmin[0])
-		return 1;
-	return 0;
-}
-
-static int compareItemY(const void* va, const void* vb)
-{
-	const BVItem* a = (const BVItem*)va;
-	const BVItem* b = (const BVItem*)vb;
-	if (a->bmin[1] < b->bmin[1])
-		return -1;
-	if (a->bmin[1] > b->bmin[1])
-		return 1;
-	return 0;
-}
+	int lo = 0;
+	int hi = n - 1;
+	while (lo < hi)
+	{
+		// Median of three pivot.
+		const int mid = lo + (hi - lo) / 2;
+		unsigned short a = items[lo].bmin[axis], b = items[mid].bmin[axis], c = items[hi].bmin[axis];
+		const unsigned short pivot = (a < b) ? ((b < c) ? b : dtMax(a, c)) : ((a < c) ? a : dtMax(b, c));
 
-static int compareItemZ(const void* va, const void* vb)
-{
-	const BVItem* a = (const BVItem*)va;
-	const BVItem* b = (const BVItem*)vb;
-	if (a->bmin[2] < b->bmin[2])
-		return -1;
-	if (a->bmin[2] > b->bmin[2])
-		return 1;
-	return 0;
+		int i = lo;
+		int j = hi;
+		while (i <= j)
+		{
+			while (items[i].bmin[axis] < pivot) i++;
+			while (items[j].bmin[axis] > pivot) j--;
+			if (i <= j)
+			{
+				dtSwap(items[i], items[j]);
+				i++;
+				j--;
+			}
+		}
+		if (k <= j)
+			hi = j;
+		else if (k >= i)
+			lo = i;
+		else
+			break;
+	}
 }
 
 static void calcExtends(BVItem* items, const int /*nitems*/, const int imin, const int imax,
@@ -110,7 +112,121 @@ inline int longestAxis(unsigned short x, unsigned short y, unsigned short z)
 	return axis;
 }
 
-static void subdivide(BVItem* items, int nitems, int imin, int imax, int& curNode, dtBVNode* nodes)
+// Partitions the items with the binned surface area heuristic. Returns the number of items moved to the
+// left side, or zero if no split is better than the others.
+static int partitionSAH(BVItem* items, const int inum)
+{
+	static const int NBINS = 16;
+
+	// Bounds of the item centroids, in twice the quantized units.
+	int cmin[3], cmax[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		cmin[k] = items[0].bmin[k] + items[0].bmax[k];
+		cmax[k] = cmin[k];
+	}
+	for (int i = 1; i < inum; ++i)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			const int c = items[i].bmin[k] + items[i].bmax[k];
+			cmin[k] = dtMin(cmin[k], c);
+			cmax[k] = dtMax(cmax[k], c);
+		}
+	}
+
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const int extent = cmax[axis] - cmin[axis];
+		if (extent == 0)
+			continue;
+
+		int counts[NBINS];
+		unsigned short bmins[NBINS][3], bmaxs[NBINS][3];
+		for (int b = 0; b < NBINS; ++b)
+		{
+			counts[b] = 0;
+			bmins[b][0] = bmins[b][1] = bmins[b][2] = 0xffff;
+			bmaxs[b][0] = bmaxs[b][1] = bmaxs[b][2] = 0;
+		}
+		for (int i = 0; i < inum; ++i)
+		{
+			const BVItem& it = items[i];
+			const int b = (it.bmin[axis] + it.bmax[axis] - cmin[axis]) * NBINS / (extent + 1);
+			counts[b]++;
+			for (int k = 0; k < 3; ++k)
+			{
+				bmins[b][k] = dtMin(bmins[b][k], it.bmin[k]);
+				bmaxs[b][k] = dtMax(bmaxs[b][k], it.bmax[k]);
+			}
+		}
+
+		// Cost of the right side of each split, swept from the last bin.
+		float rightCost[NBINS];
+		unsigned short rmin[3] = { 0xffff, 0xffff, 0xffff }, rmax[3] = { 0, 0, 0 };
+		int rcount = 0;
+		for (int b = NBINS-1; b > 0; --b)
+		{
+			rcount += counts[b];
+			for (int k = 0; k < 3; ++k)
+			{
+				rmin[k] = dtMin(rmin[k], bmins[b][k]);
+				rmax[k] = dtMax(rmax[k], bmaxs[b][k]);
+			}
+			const float dx = rcount ? (float)(rmax[0] - rmin[0]) : 0.0f;
+			const float dy = rcount ? (float)(rmax[1] - rmin[1]) : 0.0f;
+			const float dz = rcount ? (float)(rmax[2] - rmin[2]) : 0.0f;
+			rightCost[b-1] = (dx*dy + dy*dz + dz*dx) * rcount;
+		}
+
+		// Sweep the left side and pick the cheapest split.
+		unsigned short lmin[3] = { 0xffff, 0xffff, 0xffff }, lmax[3] = { 0, 0, 0 };
+		int lcount = 0;
+		for (int b = 0; b < NBINS-1; ++b)
+		{
+			lcount += counts[b];
+			for (int k = 0; k < 3; ++k)
+			{
+				lmin[k] = dtMin(lmin[k], bmins[b][k]);
+				lmax[k] = dtMax(lmax[k], bmaxs[b][k]);
+			}
+			if (lcount == 0 || lcount == inum)
+				continue;
+			const float dx = (float)(lmax[0] - lmin[0]);
+			const float dy = (float)(lmax[1] - lmin[1]);
+			const float dz = (float)(lmax[2] - lmin[2]);
+			const float cost = (dx*dy + dy*dz + dz*dx) * lcount + rightCost[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+			}
+		}
+	}
+
+	if (bestAxis == -1)
+		return 0;
+
+	// Move the items of the bins up to the best split to the left.
+	const int extent = cmax[bestAxis] - cmin[bestAxis];
+	int isplit = 0;
+	for (int i = 0; i < inum; ++i)
+	{
+		const BVItem& it = items[i];
+		const int b = (it.bmin[bestAxis] + it.bmax[bestAxis] - cmin[bestAxis]) * NBINS / (extent + 1);
+		if (b <= bestBin)
+			dtSwap(items[i], items[isplit++]);
+	}
+	return isplit;
+}
+
+static void subdivide(BVItem* items, int nitems, int imin, int imax, int& curNode, dtBVNode* nodes,
+					  const int split)
 {
 	int inum = imax - imin;
 	int icur = curNode;
@@ -135,32 +251,25 @@ static void subdivide(BVItem* items, int nitems, int imin, int imax, int& curNod
 		// Split
 		calcExtends(items, nitems, imin, imax, node.bmin, node.bmax);
 		
-		int	axis = longestAxis(node.bmax[0] - node.bmin[0],
-							   node.bmax[1] - node.bmin[1],
-							   node.bmax[2] - node.bmin[2]);
+		int isplit = 0;
+		if (split == DT_BVTREE_SPLIT_SAH)
+			isplit = imin + partitionSAH(items+imin, inum);
 		
-		if (axis == 0)
-		{
-			// Sort along x-axis
-			qsort(items+imin, inum, sizeof(BVItem), compareItemX);
-		}
-		else if (axis == 1)
-		{
-			// Sort along y-axis
-			qsort(items+imin, inum, sizeof(BVItem), compareItemY);
-		}
-		else
+		if (isplit <= imin)
 		{
-			// Sort along z-axis
-			qsort(items+imin, inum, sizeof(BVItem), compareItemZ);
+			// Split at the median along the longest axis.
+			int	axis = longestAxis(node.bmax[0] - node.bmin[0],
+								   node.bmax[1] - node.bmin[1],
+								   node.bmax[2] - node.bmin[2]);
+			
+			isplit = imin+inum/2;
+			selectItem(items+imin, inum, isplit-imin, axis);
 		}
 		
-		int isplit = imin+inum/2;
-		
 		// Left
-		subdivide(items, nitems, imin, isplit, curNode, nodes);
+		subdivide(items, nitems, imin, isplit, curNode, nodes, split);
 		// Right
-		subdivide(items, nitems, isplit, imax, curNode, nodes);
+		subdivide(items, nitems, isplit, imax, curNode, nodes, split);
 		
 		int iescape = curNode - icur;
 		// Negative index means escape.
@@ -168,7 +277,7 @@ static void subdivide(BVItem* items, int nitems, int imin, int imax, int& curNod
 	}
 }
 
-static int createBVTree(dtNavMeshCreateParams* params, dtBVNode* nodes, int /*nnodes*/)
+static int createBVTree(dtNavMeshCreateParams* params, dtBVNode* nodes, int /*nnodes*/, const int split)
 {
 	// Build tree
 	float quantFactor = 1 / params->cs;
@@ -233,13 +342,137 @@ static int createBVTree(dtNavMeshCreateParams* params, dtBVNode* nodes, int /*nn
 	}
 	
 	int curNode = 0;
-	subdivide(items, params->polyCount, 0, params->polyCount, curNode, nodes);
+	subdivide(items, params->polyCount, 0, params->polyCount, curNode, nodes, split);
 	
 	dtFree(items);
 	
 	return curNode;
 }
 
+// Number of nodes in the binary subtree starting at the node.
+inline int bvSubtreeSize(const dtBVNode* nodes, const int i)
+{
+	return nodes[i].i >= 0 ? 1 : -nodes[i].i;
+}
+
+// Creates the wide node of a binary subtree, and the wide nodes below it.
+// The children with the most polygons are opened first, which keeps the tree balanced.
+template <int Width, class Node>
+static bool collapseBVNode(const dtBVNode* nodes, const int root, Node* wideNodes, int& count, const int depth)
+{
+	if (depth > DT_BVTREE_MAX_WIDE_DEPTH)
+		return false;
+
+	Node& node = wideNodes[count++];
+
+	int children[Width];
+	int nchildren = 0;
+	if (nodes[root].i >= 0)
+	{
+		children[nchildren++] = root;
+	}
+	else
+	{
+		children[nchildren++] = root+1;
+		children[nchildren++] = root+1 + bvSubtreeSize(nodes, root+1);
+	}
+	while (nchildren < Width)
+	{
+		int best = -1;
+		int bestSize = 1;
+		for (int j = 0; j < nchildren; ++j)
+		{
+			const int size = bvSubtreeSize(nodes, children[j]);
+			if (size > bestSize)
+			{
+				best = j;
+				bestSize = size;
+			}
+		}
+		if (best == -1)
+			break;
+		const int c = children[best];
+		children[best] = c+1;
+		children[nchildren++] = c+1 + bvSubtreeSize(nodes, c+1);
+	}
+
+	for (int j = 0; j < Width; ++j)
+	{
+		if (j >= nchildren)
+		{
+			// Unused slot.
+			for (int k = 0; k < 3; ++k)
+			{
+				node.bmin[k][j] = 0xffff;
+				node.bmax[k][j] = 0;
+			}
+			node.child[j] = 0;
+			continue;
+		}
+
+		const dtBVNode& child = nodes[children[j]];
+		for (int k = 0; k < 3; ++k)
+		{
+			node.bmin[k][j] = child.bmin[k];
+			node.bmax[k][j] = child.bmax[k];
+		}
+		if (child.i >= 0)
+		{
+			node.child[j] = ~child.i;
+		}
+		else
+		{
+			const int ichild = count;
+			if (!collapseBVNode<Width>(nodes, children[j], wideNodes, count, depth+1))
+				return false;
+			node.child[j] = ichild;
+		}
+	}
+	return true;
+}
+
+// Builds a wide bounding volume tree from a binary one. Returns the number of nodes, or zero on failure.
+template <int Width, class Node>
+static int createWideBVTree(dtNavMeshCreateParams* params, dtBVNode* nodes, Node* wideNodes)
+{
+	int count = 0;
+	createBVTree(params, nodes, 2*params->polyCount, params->bvTreeSplit);
+	if (collapseBVNode<Width>(nodes, 0, wideNodes, count, 1))
+		return count;
+
+	// The tree is too deep to traverse, the median split keeps it balanced.
+	count = 0;
+	createBVTree(params, nodes, 2*params->polyCount, DT_BVTREE_SPLIT_MEDIAN);
+	if (collapseBVNode<Width>(nodes, 0, wideNodes, count, 1))
+		return count;
+	return 0;
+}
+
+// Builds a wide bounding volume tree in temporary memory, before the size of the tile data is known.
+static int createWideBVTree(dtNavMeshCreateParams* params, unsigned char** outNodes)
+{
+	*outNodes = 0;
+	const int maxNodes = dtMax(params->polyCount-1, 1);
+	dtBVNode* nodes = (dtBVNode*)dtAlloc(sizeof(dtBVNode)*params->polyCount*2, DT_ALLOC_TEMP);
+	unsigned char* wideNodes = (unsigned char*)dtAlloc(dtGetBVNodeSize(params->bvTreeWidth)*maxNodes, DT_ALLOC_TEMP);
+	int count = 0;
+	if (nodes && wideNodes)
+	{
+		if (params->bvTreeWidth == 4)
+			count = createWideBVTree<4>(params, nodes, (dtBVNode4*)wideNodes);
+		else
+			count = createWideBVTree<8>(params, nodes, (dtBVNode8*)wideNodes);
+	}
+	dtFree(nodes);
+	if (!count)
+	{
+		dtFree(wideNodes);
+		return 0;
+	}
+	*outNodes = wideNodes;
+	return count;
+}
+
 static unsigned char classifyOffMeshPoint(const float* pt, const float* bmin, const float* bmax)
 {
 	static const unsigned char XP = 1<<0;
@@ -268,6 +501,33 @@ static unsigned char classifyOffMeshPoint(const float* pt, const float* bmin, co
 	return 0xff;	
 }
 
+// Stores the end points of the edge in the plane of the border, ordered along the border.
+static void calcBorderEdge(const float* va, const float* vb, dtBorderEdge* edge)
+{
+	// Sides 0 and 4 are along z, sides 2 and 6 along x.
+	const int u = (edge->side == 0 || edge->side == 4) ? 2 : 0;
+	if (va[u] > vb[u])
+		dtSwap(va, vb);
+	edge->bmin[0] = va[u];
+	edge->bmin[1] = va[1];
+	edge->bmax[0] = vb[u];
+	edge->bmax[1] = vb[1];
+	edge->pos = u == 2 ? va[0] : va[2];
+}
+
+static int compareBorderEdges(const void* va, const void* vb)
+{
+	const dtBorderEdge* a = (const dtBorderEdge*)va;
+	const dtBorderEdge* b = (const dtBorderEdge*)vb;
+	if (a->side != b->side)
+		return a->side < b->side ? -1 : 1;
+	if (a->bmin[0] != b->bmin[0])
+		return a->bmin[0] < b->bmin[0] ? -1 : 1;
+	if (a->poly != b->poly)
+		return a->poly < b->poly ? -1 : 1;
+	return a->edge < b->edge ? -1 : (a->edge > b->edge ? 1 : 0);
+}
+
 // TODO: Better error handling.
 
 /// @par
@@ -288,6 +548,10 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	if (!params->polyCount || !params->polys)
 		return false;
 
+	const int bvTreeWidth = params->bvTreeWidth ? params->bvTreeWidth : 2;
+	if (params->buildBvTree && !dtGetBVNodeSize(bvTreeWidth))
+		return false;
+
 	const int nvp = params->nvp;
 	
 	// Classify off-mesh connection points. We store only the connections
@@ -365,6 +629,7 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	// Find portal edges which are at tile borders.
 	int edgeCount = 0;
 	int portalCount = 0;
+	int borderEdgeCount = 0;
 	for (int i = 0; i < params->polyCount; ++i)
 	{
 		const unsigned short* p = &params->polys[i*2*nvp];
@@ -378,6 +643,8 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 				unsigned short dir = p[nvp+j] & 0xf;
 				if (dir != 0xf)
 					portalCount++;
+				if (dir <= 3)
+					borderEdgeCount++;
 			}
 		}
 	}
@@ -423,6 +690,20 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 		}
 	}
 	
+	// Wide bounding volume trees are built first, their node count is not known in advance.
+	unsigned char* wideBvtree = 0;
+	// A binary tree with a leaf per polygon has 2*n-1 nodes.
+	int bvNodeCount = params->buildBvTree ? params->polyCount*2-1 : 0;
+	if (params->buildBvTree && bvTreeWidth != 2)
+	{
+		bvNodeCount = createWideBVTree(params, &wideBvtree);
+		if (!bvNodeCount)
+		{
+			dtFree(offMeshConClass);
+			return false;
+		}
+	}
+
 	// Calculate data size
 	const int headerSize = dtAlign4(sizeof(dtMeshHeader));
 	const int vertsSize = dtAlign4(sizeof(float)*3*totVertCount);
@@ -431,16 +712,18 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	const int detailMeshesSize = dtAlign4(sizeof(dtPolyDetail)*params->polyCount);
 	const int detailVertsSize = dtAlign4(sizeof(float)*3*uniqueDetailVertCount);
 	const int detailTrisSize = dtAlign4(sizeof(unsigned char)*4*detailTriCount);
-	const int bvTreeSize = params->buildBvTree ? dtAlign4(sizeof(dtBVNode)*params->polyCount*2) : 0;
+	const int bvTreeSize = dtAlign4(dtGetBVNodeSize(bvTreeWidth)*bvNodeCount);
 	const int offMeshConsSize = dtAlign4(sizeof(dtOffMeshConnection)*storedOffMeshConCount);
+	const int borderEdgesSize = dtAlign4(sizeof(dtBorderEdge)*borderEdgeCount);
 	
 	const int dataSize = headerSize + vertsSize + polysSize + linksSize +
 						 detailMeshesSize + detailVertsSize + detailTrisSize +
-						 bvTreeSize + offMeshConsSize;
+						 bvTreeSize + offMeshConsSize + borderEdgesSize;
 						 
 	unsigned char* data = (unsigned char*)dtAlloc(sizeof(unsigned char)*dataSize, DT_ALLOC_PERM);
 	if (!data)
 	{
+		dtFree(wideBvtree);
 		dtFree(offMeshConClass);
 		return false;
 	}
@@ -455,8 +738,9 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	dtPolyDetail* navDMeshes = dtGetThenAdvanceBufferPointer<dtPolyDetail>(d, detailMeshesSize);
 	float* navDVerts = dtGetThenAdvanceBufferPointer<float>(d, detailVertsSize);
 	unsigned char* navDTris = dtGetThenAdvanceBufferPointer<unsigned char>(d, detailTrisSize);
-	dtBVNode* navBvtree = dtGetThenAdvanceBufferPointer<dtBVNode>(d, bvTreeSize);
+	unsigned char* navBvtree = dtGetThenAdvanceBufferPointer<unsigned char>(d, bvTreeSize);
 	dtOffMeshConnection* offMeshCons = dtGetThenAdvanceBufferPointer<dtOffMeshConnection>(d, offMeshConsSize);
+	dtBorderEdge* borderEdges = dtGetThenAdvanceBufferPointer<dtBorderEdge>(d, borderEdgesSize);
 	
 	
 	// Store header
@@ -480,7 +764,9 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	header->walkableRadius = params->walkableRadius;
 	header->walkableClimb = params->walkableClimb;
 	header->offMeshConCount = storedOffMeshConCount;
-	header->bvNodeCount = params->buildBvTree ? params->polyCount*2 : 0;
+	header->bvNodeCount = bvNodeCount;
+	header->bvTreeWidth = bvTreeWidth;
+	header->borderEdgeCount = borderEdgeCount;
 	
 	const int offMeshVertsBase = params->vertCount;
 	const int offMeshPolyBase = params->polyCount;
@@ -622,9 +908,14 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	}
 
 	// Store and create BVtree.
-	if (params->buildBvTree)
+	if (wideBvtree)
 	{
-		createBVTree(params, navBvtree, 2*params->polyCount);
+		memcpy(navBvtree, wideBvtree, dtGetBVNodeSize(bvTreeWidth)*bvNodeCount);
+		dtFree(wideBvtree);
+	}
+	else if (params->buildBvTree)
+	{
+		createBVTree(params, (dtBVNode*)navBvtree, 2*params->polyCount, params->bvTreeSplit);
 	}
 	
 	// Store Off-Mesh connections.
@@ -650,6 +941,28 @@ bool dtCreateNavMeshData(dtNavMeshCreateParams* params, unsigned char** outData,
 	}
 		
 	dtFree(offMeshConClass);
+
+	// Store border edges.
+	n = 0;
+	for (int i = 0; i < params->polyCount; ++i)
+	{
+		const dtPoly* p = &navPolys[i];
+		for (int j = 0; j < (int)p->vertCount; ++j)
+		{
+			if ((p->neis[j] & DT_EXT_LINK) == 0)
+				continue;
+			const float* va = &navVerts[p->verts[j]*3];
+			const float* vb = &navVerts[p->verts[(j+1) % p->vertCount]*3];
+			dtBorderEdge* edge = &borderEdges[n++];
+			edge->side = (unsigned char)(p->neis[j] & 0xff);
+			edge->poly = (unsigned short)i;
+			edge->edge = (unsigned char)j;
+			calcBorderEdge(va, vb, edge);
+		}
+	}
+	dtAssert(n == borderEdgeCount);
+	if (borderEdgeCount > 1)
+		qsort(borderEdges, borderEdgeCount, sizeof(dtBorderEdge), compareBorderEdges);
 	
 	*outData = data;
 	*outDataSize = dataSize;
@@ -685,8 +998,10 @@ bool dtNavMeshHeaderSwapEndian(unsigned char* data, const int /*dataSize*/)
 	dtSwapEndian(&header->detailVertCount);
 	dtSwapEndian(&header->detailTriCount);
 	dtSwapEndian(&header->bvNodeCount);
+	dtSwapEndian(&header->bvTreeWidth);
 	dtSwapEndian(&header->offMeshConCount);
 	dtSwapEndian(&header->offMeshBase);
+	dtSwapEndian(&header->borderEdgeCount);
 	dtSwapEndian(&header->walkableHeight);
 	dtSwapEndian(&header->walkableRadius);
 	dtSwapEndian(&header->walkableClimb);
@@ -703,6 +1018,20 @@ bool dtNavMeshHeaderSwapEndian(unsigned char* data, const int /*dataSize*/)
 	return true;
 }
 
+template <int Width, class Node>
+static void swapWideBVNode(Node* node)
+{
+	for (int j = 0; j < Width; ++j)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			dtSwapEndian(&node->bmin[k][j]);
+			dtSwapEndian(&node->bmax[k][j]);
+		}
+		dtSwapEndian(&node->child[j]);
+	}
+}
+
 /// @par
 ///
 /// @warning This function assumes that the header is in the correct endianness already. 
@@ -726,8 +1055,9 @@ bool dtNavMeshDataSwapEndian(unsigned char* data, const int /*dataSize*/)
 	const int detailMeshesSize = dtAlign4(sizeof(dtPolyDetail)*header->detailMeshCount);
 	const int detailVertsSize = dtAlign4(sizeof(float)*3*header->detailVertCount);
 	const int detailTrisSize = dtAlign4(sizeof(unsigned char)*4*header->detailTriCount);
-	const int bvtreeSize = dtAlign4(sizeof(dtBVNode)*header->bvNodeCount);
+	const int bvtreeSize = dtAlign4(dtGetBVNodeSize(header->bvTreeWidth)*header->bvNodeCount);
 	const int offMeshLinksSize = dtAlign4(sizeof(dtOffMeshConnection)*header->offMeshConCount);
+	const int borderEdgesSize = dtAlign4(sizeof(dtBorderEdge)*header->borderEdgeCount);
 	
 	unsigned char* d = data + headerSize;
 	float* verts = dtGetThenAdvanceBufferPointer<float>(d, vertsSize);
@@ -738,8 +1068,9 @@ bool dtNavMeshDataSwapEndian(unsigned char* data, const int /*dataSize*/)
 	float* detailVerts = dtGetThenAdvanceBufferPointer<float>(d, detailVertsSize);
 	d += detailTrisSize; // Ignore detail tris; single bytes can't be endian-swapped.
 	//unsigned char* detailTris = dtGetThenAdvanceBufferPointer<unsigned char>(d, detailTrisSize);
-	dtBVNode* bvTree = dtGetThenAdvanceBufferPointer<dtBVNode>(d, bvtreeSize);
+	unsigned char* bvTree = dtGetThenAdvanceBufferPointer<unsigned char>(d, bvtreeSize);
 	dtOffMeshConnection* offMeshCons = dtGetThenAdvanceBufferPointer<dtOffMeshConnection>(d, offMeshLinksSize);
+	dtBorderEdge* borderEdges = dtGetThenAdvanceBufferPointer<dtBorderEdge>(d, borderEdgesSize);
 	
 	// Vertices
 	for (int i = 0; i < header->vertCount*3; ++i)
@@ -777,15 +1108,28 @@ bool dtNavMeshDataSwapEndian(unsigned char* data, const int /*dataSize*/)
 	}
 
 	// BV-tree
-	for (int i = 0; i < header->bvNodeCount; ++i)
+	if (header->bvTreeWidth == 4)
+	{
+		for (int i = 0; i < header->bvNodeCount; ++i)
+			swapWideBVNode<4>(&((dtBVNode4*)bvTree)[i]);
+	}
+	else if (header->bvTreeWidth == 8)
+	{
+		for (int i = 0; i < header->bvNodeCount; ++i)
+			swapWideBVNode<8>(&((dtBVNode8*)bvTree)[i]);
+	}
+	else
 	{
-		dtBVNode* node = &bvTree[i];
-		for (int j = 0; j < 3; ++j)
+		for (int i = 0; i < header->bvNodeCount; ++i)
 		{
-			dtSwapEndian(&node->bmin[j]);
-			dtSwapEndian(&node->bmax[j]);
+			dtBVNode* node = &((dtBVNode*)bvTree)[i];
+			for (int j = 0; j < 3; ++j)
+			{
+				dtSwapEndian(&node->bmin[j]);
+				dtSwapEndian(&node->bmax[j]);
+			}
+			dtSwapEndian(&node->i);
 		}
-		dtSwapEndian(&node->i);
 	}
 
 	// Off-mesh Connections.
@@ -797,6 +1141,19 @@ bool dtNavMeshDataSwapEndian(unsigned char* data, const int /*dataSize*/)
 		dtSwapEndian(&con->rad);
 		dtSwapEndian(&con->poly);
 	}
+
+	// Border edges.
+	for (int i = 0; i < header->borderEdgeCount; ++i)
+	{
+		dtBorderEdge* edge = &borderEdges[i];
+		for (int j = 0; j < 2; ++j)
+		{
+			dtSwapEndian(&edge->bmin[j]);
+			dtSwapEndian(&edge->bmax[j]);
+		}
+		dtSwapEndian(&edge->pos);
+		dtSwapEndian(&edge->poly);
+	}
 	
 	return true;
 }
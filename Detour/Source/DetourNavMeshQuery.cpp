@@ -19,6 +19,7 @@
 #include <float.h>
 #include <string.h>
 #include "DetourNavMeshQuery.h"
+#include "DetourNavMeshQueryTemplate.inl"
 #include "DetourNavMesh.h"
 #include "DetourNode.h"
 #include "DetourCommon.h"
@@ -83,24 +84,8 @@ float dtQueryFilter::getCost(const float* pa, const float* pb,
 {
 	return dtVdist(pa, pb) * m_areaCost[curPoly->getArea()];
 }
-#else
-inline bool dtQueryFilter::passFilter(const dtPolyRef /*ref*/,
-									  const dtMeshTile* /*tile*/,
-									  const dtPoly* poly) const
-{
-	return (poly->flags & m_includeFlags) != 0 && (poly->flags & m_excludeFlags) == 0;
-}
-
-inline float dtQueryFilter::getCost(const float* pa, const float* pb,
-									const dtPolyRef /*prevRef*/, const dtMeshTile* /*prevTile*/, const dtPoly* /*prevPoly*/,
-									const dtPolyRef /*curRef*/, const dtMeshTile* /*curTile*/, const dtPoly* curPoly,
-									const dtPolyRef /*nextRef*/, const dtMeshTile* /*nextTile*/, const dtPoly* /*nextPoly*/) const
-{
-	return dtVdist(pa, pb) * m_areaCost[curPoly->getArea()];
-}
 #endif	
 	
-static const float H_SCALE = 0.999f; // Search heuristic scale.
 
 
 dtNavMeshQuery* dtAllocNavMeshQuery()
@@ -142,24 +127,30 @@ dtPolyQuery::~dtPolyQuery()
 
 dtNavMeshQuery::dtNavMeshQuery() :
 	m_nav(0),
-	m_tinyNodePool(0),
+	m_landmarks(0),
+	m_areaSampler(0),
+	m_localScratch(0),
 	m_nodePool(0),
-	m_openList(0)
+	m_openList(0),
+	m_backOpenList(0)
 {
 	memset(&m_query, 0, sizeof(dtQueryData));
 }
 
 dtNavMeshQuery::~dtNavMeshQuery()
 {
-	if (m_tinyNodePool)
-		m_tinyNodePool->~dtNodePool();
+	if (m_localScratch)
+		m_localScratch->~dtLocalSearchScratch();
 	if (m_nodePool)
 		m_nodePool->~dtNodePool();
 	if (m_openList)
 		m_openList->~dtNodeQueue();
-	dtFree(m_tinyNodePool);
+	if (m_backOpenList)
+		m_backOpenList->~dtNodeQueue();
+	dtFree(m_localScratch);
 	dtFree(m_nodePool);
 	dtFree(m_openList);
+	dtFree(m_backOpenList);
 }
 
 /// @par 
@@ -170,7 +161,7 @@ dtNavMeshQuery::~dtNavMeshQuery()
 /// This function can be used multiple times.
 dtStatus dtNavMeshQuery::init(const dtNavMesh* nav, const int maxNodes)
 {
-	if (maxNodes > DT_NULL_IDX || maxNodes > (1 << DT_NODE_PARENT_BITS) - 1)
+	if (maxNodes <= 0 || maxNodes > (1 << DT_NODE_PARENT_BITS) - 1)
 		return DT_FAILURE | DT_INVALID_PARAM;
 
 	m_nav = nav;
@@ -192,15 +183,16 @@ dtStatus dtNavMeshQuery::init(const dtNavMesh* nav, const int maxNodes)
 		m_nodePool->clear();
 	}
 	
-	if (!m_tinyNodePool)
+	if (!m_localScratch)
 	{
-		m_tinyNodePool = new (dtAlloc(sizeof(dtNodePool), DT_ALLOC_PERM)) dtNodePool(64, 32);
-		if (!m_tinyNodePool)
+		void* mem = dtAlloc(sizeof(dtLocalSearchScratch), DT_ALLOC_PERM);
+		if (!mem)
 			return DT_FAILURE | DT_OUT_OF_MEMORY;
+		m_localScratch = new (mem) dtLocalSearchScratch;
 	}
 	else
 	{
-		m_tinyNodePool->clear();
+		m_localScratch->clear();
 	}
 	
 	if (!m_openList || m_openList->getCapacity() < maxNodes)
@@ -219,10 +211,40 @@ dtStatus dtNavMeshQuery::init(const dtNavMesh* nav, const int maxNodes)
 	{
 		m_openList->clear();
 	}
+
+	if (!m_backOpenList || m_backOpenList->getCapacity() < maxNodes)
+	{
+		if (m_backOpenList)
+		{
+			m_backOpenList->~dtNodeQueue();
+			dtFree(m_backOpenList);
+			m_backOpenList = 0;
+		}
+		m_backOpenList = new (dtAlloc(sizeof(dtNodeQueue), DT_ALLOC_PERM)) dtNodeQueue(maxNodes);
+		if (!m_backOpenList)
+			return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	else
+	{
+		m_backOpenList->clear();
+	}
 	
 	return DT_SUCCESS;
 }
 
+/// @par
+///
+/// Without an area sampler, a tile is picked with the same probability for every tile, then
+/// a polygon of the tile weighted by area. With an area sampler whose include and exclude
+/// flags are those of the filter, the polygon is picked weighted by area (and by the area
+/// weights of the sampler) over the whole navigation mesh.
+///
+/// The polygon picked by the sampler must still pass the filter, which can reject it if
+/// the filter overrides #dtQueryFilter::passFilter, or if the flags or areas of the polygons
+/// changed since the sampler tables were built. After a few rejected picks, the polygon is
+/// picked as without an area sampler.
+///
+/// @see setAreaSampler
 dtStatus dtNavMeshQuery::findRandomPoint(const dtQueryFilter* filter, float (*frand)(),
 										 dtPolyRef* randomRef, float* randomPt) const
 {
@@ -231,63 +253,86 @@ dtStatus dtNavMeshQuery::findRandomPoint(const dtQueryFilter* filter, float (*fr
 	if (!filter || !frand || !randomRef || !randomPt)
 		return DT_FAILURE | DT_INVALID_PARAM;
 
-	// Randomly pick one tile. Assume that all tiles cover roughly the same area.
 	const dtMeshTile* tile = 0;
-	float tsum = 0.0f;
-	for (int i = 0; i < m_nav->getMaxTiles(); i++)
-	{
-		const dtMeshTile* t = m_nav->getTile(i);
-		if (!t || !t->header) continue;
-		
-		// Choose random tile using reservoir sampling.
-		const float area = 1.0f; // Could be tile area too.
-		tsum += area;
-		const float u = frand();
-		if (u*tsum <= area)
-			tile = t;
-	}
-	if (!tile)
-		return DT_FAILURE;
-
-	// Randomly pick one polygon weighted by polygon area.
 	const dtPoly* poly = 0;
 	dtPolyRef polyRef = 0;
-	const dtPolyRef base = m_nav->getPolyRefBase(tile);
 
-	float areaSum = 0.0f;
-	for (int i = 0; i < tile->header->polyCount; ++i)
+	if (m_areaSampler && m_areaSampler->getNavMesh() == m_nav && m_areaSampler->matchesFilter(filter))
 	{
-		const dtPoly* p = &tile->polys[i];
-		// Do not return off-mesh connection polygons.
-		if (p->getType() != DT_POLYTYPE_GROUND)
-			continue;
-		// Must pass filter
-		const dtPolyRef ref = base | (dtPolyRef)i;
-		if (!filter->passFilter(ref, tile, p))
-			continue;
-
-		// Calc area of the polygon.
-		float polyArea = 0.0f;
-		for (int j = 2; j < p->vertCount; ++j)
-		{
-			const float* va = &tile->verts[p->verts[0]*3];
-			const float* vb = &tile->verts[p->verts[j-1]*3];
-			const float* vc = &tile->verts[p->verts[j]*3];
-			polyArea += dtTriArea2D(va,vb,vc);
-		}
-
-		// Choose random polygon weighted by area, using reservoir sampling.
-		areaSum += polyArea;
-		const float u = frand();
-		if (u*areaSum <= polyArea)
+		// Pick the polygon from the area tables.
+		static const int MAX_SAMPLER_PICKS = 8;
+		for (int i = 0; i < MAX_SAMPLER_PICKS && !poly; ++i)
 		{
+			const dtPolyRef ref = m_areaSampler->findRandomPoly(frand());
+			const dtMeshTile* t = 0;
+			const dtPoly* p = 0;
+			if (!ref || dtStatusFailed(m_nav->getTileAndPolyByRef(ref, &t, &p)))
+				break;
+			if (p->getType() != DT_POLYTYPE_GROUND || !filter->passFilter(ref, t, p))
+				continue;
+			tile = t;
 			poly = p;
 			polyRef = ref;
 		}
 	}
 	
 	if (!poly)
-		return DT_FAILURE;
+	{
+		// Randomly pick one tile. Assume that all tiles cover roughly the same area.
+		float tsum = 0.0f;
+		for (int i = 0; i < m_nav->getMaxTiles(); i++)
+		{
+			const dtMeshTile* t = m_nav->getTile(i);
+			if (!t || !t->header) continue;
+			
+			// Choose random tile using reservoir sampling.
+			const float area = 1.0f; // Could be tile area too.
+			tsum += area;
+			const float u = frand();
+			if (u*tsum <= area)
+				tile = t;
+		}
+		if (!tile)
+			return DT_FAILURE;
+
+		// Randomly pick one polygon weighted by polygon area.
+		const dtPolyRef base = m_nav->getPolyRefBase(tile);
+
+		float areaSum = 0.0f;
+		for (int i = 0; i < tile->header->polyCount; ++i)
+		{
+			const dtPoly* p = &tile->polys[i];
+			// Do not return off-mesh connection polygons.
+			if (p->getType() != DT_POLYTYPE_GROUND)
+				continue;
+			// Must pass filter
+			const dtPolyRef ref = base | (dtPolyRef)i;
+			if (!filter->passFilter(ref, tile, p))
+				continue;
+
+			// Calc area of the polygon.
+			float polyArea = 0.0f;
+			for (int j = 2; j < p->vertCount; ++j)
+			{
+				const float* va = &tile->verts[p->verts[0]*3];
+				const float* vb = &tile->verts[p->verts[j-1]*3];
+				const float* vc = &tile->verts[p->verts[j]*3];
+				polyArea += dtTriArea2D(va,vb,vc);
+			}
+
+			// Choose random polygon weighted by area, using reservoir sampling.
+			areaSum += polyArea;
+			const float u = frand();
+			if (u*areaSum <= polyArea)
+			{
+				poly = p;
+				polyRef = ref;
+			}
+		}
+		
+		if (!poly)
+			return DT_FAILURE;
+	}
 
 	// Randomly pick point on polygon.
 	const float* v = &tile->verts[poly->verts[0]*3];
@@ -341,7 +386,7 @@ dtStatus dtNavMeshQuery::findRandomPointAroundCircle(dtPolyRef startRef, const f
 	m_openList->clear();
 	
 	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, centerPos);
+	dtVcopy(m_nodePool->getNodePos(startNode), centerPos);
 	startNode->pidx = 0;
 	startNode->cost = 0;
 	startNode->total = 0;
@@ -444,9 +489,9 @@ dtStatus dtNavMeshQuery::findRandomPointAroundCircle(dtPolyRef startRef, const f
 			
 			// Cost
 			if (neighbourNode->flags == 0)
-				dtVlerp(neighbourNode->pos, va, vb, 0.5f);
+				dtVlerp(m_nodePool->getNodePos(neighbourNode), va, vb, 0.5f);
 			
-			const float total = bestNode->total + dtVdist(bestNode->pos, neighbourNode->pos);
+			const float total = bestNode->total + dtVdist(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode));
 			
 			// The node is already in open list and the new result is worse, skip.
 			if ((neighbourNode->flags & DT_NODE_OPEN) && total >= neighbourNode->total)
@@ -729,6 +774,47 @@ dtStatus dtNavMeshQuery::findNearestPoly(const float* center, const float* halfE
 	return DT_SUCCESS;
 }
 
+namespace
+{
+	// Passes the polygons found in a wide bounding volume tree to a query in batches.
+	class BatchWideBVPolys
+	{
+	public:
+		static const int batchSize = 32;
+
+		BatchWideBVPolys(const dtMeshTile* tile, const dtPolyRef base, const dtQueryFilter* filter, dtPolyQuery* query) :
+			m_tile(tile), m_base(base), m_filter(filter), m_query(query), m_n(0) {}
+
+		void operator()(const int i)
+		{
+			const dtPolyRef ref = m_base | (dtPolyRef)i;
+			dtPoly* poly = &m_tile->polys[i];
+			if (!m_filter->passFilter(ref, m_tile, poly))
+				return;
+			m_polyRefs[m_n] = ref;
+			m_polys[m_n] = poly;
+			if (++m_n == batchSize)
+				flush();
+		}
+
+		void flush()
+		{
+			if (m_n)
+				m_query->process(m_tile, m_polys, m_polyRefs, m_n);
+			m_n = 0;
+		}
+
+	private:
+		const dtMeshTile* m_tile;
+		dtPolyRef m_base;
+		const dtQueryFilter* m_filter;
+		dtPolyQuery* m_query;
+		dtPolyRef m_polyRefs[batchSize];
+		dtPoly* m_polys[batchSize];
+		int m_n;
+	};
+}
+
 void dtNavMeshQuery::queryPolygonsInTile(const dtMeshTile* tile, const float* qmin, const float* qmax,
 										 const dtQueryFilter* filter, dtPolyQuery* query) const
 {
@@ -738,10 +824,8 @@ void dtNavMeshQuery::queryPolygonsInTile(const dtMeshTile* tile, const float* qm
 	dtPoly* polys[batchSize];
 	int n = 0;
 
-	if (tile->bvTree)
+	if (tile->bvTree || tile->bvTree4 || tile->bvTree8)
 	{
-		const dtBVNode* node = &tile->bvTree[0];
-		const dtBVNode* end = &tile->bvTree[tile->header->bvNodeCount];
 		const float* tbmin = tile->header->bmin;
 		const float* tbmax = tile->header->bmax;
 		const float qfac = tile->header->bvQuantFactor;
@@ -765,6 +849,19 @@ void dtNavMeshQuery::queryPolygonsInTile(const dtMeshTile* tile, const float* qm
 
 		// Traverse tree
 		const dtPolyRef base = m_nav->getPolyRefBase(tile);
+		if (tile->bvTree4 || tile->bvTree8)
+		{
+			BatchWideBVPolys batch(tile, base, filter, query);
+			if (tile->bvTree4)
+				dtQueryWideBVTree<4>(tile->bvTree4, bmin, bmax, batch);
+			else
+				dtQueryWideBVTree<8>(tile->bvTree8, bmin, bmax, batch);
+			batch.flush();
+			return;
+		}
+
+		const dtBVNode* node = &tile->bvTree[0];
+		const dtBVNode* end = &tile->bvTree[tile->header->bvNodeCount];
 		while (node < end)
 		{
 			const bool overlap = dtOverlapQuantBounds(bmin, bmax, node->bmin, node->bmax);
@@ -975,193 +1072,46 @@ dtStatus dtNavMeshQuery::findPath(dtPolyRef startRef, dtPolyRef endRef,
 								  const dtQueryFilter* filter,
 								  dtPolyRef* path, int* pathCount, const int maxPath) const
 {
-	dtAssert(m_nav);
-	dtAssert(m_nodePool);
-	dtAssert(m_openList);
-
-	if (!pathCount)
-		return DT_FAILURE | DT_INVALID_PARAM;
-
-	*pathCount = 0;
-	
-	// Validate input
-	if (!m_nav->isValidPolyRef(startRef) || !m_nav->isValidPolyRef(endRef) ||
-		!startPos || !dtVisfinite(startPos) ||
-		!endPos || !dtVisfinite(endPos) ||
-		!filter || !path || maxPath <= 0)
-	{
-		return DT_FAILURE | DT_INVALID_PARAM;
-	}
-
-	if (startRef == endRef)
-	{
-		path[0] = startRef;
-		*pathCount = 1;
-		return DT_SUCCESS;
-	}
-	
-	m_nodePool->clear();
-	m_openList->clear();
-	
-	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, startPos);
-	startNode->pidx = 0;
-	startNode->cost = 0;
-	startNode->total = dtVdist(startPos, endPos) * H_SCALE;
-	startNode->id = startRef;
-	startNode->flags = DT_NODE_OPEN;
-	m_openList->push(startNode);
-	
-	dtNode* lastBestNode = startNode;
-	float lastBestNodeCost = startNode->total;
-	
-	bool outOfNodes = false;
-	
-	while (!m_openList->empty())
-	{
-		// Remove node from open list and put it in closed list.
-		dtNode* bestNode = m_openList->pop();
-		bestNode->flags &= ~DT_NODE_OPEN;
-		bestNode->flags |= DT_NODE_CLOSED;
-		
-		// Reached the goal, stop searching.
-		if (bestNode->id == endRef)
-		{
-			lastBestNode = bestNode;
-			break;
-		}
-		
-		// Get current poly and tile.
-		// The API input has been checked already, skip checking internal data.
-		const dtPolyRef bestRef = bestNode->id;
-		const dtMeshTile* bestTile = 0;
-		const dtPoly* bestPoly = 0;
-		m_nav->getTileAndPolyByRefUnsafe(bestRef, &bestTile, &bestPoly);
-		
-		// Get parent poly and tile.
-		dtPolyRef parentRef = 0;
-		const dtMeshTile* parentTile = 0;
-		const dtPoly* parentPoly = 0;
-		if (bestNode->pidx)
-			parentRef = m_nodePool->getNodeAtIdx(bestNode->pidx)->id;
-		if (parentRef)
-			m_nav->getTileAndPolyByRefUnsafe(parentRef, &parentTile, &parentPoly);
-		
-		for (unsigned int i = bestPoly->firstLink; i != DT_NULL_LINK; i = bestTile->links[i].next)
-		{
-			dtPolyRef neighbourRef = bestTile->links[i].ref;
-			
-			// Skip invalid ids and do not expand back to where we came from.
-			if (!neighbourRef || neighbourRef == parentRef)
-				continue;
-			
-			// Get neighbour poly and tile.
-			// The API input has been checked already, skip checking internal data.
-			const dtMeshTile* neighbourTile = 0;
-			const dtPoly* neighbourPoly = 0;
-			m_nav->getTileAndPolyByRefUnsafe(neighbourRef, &neighbourTile, &neighbourPoly);			
-			
-			if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
-				continue;
-
-			// deal explicitly with crossing tile boundaries
-			unsigned char crossSide = 0;
-			if (bestTile->links[i].side != 0xff)
-				crossSide = bestTile->links[i].side >> 1;
-
-			// get the node
-			dtNode* neighbourNode = m_nodePool->getNode(neighbourRef, crossSide);
-			if (!neighbourNode)
-			{
-				outOfNodes = true;
-				continue;
-			}
-			
-			// If the node is visited the first time, calculate node position.
-			if (neighbourNode->flags == 0)
-			{
-				getEdgeMidPoint(bestRef, bestPoly, bestTile,
-								neighbourRef, neighbourPoly, neighbourTile,
-								neighbourNode->pos);
-			}
-
-			// Calculate cost and heuristic.
-			float cost = 0;
-			float heuristic = 0;
-			
-			// Special case for last node.
-			if (neighbourRef == endRef)
-			{
-				// Cost
-				const float curCost = filter->getCost(bestNode->pos, neighbourNode->pos,
-													  parentRef, parentTile, parentPoly,
-													  bestRef, bestTile, bestPoly,
-													  neighbourRef, neighbourTile, neighbourPoly);
-				const float endCost = filter->getCost(neighbourNode->pos, endPos,
-													  bestRef, bestTile, bestPoly,
-													  neighbourRef, neighbourTile, neighbourPoly,
-													  0, 0, 0);
-				
-				cost = bestNode->cost + curCost + endCost;
-				heuristic = 0;
-			}
-			else
-			{
-				// Cost
-				const float curCost = filter->getCost(bestNode->pos, neighbourNode->pos,
-													  parentRef, parentTile, parentPoly,
-													  bestRef, bestTile, bestPoly,
-													  neighbourRef, neighbourTile, neighbourPoly);
-				cost = bestNode->cost + curCost;
-				heuristic = dtVdist(neighbourNode->pos, endPos)*H_SCALE;
-			}
-
-			const float total = cost + heuristic;
-			
-			// The node is already in open list and the new result is worse, skip.
-			if ((neighbourNode->flags & DT_NODE_OPEN) && total >= neighbourNode->total)
-				continue;
-			// The node is already visited and process, and the new result is worse, skip.
-			if ((neighbourNode->flags & DT_NODE_CLOSED) && total >= neighbourNode->total)
-				continue;
-			
-			// Add or update the node.
-			neighbourNode->pidx = m_nodePool->getNodeIdx(bestNode);
-			neighbourNode->id = neighbourRef;
-			neighbourNode->flags = (neighbourNode->flags & ~DT_NODE_CLOSED);
-			neighbourNode->cost = cost;
-			neighbourNode->total = total;
-			
-			if (neighbourNode->flags & DT_NODE_OPEN)
-			{
-				// Already in open, update node location.
-				m_openList->modify(neighbourNode);
-			}
-			else
-			{
-				// Put the node in open list.
-				neighbourNode->flags |= DT_NODE_OPEN;
-				m_openList->push(neighbourNode);
-			}
-			
-			// Update nearest node to target so far.
-			if (heuristic < lastBestNodeCost)
-			{
-				lastBestNodeCost = heuristic;
-				lastBestNode = neighbourNode;
-			}
-		}
-	}
-
-	dtStatus status = getPathToNode(lastBestNode, path, pathCount, maxPath);
-
-	if (lastBestNode->id != endRef)
-		status |= DT_PARTIAL_RESULT;
+	return findPath(startRef, endRef, startPos, endPos, filter, path, pathCount, maxPath, 0, 1.0f);
+}
 
-	if (outOfNodes)
-		status |= DT_OUT_OF_NODES;
-	
-	return status;
+/// @par
+///
+/// The default strategy (no options, @p heuristicWeight of one) is the one used by
+/// the findPath overload without options.
+///
+/// Scaling the heuristic by @p heuristicWeight turns the search into a weighted A*:
+/// the search is pulled towards the end polygon and expands fewer nodes, and the cost
+/// of the returned path is at most @p heuristicWeight times the cost of the cheapest one.
+/// 
+/// #DT_FINDPATH_FIRST_PATH stops the search when the end polygon is first reached
+/// (or when the two search frontiers first meet) instead of when it is the cheapest
+/// open node. 
+///
+/// #DT_FINDPATH_BIDIRECTIONAL searches from both ends at once, sharing the node pool
+/// between the two searches. The backward search evaluates the filter costs in the 
+/// direction of travel, but only follows links that exist in both directions, so
+/// one-way off-mesh connections are only traversed by the forward search.
+/// When the backward search runs out of open nodes, for example behind a one-way
+/// connection, the forward search continues alone until it meets the polygons visited
+/// by the backward search. When the forward search runs out of open nodes, the end
+/// polygon is unreachable and the partial path leads to the nearest polygon visited
+/// by the forward search.
+/// 
+/// #DT_FINDPATH_ANY_ANGLE is ignored, use the sliced query for any-angle paths.
+///
+/// When landmarks are set with #setLandmarks, the heuristic is the larger of the
+/// straight line distance and the landmark bound, which makes the search expand far
+/// fewer nodes around dead ends, without changing the cost of the found path.
+///
+dtStatus dtNavMeshQuery::findPath(dtPolyRef startRef, dtPolyRef endRef,
+								  const float* startPos, const float* endPos,
+								  const dtQueryFilter* filter,
+								  dtPolyRef* path, int* pathCount, const int maxPath,
+								  const unsigned int options, const float heuristicWeight) const
+{
+	return findPath<dtQueryFilter>(startRef, endRef, startPos, endPos, filter, path, pathCount, maxPath,
+								   options, heuristicWeight);
 }
 
 dtStatus dtNavMeshQuery::getPathToNode(dtNode* endNode, dtPolyRef* path, int* pathCount, int maxPath) const
@@ -1204,6 +1154,12 @@ dtStatus dtNavMeshQuery::getPathToNode(dtNode* endNode, dtPolyRef* path, int* pa
 	return DT_SUCCESS;
 }
 
+const float* dtNavMeshQuery::getGoalBounds(dtPolyRef ref, float* bounds) const
+{
+	if (!m_landmarks || m_landmarks->getNavMesh() != m_nav)
+		return 0;
+	return m_landmarks->getPolyBounds(ref, bounds) ? bounds : 0;
+}
 
 /// @par
 ///
@@ -1215,7 +1171,8 @@ dtStatus dtNavMeshQuery::getPathToNode(dtNode* endNode, dtPolyRef* path, int* pa
 ///
 dtStatus dtNavMeshQuery::initSlicedFindPath(dtPolyRef startRef, dtPolyRef endRef,
 											const float* startPos, const float* endPos,
-											const dtQueryFilter* filter, const unsigned int options)
+											const dtQueryFilter* filter, const unsigned int options,
+											const float heuristicWeight)
 {
 	dtAssert(m_nav);
 	dtAssert(m_nodePool);
@@ -1233,11 +1190,15 @@ dtStatus dtNavMeshQuery::initSlicedFindPath(dtPolyRef startRef, dtPolyRef endRef
 	m_query.filter = filter;
 	m_query.options = options;
 	m_query.raycastLimitSqr = FLT_MAX;
+	m_query.heuristicScale = DT_HEURISTIC_SCALE * heuristicWeight;
+	m_query.useLandmarks = getGoalBounds(endRef, m_query.goalBounds) != 0;
 	
 	// Validate input
 	if (!m_nav->isValidPolyRef(startRef) || !m_nav->isValidPolyRef(endRef) ||
 		!startPos || !dtVisfinite(startPos) ||
-		!endPos || !dtVisfinite(endPos) || !filter)
+		!endPos || !dtVisfinite(endPos) || !filter ||
+		!dtMathIsfinite(heuristicWeight) || heuristicWeight < 0.0f ||
+		(options & DT_FINDPATH_BIDIRECTIONAL))
 	{
 		return DT_FAILURE | DT_INVALID_PARAM;
 	}
@@ -1262,10 +1223,11 @@ dtStatus dtNavMeshQuery::initSlicedFindPath(dtPolyRef startRef, dtPolyRef endRef
 	m_openList->clear();
 	
 	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, startPos);
+	dtVcopy(m_nodePool->getNodePos(startNode), startPos);
 	startNode->pidx = 0;
 	startNode->cost = 0;
-	startNode->total = dtVdist(startPos, endPos) * H_SCALE;
+	startNode->total = getHeuristic(m_query.useLandmarks ? m_query.goalBounds : 0,
+									startRef, startPos, endPos) * m_query.heuristicScale;
 	startNode->id = startRef;
 	startNode->flags = DT_NODE_OPEN;
 	m_openList->push(startNode);
@@ -1356,7 +1318,7 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 		bool tryLOS = false;
 		if (m_query.options & DT_FINDPATH_ANY_ANGLE)
 		{
-			if ((parentRef != 0) && (dtVdistSqr(parentNode->pos, bestNode->pos) < m_query.raycastLimitSqr))
+			if ((parentRef != 0) && (dtVdistSqr(m_nodePool->getNodePos(parentNode), m_nodePool->getNodePos(bestNode)) < m_query.raycastLimitSqr))
 				tryLOS = true;
 		}
 		
@@ -1394,7 +1356,7 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 			{
 				getEdgeMidPoint(bestRef, bestPoly, bestTile,
 								neighbourRef, neighbourPoly, neighbourTile,
-								neighbourNode->pos);
+								m_nodePool->getNodePos(neighbourNode));
 			}
 			
 			// Calculate cost and heuristic.
@@ -1406,7 +1368,7 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 			rayHit.pathCost = rayHit.t = 0;
 			if (tryLOS)
 			{
-				raycast(parentRef, parentNode->pos, neighbourNode->pos, m_query.filter, DT_RAYCAST_USE_COSTS, &rayHit, grandpaRef);
+				raycast(parentRef, m_nodePool->getNodePos(parentNode), m_nodePool->getNodePos(neighbourNode), m_query.filter, DT_RAYCAST_USE_COSTS, &rayHit, grandpaRef);
 				foundShortCut = rayHit.t >= 1.0f;
 			}
 
@@ -1419,7 +1381,7 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 			else
 			{
 				// No shortcut found.
-				const float curCost = m_query.filter->getCost(bestNode->pos, neighbourNode->pos,
+				const float curCost = m_query.filter->getCost(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
 															  parentRef, parentTile, parentPoly,
 															bestRef, bestTile, bestPoly,
 															neighbourRef, neighbourTile, neighbourPoly);
@@ -1429,7 +1391,7 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 			// Special case for last node.
 			if (neighbourRef == m_query.endRef)
 			{
-				const float endCost = m_query.filter->getCost(neighbourNode->pos, m_query.endPos,
+				const float endCost = m_query.filter->getCost(m_nodePool->getNodePos(neighbourNode), m_query.endPos,
 															  bestRef, bestTile, bestPoly,
 															  neighbourRef, neighbourTile, neighbourPoly,
 															  0, 0, 0);
@@ -1439,7 +1401,8 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 			}
 			else
 			{
-				heuristic = dtVdist(neighbourNode->pos, m_query.endPos)*H_SCALE;
+				heuristic = getHeuristic(m_query.useLandmarks ? m_query.goalBounds : 0,
+										 neighbourRef, m_nodePool->getNodePos(neighbourNode), m_query.endPos)*m_query.heuristicScale;
 			}
 			
 			const float total = cost + heuristic;
@@ -1478,6 +1441,17 @@ dtStatus dtNavMeshQuery::updateSlicedFindPath(const int maxIter, int* doneIters)
 				m_query.lastBestNodeCost = heuristic;
 				m_query.lastBestNode = neighbourNode;
 			}
+
+			// Reached the goal and the caller does not need the cheapest path, stop searching.
+			if (neighbourRef == m_query.endRef && (m_query.options & DT_FINDPATH_FIRST_PATH))
+			{
+				m_query.lastBestNode = neighbourNode;
+				const dtStatus details = m_query.status & DT_STATUS_DETAIL_MASK;
+				m_query.status = DT_SUCCESS | details;
+				if (doneIters)
+					*doneIters = iter;
+				return m_query.status;
+			}
 		}
 	}
 	
@@ -1551,7 +1525,7 @@ dtStatus dtNavMeshQuery::finalizeSlicedFindPath(dtPolyRef* path, int* pathCount,
 			{
 				float t, normal[3];
 				int m;
-				status = raycast(node->id, node->pos, next->pos, m_query.filter, &t, normal, path+n, &m, maxPath-n);
+				status = raycast(node->id, m_nodePool->getNodePos(node), m_nodePool->getNodePos(next), m_query.filter, &t, normal, path+n, &m, maxPath-n);
 				n += m;
 				// raycast ends on poly boundary and the path might include the next poly boundary.
 				if (path[n-1] == next->id)
@@ -1652,7 +1626,7 @@ dtStatus dtNavMeshQuery::finalizeSlicedFindPathPartial(const dtPolyRef* existing
 			{
 				float t, normal[3];
 				int m;
-				status = raycast(node->id, node->pos, next->pos, m_query.filter, &t, normal, path+n, &m, maxPath-n);
+				status = raycast(node->id, m_nodePool->getNodePos(node), m_nodePool->getNodePos(next), m_query.filter, &t, normal, path+n, &m, maxPath-n);
 				n += m;
 				// raycast ends on poly boundary and the path might include the next poly boundary.
 				if (path[n-1] == next->id)
@@ -2024,8 +1998,11 @@ dtStatus dtNavMeshQuery::findStraightPath(const float* startPos, const float* en
 /// @par
 ///
 /// This method is optimized for small delta movement and a small number of 
-/// polygons. If used for too great a distance, the result set will form an 
-/// incomplete path.
+/// polygons. The search visits the polygons touching the circle through the
+/// start and end positions, so its cost grows with the distance.
+/// 
+/// The visited polygons are stored in @p scratch, or in the scratch space of the
+/// query object, which grow as needed.
 ///
 /// @p resultPos will equal the @p endPos if the end is reached. 
 /// Otherwise the closest reachable position will be returned.
@@ -2043,10 +2020,11 @@ dtStatus dtNavMeshQuery::findStraightPath(const float* startPos, const float* en
 ///
 dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* startPos, const float* endPos,
 										  const dtQueryFilter* filter,
-										  float* resultPos, dtPolyRef* visited, int* visitedCount, const int maxVisitedSize) const
+										  float* resultPos, dtPolyRef* visited, int* visitedCount, const int maxVisitedSize,
+										  dtLocalSearchScratch* scratch) const
 {
 	dtAssert(m_nav);
-	dtAssert(m_tinyNodePool);
+	dtAssert(m_localScratch);
 
 	if (!visitedCount)
 		return DT_FAILURE | DT_INVALID_PARAM;
@@ -2064,24 +2042,16 @@ dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* start
 	
 	dtStatus status = DT_SUCCESS;
 	
-	static const int MAX_STACK = 48;
-	dtNode* stack[MAX_STACK];
-	int nstack = 0;
+	// The visited polygons are the queue of the breadth first search.
+	dtLocalSearchScratch* list = scratch ? scratch : m_localScratch;
+	list->clear();
+	if (list->add(startRef, -1) < 0)
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
 	
-	m_tinyNodePool->clear();
-	
-	dtNode* startNode = m_tinyNodePool->getNode(startRef);
-	startNode->pidx = 0;
-	startNode->cost = 0;
-	startNode->total = 0;
-	startNode->id = startRef;
-	startNode->flags = DT_NODE_CLOSED;
-	stack[nstack++] = startNode;
-	
-	float bestPos[3];
-	float bestDist = FLT_MAX;
-	dtNode* bestNode = 0;
-	dtVcopy(bestPos, startPos);
+	float bestPos[3];
+	float bestDist = FLT_MAX;
+	int bestNode = -1;
+	dtVcopy(bestPos, startPos);
 	
 	// Search constraints
 	float searchPos[3], searchRadSqr;
@@ -2090,17 +2060,11 @@ dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* start
 	
 	float verts[DT_VERTS_PER_POLYGON*3];
 	
-	while (nstack)
+	for (int cur = 0; cur < list->getCount(); ++cur)
 	{
-		// Pop front.
-		dtNode* curNode = stack[0];
-		for (int i = 0; i < nstack-1; ++i)
-			stack[i] = stack[i+1];
-		nstack--;
-		
 		// Get poly and tile.
 		// The API input has been checked already, skip checking internal data.
-		const dtPolyRef curRef = curNode->id;
+		const dtPolyRef curRef = list->getRef(cur);
 		const dtMeshTile* curTile = 0;
 		const dtPoly* curPoly = 0;
 		m_nav->getTileAndPolyByRefUnsafe(curRef, &curTile, &curPoly);			
@@ -2113,7 +2077,7 @@ dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* start
 		// If target is inside the poly, stop search.
 		if (dtPointInPolygon(endPos, verts, nverts))
 		{
-			bestNode = curNode;
+			bestNode = cur;
 			dtVcopy(bestPos, endPos);
 			break;
 		}
@@ -2121,31 +2085,32 @@ dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* start
 		// Find wall edges and find nearest point inside the walls.
 		for (int i = 0, j = (int)curPoly->vertCount-1; i < (int)curPoly->vertCount; j = i++)
 		{
-			// Find links to neighbours.
-			static const int MAX_NEIS = 8;
-			int nneis = 0;
-			dtPolyRef neis[MAX_NEIS];
+			const float* vj = &verts[j*3];
+			const float* vi = &verts[i*3];
+			
+			// Skip the links if the edge is too far from search constraint.
+			// TODO: Maybe should use getPortalPoints(), but this one is way faster.
+			float tseg;
+			const bool inReach = dtDistancePtSegSqr2D(searchPos, vj, vi, tseg) <= searchRadSqr;
 			
+			// Find links to neighbours, and visit the ones not visited yet.
+			bool wall = true;
 			if (curPoly->neis[j] & DT_EXT_LINK)
 			{
 				// Tile border.
 				for (unsigned int k = curPoly->firstLink; k != DT_NULL_LINK; k = curTile->links[k].next)
 				{
 					const dtLink* link = &curTile->links[k];
-					if (link->edge == j)
-					{
-						if (link->ref != 0)
-						{
-							const dtMeshTile* neiTile = 0;
-							const dtPoly* neiPoly = 0;
-							m_nav->getTileAndPolyByRefUnsafe(link->ref, &neiTile, &neiPoly);
-							if (filter->passFilter(link->ref, neiTile, neiPoly))
-							{
-								if (nneis < MAX_NEIS)
-									neis[nneis++] = link->ref;
-							}
-						}
-					}
+					if (link->edge != j || link->ref == 0)
+						continue;
+					const dtMeshTile* neiTile = 0;
+					const dtPoly* neiPoly = 0;
+					m_nav->getTileAndPolyByRefUnsafe(link->ref, &neiTile, &neiPoly);
+					if (!filter->passFilter(link->ref, neiTile, neiPoly))
+						continue;
+					wall = false;
+					if (inReach && list->find(link->ref) < 0 && list->add(link->ref, cur) < 0)
+						status |= DT_OUT_OF_NODES;
 				}
 			}
 			else if (curPoly->neis[j])
@@ -2155,86 +2120,43 @@ dtStatus dtNavMeshQuery::moveAlongSurface(dtPolyRef startRef, const float* start
 				if (filter->passFilter(ref, curTile, &curTile->polys[idx]))
 				{
 					// Internal edge, encode id.
-					neis[nneis++] = ref;
+					wall = false;
+					if (inReach && list->find(ref) < 0 && list->add(ref, cur) < 0)
+						status |= DT_OUT_OF_NODES;
 				}
 			}
 			
-			if (!nneis)
+			if (wall)
 			{
 				// Wall edge, calc distance.
-				const float* vj = &verts[j*3];
-				const float* vi = &verts[i*3];
-				float tseg;
 				const float distSqr = dtDistancePtSegSqr2D(endPos, vj, vi, tseg);
 				if (distSqr < bestDist)
 				{
                     // Update nearest distance.
 					dtVlerp(bestPos, vj,vi, tseg);
 					bestDist = distSqr;
-					bestNode = curNode;
-				}
-			}
-			else
-			{
-				for (int k = 0; k < nneis; ++k)
-				{
-					// Skip if no node can be allocated.
-					dtNode* neighbourNode = m_tinyNodePool->getNode(neis[k]);
-					if (!neighbourNode)
-						continue;
-					// Skip if already visited.
-					if (neighbourNode->flags & DT_NODE_CLOSED)
-						continue;
-					
-					// Skip the link if it is too far from search constraint.
-					// TODO: Maybe should use getPortalPoints(), but this one is way faster.
-					const float* vj = &verts[j*3];
-					const float* vi = &verts[i*3];
-					float tseg;
-					float distSqr = dtDistancePtSegSqr2D(searchPos, vj, vi, tseg);
-					if (distSqr > searchRadSqr)
-						continue;
-					
-					// Mark as the node as visited and push to queue.
-					if (nstack < MAX_STACK)
-					{
-						neighbourNode->pidx = m_tinyNodePool->getNodeIdx(curNode);
-						neighbourNode->flags |= DT_NODE_CLOSED;
-						stack[nstack++] = neighbourNode;
-					}
+					bestNode = cur;
 				}
 			}
 		}
 	}
 	
 	int n = 0;
-	if (bestNode)
+	if (bestNode != -1)
 	{
-		// Reverse the path.
-		dtNode* prev = 0;
-		dtNode* node = bestNode;
-		do
-		{
-			dtNode* next = m_tinyNodePool->getNodeAtIdx(node->pidx);
-			node->pidx = m_tinyNodePool->getNodeIdx(prev);
-			prev = node;
-			node = next;
-		}
-		while (node);
-		
-		// Store result
-		node = prev;
-		do
+		// Store the path from the start, as far as it fits.
+		int pathCount = 0;
+		for (int node = bestNode; node != -1; node = list->getParent(node))
+			pathCount++;
+		if (pathCount >= maxVisitedSize)
+			status |= DT_BUFFER_TOO_SMALL;
+		n = dtMin(pathCount, maxVisitedSize);
+		int i = pathCount;
+		for (int node = bestNode; node != -1; node = list->getParent(node))
 		{
-			visited[n++] = node->id;
-			if (n >= maxVisitedSize)
-			{
-				status |= DT_BUFFER_TOO_SMALL;
-				break;
-			}
-			node = m_tinyNodePool->getNodeAtIdx(node->pidx);
+			if (--i < n)
+				visited[i] = list->getRef(node);
 		}
-		while (node);
 	}
 	
 	dtVcopy(resultPos, bestPos);
@@ -2425,6 +2347,345 @@ dtStatus dtNavMeshQuery::raycast(dtPolyRef startRef, const float* startPos, cons
 }
 
 
+namespace
+{
+	// The vertices of a polygon crossed by raycasts and its edges, the edge from each vertex
+	// to the next one. The edge arrays are padded with zeros so that they are processed at once.
+	struct RaycastPoly
+	{
+		dtPolyRef ref;
+		int nv;
+		float verts[DT_VERTS_PER_POLYGON*3];
+		float vx[DT_VERTS_PER_POLYGON];
+		float vz[DT_VERTS_PER_POLYGON];
+		float ex[DT_VERTS_PER_POLYGON];
+		float ez[DT_VERTS_PER_POLYGON];
+	};
+
+	// The polygons crossed by raycasts, indexed by a hash of their reference.
+	class RaycastPolyCache
+	{
+	public:
+		RaycastPolyCache(RaycastPoly* polys, const int bits) : m_polys(polys), m_bits(bits)
+		{
+			for (int i = 0; i < (1 << bits); ++i)
+				m_polys[i].ref = 0;
+		}
+
+		const RaycastPoly& get(const dtPolyRef ref, const dtMeshTile* tile, const dtPoly* poly)
+		{
+			RaycastPoly& p = m_polys[hash(ref)];
+			if (p.ref == ref)
+				return p;
+
+			p.ref = ref;
+			p.nv = (int)poly->vertCount;
+			for (int i = 0; i < p.nv; ++i)
+				dtVcopy(&p.verts[i*3], &tile->verts[poly->verts[i]*3]);
+			for (int i = 0; i < DT_VERTS_PER_POLYGON; ++i)
+			{
+				if (i < p.nv)
+				{
+					const float* va = &p.verts[i*3];
+					const float* vb = &p.verts[(i+1 < p.nv ? i+1 : 0)*3];
+					p.vx[i] = va[0];
+					p.vz[i] = va[2];
+					p.ex[i] = vb[0] - va[0];
+					p.ez[i] = vb[2] - va[2];
+				}
+				else
+				{
+					p.vx[i] = p.vz[i] = p.ex[i] = p.ez[i] = 0.0f;
+				}
+			}
+			return p;
+		}
+
+	private:
+		unsigned int hash(const dtPolyRef ref) const
+		{
+			if (!m_bits)
+				return 0;
+			unsigned int h = (unsigned int)ref;
+#ifdef DT_POLYREF64
+			h ^= (unsigned int)(ref >> 32);
+#endif
+			return (h * 2654435761u) >> (32 - m_bits);
+		}
+
+		RaycastPoly* m_polys;
+		int m_bits;
+	};
+
+	// Same as dtIntersectSegmentPoly2D. The terms of all the edges are computed first in a loop
+	// without branches, then the edges are clipped in the same order, so the results are identical.
+	bool intersectSegmentPoly2D(const float* p0, const float* dir, const RaycastPoly& p,
+								float& tmin, float& tmax, int& segMin, int& segMax)
+	{
+		static const float EPS = 0.000001f;
+
+		float num[DT_VERTS_PER_POLYGON], den[DT_VERTS_PER_POLYGON];
+		for (int i = 0; i < DT_VERTS_PER_POLYGON; ++i)
+		{
+			num[i] = p.ez[i]*(p0[0] - p.vx[i]) - p.ex[i]*(p0[2] - p.vz[i]);
+			den[i] = dir[2]*p.ex[i] - dir[0]*p.ez[i];
+		}
+
+		tmin = 0;
+		tmax = 1;
+		segMin = -1;
+		segMax = -1;
+
+		for (int i = 0; i < p.nv; ++i)
+		{
+			const int j = i > 0 ? i-1 : p.nv-1;
+			const float n = num[j];
+			const float d = den[j];
+			if (fabsf(d) < EPS)
+			{
+				// S is nearly parallel to this edge
+				if (n < 0)
+					return false;
+				else
+					continue;
+			}
+			const float t = n / d;
+			if (d < 0)
+			{
+				// segment S is entering across this edge
+				if (t > tmin)
+				{
+					tmin = t;
+					segMin = j;
+					// S enters after leaving polygon
+					if (tmin > tmax)
+						return false;
+				}
+			}
+			else
+			{
+				// segment S is leaving across this edge
+				if (t < tmax)
+				{
+					tmax = t;
+					segMax = j;
+					// S leaves before entering polygon
+					if (tmax < tmin)
+						return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Casts a ray whose input has been validated, from the start polygon found by the caller.
+	dtStatus raycastPolys(const dtNavMesh* nav, const dtPolyRef startRef, const dtMeshTile* startTile, const dtPoly* startPoly,
+						  const float* startPos, const float* endPos, const dtQueryFilter* filter, const unsigned int options,
+						  dtRaycastHit* hit, dtPolyRef prevRef, RaycastPolyCache& cache)
+	{
+		float dir[3], curPos[3], lastPos[3];
+		int n = 0;
+
+		dtVcopy(curPos, startPos);
+		dtVsub(dir, endPos, startPos);
+		dtVset(hit->hitNormal, 0, 0, 0);
+
+		dtStatus status = DT_SUCCESS;
+
+		const dtMeshTile* prevTile, *tile, *nextTile;
+		const dtPoly* prevPoly, *poly, *nextPoly;
+		dtPolyRef curRef;
+
+		// The API input has been checked already, skip checking internal data.
+		curRef = startRef;
+		tile = startTile;
+		poly = startPoly;
+		nextTile = prevTile = tile;
+		nextPoly = prevPoly = poly;
+		if (prevRef)
+			nav->getTileAndPolyByRefUnsafe(prevRef, &prevTile, &prevPoly);
+
+		while (curRef)
+		{
+			// Cast ray against current polygon.
+			const RaycastPoly& cur = cache.get(curRef, tile, poly);
+			const float* verts = cur.verts;
+			const int nv = cur.nv;
+
+			float tmin, tmax;
+			int segMin, segMax;
+			if (!intersectSegmentPoly2D(startPos, dir, cur, tmin, tmax, segMin, segMax))
+			{
+				// Could not hit the polygon, keep the old t and report hit.
+				hit->pathCount = n;
+				return status;
+			}
+
+			hit->hitEdgeIndex = segMax;
+
+			// Keep track of furthest t so far.
+			if (tmax > hit->t)
+				hit->t = tmax;
+
+			// Store visited polygons.
+			if (n < hit->maxPath)
+				hit->path[n++] = curRef;
+			else
+				status |= DT_BUFFER_TOO_SMALL;
+
+			// Ray end is completely inside the polygon.
+			if (segMax == -1)
+			{
+				hit->t = FLT_MAX;
+				hit->pathCount = n;
+
+				// add the cost
+				if (options & DT_RAYCAST_USE_COSTS)
+					hit->pathCost += filter->getCost(curPos, endPos, prevRef, prevTile, prevPoly, curRef, tile, poly, curRef, tile, poly);
+				return status;
+			}
+
+			// Follow neighbours.
+			dtPolyRef nextRef = 0;
+
+			for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+			{
+				const dtLink* link = &tile->links[i];
+
+				// Find link which contains this edge.
+				if ((int)link->edge != segMax)
+					continue;
+
+				// Get pointer to the next polygon.
+				nextTile = 0;
+				nextPoly = 0;
+				nav->getTileAndPolyByRefUnsafe(link->ref, &nextTile, &nextPoly);
+
+				// Skip off-mesh connections.
+				if (nextPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+					continue;
+
+				// Skip links based on filter.
+				if (!filter->passFilter(link->ref, nextTile, nextPoly))
+					continue;
+
+				// If the link is internal, just return the ref.
+				if (link->side == 0xff)
+				{
+					nextRef = link->ref;
+					break;
+				}
+
+				// If the link is at tile boundary,
+
+				// Check if the link spans the whole edge, and accept.
+				if (link->bmin == 0 && link->bmax == 255)
+				{
+					nextRef = link->ref;
+					break;
+				}
+
+				// Check for partial edge links.
+				const int v0 = poly->verts[link->edge];
+				const int v1 = poly->verts[(link->edge+1) % poly->vertCount];
+				const float* left = &tile->verts[v0*3];
+				const float* right = &tile->verts[v1*3];
+
+				// Check that the intersection lies inside the link portal.
+				if (link->side == 0 || link->side == 4)
+				{
+					// Calculate link size.
+					const float s = 1.0f/255.0f;
+					float lmin = left[2] + (right[2] - left[2])*(link->bmin*s);
+					float lmax = left[2] + (right[2] - left[2])*(link->bmax*s);
+					if (lmin > lmax) dtSwap(lmin, lmax);
+
+					// Find Z intersection.
+					float z = startPos[2] + (endPos[2]-startPos[2])*tmax;
+					if (z >= lmin && z <= lmax)
+					{
+						nextRef = link->ref;
+						break;
+					}
+				}
+				else if (link->side == 2 || link->side == 6)
+				{
+					// Calculate link size.
+					const float s = 1.0f/255.0f;
+					float lmin = left[0] + (right[0] - left[0])*(link->bmin*s);
+					float lmax = left[0] + (right[0] - left[0])*(link->bmax*s);
+					if (lmin > lmax) dtSwap(lmin, lmax);
+
+					// Find X intersection.
+					float x = startPos[0] + (endPos[0]-startPos[0])*tmax;
+					if (x >= lmin && x <= lmax)
+					{
+						nextRef = link->ref;
+						break;
+					}
+				}
+			}
+
+			// add the cost
+			if (options & DT_RAYCAST_USE_COSTS)
+			{
+				// compute the intersection point at the furthest end of the polygon
+				// and correct the height (since the raycast moves in 2d)
+				dtVcopy(lastPos, curPos);
+				dtVmad(curPos, startPos, dir, hit->t);
+				const float* e1 = &verts[segMax*3];
+				const float* e2 = &verts[((segMax+1)%nv)*3];
+				float eDir[3], diff[3];
+				dtVsub(eDir, e2, e1);
+				dtVsub(diff, curPos, e1);
+				float s = dtSqr(eDir[0]) > dtSqr(eDir[2]) ? diff[0] / eDir[0] : diff[2] / eDir[2];
+				curPos[1] = e1[1] + eDir[1] * s;
+
+				hit->pathCost += filter->getCost(lastPos, curPos, prevRef, prevTile, prevPoly, curRef, tile, poly, nextRef, nextTile, nextPoly);
+			}
+
+			if (!nextRef)
+			{
+				// No neighbour, we hit a wall.
+
+				// Calculate hit normal.
+				const int a = segMax;
+				const int b = segMax+1 < nv ? segMax+1 : 0;
+				const float* va = &verts[a*3];
+				const float* vb = &verts[b*3];
+				const float dx = vb[0] - va[0];
+				const float dz = vb[2] - va[2];
+				hit->hitNormal[0] = dz;
+				hit->hitNormal[1] = 0;
+				hit->hitNormal[2] = -dx;
+				dtVnormalize(hit->hitNormal);
+
+				hit->pathCount = n;
+				return status;
+			}
+
+			// No hit, advance to neighbour polygon.
+			prevRef = curRef;
+			curRef = nextRef;
+			prevTile = tile;
+			tile = nextTile;
+			prevPoly = poly;
+			poly = nextPoly;
+
+			if (status & DT_BUFFER_TOO_SMALL)
+			{
+				status |= DT_PARTIAL_RESULT;
+				break;
+			}
+		}
+
+		hit->pathCount = n;
+
+		return status;
+	}
+}
+
 /// @par
 ///
 /// This method is meant to be used for quick, short distance checks.
@@ -2486,212 +2747,82 @@ dtStatus dtNavMeshQuery::raycast(dtPolyRef startRef, const float* startPos, cons
 		return DT_FAILURE | DT_INVALID_PARAM;
 	}
 	
-	float dir[3], curPos[3], lastPos[3];
-	float verts[DT_VERTS_PER_POLYGON*3+3];	
-	int n = 0;
-
-	dtVcopy(curPos, startPos);
-	dtVsub(dir, endPos, startPos);
-	dtVset(hit->hitNormal, 0, 0, 0);
+	// The API input has been checked already, skip checking internal data.
+	const dtMeshTile* tile = 0;
+	const dtPoly* poly = 0;
+	m_nav->getTileAndPolyByRefUnsafe(startRef, &tile, &poly);
 
-	dtStatus status = DT_SUCCESS;
+	RaycastPoly cur;
+	RaycastPolyCache cache(&cur, 0);
+	return raycastPolys(m_nav, startRef, tile, poly, startPos, endPos, filter, options, hit, prevRef, cache);
+}
 
-	const dtMeshTile* prevTile, *tile, *nextTile;
-	const dtPoly* prevPoly, *poly, *nextPoly;
-	dtPolyRef curRef;
+/// @par
+///
+/// The vertices and edges of the polygons crossed by the rays are kept between the rays of
+/// the batch, and consecutive rays from the same polygon share the lookup of the polygon, so
+/// it pays to group the rays by start polygon. The results of each ray are the same as the
+/// results of #raycast.
+///
+/// Each hit structure must have its own @p path buffer, or a null buffer and a zero
+/// @p maxPath. If any ray fails, the query fails too; @p statuses tells which rays failed.
+///
+/// @see raycast
+dtStatus dtNavMeshQuery::raycastBatch(const dtPolyRef* startRefs, const float* startPos, const float* endPos, const int nrays,
+									  const dtQueryFilter* filter, const unsigned int options,
+									  dtRaycastHit* hits, dtStatus* statuses, const dtPolyRef* prevRefs) const
+{
+	dtAssert(m_nav);
 
-	// The API input has been checked already, skip checking internal data.
-	curRef = startRef;
-	tile = 0;
-	poly = 0;
-	m_nav->getTileAndPolyByRefUnsafe(curRef, &tile, &poly);
-	nextTile = prevTile = tile;
-	nextPoly = prevPoly = poly;
-	if (prevRef)
-		m_nav->getTileAndPolyByRefUnsafe(prevRef, &prevTile, &prevPoly);
-
-	while (curRef)
-	{
-		// Cast ray against current polygon.
-		
-		// Collect vertices.
-		int nv = 0;
-		for (int i = 0; i < (int)poly->vertCount; ++i)
-		{
-			dtVcopy(&verts[nv*3], &tile->verts[poly->verts[i]*3]);
-			nv++;
-		}
-		
-		float tmin, tmax;
-		int segMin, segMax;
-		if (!dtIntersectSegmentPoly2D(startPos, endPos, verts, nv, tmin, tmax, segMin, segMax))
-		{
-			// Could not hit the polygon, keep the old t and report hit.
-			hit->pathCount = n;
-			return status;
-		}
+	if (nrays < 0 || !filter || (nrays > 0 && (!startRefs || !startPos || !endPos || !hits)))
+		return DT_FAILURE | DT_INVALID_PARAM;
 
-		hit->hitEdgeIndex = segMax;
+	static const int CACHE_BITS = 6;
+	RaycastPoly polys[1 << CACHE_BITS];
+	RaycastPolyCache cache(polys, CACHE_BITS);
 
-		// Keep track of furthest t so far.
-		if (tmax > hit->t)
-			hit->t = tmax;
-		
-		// Store visited polygons.
-		if (n < hit->maxPath)
-			hit->path[n++] = curRef;
-		else
-			status |= DT_BUFFER_TOO_SMALL;
+	unsigned int details = 0;
+	bool failed = false;
+	dtPolyRef startRef = 0;
+	const dtMeshTile* startTile = 0;
+	const dtPoly* startPoly = 0;
+	bool startValid = false;
+	for (int r = 0; r < nrays; ++r)
+	{
+		dtRaycastHit* hit = &hits[r];
+		const dtPolyRef prevRef = prevRefs ? prevRefs[r] : 0;
+		hit->t = 0;
+		hit->pathCount = 0;
+		hit->pathCost = 0;
 
-		// Ray end is completely inside the polygon.
-		if (segMax == -1)
+		// Rays from the same polygon share the lookup of the polygon.
+		if (r == 0 || startRefs[r] != startRef)
 		{
-			hit->t = FLT_MAX;
-			hit->pathCount = n;
-			
-			// add the cost
-			if (options & DT_RAYCAST_USE_COSTS)
-				hit->pathCost += filter->getCost(curPos, endPos, prevRef, prevTile, prevPoly, curRef, tile, poly, curRef, tile, poly);
-			return status;
+			startRef = startRefs[r];
+			startValid = dtStatusSucceed(m_nav->getTileAndPolyByRef(startRef, &startTile, &startPoly));
 		}
 
-		// Follow neighbours.
-		dtPolyRef nextRef = 0;
-		
-		for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+		dtStatus status;
+		if (!startValid ||
+			!dtVisfinite(&startPos[r*3]) || !dtVisfinite(&endPos[r*3]) ||
+			(prevRef && !m_nav->isValidPolyRef(prevRef)))
 		{
-			const dtLink* link = &tile->links[i];
-			
-			// Find link which contains this edge.
-			if ((int)link->edge != segMax)
-				continue;
-			
-			// Get pointer to the next polygon.
-			nextTile = 0;
-			nextPoly = 0;
-			m_nav->getTileAndPolyByRefUnsafe(link->ref, &nextTile, &nextPoly);
-			
-			// Skip off-mesh connections.
-			if (nextPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
-				continue;
-			
-			// Skip links based on filter.
-			if (!filter->passFilter(link->ref, nextTile, nextPoly))
-				continue;
-			
-			// If the link is internal, just return the ref.
-			if (link->side == 0xff)
-			{
-				nextRef = link->ref;
-				break;
-			}
-			
-			// If the link is at tile boundary,
-			
-			// Check if the link spans the whole edge, and accept.
-			if (link->bmin == 0 && link->bmax == 255)
-			{
-				nextRef = link->ref;
-				break;
-			}
-			
-			// Check for partial edge links.
-			const int v0 = poly->verts[link->edge];
-			const int v1 = poly->verts[(link->edge+1) % poly->vertCount];
-			const float* left = &tile->verts[v0*3];
-			const float* right = &tile->verts[v1*3];
-			
-			// Check that the intersection lies inside the link portal.
-			if (link->side == 0 || link->side == 4)
-			{
-				// Calculate link size.
-				const float s = 1.0f/255.0f;
-				float lmin = left[2] + (right[2] - left[2])*(link->bmin*s);
-				float lmax = left[2] + (right[2] - left[2])*(link->bmax*s);
-				if (lmin > lmax) dtSwap(lmin, lmax);
-				
-				// Find Z intersection.
-				float z = startPos[2] + (endPos[2]-startPos[2])*tmax;
-				if (z >= lmin && z <= lmax)
-				{
-					nextRef = link->ref;
-					break;
-				}
-			}
-			else if (link->side == 2 || link->side == 6)
-			{
-				// Calculate link size.
-				const float s = 1.0f/255.0f;
-				float lmin = left[0] + (right[0] - left[0])*(link->bmin*s);
-				float lmax = left[0] + (right[0] - left[0])*(link->bmax*s);
-				if (lmin > lmax) dtSwap(lmin, lmax);
-				
-				// Find X intersection.
-				float x = startPos[0] + (endPos[0]-startPos[0])*tmax;
-				if (x >= lmin && x <= lmax)
-				{
-					nextRef = link->ref;
-					break;
-				}
-			}
-		}
-		
-		// add the cost
-		if (options & DT_RAYCAST_USE_COSTS)
-		{
-			// compute the intersection point at the furthest end of the polygon
-			// and correct the height (since the raycast moves in 2d)
-			dtVcopy(lastPos, curPos);
-			dtVmad(curPos, startPos, dir, hit->t);
-			float* e1 = &verts[segMax*3];
-			float* e2 = &verts[((segMax+1)%nv)*3];
-			float eDir[3], diff[3];
-			dtVsub(eDir, e2, e1);
-			dtVsub(diff, curPos, e1);
-			float s = dtSqr(eDir[0]) > dtSqr(eDir[2]) ? diff[0] / eDir[0] : diff[2] / eDir[2];
-			curPos[1] = e1[1] + eDir[1] * s;
-
-			hit->pathCost += filter->getCost(lastPos, curPos, prevRef, prevTile, prevPoly, curRef, tile, poly, nextRef, nextTile, nextPoly);
+			status = DT_FAILURE | DT_INVALID_PARAM;
 		}
-
-		if (!nextRef)
+		else
 		{
-			// No neighbour, we hit a wall.
-			
-			// Calculate hit normal.
-			const int a = segMax;
-			const int b = segMax+1 < nv ? segMax+1 : 0;
-			const float* va = &verts[a*3];
-			const float* vb = &verts[b*3];
-			const float dx = vb[0] - va[0];
-			const float dz = vb[2] - va[2];
-			hit->hitNormal[0] = dz;
-			hit->hitNormal[1] = 0;
-			hit->hitNormal[2] = -dx;
-			dtVnormalize(hit->hitNormal);
-			
-			hit->pathCount = n;
-			return status;
+			status = raycastPolys(m_nav, startRef, startTile, startPoly, &startPos[r*3], &endPos[r*3],
+								  filter, options, hit, prevRef, cache);
 		}
 
-		// No hit, advance to neighbour polygon.
-		prevRef = curRef;
-		curRef = nextRef;
-		prevTile = tile;
-		tile = nextTile;
-		prevPoly = poly;
-		poly = nextPoly;
-
-		if (status & DT_BUFFER_TOO_SMALL)
-		{
-			status |= DT_PARTIAL_RESULT;
-			break;
-		}
+		if (statuses)
+			statuses[r] = status;
+		if (dtStatusFailed(status))
+			failed = true;
+		details |= status & DT_STATUS_DETAIL_MASK;
 	}
-	
-	hit->pathCount = n;
-	
-	return status;
+
+	return (failed ? DT_FAILURE : DT_SUCCESS) | details;
 }
 
 /// @par
@@ -2749,7 +2880,7 @@ dtStatus dtNavMeshQuery::findPolysAroundCircle(dtPolyRef startRef, const float*
 	m_openList->clear();
 	
 	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, centerPos);
+	dtVcopy(m_nodePool->getNodePos(startNode), centerPos);
 	startNode->pidx = 0;
 	startNode->cost = 0;
 	startNode->total = 0;
@@ -2840,10 +2971,10 @@ dtStatus dtNavMeshQuery::findPolysAroundCircle(dtPolyRef startRef, const float*
 			
 			// Cost
 			if (neighbourNode->flags == 0)
-				dtVlerp(neighbourNode->pos, va, vb, 0.5f);
+				dtVlerp(m_nodePool->getNodePos(neighbourNode), va, vb, 0.5f);
 			
 			float cost = filter->getCost(
-				bestNode->pos, neighbourNode->pos,
+				m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
 				parentRef, parentTile, parentPoly,
 				bestRef, bestTile, bestPoly,
 				neighbourRef, neighbourTile, neighbourPoly);
@@ -2931,7 +3062,7 @@ dtStatus dtNavMeshQuery::findPolysAroundShape(dtPolyRef startRef, const float* v
 	dtVscale(centerPos,centerPos,1.0f/nverts);
 
 	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, centerPos);
+	dtVcopy(m_nodePool->getNodePos(startNode), centerPos);
 	startNode->pidx = 0;
 	startNode->cost = 0;
 	startNode->total = 0;
@@ -3023,10 +3154,10 @@ dtStatus dtNavMeshQuery::findPolysAroundShape(dtPolyRef startRef, const float* v
 			
 			// Cost
 			if (neighbourNode->flags == 0)
-				dtVlerp(neighbourNode->pos, va, vb, 0.5f);
+				dtVlerp(m_nodePool->getNodePos(neighbourNode), va, vb, 0.5f);
 			
 			float cost = filter->getCost(
-				bestNode->pos, neighbourNode->pos,
+				m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode),
 				parentRef, parentTile, parentPoly,
 				bestRef, bestTile, bestPoly,
 				neighbourRef, neighbourTile, neighbourPoly);
@@ -3095,13 +3226,17 @@ dtStatus dtNavMeshQuery::getPathFromDijkstraSearch(dtPolyRef endRef, dtPolyRef*
 /// If the result arrays are is too small to hold the entire result set, they will 
 /// be filled to capacity.
 /// 
+/// The visited polygons are stored in @p scratch, or in the scratch space of the
+/// query object, which grow as needed.
+/// 
 dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float* centerPos, const float radius,
 												const dtQueryFilter* filter,
 												dtPolyRef* resultRef, dtPolyRef* resultParent,
-												int* resultCount, const int maxResult) const
+												int* resultCount, const int maxResult,
+												dtLocalSearchScratch* scratch) const
 {
 	dtAssert(m_nav);
-	dtAssert(m_tinyNodePool);
+	dtAssert(m_localScratch);
 
 	if (!resultCount)
 		return DT_FAILURE | DT_INVALID_PARAM;
@@ -3116,17 +3251,12 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 		return DT_FAILURE | DT_INVALID_PARAM;
 	}
 
-	static const int MAX_STACK = 48;
-	dtNode* stack[MAX_STACK];
-	int nstack = 0;
-	
-	m_tinyNodePool->clear();
-	
-	dtNode* startNode = m_tinyNodePool->getNode(startRef);
-	startNode->pidx = 0;
-	startNode->id = startRef;
-	startNode->flags = DT_NODE_CLOSED;
-	stack[nstack++] = startNode;
+	// The visited polygons are the queue of the breadth first search, the polygons
+	// overlapping the results are visited but closed.
+	dtLocalSearchScratch* list = scratch ? scratch : m_localScratch;
+	list->clear();
+	if (list->add(startRef, -1) < 0)
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
 	
 	const float radiusSqr = dtSqr(radius);
 	
@@ -3138,7 +3268,7 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 	int n = 0;
 	if (n < maxResult)
 	{
-		resultRef[n] = startNode->id;
+		resultRef[n] = startRef;
 		if (resultParent)
 			resultParent[n] = 0;
 		++n;
@@ -3148,17 +3278,14 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 		status |= DT_BUFFER_TOO_SMALL;
 	}
 	
-	while (nstack)
+	for (int cur = 0; cur < list->getCount(); ++cur)
 	{
-		// Pop front.
-		dtNode* curNode = stack[0];
-		for (int i = 0; i < nstack-1; ++i)
-			stack[i] = stack[i+1];
-		nstack--;
+		if (!list->isOpen(cur))
+			continue;
 		
 		// Get poly and tile.
 		// The API input has been checked already, skip checking internal data.
-		const dtPolyRef curRef = curNode->id;
+		const dtPolyRef curRef = list->getRef(cur);
 		const dtMeshTile* curTile = 0;
 		const dtPoly* curPoly = 0;
 		m_nav->getTileAndPolyByRefUnsafe(curRef, &curTile, &curPoly);
@@ -3171,12 +3298,8 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 			if (!neighbourRef)
 				continue;
 			
-			// Skip if cannot alloca more nodes.
-			dtNode* neighbourNode = m_tinyNodePool->getNode(neighbourRef);
-			if (!neighbourNode)
-				continue;
 			// Skip visited.
-			if (neighbourNode->flags & DT_NODE_CLOSED)
+			if (list->find(neighbourRef) >= 0)
 				continue;
 			
 			// Expand to neighbour
@@ -3205,8 +3328,12 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 			
 			// Mark node visited, this is done before the overlap test so that
 			// we will not visit the poly again if the test fails.
-			neighbourNode->flags |= DT_NODE_CLOSED;
-			neighbourNode->pidx = m_tinyNodePool->getNodeIdx(curNode);
+			const int neighbourNode = list->add(neighbourRef, cur);
+			if (neighbourNode < 0)
+			{
+				status |= DT_OUT_OF_NODES;
+				continue;
+			}
 			
 			// Check that the polygon does not collide with existing polygons.
 			
@@ -3250,7 +3377,10 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 				}
 			}
 			if (overlap)
+			{
+				list->close(neighbourNode);
 				continue;
+			}
 			
 			// This poly is fine, store and advance to the poly.
 			if (n < maxResult)
@@ -3264,11 +3394,6 @@ dtStatus dtNavMeshQuery::findLocalNeighbourhood(dtPolyRef startRef, const float*
 			{
 				status |= DT_BUFFER_TOO_SMALL;
 			}
-			
-			if (nstack < MAX_STACK)
-			{
-				stack[nstack++] = neighbourNode;
-			}
 		}
 	}
 	
@@ -3494,7 +3619,7 @@ dtStatus dtNavMeshQuery::findDistanceToWall(dtPolyRef startRef, const float* cen
 	m_openList->clear();
 	
 	dtNode* startNode = m_nodePool->getNode(startRef);
-	dtVcopy(startNode->pos, centerPos);
+	dtVcopy(m_nodePool->getNodePos(startNode), centerPos);
 	startNode->pidx = 0;
 	startNode->cost = 0;
 	startNode->total = 0;
@@ -3625,10 +3750,10 @@ dtStatus dtNavMeshQuery::findDistanceToWall(dtPolyRef startRef, const float* cen
 			if (neighbourNode->flags == 0)
 			{
 				getEdgeMidPoint(bestRef, bestPoly, bestTile,
-								neighbourRef, neighbourPoly, neighbourTile, neighbourNode->pos);
+								neighbourRef, neighbourPoly, neighbourTile, m_nodePool->getNodePos(neighbourNode));
 			}
 			
-			const float total = bestNode->total + dtVdist(bestNode->pos, neighbourNode->pos);
+			const float total = bestNode->total + dtVdist(m_nodePool->getNodePos(bestNode), m_nodePool->getNodePos(neighbourNode));
 			
 			// The node is already in open list and the new result is worse, skip.
 			if ((neighbourNode->flags & DT_NODE_OPEN) && total >= neighbourNode->total)
@@ -48,58 +48,71 @@ inline unsigned int dtHashRef(dtPolyRef a)
 #endif
 
 //////////////////////////////////////////////////////////////////////////////////////////
+
+/// @class dtNodePool
+///
+/// The nodes are looked up with an open addressing hash table keyed by the polygon reference,
+/// using linear probing. The table has at least twice as many slots as there are nodes.
+///
+/// Each slot is stamped with the generation of the pool when it is filled. Clearing the pool
+/// only advances the generation, which empties all the slots without touching the table.
+
 dtNodePool::dtNodePool(int maxNodes, int hashSize) :
 	m_nodes(0),
-	m_first(0),
-	m_next(0),
+	m_nodePos(0),
+	m_slots(0),
 	m_maxNodes(maxNodes),
-	m_hashSize(hashSize),
-	m_nodeCount(0)
+	m_hashSize((int)dtNextPow2((unsigned int)dtMax(hashSize, maxNodes*2))),
+	m_nodeCount(0),
+	m_stamp(1)
 {
-	dtAssert(dtNextPow2(m_hashSize) == (unsigned int)m_hashSize);
+	dtAssert(dtNextPow2(hashSize) == (unsigned int)hashSize);
 	// pidx is special as 0 means "none" and 1 is the first node. For that reason
 	// we have 1 fewer nodes available than the number of values it can contain.
-	dtAssert(m_maxNodes > 0 && m_maxNodes <= DT_NULL_IDX && m_maxNodes <= (1 << DT_NODE_PARENT_BITS) - 1);
+	dtAssert(m_maxNodes > 0 && m_maxNodes <= (1 << DT_NODE_PARENT_BITS) - 1);
 
 	m_nodes = (dtNode*)dtAlloc(sizeof(dtNode)*m_maxNodes, DT_ALLOC_PERM);
-	m_next = (dtNodeIndex*)dtAlloc(sizeof(dtNodeIndex)*m_maxNodes, DT_ALLOC_PERM);
-	m_first = (dtNodeIndex*)dtAlloc(sizeof(dtNodeIndex)*hashSize, DT_ALLOC_PERM);
+	m_nodePos = (float*)dtAlloc(sizeof(float)*3*m_maxNodes, DT_ALLOC_PERM);
+	m_slots = (dtNodeSlot*)dtAlloc(sizeof(dtNodeSlot)*m_hashSize, DT_ALLOC_PERM);
 
 	dtAssert(m_nodes);
-	dtAssert(m_next);
-	dtAssert(m_first);
+	dtAssert(m_nodePos);
+	dtAssert(m_slots);
 
-	memset(m_first, 0xff, sizeof(dtNodeIndex)*m_hashSize);
-	memset(m_next, 0xff, sizeof(dtNodeIndex)*m_maxNodes);
+	memset(m_slots, 0, sizeof(dtNodeSlot)*m_hashSize);
 }
 
 dtNodePool::~dtNodePool()
 {
 	dtFree(m_nodes);
-	dtFree(m_next);
-	dtFree(m_first);
+	dtFree(m_nodePos);
+	dtFree(m_slots);
 }
 
 void dtNodePool::clear()
 {
-	memset(m_first, 0xff, sizeof(dtNodeIndex)*m_hashSize);
+	m_stamp++;
+	if (m_stamp == 0)
+	{
+		// The generation wrapped around, old stamps could match again.
+		memset(m_slots, 0, sizeof(dtNodeSlot)*m_hashSize);
+		m_stamp = 1;
+	}
 	m_nodeCount = 0;
 }
 
 unsigned int dtNodePool::findNodes(dtPolyRef id, dtNode** nodes, const int maxNodes)
 {
 	int n = 0;
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	while (i != DT_NULL_IDX)
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	for (unsigned int i = dtHashRef(id) & mask; m_slots[i].stamp == m_stamp; i = (i+1) & mask)
 	{
-		if (m_nodes[i].id == id)
+		if (m_slots[i].id == id)
 		{
 			if (n >= maxNodes)
 				return n;
-			nodes[n++] = &m_nodes[i];
+			nodes[n++] = &m_nodes[m_slots[i].idx];
 		}
-		i = m_next[i];
 	}
 
 	return n;
@@ -107,51 +120,176 @@ unsigned int dtNodePool::findNodes(dtPolyRef id, dtNode** nodes, const int maxNo
 
 dtNode* dtNodePool::findNode(dtPolyRef id, unsigned char state)
 {
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	while (i != DT_NULL_IDX)
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	for (unsigned int i = dtHashRef(id) & mask; m_slots[i].stamp == m_stamp; i = (i+1) & mask)
 	{
-		if (m_nodes[i].id == id && m_nodes[i].state == state)
-			return &m_nodes[i];
-		i = m_next[i];
+		if (m_slots[i].id == id && m_nodes[m_slots[i].idx].state == state)
+			return &m_nodes[m_slots[i].idx];
 	}
 	return 0;
 }
 
 dtNode* dtNodePool::getNode(dtPolyRef id, unsigned char state)
 {
-	unsigned int bucket = dtHashRef(id) & (m_hashSize-1);
-	dtNodeIndex i = m_first[bucket];
-	dtNode* node = 0;
-	while (i != DT_NULL_IDX)
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	unsigned int i = dtHashRef(id) & mask;
+	for (; m_slots[i].stamp == m_stamp; i = (i+1) & mask)
 	{
-		if (m_nodes[i].id == id && m_nodes[i].state == state)
-			return &m_nodes[i];
-		i = m_next[i];
+		if (m_slots[i].id == id && m_nodes[m_slots[i].idx].state == state)
+			return &m_nodes[m_slots[i].idx];
 	}
 	
 	if (m_nodeCount >= m_maxNodes)
 		return 0;
 	
-	i = (dtNodeIndex)m_nodeCount;
+	const dtNodeIndex idx = (dtNodeIndex)m_nodeCount;
 	m_nodeCount++;
 	
 	// Init node
-	node = &m_nodes[i];
+	dtNode* node = &m_nodes[idx];
 	node->pidx = 0;
 	node->cost = 0;
 	node->total = 0;
 	node->id = id;
 	node->state = state;
 	node->flags = 0;
-	
-	m_next[i] = m_first[bucket];
-	m_first[bucket] = i;
+
+	// Claim the empty slot ending the probe sequence.
+	m_slots[i].id = id;
+	m_slots[i].stamp = m_stamp;
+	m_slots[i].idx = idx;
 	
 	return node;
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/// @class dtLocalSearchScratch
+///
+/// The entries are stored in visit order, so a breadth first traversal pops them by walking
+/// the arrays forward. They are found by polygon reference with a stamped open addressing hash
+/// table like the one of dtNodePool, which is rebuilt with twice the size when the entries grow.
+
+dtLocalSearchScratch::dtLocalSearchScratch() :
+	m_refs(0),
+	m_parents(0),
+	m_open(0),
+	m_slots(0),
+	m_count(0),
+	m_capacity(0),
+	m_hashSize(0),
+	m_stamp(1)
+{
+}
+
+dtLocalSearchScratch::~dtLocalSearchScratch()
+{
+	dtFree(m_refs);
+	dtFree(m_parents);
+	dtFree(m_open);
+	dtFree(m_slots);
+}
+
+void dtLocalSearchScratch::clear()
+{
+	m_stamp++;
+	if (m_stamp == 0)
+	{
+		// The generation wrapped around, old stamps could match again.
+		if (m_slots)
+			memset(m_slots, 0, sizeof(dtLocalSlot)*m_hashSize);
+		m_stamp = 1;
+	}
+	m_count = 0;
+}
+
+int dtLocalSearchScratch::find(dtPolyRef ref) const
+{
+	if (!m_count)
+		return -1;
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	for (unsigned int i = dtHashRef(ref) & mask; m_slots[i].stamp == m_stamp; i = (i+1) & mask)
+	{
+		if (m_slots[i].ref == ref)
+			return m_slots[i].idx;
+	}
+	return -1;
+}
+
+bool dtLocalSearchScratch::grow()
+{
+	const int capacity = dtMax(m_capacity*2, 64);
+	const int hashSize = capacity*2;
+	dtPolyRef* refs = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef)*capacity, DT_ALLOC_PERM);
+	int* parents = (int*)dtAlloc(sizeof(int)*capacity, DT_ALLOC_PERM);
+	unsigned char* open = (unsigned char*)dtAlloc(sizeof(unsigned char)*capacity, DT_ALLOC_PERM);
+	dtLocalSlot* slots = (dtLocalSlot*)dtAlloc(sizeof(dtLocalSlot)*hashSize, DT_ALLOC_PERM);
+	if (!refs || !parents || !open || !slots)
+	{
+		dtFree(refs);
+		dtFree(parents);
+		dtFree(open);
+		dtFree(slots);
+		return false;
+	}
+
+	if (m_count)
+	{
+		memcpy(refs, m_refs, sizeof(dtPolyRef)*m_count);
+		memcpy(parents, m_parents, sizeof(int)*m_count);
+		memcpy(open, m_open, sizeof(unsigned char)*m_count);
+	}
+	dtFree(m_refs);
+	dtFree(m_parents);
+	dtFree(m_open);
+	dtFree(m_slots);
+	m_refs = refs;
+	m_parents = parents;
+	m_open = open;
+	m_slots = slots;
+	m_capacity = capacity;
+	m_hashSize = hashSize;
+
+	// Rehash the entries.
+	memset(m_slots, 0, sizeof(dtLocalSlot)*m_hashSize);
+	m_stamp = 1;
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	for (int j = 0; j < m_count; ++j)
+	{
+		unsigned int i = dtHashRef(m_refs[j]) & mask;
+		while (m_slots[i].stamp == m_stamp)
+			i = (i+1) & mask;
+		m_slots[i].ref = m_refs[j];
+		m_slots[i].stamp = m_stamp;
+		m_slots[i].idx = j;
+	}
+	return true;
+}
+
+int dtLocalSearchScratch::add(dtPolyRef ref, int parent)
+{
+	if (m_count >= m_capacity && !grow())
+		return -1;
+
+	const int idx = m_count++;
+	m_refs[idx] = ref;
+	m_parents[idx] = parent;
+	m_open[idx] = 1;
+
+	// Claim the empty slot ending the probe sequence.
+	const unsigned int mask = (unsigned int)m_hashSize-1;
+	unsigned int i = dtHashRef(ref) & mask;
+	while (m_slots[i].stamp == m_stamp)
+		i = (i+1) & mask;
+	m_slots[i].ref = ref;
+	m_slots[i].stamp = m_stamp;
+	m_slots[i].idx = idx;
+
+	return idx;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 dtNodeQueue::dtNodeQueue(int n) :
 	m_heap(0),
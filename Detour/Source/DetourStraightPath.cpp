@@ -0,0 +1,398 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <string.h>
+#include "DetourStraightPath.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourCommon.h"
+#include "DetourAlloc.h"
+#include "DetourAssert.h"
+
+/**
+@class dtStraightPathIterator
+@par
+
+The iterator runs the same funnel algorithm as dtNavMeshQuery::findStraightPath, but keeps the funnel
+state between the calls to #next() so that only the vertices the caller consumes are computed.
+#getStraightPath() gives the same result as dtNavMeshQuery::findStraightPath without crossing options.
+
+Querying the portal of two polygons is the most expensive part of string pulling. The portals at the
+start of the corridor are kept in a cache keyed by the polygon references. When a following #begin()
+gets a corridor whose first polygons were passed since the previous call, the cache is shifted to
+match, so an agent moving along a corridor only queries the portals it has not seen yet.
+
+Polygon references change when tiles are removed, so stale portals are never used. Call #reset()
+if a tile is restored with its previous reference.
+
+@see dtNavMeshQuery::findStraightPath, dtPathCorridor::findCorners
+*/
+
+dtStraightPathIterator::dtStraightPathIterator() :
+	m_portals(0),
+	m_maxPortals(0),
+	m_ownsPortals(false),
+	m_nav(0),
+	m_query(0),
+	m_path(0),
+	m_pathSize(0),
+	m_state(DT_STRAIGHTPATH_STATE_DONE),
+	m_apexIndex(0),
+	m_leftIndex(0),
+	m_rightIndex(0),
+	m_leftPolyType(0),
+	m_rightPolyType(0),
+	m_leftPolyRef(0),
+	m_rightPolyRef(0),
+	m_portalIndex(0)
+{
+	memset(m_endPos, 0, sizeof(m_endPos));
+	memset(m_closestEndPos, 0, sizeof(m_closestEndPos));
+	memset(m_portalApex, 0, sizeof(m_portalApex));
+	memset(m_portalLeft, 0, sizeof(m_portalLeft));
+	memset(m_portalRight, 0, sizeof(m_portalRight));
+}
+
+dtStraightPathIterator::~dtStraightPathIterator()
+{
+	if (m_ownsPortals)
+		dtFree(m_portals);
+}
+
+bool dtStraightPathIterator::init(const int maxPortals)
+{
+	init(0, 0);
+	if (maxPortals > 0)
+	{
+		dtStraightPathPortal* portals = (dtStraightPathPortal*)dtAlloc(sizeof(dtStraightPathPortal)*maxPortals, DT_ALLOC_PERM);
+		if (!portals)
+			return false;
+		init(portals, maxPortals);
+		m_ownsPortals = true;
+	}
+	return true;
+}
+
+/// @par
+///
+/// The iterator does not free the portal cache.
+void dtStraightPathIterator::init(dtStraightPathPortal* portals, const int maxPortals)
+{
+	if (m_ownsPortals)
+		dtFree(m_portals);
+	m_portals = portals;
+	m_maxPortals = portals ? dtMax(maxPortals, 0) : 0;
+	m_ownsPortals = false;
+	reset();
+}
+
+void dtStraightPathIterator::reset()
+{
+	if (m_portals)
+		memset(m_portals, 0, sizeof(dtStraightPathPortal)*m_maxPortals);
+	m_nav = 0;
+}
+
+/// @par
+///
+/// The start position is clamped to the first polygon in the path, and the end position
+/// is clamped to the last, like in dtNavMeshQuery::findStraightPath.
+dtStatus dtStraightPathIterator::begin(const dtNavMeshQuery* query, const float* startPos, const float* endPos,
+									   const dtPolyRef* path, const int pathSize)
+{
+	m_state = DT_STRAIGHTPATH_STATE_DONE;
+
+	if (!query || !query->getAttachedNavMesh() ||
+		!startPos || !dtVisfinite(startPos) ||
+		!endPos || !dtVisfinite(endPos) ||
+		!path || pathSize <= 0 || !path[0])
+	{
+		return DT_FAILURE | DT_INVALID_PARAM;
+	}
+
+	if (query->getAttachedNavMesh() != m_nav)
+	{
+		reset();
+		m_nav = query->getAttachedNavMesh();
+	}
+	else if (m_maxPortals > 0 && m_portals[0].from != path[0])
+	{
+		// The start of the corridor has moved forward, shift the cache to match.
+		int shift = 1;
+		while (shift < m_maxPortals && m_portals[shift].from != path[0])
+			shift++;
+		if (shift < m_maxPortals)
+		{
+			memmove(m_portals, m_portals+shift, sizeof(dtStraightPathPortal)*(m_maxPortals-shift));
+			memset(m_portals+m_maxPortals-shift, 0, sizeof(dtStraightPathPortal)*shift);
+		}
+	}
+
+	float closestStartPos[3];
+	if (dtStatusFailed(query->closestPointOnPolyBoundary(path[0], startPos, closestStartPos)))
+		return DT_FAILURE | DT_INVALID_PARAM;
+	if (dtStatusFailed(query->closestPointOnPolyBoundary(path[pathSize-1], endPos, m_closestEndPos)))
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	m_query = query;
+	m_path = path;
+	m_pathSize = pathSize;
+	dtVcopy(m_endPos, endPos);
+
+	dtVcopy(m_portalApex, closestStartPos);
+	dtVcopy(m_portalLeft, m_portalApex);
+	dtVcopy(m_portalRight, m_portalApex);
+	m_apexIndex = 0;
+	m_leftIndex = 0;
+	m_rightIndex = 0;
+	m_leftPolyType = 0;
+	m_rightPolyType = 0;
+	m_leftPolyRef = path[0];
+	m_rightPolyRef = path[0];
+	m_portalIndex = 0;
+
+	m_state = DT_STRAIGHTPATH_STATE_START;
+
+	return DT_SUCCESS;
+}
+
+dtStatus dtStraightPathIterator::getPortal(const int i, float* left, float* right, unsigned char& toType)
+{
+	const dtPolyRef from = m_path[i];
+	const dtPolyRef to = m_path[i+1];
+	unsigned char fromType; // fromType is ignored.
+
+	if (i >= m_maxPortals)
+		return m_query->getPortalPoints(from, to, left, right, fromType, toType);
+
+	dtStraightPathPortal& portal = m_portals[i];
+	if (portal.from != from || portal.to != to)
+	{
+		if (dtStatusFailed(m_query->getPortalPoints(from, to, portal.left, portal.right, fromType, portal.toType)))
+		{
+			portal.from = 0;
+			portal.to = 0;
+			return DT_FAILURE | DT_INVALID_PARAM;
+		}
+		portal.from = from;
+		portal.to = to;
+	}
+
+	dtVcopy(left, portal.left);
+	dtVcopy(right, portal.right);
+	toType = portal.toType;
+	return DT_SUCCESS;
+}
+
+dtStatus dtStraightPathIterator::advanceApex(const float* pos, const dtPolyRef ref, const unsigned char type,
+											 const int index,
+											 float* outPos, unsigned char* outFlags, dtPolyRef* outRef)
+{
+	dtVcopy(m_portalApex, pos);
+	m_apexIndex = index;
+
+	unsigned char flags = 0;
+	if (!ref)
+		flags = DT_STRAIGHTPATH_END;
+	else if (type == DT_POLYTYPE_OFFMESH_CONNECTION)
+		flags = DT_STRAIGHTPATH_OFFMESH_CONNECTION;
+
+	dtVcopy(outPos, m_portalApex);
+	if (outFlags)
+		*outFlags = flags;
+	if (outRef)
+		*outRef = ref;
+
+	dtVcopy(m_portalLeft, m_portalApex);
+	dtVcopy(m_portalRight, m_portalApex);
+	m_leftIndex = m_apexIndex;
+	m_rightIndex = m_apexIndex;
+
+	// Restart from the portal after the new apex.
+	m_portalIndex = m_apexIndex + 1;
+
+	if (flags == DT_STRAIGHTPATH_END)
+	{
+		m_state = DT_STRAIGHTPATH_STATE_DONE;
+		return DT_SUCCESS;
+	}
+	return DT_IN_PROGRESS;
+}
+
+/// @par
+///
+/// The returned vertices are the ones dtNavMeshQuery::findStraightPath would append, so two consecutive
+/// vertices can be equal. The last vertex is returned with #DT_SUCCESS, which has #DT_PARTIAL_RESULT set
+/// if the path ended at an invalid polygon. Any further call fails.
+dtStatus dtStraightPathIterator::next(float* pos, unsigned char* flags, dtPolyRef* ref)
+{
+	if (!pos || m_state == DT_STRAIGHTPATH_STATE_DONE)
+		return DT_FAILURE;
+
+	if (m_state == DT_STRAIGHTPATH_STATE_START)
+	{
+		m_state = m_pathSize > 1 ? DT_STRAIGHTPATH_STATE_FUNNEL : DT_STRAIGHTPATH_STATE_END;
+		dtVcopy(pos, m_portalApex);
+		if (flags)
+			*flags = DT_STRAIGHTPATH_START;
+		if (ref)
+			*ref = m_path[0];
+		return DT_IN_PROGRESS;
+	}
+
+	if (m_state == DT_STRAIGHTPATH_STATE_FUNNEL)
+	{
+		for (; m_portalIndex < m_pathSize; ++m_portalIndex)
+		{
+			const int i = m_portalIndex;
+			float left[3], right[3];
+			unsigned char toType;
+
+			if (i+1 < m_pathSize)
+			{
+				// Next portal.
+				if (dtStatusFailed(getPortal(i, left, right, toType)))
+				{
+					// Failed to get portal points, in practice this means that path[i+1] is invalid polygon.
+					// Clamp the end point to path[i], and end the path there.
+					m_state = DT_STRAIGHTPATH_STATE_DONE;
+					if (dtStatusFailed(m_query->closestPointOnPolyBoundary(m_path[i], m_endPos, m_closestEndPos)))
+						return DT_FAILURE | DT_INVALID_PARAM;
+
+					dtVcopy(pos, m_closestEndPos);
+					if (flags)
+						*flags = 0;
+					if (ref)
+						*ref = m_path[i];
+					return DT_SUCCESS | DT_PARTIAL_RESULT;
+				}
+
+				// If starting really close the portal, advance.
+				if (i == 0)
+				{
+					float t;
+					if (dtDistancePtSegSqr2D(m_portalApex, left, right, t) < dtSqr(0.001f))
+						continue;
+				}
+			}
+			else
+			{
+				// End of the path.
+				dtVcopy(left, m_closestEndPos);
+				dtVcopy(right, m_closestEndPos);
+
+				toType = DT_POLYTYPE_GROUND;
+			}
+
+			// Right vertex.
+			if (dtTriArea2D(m_portalApex, m_portalRight, right) <= 0.0f)
+			{
+				if (dtVequal(m_portalApex, m_portalRight) || dtTriArea2D(m_portalApex, m_portalLeft, right) > 0.0f)
+				{
+					dtVcopy(m_portalRight, right);
+					m_rightPolyRef = (i+1 < m_pathSize) ? m_path[i+1] : 0;
+					m_rightPolyType = toType;
+					m_rightIndex = i;
+				}
+				else
+				{
+					return advanceApex(m_portalLeft, m_leftPolyRef, m_leftPolyType, m_leftIndex, pos, flags, ref);
+				}
+			}
+
+			// Left vertex.
+			if (dtTriArea2D(m_portalApex, m_portalLeft, left) >= 0.0f)
+			{
+				if (dtVequal(m_portalApex, m_portalLeft) || dtTriArea2D(m_portalApex, m_portalRight, left) < 0.0f)
+				{
+					dtVcopy(m_portalLeft, left);
+					m_leftPolyRef = (i+1 < m_pathSize) ? m_path[i+1] : 0;
+					m_leftPolyType = toType;
+					m_leftIndex = i;
+				}
+				else
+				{
+					return advanceApex(m_portalRight, m_rightPolyRef, m_rightPolyType, m_rightIndex, pos, flags, ref);
+				}
+			}
+		}
+		m_state = DT_STRAIGHTPATH_STATE_END;
+	}
+
+	// Add end point.
+	m_state = DT_STRAIGHTPATH_STATE_DONE;
+	dtVcopy(pos, m_closestEndPos);
+	if (flags)
+		*flags = DT_STRAIGHTPATH_END;
+	if (ref)
+		*ref = 0;
+	return DT_SUCCESS;
+}
+
+/// @par
+///
+/// If the provided result buffers are too small for the remaining vertices, they are filled as far as
+/// possible and the following call continues from there.
+dtStatus dtStraightPathIterator::getStraightPath(float* straightPath, unsigned char* straightPathFlags,
+												 dtPolyRef* straightPathRefs,
+												 int* straightPathCount, const int maxStraightPath)
+{
+	if (!straightPathCount)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	*straightPathCount = 0;
+
+	if (!straightPath || maxStraightPath <= 0)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	for (;;)
+	{
+		const int n = *straightPathCount;
+		float pos[3];
+		unsigned char flags = 0;
+		dtPolyRef ref = 0;
+		const dtStatus stat = next(pos, &flags, &ref);
+		if (dtStatusFailed(stat))
+			return stat;
+
+		if (n > 0 && dtVequal(&straightPath[(n-1)*3], pos))
+		{
+			// The vertices are equal, update flags and poly.
+			if (straightPathFlags)
+				straightPathFlags[n-1] = flags;
+			if (straightPathRefs)
+				straightPathRefs[n-1] = ref;
+		}
+		else
+		{
+			// Append new vertex.
+			dtVcopy(&straightPath[n*3], pos);
+			if (straightPathFlags)
+				straightPathFlags[n] = flags;
+			if (straightPathRefs)
+				straightPathRefs[n] = ref;
+			(*straightPathCount)++;
+
+			// If there is no space to append more vertices, return.
+			if (*straightPathCount >= maxStraightPath)
+				return (stat & ~DT_IN_PROGRESS) | DT_SUCCESS | DT_BUFFER_TOO_SMALL;
+		}
+
+		if (!dtStatusInProgress(stat))
+			return stat | ((*straightPathCount >= maxStraightPath) ? DT_BUFFER_TOO_SMALL : 0);
+	}
+}
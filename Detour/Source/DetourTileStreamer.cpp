@@ -0,0 +1,501 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "DetourTileStreamer.h"
+#include "DetourCommon.h"
+#include "DetourMath.h"
+#include "DetourAlloc.h"
+#include "DetourAssert.h"
+
+enum dtStreamTileMode
+{
+	DT_STREAM_TILE_NONE = 0,		///< The tile is not resident.
+	DT_STREAM_TILE_READING,			///< The tile data is being read.
+	DT_STREAM_TILE_READ,			///< The tile data has been read and waits to be added.
+	DT_STREAM_TILE_RESIDENT,		///< The tile is in the navigation mesh.
+	DT_STREAM_TILE_FAILED			///< The tile could not be read or added. It is retried when the interest points change.
+};
+
+/// The streaming status of a tile of the tile set.
+struct dtStreamTileStatus
+{
+	dtTileRef ref;					///< The reference of the resident tile, or of the tile before it was removed.
+	unsigned char* data;			///< The read data waiting to be added.
+	int dataSize;					///< The size of the read or resident data.
+	unsigned char* state;			///< The tile state stored when the tile was removed.
+	int stateSize;
+	unsigned int lastUse;			///< The update the tile was last used in.
+	unsigned char mode;				///< The streaming mode. (See: #dtStreamTileMode)
+	bool wanted;					///< True if the tile is around an interest point.
+};
+
+struct dtStreamWantedTile
+{
+	float dist;
+	int index;
+};
+
+static int compareWantedTiles(const void* va, const void* vb)
+{
+	const dtStreamWantedTile* a = (const dtStreamWantedTile*)va;
+	const dtStreamWantedTile* b = (const dtStreamWantedTile*)vb;
+	if (a->dist < b->dist) return -1;
+	if (a->dist > b->dist) return 1;
+	return a->index - b->index;
+}
+
+// Squared distance on the xz-plane from a point to the bounds.
+static float distSqrPointBounds2D(const float* pt, const float* bmin, const float* bmax)
+{
+	const float dx = dtMax(dtMax(bmin[0] - pt[0], pt[0] - bmax[0]), 0.0f);
+	const float dz = dtMax(dtMax(bmin[2] - pt[2], pt[2] - bmax[2]), 0.0f);
+	return dx*dx + dz*dz;
+}
+
+dtTileStreamer* dtAllocTileStreamer()
+{
+	void* mem = dtAlloc(sizeof(dtTileStreamer), DT_ALLOC_PERM);
+	if (!mem) return 0;
+	return new(mem) dtTileStreamer;
+}
+
+void dtFreeTileStreamer(dtTileStreamer* streamer)
+{
+	if (!streamer) return;
+	streamer->~dtTileStreamer();
+	dtFree(streamer);
+}
+
+dtTileStreamer::dtTileStreamer() :
+	m_nav(0),
+	m_reader(0),
+	m_tiles(0),
+	m_status(0),
+	m_tileCount(0),
+	m_navTiles(0),
+	m_maxNavTiles(0),
+	m_wanted(0),
+	m_wantedCount(0),
+	m_memoryBudget(0),
+	m_usedMemory(0),
+	m_residentCount(0),
+	m_pendingReads(0),
+	m_frame(0)
+{
+}
+
+dtTileStreamer::~dtTileStreamer()
+{
+	purge();
+}
+
+void dtTileStreamer::purge()
+{
+	for (int i = 0; i < m_tileCount; ++i)
+	{
+		dtFree(m_status[i].data);
+		dtFree(m_status[i].state);
+	}
+	dtFree(m_tiles);
+	m_tiles = 0;
+	dtFree(m_status);
+	m_status = 0;
+	dtFree(m_navTiles);
+	m_navTiles = 0;
+	dtFree(m_wanted);
+	m_wanted = 0;
+	m_tileCount = 0;
+	m_maxNavTiles = 0;
+	m_wantedCount = 0;
+	m_usedMemory = 0;
+	m_residentCount = 0;
+	m_pendingReads = 0;
+	m_nav = 0;
+	m_reader = 0;
+}
+
+/// @par
+///
+/// The tiles must not be in the navigation mesh yet. The reads that are still in flight when
+/// the streamer is initialized again or destroyed are not polled anymore, the reader must
+/// release their data.
+dtStatus dtTileStreamer::init(dtNavMesh* nav, const dtStreamTile* tiles, const int tileCount,
+							  dtTileStreamReader* reader, const int memoryBudget)
+{
+	purge();
+
+	if (!nav || !reader || tileCount < 0 || (tileCount > 0 && !tiles) || memoryBudget < 0)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	m_maxNavTiles = nav->getMaxTiles();
+	m_tiles = (dtStreamTile*)dtAlloc(sizeof(dtStreamTile) * dtMax(tileCount, 1), DT_ALLOC_PERM);
+	m_status = (dtStreamTileStatus*)dtAlloc(sizeof(dtStreamTileStatus) * dtMax(tileCount, 1), DT_ALLOC_PERM);
+	m_wanted = (dtStreamWantedTile*)dtAlloc(sizeof(dtStreamWantedTile) * dtMax(tileCount, 1), DT_ALLOC_PERM);
+	m_navTiles = (int*)dtAlloc(sizeof(int) * dtMax(m_maxNavTiles, 1), DT_ALLOC_PERM);
+	if (!m_tiles || !m_status || !m_wanted || !m_navTiles)
+	{
+		purge();
+		return DT_FAILURE | DT_OUT_OF_MEMORY;
+	}
+	if (tileCount > 0)
+		memcpy(m_tiles, tiles, sizeof(dtStreamTile) * tileCount);
+	memset(m_status, 0, sizeof(dtStreamTileStatus) * dtMax(tileCount, 1));
+	for (int i = 0; i < m_maxNavTiles; ++i)
+		m_navTiles[i] = -1;
+
+	m_nav = nav;
+	m_reader = reader;
+	m_tileCount = tileCount;
+	m_memoryBudget = memoryBudget;
+	m_frame = 0;
+
+	return DT_SUCCESS;
+}
+
+dtStatus dtTileStreamer::setInterestPoints(const float* points, const int pointCount, const float radius)
+{
+	if (!m_nav)
+		return DT_FAILURE;
+	if (pointCount < 0 || (pointCount > 0 && !points) || !dtMathIsfinite(radius) || radius < 0.0f)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	const float radiusSqr = radius*radius;
+	m_wantedCount = 0;
+	for (int i = 0; i < m_tileCount; ++i)
+	{
+		const dtStreamTile& tile = m_tiles[i];
+		dtStreamTileStatus& st = m_status[i];
+
+		float distSqr = FLT_MAX;
+		for (int j = 0; j < pointCount; ++j)
+			distSqr = dtMin(distSqr, distSqrPointBounds2D(&points[j*3], tile.bmin, tile.bmax));
+
+		st.wanted = distSqr <= radiusSqr;
+		if (st.wanted)
+		{
+			m_wantedCount++;
+			m_wanted[m_wantedCount-1].dist = distSqr;
+			m_wanted[m_wantedCount-1].index = i;
+		}
+		if (st.mode == DT_STREAM_TILE_FAILED)
+			st.mode = DT_STREAM_TILE_NONE;
+	}
+	qsort(m_wanted, m_wantedCount, sizeof(dtStreamWantedTile), compareWantedTiles);
+
+	// Only the nearest tiles that fit the tile slots of the navigation mesh are wanted.
+	for (int i = m_maxNavTiles; i < m_wantedCount; ++i)
+		m_status[m_wanted[i].index].wanted = false;
+	m_wantedCount = dtMin(m_wantedCount, m_maxNavTiles);
+
+	// Drop the data of tiles that are not needed anymore.
+	for (int i = 0; i < m_tileCount; ++i)
+	{
+		dtStreamTileStatus& st = m_status[i];
+		if (st.wanted || st.mode != DT_STREAM_TILE_READ)
+			continue;
+		dtFree(st.data);
+		st.data = 0;
+		m_usedMemory -= st.dataSize;
+		st.mode = DT_STREAM_TILE_NONE;
+	}
+
+	return DT_SUCCESS;
+}
+
+void dtTileStreamer::touchPoly(dtPolyRef ref)
+{
+	if (!m_nav || !ref)
+		return;
+	const unsigned int it = m_nav->decodePolyIdTile(ref);
+	if (it >= (unsigned int)m_maxNavTiles || m_navTiles[it] < 0)
+		return;
+	dtStreamTileStatus& st = m_status[m_navTiles[it]];
+	if (st.mode == DT_STREAM_TILE_RESIDENT)
+		st.lastUse = m_frame;
+}
+
+bool dtTileStreamer::isTileResident(const int index) const
+{
+	if (index < 0 || index >= m_tileCount)
+		return false;
+	return m_status[index].mode == DT_STREAM_TILE_RESIDENT;
+}
+
+void dtTileStreamer::pollReads()
+{
+	int index = 0;
+	unsigned char* data = 0;
+	int dataSize = 0;
+	while (m_reader->pollRead(&index, &data, &dataSize))
+	{
+		if (index < 0 || index >= m_tileCount || m_status[index].mode != DT_STREAM_TILE_READING)
+		{
+			dtFree(data);
+			continue;
+		}
+		dtStreamTileStatus& st = m_status[index];
+		m_pendingReads--;
+		m_usedMemory -= m_tiles[index].dataSize;
+		if (!data)
+		{
+			st.mode = DT_STREAM_TILE_FAILED;
+		}
+		else if (!st.wanted)
+		{
+			dtFree(data);
+			st.mode = DT_STREAM_TILE_NONE;
+		}
+		else
+		{
+			st.data = data;
+			st.dataSize = dataSize;
+			st.mode = DT_STREAM_TILE_READ;
+			m_usedMemory += dataSize;
+		}
+	}
+}
+
+// Finds a free navigation mesh tile slot for a tile without a stored state. The slots of the
+// removed tiles with a stored state are reserved until they are added back, unless every
+// free slot is reserved.
+dtTileRef dtTileStreamer::findFreeTileRef()
+{
+	const dtNavMesh* nav = m_nav;
+	int reserved = -1;
+	for (int i = 0; i < m_maxNavTiles; ++i)
+	{
+		const dtMeshTile* tile = nav->getTile(i);
+		if (tile->header)
+			continue;
+		if (m_navTiles[i] == -1)
+			return m_nav->encodePolyId(tile->salt, (unsigned int)i, 0);
+		if (reserved == -1)
+			reserved = i;
+	}
+	if (reserved == -1)
+		return 0;
+
+	dtStreamTileStatus& owner = m_status[m_navTiles[reserved]];
+	dtFree(owner.state);
+	owner.state = 0;
+	m_navTiles[reserved] = -1;
+	return m_nav->encodePolyId(nav->getTile(reserved)->salt, (unsigned int)reserved, 0);
+}
+
+bool dtTileStreamer::hasFreeTileSlot() const
+{
+	const dtNavMesh* nav = m_nav;
+	for (int i = 0; i < m_maxNavTiles; ++i)
+	{
+		if (!nav->getTile(i)->header)
+			return true;
+	}
+	return false;
+}
+
+bool dtTileStreamer::addTile(const int index)
+{
+	dtStreamTileStatus& st = m_status[index];
+	dtAssert(st.mode == DT_STREAM_TILE_READ);
+
+	// A tile with a stored state is added back with its previous reference.
+	const dtTileRef lastRef = st.state ? st.ref : findFreeTileRef();
+	dtTileRef ref = 0;
+	const dtStatus status = lastRef ? m_nav->addTile(st.data, st.dataSize, DT_TILE_FREE_DATA, lastRef, &ref) : DT_FAILURE;
+	if (dtStatusFailed(status))
+	{
+		if (st.state)
+		{
+			m_navTiles[m_nav->decodePolyIdTile((dtPolyRef)st.ref)] = -1;
+			dtFree(st.state);
+			st.state = 0;
+		}
+		dtFree(st.data);
+		st.data = 0;
+		m_usedMemory -= st.dataSize;
+		st.mode = DT_STREAM_TILE_FAILED;
+		return false;
+	}
+
+	st.data = 0;
+	st.ref = ref;
+	st.mode = DT_STREAM_TILE_RESIDENT;
+	m_residentCount++;
+	m_navTiles[m_nav->decodePolyIdTile((dtPolyRef)ref)] = index;
+
+	if (st.state)
+	{
+		// The streamer added the tile, so it may modify it.
+		dtMeshTile* tile = const_cast<dtMeshTile*>(m_nav->getTileByRef(ref));
+		m_nav->restoreTileState(tile, st.state, st.stateSize);
+		dtFree(st.state);
+		st.state = 0;
+	}
+
+	return true;
+}
+
+bool dtTileStreamer::removeTile(const int index)
+{
+	dtStreamTileStatus& st = m_status[index];
+	dtAssert(st.mode == DT_STREAM_TILE_RESIDENT);
+
+	// Keep the tile state until the tile is added back.
+	const dtMeshTile* tile = m_nav->getTileByRef(st.ref);
+	if (tile)
+	{
+		st.stateSize = m_nav->getTileStateSize(tile);
+		st.state = (unsigned char*)dtAlloc(st.stateSize, DT_ALLOC_PERM);
+		if (st.state && dtStatusFailed(m_nav->storeTileState(tile, st.state, st.stateSize)))
+		{
+			dtFree(st.state);
+			st.state = 0;
+		}
+	}
+
+	const dtStatus status = m_nav->removeTile(st.ref, 0, 0);
+	const unsigned int it = m_nav->decodePolyIdTile((dtPolyRef)st.ref);
+	m_navTiles[it] = st.state ? index : -1;
+	m_usedMemory -= st.dataSize;
+	m_residentCount--;
+	st.mode = DT_STREAM_TILE_NONE;
+
+	return dtStatusSucceed(status);
+}
+
+// Finds the least recently used resident tile that is not around the interest points.
+int dtTileStreamer::findEvictable() const
+{
+	int best = -1;
+	for (int i = 0; i < m_tileCount; ++i)
+	{
+		const dtStreamTileStatus& st = m_status[i];
+		if (st.mode != DT_STREAM_TILE_RESIDENT || st.wanted)
+			continue;
+		if (best == -1 || st.lastUse < m_status[best].lastUse)
+			best = i;
+	}
+	return best;
+}
+
+/// @par
+///
+/// The tiles around the interest points are handled nearest first. Tiles that have been read
+/// are added, and reads are started for the others while the memory budget allows it. Tiles
+/// outside the interest points are only removed to make room for new reads, or for new
+/// tiles when every tile slot of the navigation mesh is in use.
+dtStatus dtTileStreamer::update(const int maxCommits, bool* upToDate)
+{
+	if (upToDate)
+		*upToDate = false;
+	if (!m_nav)
+		return DT_FAILURE;
+	if (maxCommits <= 0)
+		return DT_FAILURE | DT_INVALID_PARAM;
+
+	m_frame++;
+	for (int i = 0; i < m_wantedCount; ++i)
+		m_status[m_wanted[i].index].lastUse = m_frame;
+
+	pollReads();
+
+	// Link the tiles added and removed in this update in one pass.
+	const bool batch = !m_nav->isTileBatchOpen() && dtStatusSucceed(m_nav->beginTileBatch());
+
+	int commits = 0;
+	bool canRead = true;
+	bool done = true;
+	for (int i = 0; i < m_wantedCount; ++i)
+	{
+		const int index = m_wanted[i].index;
+		dtStreamTileStatus& st = m_status[index];
+
+		if (st.mode == DT_STREAM_TILE_READ)
+		{
+			if (commits >= maxCommits)
+			{
+				done = false;
+				continue;
+			}
+
+			// Make room in the navigation mesh for the tile. A tile with a stored state
+			// keeps its slot reserved.
+			if (!st.state && !hasFreeTileSlot())
+			{
+				const int evict = findEvictable();
+				if (evict != -1)
+				{
+					removeTile(evict);
+					commits++;
+					if (commits >= maxCommits)
+					{
+						done = false;
+						continue;
+					}
+				}
+			}
+			addTile(index);
+			commits++;
+		}
+		else if (st.mode == DT_STREAM_TILE_NONE && canRead)
+		{
+			const int dataSize = m_tiles[index].dataSize;
+
+			// Make room for the tile.
+			while (m_usedMemory + dataSize > m_memoryBudget && commits < maxCommits)
+			{
+				const int evict = findEvictable();
+				if (evict == -1)
+					break;
+				removeTile(evict);
+				commits++;
+			}
+			if (m_usedMemory + dataSize > m_memoryBudget)
+			{
+				// Nearer tiles fill the budget, unless the remaining commits were not enough to free it.
+				if (commits >= maxCommits && findEvictable() != -1)
+					done = false;
+				canRead = false;
+				continue;
+			}
+
+			if (!m_reader->beginRead(index, m_tiles[index]))
+			{
+				done = false;
+				canRead = false;
+				continue;
+			}
+			st.mode = DT_STREAM_TILE_READING;
+			m_usedMemory += dataSize;
+			m_pendingReads++;
+		}
+	}
+
+	if (batch)
+		m_nav->commitTileBatch();
+
+	if (upToDate)
+		*upToDate = done && m_pendingReads == 0;
+
+	return DT_SUCCESS;
+}
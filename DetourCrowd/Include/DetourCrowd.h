@@ -216,6 +216,9 @@ class dtCrowd
 	
 	dtPolyRef* m_pathResult;
 	int m_maxPathResult;
+
+	dtPolyRef* m_pathPool;			///< The path buffers of the agent corridors. [(polyRef) * #m_maxPathResult * #m_maxAgents]
+	dtStraightPathPortal* m_portalPool;	///< The portal caches of the agent corridors. [(portal) * #DT_PATHCORRIDOR_MAX_CACHED_PORTALS * #m_maxAgents]
 	
 	float m_agentPlacementHalfExtents[3];
 
@@ -227,8 +230,8 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
-	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
-	void updateMoveRequest(const float dt);
+	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt, const int maxIters);
+	int updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
 
 	inline int getAgentIndex(const dtCrowdAgent* agent) const  { return (int)(agent - m_agents); }
@@ -245,8 +248,9 @@ public:
 	///  @param[in]		maxAgents		The maximum number of agents the crowd can manage. [Limit: >= 1]
 	///  @param[in]		maxAgentRadius	The maximum radius of any agent that will be added to the crowd. [Limit: > 0]
 	///  @param[in]		nav				The navigation mesh to use for planning.
+	///  @param[in]		maxPath			The maximum number of polygons in the path corridor of an agent. [Limit: >= 1]
 	/// @return True if the initialization succeeded.
-	bool init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav);
+	bool init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav, const int maxPath = 256);
 	
 	/// Sets the shared avoidance configuration for the specified index.
 	///  @param[in]		idx		The index. [Limits: 0 <= value < #DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS]
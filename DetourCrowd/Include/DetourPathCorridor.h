@@ -20,6 +20,12 @@
 #define DETOUTPATHCORRIDOR_H
 
 #include "DetourNavMeshQuery.h"
+#include "DetourStraightPath.h"
+
+/// The number of portals from the start of a corridor that #dtPathCorridor caches for #dtPathCorridor::findCorners.
+/// Corners are looked up near the start of the corridor, portals further away are rarely reused.
+/// @ingroup crowd
+static const int DT_PATHCORRIDOR_MAX_CACHED_PORTALS = 32;
 
 /// Represents a dynamic polygon corridor used to plan agent movement.
 /// @ingroup crowd, detour
@@ -31,15 +37,32 @@ class dtPathCorridor
 	dtPolyRef* m_path;
 	int m_npath;
 	int m_maxPath;
+	bool m_ownsPath;
+
+	float m_visOptNext[3];
+	dtPolyRef m_visOptRef;
+
+	dtStraightPathIterator m_straightPath;
 	
 public:
 	dtPathCorridor();
 	~dtPathCorridor();
 	
-	/// Allocates the corridor's path buffer. 
+	/// Allocates the corridor's path buffer and portal cache.
 	///  @param[in]		maxPath		The maximum path size the corridor can handle.
 	/// @return True if the initialization succeeded.
 	bool init(const int maxPath);
+
+	/// Uses a path buffer and portal cache owned by the caller, such as parts of buffers shared by many
+	/// corridors. Does not allocate.
+	///  @param[in]		path		The path buffer. Must outlive the corridor. [(polyRef) * @p maxPath]
+	///  @param[in]		maxPath		The maximum path size the corridor can handle.
+	///  @param[in]		portals		The portal cache of #findCorners. Must outlive the corridor.
+	///  							[(portal) * @p maxPortals] [opt]
+	///  @param[in]		maxPortals	The number of portals the cache can hold.
+	///  							[Limits: 0 <= value <= #DT_PATHCORRIDOR_MAX_CACHED_PORTALS]
+	/// @return True if the initialization succeeded.
+	bool init(dtPolyRef* path, const int maxPath, dtStraightPathPortal* portals = 0, const int maxPortals = 0);
 	
 	/// Resets the path corridor to the specified position.
 	///  @param[in]		ref		The polygon reference containing the position.
@@ -64,13 +87,18 @@ public:
 	///  @param[in]		pathOptimizationRange	The maximum range to search. [Limit: > 0]
 	///  @param[in]		navquery				The query object used to build the corridor.
 	///  @param[in]		filter					The filter to apply to the operation.			
+	///  @param[in]		skipUnchanged			Skips the search if @p next and the first polygon of the
+	///  										corridor are the same as in the previous optimization.
 	void optimizePathVisibility(const float* next, const float pathOptimizationRange,
-								dtNavMeshQuery* navquery, const dtQueryFilter* filter);
+								dtNavMeshQuery* navquery, const dtQueryFilter* filter,
+								const bool skipUnchanged = false);
 	
 	/// Attempts to optimize the path using a local area search. (Partial replanning.) 
-	///  @param[in]		navquery	The query object used to build the corridor.
-	///  @param[in]		filter		The filter to apply to the operation.	
-	bool optimizePathTopology(dtNavMeshQuery* navquery, const dtQueryFilter* filter);
+	///  @param[in]		navquery		The query object used to build the corridor.
+	///  @param[in]		filter			The filter to apply to the operation.	
+	///  @param[in]		maxIterations	The maximum number of iterations of the search. [Limit: > 0]
+	bool optimizePathTopology(dtNavMeshQuery* navquery, const dtQueryFilter* filter,
+							  const int maxIterations = 32);
 	
 	bool moveOverOffmeshConnection(dtPolyRef offMeshConRef, dtPolyRef* refs,
 								   float* startPos, float* endPos,
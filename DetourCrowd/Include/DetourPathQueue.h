@@ -58,7 +58,10 @@ public:
 	
 	bool init(const int maxPathSize, const int maxSearchNodeCount, dtNavMesh* nav);
 	
-	void update(const int maxIters);
+	/// Runs the path searches of the queued requests.
+	///  @param[in]		maxIters	The maximum number of search iterations.
+	/// @return The number of search iterations done.
+	int update(const int maxIters);
 	
 	dtPathQueueRef request(dtPolyRef startRef, dtPolyRef endRef,
 						   const float* startPos, const float* endPos, 
@@ -321,8 +321,8 @@ Notes:
   performed.
 - Agent objects are kept in a pool and re-used.  So it is important when using agent objects to check the value of
   #dtCrowdAgent::active to determine if the agent is actually in use or not.
-- This class is meant to provide 'local' movement. There is a limit of 256 polygons in the path corridor.  
-  So it is not meant to provide automatic pathfinding services over long distances.
+- This class is meant to provide 'local' movement. The path corridors have a limit of 256 polygons by default
+  (see #init()). So it is not meant to provide automatic pathfinding services over long distances.
 
 @see dtAllocCrowd(), dtFreeCrowd(), init(), dtCrowdAgent
 
@@ -337,6 +337,8 @@ dtCrowd::dtCrowd() :
 	m_grid(0),
 	m_pathResult(0),
 	m_maxPathResult(0),
+	m_pathPool(0),
+	m_portalPool(0),
 	m_maxAgentRadius(0),
 	m_velocitySampleCount(0),
 	m_navquery(0)
@@ -364,6 +366,12 @@ void dtCrowd::purge()
 	
 	dtFree(m_pathResult);
 	m_pathResult = 0;
+
+	dtFree(m_pathPool);
+	m_pathPool = 0;
+
+	dtFree(m_portalPool);
+	m_portalPool = 0;
 	
 	dtFreeProximityGrid(m_grid);
 	m_grid = 0;
@@ -378,10 +386,16 @@ void dtCrowd::purge()
 /// @par
 ///
 /// May be called more than once to purge and re-initialize the crowd.
-bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav)
+///
+/// The path corridors of the agents share a single buffer of @p maxPath polygons per agent, and
+/// a single buffer for their portal caches.
+bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav, const int maxPath)
 {
 	purge();
 	
+	if (maxPath < 1)
+		return false;
+	
 	m_maxAgents = maxAgents;
 	m_maxAgentRadius = maxAgentRadius;
 
@@ -418,7 +432,7 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	}
 	
 	// Allocate temp buffer for merging paths.
-	m_maxPathResult = 256;
+	m_maxPathResult = maxPath;
 	m_pathResult = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef)*m_maxPathResult, DT_ALLOC_PERM);
 	if (!m_pathResult)
 		return false;
@@ -426,6 +440,15 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	if (!m_pathq.init(m_maxPathResult, MAX_PATHQUEUE_NODES, nav))
 		return false;
 	
+	// The path buffers and portal caches of the agent corridors.
+	m_pathPool = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef)*m_maxPathResult*m_maxAgents, DT_ALLOC_PERM);
+	if (!m_pathPool)
+		return false;
+	const int maxPortals = dtMin(m_maxPathResult, DT_PATHCORRIDOR_MAX_CACHED_PORTALS);
+	m_portalPool = (dtStraightPathPortal*)dtAlloc(sizeof(dtStraightPathPortal)*maxPortals*m_maxAgents, DT_ALLOC_PERM);
+	if (!m_portalPool)
+		return false;
+	
 	m_agents = (dtCrowdAgent*)dtAlloc(sizeof(dtCrowdAgent)*m_maxAgents, DT_ALLOC_PERM);
 	if (!m_agents)
 		return false;
@@ -442,7 +465,8 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	{
 		new(&m_agents[i]) dtCrowdAgent();
 		m_agents[i].active = false;
-		if (!m_agents[i].corridor.init(m_maxPathResult))
+		if (!m_agents[i].corridor.init(&m_pathPool[i*m_maxPathResult], m_maxPathResult,
+									   &m_portalPool[i*maxPortals], maxPortals))
 			return false;
 	}
 
@@ -674,7 +698,8 @@ int dtCrowd::getActiveAgents(dtCrowdAgent** agents, const int maxAgents)
 }
 
 
-void dtCrowd::updateMoveRequest(const float /*dt*/)
+// Returns the number of path finder iterations left in the update.
+int dtCrowd::updateMoveRequest(const float /*dt*/)
 {
 	const int PATH_MAX_AGENTS = 8;
 	dtCrowdAgent* queue[PATH_MAX_AGENTS];
@@ -779,7 +804,7 @@ void dtCrowd::updateMoveRequest(const float /*dt*/)
 
 	
 	// Update requests.
-	m_pathq.update(MAX_ITERS_PER_UPDATE);
+	const int pathIters = m_pathq.update(MAX_ITERS_PER_UPDATE);
 
 	dtStatus status;
 
@@ -901,16 +926,19 @@ void dtCrowd::updateMoveRequest(const float /*dt*/)
 		}
 	}
 	
+	return MAX_ITERS_PER_UPDATE - pathIters;
 }
 
 
-void dtCrowd::updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt)
+void dtCrowd::updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt, const int maxIters)
 {
 	if (!nagents)
 		return;
 	
 	const float OPT_TIME_THR = 0.5f; // seconds
-	const int OPT_MAX_AGENTS = 1;
+	const int OPT_ITERS = 32;
+	// At most the iterations of a whole update are left for the optimization.
+	const int OPT_MAX_AGENTS = MAX_ITERS_PER_UPDATE / OPT_ITERS;
 	dtCrowdAgent* queue[OPT_MAX_AGENTS];
 	int nqueue = 0;
 	
@@ -928,11 +956,15 @@ void dtCrowd::updateTopologyOptimization(dtCrowdAgent** agents, const int nagent
 			nqueue = addToOptQueue(ag, queue, nqueue, OPT_MAX_AGENTS);
 	}
 
-	for (int i = 0; i < nqueue; ++i)
+	// The agent that waited the longest is always optimized, the others share the iterations
+	// the path finder left in this update.
+	int iters = dtMax(maxIters, OPT_ITERS);
+	for (int i = 0; i < nqueue && iters >= OPT_ITERS; ++i)
 	{
 		dtCrowdAgent* ag = queue[i];
-		ag->corridor.optimizePathTopology(m_navquery, &m_filters[ag->params.queryFilterType]);
+		ag->corridor.optimizePathTopology(m_navquery, &m_filters[ag->params.queryFilterType], OPT_ITERS);
 		ag->topologyOptTime = 0;
+		iters -= OPT_ITERS;
 	}
 
 }
@@ -1056,10 +1088,10 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 	checkPathValidity(agents, nagents, dt);
 	
 	// Update async move request and path finder.
-	updateMoveRequest(dt);
+	const int optIters = updateMoveRequest(dt);
 
 	// Optimize path topology.
-	updateTopologyOptimization(agents, nagents, dt);
+	updateTopologyOptimization(agents, nagents, dt, optIters);
 	
 	// Register agents to proximity grid.
 	m_grid->clear();
@@ -1114,7 +1146,8 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		if ((ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS) && ag->ncorners > 0)
 		{
 			const float* target = &ag->cornerVerts[dtMin(1,ag->ncorners-1)*3];
-			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, m_navquery, &m_filters[ag->params.queryFilterType]);
+			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, m_navquery,
+												&m_filters[ag->params.queryFilterType], true);
 			
 			// Copy data for debug purposes.
 			if (debugIdx == i)
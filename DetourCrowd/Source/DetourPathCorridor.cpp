@@ -165,7 +165,8 @@ agent locomotion.
 
 Example of a common use case:
 
--# Construct the corridor object and call #init() to allocate its path buffer.
+-# Construct the corridor object and call #init() to allocate its path buffer, or to give it a part of
+   a buffer shared by many corridors.
 -# Obtain a path from a #dtNavMeshQuery object.
 -# Use #reset() to set the agent's current position. (At the beginning of the path.)
 -# Use #setCorridor() to load the path and target.
@@ -200,13 +201,17 @@ may be needed.  E.g. If you move the target, check #getLastPoly() to see if it i
 dtPathCorridor::dtPathCorridor() :
 	m_path(0),
 	m_npath(0),
-	m_maxPath(0)
+	m_maxPath(0),
+	m_ownsPath(false),
+	m_visOptRef(0)
 {
+	dtVset(m_visOptNext, 0, 0, 0);
 }
 
 dtPathCorridor::~dtPathCorridor()
 {
-	dtFree(m_path);
+	if (m_ownsPath)
+		dtFree(m_path);
 }
 
 /// @par
@@ -215,11 +220,35 @@ dtPathCorridor::~dtPathCorridor()
 bool dtPathCorridor::init(const int maxPath)
 {
 	dtAssert(!m_path);
-	m_path = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef)*maxPath, DT_ALLOC_PERM);
-	if (!m_path)
+	dtPolyRef* path = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef)*maxPath, DT_ALLOC_PERM);
+	if (!path)
 		return false;
+	if (!init(path, maxPath) || !m_straightPath.init(dtMin(maxPath, DT_PATHCORRIDOR_MAX_CACHED_PORTALS)))
+	{
+		dtFree(path);
+		m_path = 0;
+		return false;
+	}
+	m_ownsPath = true;
+	return true;
+}
+
+/// @par
+///
+/// The corridor does not free the buffers. Without a portal cache, #findCorners queries all
+/// the portals it passes on every call.
+///
+/// @warning Cannot be called more than once, or after #init(const int).
+bool dtPathCorridor::init(dtPolyRef* path, const int maxPath, dtStraightPathPortal* portals, const int maxPortals)
+{
+	dtAssert(!m_path);
+	if (!path || maxPath <= 0)
+		return false;
+	m_path = path;
+	m_straightPath.init(portals, dtMin(maxPortals, maxPath));
 	m_npath = 0;
 	m_maxPath = maxPath;
+	m_visOptRef = 0;
 	return true;
 }
 
@@ -234,6 +263,7 @@ void dtPathCorridor::reset(dtPolyRef ref, const float* pos)
 	dtVcopy(m_target, pos);
 	m_path[0] = ref;
 	m_npath = 1;
+	m_visOptRef = 0;
 }
 
 /**
@@ -247,6 +277,9 @@ For example: If the buffers are sized to hold 10 corners, the function will neve
 So if 10 corners are needed, the buffers should be sized for 11 corners.
 
 If the target is within range, it will be the last corner and have a polygon reference id of zero.
+
+The portals at the start of the corridor are cached between calls, so moving the position along the 
+corridor does not query the same portals again.
 */
 int dtPathCorridor::findCorners(float* cornerVerts, unsigned char* cornerFlags,
 							  dtPolyRef* cornerPolys, const int maxCorners,
@@ -258,8 +291,8 @@ int dtPathCorridor::findCorners(float* cornerVerts, unsigned char* cornerFlags,
 	static const float MIN_TARGET_DIST = 0.01f;
 	
 	int ncorners = 0;
-	navquery->findStraightPath(m_pos, m_target, m_path, m_npath,
-							   cornerVerts, cornerFlags, cornerPolys, &ncorners, maxCorners);
+	m_straightPath.begin(navquery, m_pos, m_target, m_path, m_npath);
+	m_straightPath.getStraightPath(cornerVerts, cornerFlags, cornerPolys, &ncorners, maxCorners);
 	
 	// Prune points in the beginning of the path which are too close.
 	while (ncorners)
@@ -305,13 +338,26 @@ is better than following the existing path.
 The more inaccurate the agent movement, the more beneficial this function becomes. Simply adjust the frequency 
 of the call to match the needs to the agent.
 
+With @p skipUnchanged, the search is only done again when @p next changes or the position moves to another 
+polygon, which is enough when the function is called every update with the next corner of the corridor.
+Loading a new corridor with #setCorridor() or #reset() always allows the next search.
+
 This function is not suitable for long distance searches.
 */
 void dtPathCorridor::optimizePathVisibility(const float* next, const float pathOptimizationRange,
-										  dtNavMeshQuery* navquery, const dtQueryFilter* filter)
+										  dtNavMeshQuery* navquery, const dtQueryFilter* filter,
+										  const bool skipUnchanged)
 {
 	dtAssert(m_path);
 	
+	if (skipUnchanged && m_visOptRef == m_path[0] &&
+		next[0] == m_visOptNext[0] && next[1] == m_visOptNext[1] && next[2] == m_visOptNext[2])
+	{
+		return;
+	}
+	m_visOptRef = m_path[0];
+	dtVcopy(m_visOptNext, next);
+
 	// Clamp the ray to max distance.
 	float goal[3];
 	dtVcopy(goal, next);
@@ -349,8 +395,11 @@ local area path search to try to re-optimize the corridor.
 
 The more inaccurate the agent movement, the more beneficial this function becomes. Simply adjust the frequency of 
 the call to match the needs to the agent.
+
+The search stops after @p maxIterations iterations, and the corridor is shortcut to the best polygon found by then.
 */
-bool dtPathCorridor::optimizePathTopology(dtNavMeshQuery* navquery, const dtQueryFilter* filter)
+bool dtPathCorridor::optimizePathTopology(dtNavMeshQuery* navquery, const dtQueryFilter* filter,
+										  const int maxIterations)
 {
 	dtAssert(navquery);
 	dtAssert(filter);
@@ -359,13 +408,12 @@ bool dtPathCorridor::optimizePathTopology(dtNavMeshQuery* navquery, const dtQuer
 	if (m_npath < 3)
 		return false;
 	
-	static const int MAX_ITER = 32;
 	static const int MAX_RES = 32;
 	
 	dtPolyRef res[MAX_RES];
 	int nres = 0;
 	navquery->initSlicedFindPath(m_path[0], m_path[m_npath-1], m_pos, m_target, filter);
-	navquery->updateSlicedFindPath(MAX_ITER, 0);
+	navquery->updateSlicedFindPath(maxIterations, 0);
 	dtStatus status = navquery->finalizeSlicedFindPathPartial(m_path, m_npath, res, &nres, MAX_RES);
 	
 	if (dtStatusSucceed(status) && nres > 0)
@@ -517,6 +565,7 @@ void dtPathCorridor::setCorridor(const float* target, const dtPolyRef* path, con
 	dtVcopy(m_target, target);
 	memcpy(m_path, path, sizeof(dtPolyRef)*npath);
 	m_npath = npath;
+	m_visOptRef = 0;
 }
 
 bool dtPathCorridor::fixPathStart(dtPolyRef safeRef, const float* safePos)
@@ -94,10 +94,24 @@ enum rcTimerLabel
 	RC_TIMER_BUILD_POLYMESHDETAIL,
 	/// The time to merge polygon mesh details. (See: #rcMergePolyMeshDetails)
 	RC_TIMER_MERGE_POLYMESHDETAIL,
+	/// The time to build the triangle bounding volume hierarchy. (See: #rcBuildTriMeshBVH)
+	RC_TIMER_BUILD_TRIMESHBVH,
 	/// The maximum number of timers.  (Used for iterating timers.)
 	RC_MAX_TIMERS
 };
 
+/// A piece of build work that is split into independent parts. (See: rcContext::runParallel)
+/// @ingroup recast
+class rcParallelTask
+{
+public:
+	virtual ~rcParallelTask() {}
+
+	/// Runs one part of the task. Different parts may run at the same time.
+	///  @param[in]		part	The index of the part. [Limit: 0 <= @p part < part count]
+	virtual void runPart(const int part) = 0;
+};
+
 /// Provides an interface for optional logging and performance tracking of the Recast 
 /// build process.
 /// 
@@ -109,6 +123,11 @@ enum rcTimerLabel
 ///
 /// If no logging or timers are required, just pass an instance of this 
 /// class through the Recast build process.
+///
+/// The build steps that can split their work into independent parts run them
+/// through #runParallel. By default the parts run one after the other on the calling
+/// thread. Implementations can run them on several threads by overriding
+/// #doGetParallelParts and #doRunParallel.
 /// 
 /// @ingroup recast
 class rcContext
@@ -158,6 +177,15 @@ public:
 	/// @return The accumulated time of the timer, or -1 if timers are disabled or the timer has never been started.
 	inline int getAccumulatedTime(const rcTimerLabel label) const { return m_timerEnabled ? doGetAccumulatedTime(label) : -1; }
 
+	/// Returns the number of parts that the build steps split their parallel work into.
+	/// @return The number of parts. (At least 1.)
+	inline int getParallelParts() const { const int n = doGetParallelParts(); return n > 1 ? n : 1; }
+
+	/// Runs all the parts of a task and returns when they have finished.
+	///  @param[in]		task		The task to run.
+	///  @param[in]		partCount	The number of parts of the task.
+	inline void runParallel(rcParallelTask& task, const int partCount) { doRunParallel(task, partCount); }
+
 protected:
 	/// Clears all log entries.
 	virtual void doResetLog();
@@ -183,6 +211,19 @@ protected:
 	/// @param[in]		label	The category of the timer.
 	/// @return The accumulated time of the timer, or -1 if timers are disabled or the timer has never been started.
 	virtual int doGetAccumulatedTime(const rcTimerLabel label) const { rcIgnoreUnused(label); return -1; }
+
+	/// Returns the number of parts that the build steps split their parallel work into.
+	/// The output of the build does not depend on it. More parts than threads balance
+	/// the uneven parts better.
+	/// @return The number of parts.
+	virtual int doGetParallelParts() const { return 1; }
+
+	/// Runs all the parts of a task and returns when they have finished.
+	/// The parts can run in any order and on any threads. When they run at the same time,
+	/// the logging and timer functions can also be called from several threads at once.
+	///  @param[in]		task		The task to run.
+	///  @param[in]		partCount	The number of parts of the task.
+	virtual void doRunParallel(rcParallelTask& task, const int partCount) { for (int i = 0; i < partCount; ++i) task.runPart(i); }
 	
 	/// True if logging is enabled.
 	bool m_logEnabled;
@@ -500,6 +541,58 @@ private:
 	rcPolyMeshDetail& operator=(const rcPolyMeshDetail&);
 };
 
+/// A node of a triangle bounding volume hierarchy. (See: #rcTriMeshBVH)
+/// @ingroup recast
+struct rcTriMeshBVHNode
+{
+	float bmin[3];			///< The minimum bounds of the triangles in the node. [(x, y, z)]
+	float bmax[3];			///< The maximum bounds of the triangles in the node. [(x, y, z)]
+	int parent;				///< The index of the parent node, or -1 for the root.
+	int child;				///< The index of the first of the two adjacent child nodes, or -1 for a leaf.
+	int first;				///< The index of the first triangle slot of a leaf in rcTriMeshBVH::items.
+	int count;				///< The number of triangles in a leaf.
+};
+
+/// A triangle slot in a leaf of a triangle bounding volume hierarchy. (See: #rcTriMeshBVH)
+/// @ingroup recast
+struct rcTriMeshBVHItem
+{
+	float bmin[3];			///< The minimum bounds of the triangle. [(x, y, z)]
+	float bmax[3];			///< The maximum bounds of the triangle. [(x, y, z)]
+	int tri;				///< The index of the triangle in the mesh.
+};
+
+/// A bounding volume hierarchy of the triangles of a mesh, used to find the triangles that
+/// overlap a tile, a box or a segment without testing every triangle.
+/// 
+/// Each leaf owns a block of #trisPerLeaf triangle slots, so that triangles can be inserted
+/// and removed after the build. The children of a node are adjacent and have larger indices
+/// than the node.
+/// @ingroup recast
+/// @see rcAllocTriMeshBVH, rcBuildTriMeshBVH
+struct rcTriMeshBVH
+{
+	rcTriMeshBVH();
+	~rcTriMeshBVH();
+
+	rcTriMeshBVHNode* nodes;	///< The nodes. The root is the first node. [Size: #nnodes]
+	rcTriMeshBVHItem* items;	///< The triangle slots of the leaves. [Size: #nblocks * #trisPerLeaf]
+	int* blockLeaf;				///< The leaf node of each block of triangle slots. [Size: #nblocks]
+	int* triSlots;				///< The slot of each triangle, or -1 if the triangle is not in the hierarchy. [Size: #maxTris]
+	int nnodes;					///< The number of nodes.
+	int maxNodes;				///< The number of allocated nodes.
+	int nblocks;				///< The number of blocks of triangle slots.
+	int maxBlocks;				///< The number of allocated blocks.
+	int maxTris;				///< The size of the triangle slot lookup.
+	int ntris;					///< The number of triangles in the hierarchy.
+	int trisPerLeaf;			///< The maximum number of triangles in a leaf.
+
+private:
+	// Explicitly-disabled copy constructor and copy assignment operator.
+	rcTriMeshBVH(const rcTriMeshBVH&);
+	rcTriMeshBVH& operator=(const rcTriMeshBVH&);
+};
+
 /// @name Allocation Functions
 /// Functions used to allocate and de-allocate Recast objects.
 /// @see rcAllocSetCustom
@@ -577,6 +670,18 @@ rcPolyMeshDetail* rcAllocPolyMeshDetail();
 /// @see rcAllocPolyMeshDetail
 void rcFreePolyMeshDetail(rcPolyMeshDetail* detailMesh);
 
+/// Allocates a triangle bounding volume hierarchy using the Recast allocator.
+/// @return A triangle hierarchy that is ready for initialization, or null on failure.
+/// @ingroup recast
+/// @see rcBuildTriMeshBVH, rcFreeTriMeshBVH
+rcTriMeshBVH* rcAllocTriMeshBVH();
+
+/// Frees the specified triangle bounding volume hierarchy using the Recast allocator.
+/// @param[in]		bvh		A triangle hierarchy allocated using #rcAllocTriMeshBVH
+/// @ingroup recast
+/// @see rcAllocTriMeshBVH
+void rcFreeTriMeshBVH(rcTriMeshBVH* bvh);
+
 /// @}
 
 /// Heightfield border flag.
@@ -1099,7 +1204,7 @@ bool rcBuildCompactHeightfield(rcContext* context, int walkableHeight, int walka
 /// @ingroup recast
 ///
 /// @param[in,out]	context				The build context to use during the operation.
-/// @param[in]		erosionRadius		The radius of erosion. [Limits: 0 < value < 255] [Units: vx]
+/// @param[in]		erosionRadius		The radius of erosion. [Limits: 0 < value < 32768] [Units: vx]
 /// @param[in,out]	compactHeightfield	The populated compact heightfield to erode.
 /// @returns True if the operation completed successfully.
 bool rcErodeWalkableArea(rcContext* context, int erosionRadius, rcCompactHeightfield& compactHeightfield);
@@ -1151,6 +1256,34 @@ void rcMarkConvexPolyArea(rcContext* context, const float* verts, int numVerts,
 						  float minY, float maxY, unsigned char areaId,
 						  rcCompactHeightfield& compactHeightfield);
 
+/// A convex polygon volume marked by #rcMarkConvexPolyAreas.
+/// @see rcMarkConvexPolyArea
+/// @ingroup recast
+struct rcConvexPolyVolume
+{
+	const float* verts;		///< The vertices of the polygon. [(x, y, z) * #numVerts]
+	int numVerts;			///< The number of vertices in the polygon.
+	float minY;				///< The height of the base of the polygon. [Units: wu]
+	float maxY;				///< The height of the top of the polygon. [Units: wu]
+	unsigned char areaId;	///< The area id to apply. [Limit: <= #RC_WALKABLE_AREA]
+};
+
+/// Applies the area ids of many convex polygon volumes to the spans within them.
+///
+/// The result is the same as calling #rcMarkConvexPolyArea for each volume in order: where
+/// volumes overlap the last one wins, and spans marked with #RC_NULL_AREA stay unwalkable.
+/// 
+/// @see rcCompactHeightfield, rcConvexPolyVolume, rcMarkConvexPolyArea
+/// @ingroup recast
+/// 
+/// @param[in,out]	context				The build context to use during the operation.
+/// @param[in]		volumes				The volumes to apply. [Size: @p numVolumes]
+/// @param[in]		numVolumes			The number of volumes.
+/// @param[in,out]	compactHeightfield	A populated compact heightfield.
+/// @returns True if the operation completed successfully.
+bool rcMarkConvexPolyAreas(rcContext* context, const rcConvexPolyVolume* volumes, int numVolumes,
+						   rcCompactHeightfield& compactHeightfield);
+
 /// Expands a convex polygon along its vertex normals by the given offset amount.
 /// Inserts extra vertices to bevel sharp corners.
 ///
@@ -1181,6 +1314,27 @@ int rcOffsetPoly(const float* verts, int numVerts, float offset, float* outVerts
 void rcMarkCylinderArea(rcContext* context, const float* position, float radius, float height,
 						unsigned char areaId, rcCompactHeightfield& compactHeightfield);
 
+/// The spans the distances of #rcCalcBoundaryDistance are measured from.
+/// @ingroup recast
+enum rcBoundaryType
+{
+	/// Unwalkable spans, and walkable spans with a missing or unwalkable neighbour. (Used by #rcErodeWalkableArea)
+	RC_BOUNDARY_WALKABLE = 0,
+	/// Spans with a missing neighbour or a neighbour of another area. (Used by #rcBuildDistanceField)
+	RC_BOUNDARY_AREA = 1,
+};
+
+/// Computes the distance of each span of the compact heightfield to the nearest boundary span.
+/// @ingroup recast
+/// @param[in,out]	ctx				The build context to use during the operation.
+/// @param[in]		chf				A populated compact heightfield.
+/// @param[in]		boundaryType	The spans the distances are measured from. (See: #rcBoundaryType)
+/// @param[out]		distances		The distance of each span, 2 per cell. [(distance) * rcCompactHeightfield::spanCount]
+/// @param[out]		maxDistance		The maximum distance of any span. [opt]
+/// @returns True if the operation completed successfully.
+bool rcCalcBoundaryDistance(rcContext* ctx, const rcCompactHeightfield& chf, int boundaryType,
+							unsigned short* distances, unsigned short* maxDistance = 0);
+
 /// Builds the distance field for the specified compact heightfield. 
 /// @ingroup recast
 /// @param[in,out]	ctx		The build context to use during the operation.
@@ -1360,6 +1514,86 @@ bool rcCopyPolyMesh(rcContext* ctx, const rcPolyMesh& src, rcPolyMesh& dst);
 /// @returns True if the operation completed successfully.
 bool rcMergePolyMeshDetails(rcContext* ctx, rcPolyMeshDetail** meshes, const int nmeshes, rcPolyMeshDetail& mesh);
 
+/// @}
+/// @name Triangle Bounding Volume Hierarchy Functions
+/// @see rcTriMeshBVH
+/// @{
+
+/// Builds a bounding volume hierarchy of the triangles of a mesh.
+/// The subtrees are built in parallel parts through rcContext::runParallel, the result is the same
+/// for any number of parts.
+/// @ingroup recast
+/// @param[in,out]	ctx				The build context to use during the operation.
+/// @param[in]		verts			The vertices of the mesh. [(x, y, z) * N]
+/// @param[in]		tris			The triangle vertex indices. [(vertA, vertB, vertC) * @p ntris]
+/// @param[in]		ntris			The number of triangles.
+/// @param[in]		trisPerLeaf		The maximum number of triangles in a leaf. [Limit: > 0]
+/// @param[out]		bvh				The resulting hierarchy. (Must be pre-allocated.)
+/// @returns True if the operation completed successfully.
+bool rcBuildTriMeshBVH(rcContext* ctx, const float* verts, const int* tris, const int ntris,
+					   const int trisPerLeaf, rcTriMeshBVH& bvh);
+
+/// Inserts a triangle into the leaf whose bounds grow the least, splitting the leaf if it is full.
+/// @ingroup recast
+/// @param[in,out]	ctx		The build context to use during the operation.
+/// @param[in]		verts	The vertices of the mesh. [(x, y, z) * N]
+/// @param[in]		tris	The triangle vertex indices of the mesh. [(vertA, vertB, vertC) * N]
+/// @param[in]		tri		The index of the triangle to insert.
+/// @param[in,out]	bvh		The hierarchy.
+/// @returns True if the triangle was inserted, false if it is already in the hierarchy or
+/// the hierarchy could not grow.
+bool rcInsertTriMeshBVH(rcContext* ctx, const float* verts, const int* tris, const int tri, rcTriMeshBVH& bvh);
+
+/// Removes a triangle and shrinks the bounds of its leaf and the leaf's ancestors.
+/// @ingroup recast
+/// @param[in]		tri		The index of the triangle to remove.
+/// @param[in,out]	bvh		The hierarchy.
+/// @returns True if the triangle was removed, false if it is not in the hierarchy.
+bool rcRemoveTriMeshBVH(const int tri, rcTriMeshBVH& bvh);
+
+/// Recalculates the bounds of the triangles and the nodes after the vertices of the mesh have moved.
+/// The triangles stay in their leaves, so the hierarchy can get looser.
+/// @ingroup recast
+/// @param[in]		verts	The vertices of the mesh. [(x, y, z) * N]
+/// @param[in]		tris	The triangle vertex indices of the mesh. [(vertA, vertB, vertC) * N]
+/// @param[in,out]	bvh		The hierarchy.
+void rcRefitTriMeshBVH(const float* verts, const int* tris, rcTriMeshBVH& bvh);
+
+/// Finds the triangles whose bounds overlap a box.
+/// @ingroup recast
+/// @param[in]		bvh			The hierarchy.
+/// @param[in]		bmin		The minimum bounds of the box. [(x, y, z)]
+/// @param[in]		bmax		The maximum bounds of the box. [(x, y, z)]
+/// @param[out]		tris		The indices of the triangles. [Size: @p maxTris]
+/// @param[in]		maxTris		The size of the result array.
+/// @returns The number of overlapping triangles. If it is larger than @p maxTris, only the
+/// first @p maxTris triangles are stored.
+int rcQueryTriMeshBVHBox(const rcTriMeshBVH& bvh, const float* bmin, const float* bmax, int* tris, const int maxTris);
+
+/// Finds the triangles whose bounds overlap a segment.
+/// @ingroup recast
+/// @param[in]		bvh			The hierarchy.
+/// @param[in]		sp			The start point of the segment. [(x, y, z)]
+/// @param[in]		sq			The end point of the segment. [(x, y, z)]
+/// @param[out]		tris		The indices of the triangles. [Size: @p maxTris]
+/// @param[in]		maxTris		The size of the result array.
+/// @returns The number of overlapping triangles. If it is larger than @p maxTris, only the
+/// first @p maxTris triangles are stored.
+int rcQueryTriMeshBVHSegment(const rcTriMeshBVH& bvh, const float* sp, const float* sq, int* tris, const int maxTris);
+
+/// Finds the first triangle hit by a segment.
+/// @ingroup recast
+/// @param[in]		bvh			The hierarchy.
+/// @param[in]		verts		The vertices of the mesh. [(x, y, z) * N]
+/// @param[in]		tris		The triangle vertex indices of the mesh. [(vertA, vertB, vertC) * N]
+/// @param[in]		sp			The start point of the segment. [(x, y, z)]
+/// @param[in]		sq			The end point of the segment. [(x, y, z)]
+/// @param[out]		hitTime		The parametric distance along the segment to the hit. [(0 <= value <= 1)]
+/// @param[out]		hitTri		The index of the hit triangle.
+/// @returns True if the segment hits a triangle.
+bool rcRaycastTriMeshBVH(const rcTriMeshBVH& bvh, const float* verts, const int* tris,
+						 const float* sp, const float* sq, float& hitTime, int& hitTri);
+
 /// @}
 
 #endif // RECAST_H
@@ -284,6 +284,39 @@ rcPolyMeshDetail::rcPolyMeshDetail()
 {
 }
 
+rcTriMeshBVH* rcAllocTriMeshBVH()
+{
+	return rcNew<rcTriMeshBVH>(RC_ALLOC_PERM);
+}
+
+void rcFreeTriMeshBVH(rcTriMeshBVH* bvh)
+{
+	rcDelete(bvh);
+}
+
+rcTriMeshBVH::rcTriMeshBVH()
+: nodes()
+, items()
+, blockLeaf()
+, triSlots()
+, nnodes()
+, maxNodes()
+, nblocks()
+, maxBlocks()
+, maxTris()
+, ntris()
+, trisPerLeaf()
+{
+}
+
+rcTriMeshBVH::~rcTriMeshBVH()
+{
+	rcFree(nodes);
+	rcFree(items);
+	rcFree(blockLeaf);
+	rcFree(triSlots);
+}
+
 void rcCalcBounds(const float* verts, int numVerts, float* minBounds, float* maxBounds)
 {
 	// Calculate bounding box.
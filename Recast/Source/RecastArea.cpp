@@ -20,6 +20,7 @@
 #include "RecastAlloc.h"
 #include "RecastAssert.h"
 
+#include <math.h> // for ceilf
 #include <string.h> // for memcpy and memset
 
 /// Sorts the given data in-place using insertion sort.
@@ -76,206 +77,26 @@ bool rcErodeWalkableArea(rcContext* context, const int erosionRadius, rcCompactH
 {
 	rcAssert(context != NULL);
 
-	const int xSize = compactHeightfield.width;
-	const int zSize = compactHeightfield.height;
-	const int& zStride = xSize; // For readability
-
 	rcScopedTimer timer(context, RC_TIMER_ERODE_AREA);
 
-	unsigned char* distanceToBoundary = (unsigned char*)rcAlloc(sizeof(unsigned char) * compactHeightfield.spanCount,
-	                                                            RC_ALLOC_TEMP);
+	unsigned short* distanceToBoundary = (unsigned short*)rcAlloc(sizeof(unsigned short) * compactHeightfield.spanCount,
+	                                                              RC_ALLOC_TEMP);
 	if (!distanceToBoundary)
 	{
 		context->log(RC_LOG_ERROR, "erodeWalkableArea: Out of memory 'dist' (%d).", compactHeightfield.spanCount);
 		return false;
 	}
-	memset(distanceToBoundary, 0xff, sizeof(unsigned char) * compactHeightfield.spanCount);
-	
-	// Mark boundary cells.
-	for (int z = 0; z < zSize; ++z)
-	{
-		for (int x = 0; x < xSize; ++x)
-		{
-			const rcCompactCell& cell = compactHeightfield.cells[x + z * zStride];
-			for (int spanIndex = (int)cell.index, maxSpanIndex = (int)(cell.index + cell.count); spanIndex < maxSpanIndex; ++spanIndex)
-			{
-				if (compactHeightfield.areas[spanIndex] == RC_NULL_AREA)
-				{
-					distanceToBoundary[spanIndex] = 0;
-					continue;
-				}
-				const rcCompactSpan& span = compactHeightfield.spans[spanIndex];
-
-				// Check that there is a non-null adjacent span in each of the 4 cardinal directions.
-				int neighborCount = 0;
-				for (int direction = 0; direction < 4; ++direction)
-				{
-					const int neighborConnection = rcGetCon(span, direction);
-					if (neighborConnection == RC_NOT_CONNECTED)
-					{
-						break;
-					}
-					
-					const int neighborX = x + rcGetDirOffsetX(direction);
-					const int neighborZ = z + rcGetDirOffsetY(direction);
-					const int neighborSpanIndex = (int)compactHeightfield.cells[neighborX + neighborZ * zStride].index + neighborConnection;
-					
-					if (compactHeightfield.areas[neighborSpanIndex] == RC_NULL_AREA)
-					{
-						break;
-					}
-					neighborCount++;
-				}
-				
-				// At least one missing neighbour, so this is a boundary cell.
-				if (neighborCount != 4)
-				{
-					distanceToBoundary[spanIndex] = 0;
-				}
-			}
-		}
-	}
-	
-	unsigned char newDistance;
-	
-	// Pass 1
-	for (int z = 0; z < zSize; ++z)
-	{
-		for (int x = 0; x < xSize; ++x)
-		{
-			const rcCompactCell& cell = compactHeightfield.cells[x + z * zStride];
-			const int maxSpanIndex = (int)(cell.index + cell.count);
-			for (int spanIndex = (int)cell.index; spanIndex < maxSpanIndex; ++spanIndex)
-			{
-				const rcCompactSpan& span = compactHeightfield.spans[spanIndex];
-
-				if (rcGetCon(span, 0) != RC_NOT_CONNECTED)
-				{
-					// (-1,0)
-					const int aX = x + rcGetDirOffsetX(0);
-					const int aY = z + rcGetDirOffsetY(0);
-					const int aIndex = (int)compactHeightfield.cells[aX + aY * xSize].index + rcGetCon(span, 0);
-					const rcCompactSpan& aSpan = compactHeightfield.spans[aIndex];
-					newDistance = (unsigned char)rcMin((int)distanceToBoundary[aIndex] + 2, 255);
-					if (newDistance < distanceToBoundary[spanIndex])
-					{
-						distanceToBoundary[spanIndex] = newDistance;
-					}
-
-					// (-1,-1)
-					if (rcGetCon(aSpan, 3) != RC_NOT_CONNECTED)
-					{
-						const int bX = aX + rcGetDirOffsetX(3);
-						const int bY = aY + rcGetDirOffsetY(3);
-						const int bIndex = (int)compactHeightfield.cells[bX + bY * xSize].index + rcGetCon(aSpan, 3);
-						newDistance = (unsigned char)rcMin((int)distanceToBoundary[bIndex] + 3, 255);
-						if (newDistance < distanceToBoundary[spanIndex])
-						{
-							distanceToBoundary[spanIndex] = newDistance;
-						}
-					}
-				}
-				if (rcGetCon(span, 3) != RC_NOT_CONNECTED)
-				{
-					// (0,-1)
-					const int aX = x + rcGetDirOffsetX(3);
-					const int aY = z + rcGetDirOffsetY(3);
-					const int aIndex = (int)compactHeightfield.cells[aX + aY * xSize].index + rcGetCon(span, 3);
-					const rcCompactSpan& aSpan = compactHeightfield.spans[aIndex];
-					newDistance = (unsigned char)rcMin((int)distanceToBoundary[aIndex] + 2, 255);
-					if (newDistance < distanceToBoundary[spanIndex])
-					{
-						distanceToBoundary[spanIndex] = newDistance;
-					}
-
-					// (1,-1)
-					if (rcGetCon(aSpan, 2) != RC_NOT_CONNECTED)
-					{
-						const int bX = aX + rcGetDirOffsetX(2);
-						const int bY = aY + rcGetDirOffsetY(2);
-						const int bIndex = (int)compactHeightfield.cells[bX + bY * xSize].index + rcGetCon(aSpan, 2);
-						newDistance = (unsigned char)rcMin((int)distanceToBoundary[bIndex] + 3, 255);
-						if (newDistance < distanceToBoundary[spanIndex])
-						{
-							distanceToBoundary[spanIndex] = newDistance;
-						}
-					}
-				}
-			}
-		}
-	}
-
-	// Pass 2
-	for (int z = zSize - 1; z >= 0; --z)
+	if (!rcCalcBoundaryDistance(context, compactHeightfield, RC_BOUNDARY_WALKABLE, distanceToBoundary))
 	{
-		for (int x = xSize - 1; x >= 0; --x)
-		{
-			const rcCompactCell& cell = compactHeightfield.cells[x + z * zStride];
-			const int maxSpanIndex = (int)(cell.index + cell.count);
-			for (int spanIndex = (int)cell.index; spanIndex < maxSpanIndex; ++spanIndex)
-			{
-				const rcCompactSpan& span = compactHeightfield.spans[spanIndex];
-
-				if (rcGetCon(span, 2) != RC_NOT_CONNECTED)
-				{
-					// (1,0)
-					const int aX = x + rcGetDirOffsetX(2);
-					const int aY = z + rcGetDirOffsetY(2);
-					const int aIndex = (int)compactHeightfield.cells[aX + aY * xSize].index + rcGetCon(span, 2);
-					const rcCompactSpan& aSpan = compactHeightfield.spans[aIndex];
-					newDistance = (unsigned char)rcMin((int)distanceToBoundary[aIndex] + 2, 255);
-					if (newDistance < distanceToBoundary[spanIndex])
-					{
-						distanceToBoundary[spanIndex] = newDistance;
-					}
-
-					// (1,1)
-					if (rcGetCon(aSpan, 1) != RC_NOT_CONNECTED)
-					{
-						const int bX = aX + rcGetDirOffsetX(1);
-						const int bY = aY + rcGetDirOffsetY(1);
-						const int bIndex = (int)compactHeightfield.cells[bX + bY * xSize].index + rcGetCon(aSpan, 1);
-						newDistance = (unsigned char)rcMin((int)distanceToBoundary[bIndex] + 3, 255);
-						if (newDistance < distanceToBoundary[spanIndex])
-						{
-							distanceToBoundary[spanIndex] = newDistance;
-						}
-					}
-				}
-				if (rcGetCon(span, 1) != RC_NOT_CONNECTED)
-				{
-					// (0,1)
-					const int aX = x + rcGetDirOffsetX(1);
-					const int aY = z + rcGetDirOffsetY(1);
-					const int aIndex = (int)compactHeightfield.cells[aX + aY * xSize].index + rcGetCon(span, 1);
-					const rcCompactSpan& aSpan = compactHeightfield.spans[aIndex];
-					newDistance = (unsigned char)rcMin((int)distanceToBoundary[aIndex] + 2, 255);
-					if (newDistance < distanceToBoundary[spanIndex])
-					{
-						distanceToBoundary[spanIndex] = newDistance;
-					}
-
-					// (-1,1)
-					if (rcGetCon(aSpan, 0) != RC_NOT_CONNECTED)
-					{
-						const int bX = aX + rcGetDirOffsetX(0);
-						const int bY = aY + rcGetDirOffsetY(0);
-						const int bIndex = (int)compactHeightfield.cells[bX + bY * xSize].index + rcGetCon(aSpan, 0);
-						newDistance = (unsigned char)rcMin((int)distanceToBoundary[bIndex] + 3, 255);
-						if (newDistance < distanceToBoundary[spanIndex])
-						{
-							distanceToBoundary[spanIndex] = newDistance;
-						}
-					}
-				}
-			}
-		}
+		rcFree(distanceToBoundary);
+		return false;
 	}
 
-	const unsigned char minBoundaryDistance = (unsigned char)(erosionRadius * 2);
+	// The distances are 2 per cell.
+	const int minBoundaryDistance = erosionRadius * 2;
 	for (int spanIndex = 0; spanIndex < compactHeightfield.spanCount; ++spanIndex)
 	{
-		if (distanceToBoundary[spanIndex] < minBoundaryDistance)
+		if ((int)distanceToBoundary[spanIndex] < minBoundaryDistance)
 		{
 			compactHeightfield.areas[spanIndex] = RC_NULL_AREA;
 		}
@@ -512,6 +333,265 @@ void rcMarkConvexPolyArea(rcContext* context, const float* verts, const int numV
 	}
 }
 
+namespace
+{
+/// A run of cells of a heightfield row inside a convex volume.
+struct ConvexVolumeRun
+{
+	int minX;
+	int maxX;
+	int minY;
+	int maxY;
+	unsigned char areaId;
+};
+
+/// The x coordinate of the center of a cell, as tested against the volume polygons.
+inline float getCellCenterX(const rcCompactHeightfield& compactHeightfield, const int x)
+{
+	return compactHeightfield.bmin[0] + ((float)x + 0.5f) * compactHeightfield.cs;
+}
+
+/// Finds the grid footprint of a volume like #rcMarkConvexPolyArea, clamped to the grid.
+/// @returns false if the volume lies entirely outside the grid.
+bool getConvexVolumeFootprint(const rcCompactHeightfield& compactHeightfield, const rcConvexPolyVolume& volume,
+							  int& minx, int& miny, int& minz, int& maxx, int& maxy, int& maxz)
+{
+	float bmin[3];
+	float bmax[3];
+	rcVcopy(bmin, volume.verts);
+	rcVcopy(bmax, volume.verts);
+	for (int i = 1; i < volume.numVerts; ++i)
+	{
+		rcVmin(bmin, &volume.verts[i * 3]);
+		rcVmax(bmax, &volume.verts[i * 3]);
+	}
+	bmin[1] = volume.minY;
+	bmax[1] = volume.maxY;
+
+	minx = (int)((bmin[0] - compactHeightfield.bmin[0]) / compactHeightfield.cs);
+	miny = (int)((bmin[1] - compactHeightfield.bmin[1]) / compactHeightfield.ch);
+	minz = (int)((bmin[2] - compactHeightfield.bmin[2]) / compactHeightfield.cs);
+	maxx = (int)((bmax[0] - compactHeightfield.bmin[0]) / compactHeightfield.cs);
+	maxy = (int)((bmax[1] - compactHeightfield.bmin[1]) / compactHeightfield.ch);
+	maxz = (int)((bmax[2] - compactHeightfield.bmin[2]) / compactHeightfield.cs);
+
+	if (maxx < 0 || minx >= compactHeightfield.width || maxz < 0 || minz >= compactHeightfield.height)
+	{
+		return false;
+	}
+
+	minx = rcMax(minx, 0);
+	maxx = rcMin(maxx, compactHeightfield.width - 1);
+	minz = rcMax(minz, 0);
+	maxz = rcMin(maxz, compactHeightfield.height - 1);
+	return true;
+}
+
+/// Finds the first cell in [from, to) whose center is at or to the right of @p crossingX, or @p to.
+int findFirstCellRightOf(const rcCompactHeightfield& compactHeightfield, const float crossingX, const int from, const int to)
+{
+	// Estimate the cell, then step to the exact one with the same center coordinates as the test.
+	const float estimate = (crossingX - compactHeightfield.bmin[0]) / compactHeightfield.cs - 0.5f;
+	int x = to;
+	if (estimate <= (float)from)
+	{
+		x = from;
+	}
+	else if (estimate < (float)to)
+	{
+		x = (int)ceilf(estimate);
+	}
+	while (x > from && getCellCenterX(compactHeightfield, x - 1) >= crossingX)
+	{
+		x--;
+	}
+	while (x < to && getCellCenterX(compactHeightfield, x) < crossingX)
+	{
+		x++;
+	}
+	return x;
+}
+
+/// Finds the runs of cells of a row whose centers pass the point in polygon test of the volume.
+/// The test counts the polygon edges crossing the row to the right of the cell center, so the
+/// crossings of the row are computed once and the cells between them form the runs.
+/// @returns The number of runs written to @p runs. [(minX, maxX) * count]
+int findConvexVolumeRuns(const rcCompactHeightfield& compactHeightfield, const rcConvexPolyVolume& volume,
+						 const int z, const int minx, const int maxx, float* crossings, int* runs)
+{
+	const float pointZ = compactHeightfield.bmin[2] + ((float)z + 0.5f) * compactHeightfield.cs;
+	const float* verts = volume.verts;
+
+	int numCrossings = 0;
+	for (int i = 0, j = volume.numVerts - 1; i < volume.numVerts; j = i++)
+	{
+		const float* vi = &verts[i * 3];
+		const float* vj = &verts[j * 3];
+		if ((vi[2] > pointZ) == (vj[2] > pointZ))
+		{
+			continue;
+		}
+
+		// Insert in sorted order.
+		const float crossingX = (vj[0] - vi[0]) * (pointZ - vi[2]) / (vj[2] - vi[2]) + vi[0];
+		int insertionIndex = numCrossings++;
+		for (; insertionIndex > 0 && crossings[insertionIndex - 1] > crossingX; --insertionIndex)
+		{
+			crossings[insertionIndex] = crossings[insertionIndex - 1];
+		}
+		crossings[insertionIndex] = crossingX;
+	}
+
+	// The cells between crossing k-1 and k have k crossings at or to the left of the center,
+	// and are inside if the number of crossings to the right is odd.
+	int numRuns = 0;
+	int x = minx;
+	for (int k = 0; k <= numCrossings && x <= maxx; ++k)
+	{
+		const int end = k < numCrossings ? findFirstCellRightOf(compactHeightfield, crossings[k], x, maxx + 1) : maxx + 1;
+		if (((numCrossings - k) & 1) && end > x)
+		{
+			runs[numRuns * 2 + 0] = x;
+			runs[numRuns * 2 + 1] = end - 1;
+			numRuns++;
+		}
+		x = end;
+	}
+	return numRuns;
+}
+}
+
+/// @par
+///
+/// The polygon of each volume is rasterized row by row into runs of cells: the polygon edges
+/// crossing a row are found once, instead of testing the polygon for every span. The runs are
+/// bucketed by row in volume order and applied in one pass over the rows of the heightfield.
+bool rcMarkConvexPolyAreas(rcContext* context, const rcConvexPolyVolume* volumes, const int numVolumes,
+						   rcCompactHeightfield& compactHeightfield)
+{
+	rcAssert(context);
+
+	rcScopedTimer timer(context, RC_TIMER_MARK_CONVEXPOLY_AREA);
+
+	const int xSize = compactHeightfield.width;
+	const int zSize = compactHeightfield.height;
+	const int zStride = xSize; // For readability
+
+	int maxVerts = 0;
+	for (int i = 0; i < numVolumes; ++i)
+	{
+		maxVerts = rcMax(maxVerts, volumes[i].numVerts);
+	}
+
+	float* crossings = (float*)rcAlloc(sizeof(float) * (maxVerts + 1), RC_ALLOC_TEMP);
+	int* volumeRuns = (int*)rcAlloc(sizeof(int) * (maxVerts + 2) * 2, RC_ALLOC_TEMP);
+	int* rowStart = (int*)rcAlloc(sizeof(int) * (zSize + 1), RC_ALLOC_TEMP);
+	if (!crossings || !volumeRuns || !rowStart)
+	{
+		context->log(RC_LOG_ERROR, "rcMarkConvexPolyAreas: Out of memory 'rowStart' (%d).", zSize + 1);
+		rcFree(crossings);
+		rcFree(volumeRuns);
+		rcFree(rowStart);
+		return false;
+	}
+	memset(rowStart, 0, sizeof(int) * (zSize + 1));
+
+	// Count the runs of each row.
+	for (int i = 0; i < numVolumes; ++i)
+	{
+		int minx, miny, minz, maxx, maxy, maxz;
+		if (!getConvexVolumeFootprint(compactHeightfield, volumes[i], minx, miny, minz, maxx, maxy, maxz))
+		{
+			continue;
+		}
+		for (int z = minz; z <= maxz; ++z)
+		{
+			rowStart[z + 1] += findConvexVolumeRuns(compactHeightfield, volumes[i], z, minx, maxx, crossings, volumeRuns);
+		}
+	}
+	for (int z = 0; z < zSize; ++z)
+	{
+		rowStart[z + 1] += rowStart[z];
+	}
+
+	const int numRuns = rowStart[zSize];
+	ConvexVolumeRun* runs = (ConvexVolumeRun*)rcAlloc(sizeof(ConvexVolumeRun) * rcMax(numRuns, 1), RC_ALLOC_TEMP);
+	if (!runs)
+	{
+		context->log(RC_LOG_ERROR, "rcMarkConvexPolyAreas: Out of memory 'runs' (%d).", numRuns);
+		rcFree(crossings);
+		rcFree(volumeRuns);
+		rcFree(rowStart);
+		return false;
+	}
+
+	// Bucket the runs by row, in volume order. rowStart[z] is the next free run of the row meanwhile.
+	for (int i = 0; i < numVolumes; ++i)
+	{
+		int minx, miny, minz, maxx, maxy, maxz;
+		if (!getConvexVolumeFootprint(compactHeightfield, volumes[i], minx, miny, minz, maxx, maxy, maxz))
+		{
+			continue;
+		}
+		for (int z = minz; z <= maxz; ++z)
+		{
+			const int n = findConvexVolumeRuns(compactHeightfield, volumes[i], z, minx, maxx, crossings, volumeRuns);
+			for (int j = 0; j < n; ++j)
+			{
+				ConvexVolumeRun& run = runs[rowStart[z]++];
+				run.minX = volumeRuns[j * 2 + 0];
+				run.maxX = volumeRuns[j * 2 + 1];
+				run.minY = miny;
+				run.maxY = maxy;
+				run.areaId = volumes[i].areaId;
+			}
+		}
+	}
+	for (int z = zSize; z > 0; --z)
+	{
+		rowStart[z] = rowStart[z - 1];
+	}
+	rowStart[0] = 0;
+
+	// Mark the spans row by row.
+	for (int z = 0; z < zSize; ++z)
+	{
+		for (int r = rowStart[z]; r < rowStart[z + 1]; ++r)
+		{
+			const ConvexVolumeRun& run = runs[r];
+			for (int x = run.minX; x <= run.maxX; ++x)
+			{
+				const rcCompactCell& cell = compactHeightfield.cells[x + z * zStride];
+				const int maxSpanIndex = (int)(cell.index + cell.count);
+				for (int spanIndex = (int)cell.index; spanIndex < maxSpanIndex; ++spanIndex)
+				{
+					// Skip if span is removed.
+					if (compactHeightfield.areas[spanIndex] == RC_NULL_AREA)
+					{
+						continue;
+					}
+
+					// Skip if y extents don't overlap.
+					const int spanY = (int)compactHeightfield.spans[spanIndex].y;
+					if (spanY < run.minY || spanY > run.maxY)
+					{
+						continue;
+					}
+
+					compactHeightfield.areas[spanIndex] = run.areaId;
+				}
+			}
+		}
+	}
+
+	rcFree(runs);
+	rcFree(crossings);
+	rcFree(volumeRuns);
+	rcFree(rowStart);
+
+	return true;
+}
+
 static const float EPSILON = 1e-6f;
 
 /// Normalizes the vector if the length is greater than zero.
@@ -23,7 +23,6 @@
 #include "Recast.h"
 #include "RecastAlloc.h"
 #include "RecastAssert.h"
-#include "vector"
 
 static int getCornerHeight(int x, int y, int i, int dir,
 						   const rcCompactHeightfield& chf,
@@ -798,6 +797,257 @@ static void mergeRegionHoles(rcContext* ctx, rcContourRegion& region)
 }
 
 
+// Appends items to a vector, growing its capacity geometrically.
+template<typename T>
+static bool appendItems(rcTempVector<T>& vec, const int count)
+{
+	const rcSizeType size = vec.size() + count;
+	if (size > vec.capacity() && !vec.reserve(rcMax(size, vec.capacity()*2)))
+		return false;
+	vec.resize(size);
+	return true;
+}
+
+// A contour traced by a part of the contour build.
+struct rcPartContour
+{
+	int span;		// The span the contour was traced from.
+	int rverts;		// The first raw vertex in the part.
+	int nrverts;
+	int verts;		// The first simplified vertex in the part.
+	int nverts;
+	unsigned short reg;
+	unsigned char area;
+};
+
+// The contours of the regions of a part, in the order they were traced.
+struct rcContourPart
+{
+	inline rcContourPart() : ok(false) {}
+	rcTempVector<rcPartContour> contours;
+	rcTempVector<int> rverts;
+	rcTempVector<int> verts;
+	bool ok;
+};
+
+// A contour of a part, sorted into the order of a serial build. (See: compareContourRefs)
+struct rcContourRef
+{
+	int span;
+	int part;
+	int index;
+};
+
+static int compareContourRefs(const void* va, const void* vb)
+{
+	const rcContourRef* a = (const rcContourRef*)va;
+	const rcContourRef* b = (const rcContourRef*)vb;
+	if (a->span != b->span)
+		return a->span < b->span ? -1 : 1;
+	if (a->index != b->index)
+		return a->index < b->index ? -1 : 1;
+	return 0;
+}
+
+// Traces the contours of the regions of each part. A part owns the regions whose id modulo
+// the number of parts is its index, and tracing only visits the spans of the traced region,
+// so the parts can share the edge flags.
+class rcContourTraceTask : public rcParallelTask
+{
+public:
+	rcContourTraceTask(rcContext* ctx, const rcCompactHeightfield& chf, unsigned char* flags,
+					   const int* starts, const int* partStarts, rcContourPart* parts) :
+		m_ctx(ctx), m_chf(chf), m_flags(flags), m_starts(starts), m_partStarts(partStarts), m_parts(parts)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		rcContourPart& out = m_parts[part];
+		out.ok = traceContours(m_partStarts[part], m_partStarts[part+1], out);
+	}
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	rcContourTraceTask(const rcContourTraceTask&);
+	rcContourTraceTask& operator=(const rcContourTraceTask&);
+
+	bool addContour(const int span, const unsigned short reg, const unsigned char area,
+					const int* points, const int npoints, rcContourPart& out)
+	{
+		const int rbase = static_cast<int>(out.rverts.size()) / 4;
+		if (!appendItems(out.contours, 1) || !appendItems(out.rverts, npoints*4))
+		{
+			m_ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'rverts' (%d).", rbase+npoints);
+			return false;
+		}
+		memcpy(&out.rverts[rbase*4], points, sizeof(int)*npoints*4);
+		
+		rcPartContour& cont = out.contours[out.contours.size()-1];
+		cont.span = span;
+		cont.rverts = rbase;
+		cont.nrverts = npoints;
+		cont.verts = 0;
+		cont.nverts = 0;
+		cont.reg = reg;
+		cont.area = area;
+		return true;
+	}
+
+	bool traceContours(const int first, const int last, rcContourPart& out)
+	{
+		const rcCompactHeightfield& chf = m_chf;
+		unsigned char* flags = m_flags;
+		
+		rcTempVector<int> verts(256);
+		
+		for (int j = first; j < last; ++j)
+		{
+			const int i = m_starts[j*2+0];
+			const int x = m_starts[j*2+1] % chf.width;
+			const int y = m_starts[j*2+1] / chf.width;
+			
+			// Skip if an earlier contour of the region visited all the edges.
+			if (flags[i] == 0)
+				continue;
+			const unsigned short reg = chf.spans[i].reg;
+			const unsigned char area = chf.areas[i];
+			
+			verts.clear();
+			walkContour(x, y, i, chf, flags, verts);
+			
+			// Split off the loops where the contour passes the same vertex twice.
+			for (int n = 1; n < verts.size() / 4; ++n)
+			{
+				const int* v = &verts[0];
+				const int nv = static_cast<int>(verts.size()) / 4;
+				int startVertX = v[n * 4];
+				int startVertY = v[n * 4 + 1];
+				int startVertZ = v[n * 4 + 2];
+				for (int m = n + 1; m < nv - 1; ++m)
+				{
+					if (startVertX == v[m * 4] && 
+						startVertY == v[m * 4 + 1] && 
+						startVertZ == v[m * 4 + 2])
+					{
+						// Cut [n, m] into a contour of its own.
+						if (!addContour(i, reg, area, &verts[n * 4], m - n + 1, out))
+							return false;
+						int cutPointNum = m - n;
+						for (int k = (m + 1); k < verts.size() / 4; ++k)
+						{
+							verts[(k - cutPointNum) * 4] = verts[k * 4];
+							verts[(k - cutPointNum) * 4 + 1] = verts[k * 4 + 1];
+							verts[(k - cutPointNum) * 4 + 2] = verts[k * 4 + 2];
+							verts[(k - cutPointNum) * 4 + 3] = verts[k * 4 + 3];
+						}
+						verts.resize(verts.size() - cutPointNum * 4);
+						break;
+					}
+				}
+			}
+			if (verts.size() > 0)
+			{
+				if (!addContour(i, reg, area, &verts[0], static_cast<int>(verts.size()) / 4, out))
+					return false;
+			}
+		}
+		
+		return true;
+	}
+
+	rcContext* m_ctx;
+	const rcCompactHeightfield& m_chf;
+	unsigned char* m_flags;
+	const int* m_starts;
+	const int* m_partStarts;
+	rcContourPart* m_parts;
+};
+
+// Simplifies the traced contours of each part into the buffers of the part.
+class rcContourSimplifyTask : public rcParallelTask
+{
+public:
+	rcContourSimplifyTask(rcContext* ctx, const float maxError, const int maxEdgeLen, const int buildFlags,
+						  rcContourPart* parts) :
+		m_ctx(ctx), m_maxError(maxError), m_maxEdgeLen(maxEdgeLen), m_buildFlags(buildFlags), m_parts(parts)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		rcContourPart& out = m_parts[part];
+		if (out.ok)
+			out.ok = simplifyContours(out);
+	}
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	rcContourSimplifyTask(const rcContourSimplifyTask&);
+	rcContourSimplifyTask& operator=(const rcContourSimplifyTask&);
+
+	bool simplifyContours(rcContourPart& out)
+	{
+		rcTempVector<int> points(256);
+		rcTempVector<int> simplified(64);
+		
+		for (int i = 0; i < out.contours.size(); ++i)
+		{
+			rcPartContour& cont = out.contours[i];
+			points.assign(&out.rverts[cont.rverts*4], &out.rverts[cont.rverts*4] + cont.nrverts*4);
+			simplified.clear();
+			simplifyContour(points, simplified, m_maxError, m_maxEdgeLen, m_buildFlags);
+			removeDegenerateSegments(simplified);
+			
+			cont.verts = static_cast<int>(out.verts.size()) / 4;
+			cont.nverts = static_cast<int>(simplified.size()) / 4;
+			if (cont.nverts < 3)
+				continue;
+			if (!appendItems(out.verts, cont.nverts*4))
+			{
+				m_ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'verts' (%d).", cont.verts+cont.nverts);
+				return false;
+			}
+			memcpy(&out.verts[cont.verts*4], &simplified[0], sizeof(int)*cont.nverts*4);
+		}
+		
+		return true;
+	}
+
+	rcContext* m_ctx;
+	const float m_maxError;
+	const int m_maxEdgeLen;
+	const int m_buildFlags;
+	rcContourPart* m_parts;
+};
+
+// Merges the holes of the regions into their outlines, each part a contiguous range of regions.
+class rcMergeHolesTask : public rcParallelTask
+{
+public:
+	rcMergeHolesTask(rcContext* ctx, rcContourRegion* regions, const int* mergeRegions, const int nmerge, const int nparts) :
+		m_ctx(ctx), m_regions(regions), m_mergeRegions(mergeRegions), m_nmerge(nmerge), m_nparts(nparts)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		for (int i = m_nmerge*part/m_nparts; i < m_nmerge*(part+1)/m_nparts; ++i)
+			mergeRegionHoles(m_ctx, m_regions[m_mergeRegions[i]]);
+	}
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	rcMergeHolesTask(const rcMergeHolesTask&);
+	rcMergeHolesTask& operator=(const rcMergeHolesTask&);
+
+	rcContext* m_ctx;
+	rcContourRegion* m_regions;
+	const int* m_mergeRegions;
+	const int m_nmerge;
+	const int m_nparts;
+};
+
 /// @par
 ///
 /// The raw contours will match the region outlines exactly. The @p maxError and @p maxEdgeLen
@@ -810,6 +1060,10 @@ static void mergeRegionHoles(rcContext* ctx, rcContourRegion& region)
 ///
 /// See the #rcConfig documentation for more information on the configuration parameters.
 ///
+/// The regions are split into rcContext::getParallelParts() parts that trace and simplify
+/// their contours with rcContext::runParallel, after which the holes of the regions are merged
+/// in parallel parts. The result is the same for any number of parts.
+///
 /// @see rcAllocContourSet, rcCompactHeightfield, rcContourSet, rcConfig
 bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 					 const float maxError, const int maxEdgeLen,
@@ -891,9 +1145,32 @@ bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 	
 	ctx->stopTimer(RC_TIMER_BUILD_CONTOURS_TRACE);
 	
-	rcTempVector<int> verts(256);
-	rcTempVector<int> simplified(64);
-	
+	// Collect the spans to trace the contours from, per part in scan order.
+	const int nparts = rcMax(1, rcMin(ctx->getParallelParts(), (int)chf.maxRegions));
+	rcTempVector<int> partStarts(nparts+1, 0);
+	if ((int)partStarts.size() != nparts+1)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'partStarts' (%d).", nparts+1);
+		return false;
+	}
+	for (int i = 0; i < chf.spanCount; ++i)
+	{
+		if (flags[i] == 0 || flags[i] == 0xf)
+		{
+			flags[i] = 0;
+			continue;
+		}
+		partStarts[chf.spans[i].reg % nparts + 1]++;
+	}
+	for (int i = 0; i < nparts; ++i)
+		partStarts[i+1] += partStarts[i];
+	const int nstarts = partStarts[nparts];
+	rcScopedDelete<int> starts((int*)rcAlloc(sizeof(int)*rcMax(nstarts, 1)*2, RC_ALLOC_TEMP));
+	if (!starts)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'starts' (%d).", nstarts*2);
+		return false;
+	}
 	for (int y = 0; y < h; ++y)
 	{
 		for (int x = 0; x < w; ++x)
@@ -901,141 +1178,137 @@ bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 			const rcCompactCell& c = chf.cells[x+y*w];
 			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
 			{
-				if (flags[i] == 0 || flags[i] == 0xf)
-				{
-					flags[i] = 0;
-					continue;
-				}
-				const unsigned short reg = chf.spans[i].reg;
-				if (!reg || (reg & RC_BORDER_REG))
+				if (flags[i] == 0)
 					continue;
-				const unsigned char area = chf.areas[i];
-				
-				verts.clear();
-				simplified.clear();
-				
-				ctx->startTimer(RC_TIMER_BUILD_CONTOURS_TRACE);
-				walkContour(x, y, i, chf, flags, verts);
-				ctx->stopTimer(RC_TIMER_BUILD_CONTOURS_TRACE);
-				std::vector< rcTempVector<int> > splitedVerts;
-				{
-					for (int n = 1; n < verts.size() / 4; ++n)
-					{
-						int startVertX = verts[n * 4];
-						int startVertY = verts[n * 4 + 1];
-						int startVertZ = verts[n * 4 + 2];
-						int startVertCon = verts[n * 4 + 3];
-						for (int m = n + 1; m < verts.size() / 4 - 1; ++m)
-						{
-							int endVertX = verts[m * 4];
-							int endVertY = verts[m * 4 + 1];
-							int endVertZ = verts[m * 4 + 2];
-							int endVertCon = verts[m * 4 + 3];
-							if (startVertX == endVertX && 
-								startVertY == endVertY && 
-								startVertZ == endVertZ)
-							{
-								// 截取[n, m]到新数组.
-								// 注意此构造函数的参数是[n,m)
-								rcTempVector<int> newContourVerts(&verts[n * 4], &verts[(m + 1) * 4]);
-								splitedVerts.push_back(newContourVerts);
-								int cutPointNum = newContourVerts.size() / 4 - 1;
-								for (int k = (m + 1); k < verts.size() / 4; ++k)
-								{
-									verts[(k - cutPointNum) * 4] = verts[k * 4];
-									verts[(k - cutPointNum) * 4 + 1] = verts[k * 4 + 1];
-									verts[(k - cutPointNum) * 4 + 2] = verts[k * 4 + 2];
-									verts[(k - cutPointNum) * 4 + 3] = verts[k * 4 + 3];
-								}
-								verts.resize(verts.size() - cutPointNum * 4);
-								break;
-							}
-						}
-					}
-					if (verts.size() > 0)
-					{
-						splitedVerts.push_back(verts);
-					}
-				}
-				for (auto& safe_verts : splitedVerts)
-				{
-					ctx->startTimer(RC_TIMER_BUILD_CONTOURS_SIMPLIFY);
-					simplified.clear();
-					simplifyContour(safe_verts, simplified, maxError, maxEdgeLen, buildFlags);
-					removeDegenerateSegments(simplified);
-					ctx->stopTimer(RC_TIMER_BUILD_CONTOURS_SIMPLIFY);
-				
-					// Store region->contour remap info.
-					// Create contour.
-					if (simplified.size()/4 >= 3)
-					{
-						if (cset.nconts >= maxContours)
-						{
-							// Allocate more contours.
-							// This happens when a region has holes.
-							const int oldMax = maxContours;
-							maxContours *= 2;
-							rcContour* newConts = (rcContour*)rcAlloc(sizeof(rcContour)*maxContours, RC_ALLOC_PERM);
-							for (int j = 0; j < cset.nconts; ++j)
-							{
-								newConts[j] = cset.conts[j];
-								// Reset source pointers to prevent data deletion.
-								cset.conts[j].verts = 0;
-								cset.conts[j].rverts = 0;
-							}
-							rcFree(cset.conts);
-							cset.conts = newConts;
-							
-							ctx->log(RC_LOG_WARNING, "rcBuildContours: Expanding max contours from %d to %d.", oldMax, maxContours);
-						}
-						
-						rcContour* cont = &cset.conts[cset.nconts++];
-						
-						cont->nverts = static_cast<int>(simplified.size()) / 4;
-						cont->verts = (int*)rcAlloc(sizeof(int)*cont->nverts*4, RC_ALLOC_PERM);
-						if (!cont->verts)
-						{
-							ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'verts' (%d).", cont->nverts);
-							return false;
-						}
-						memcpy(cont->verts, &simplified[0], sizeof(int)*cont->nverts*4);
-						if (borderSize > 0)
-						{
-							// If the heightfield was build with bordersize, remove the offset.
-							for (int j = 0; j < cont->nverts; ++j)
-							{
-								int* v = &cont->verts[j*4];
-								v[0] -= borderSize;
-								v[2] -= borderSize;
-							}
-						}
-						
-						cont->nrverts = static_cast<int>(safe_verts.size()) / 4;
-						cont->rverts = static_cast<int*>(rcAlloc(sizeof(int) * cont->nrverts * 4, RC_ALLOC_PERM));
-						if (!cont->rverts)
-						{
-							ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'rverts' (%d).", cont->nrverts);
-							return false;
-						}
-						memcpy(cont->rverts, &safe_verts[0], sizeof(int)*cont->nrverts*4);
-						if (borderSize > 0)
-						{
-							// If the heightfield was build with bordersize, remove the offset.
-							for (int j = 0; j < cont->nrverts; ++j)
-							{
-								int* v = &cont->rverts[j*4];
-								v[0] -= borderSize;
-								v[2] -= borderSize;
-							}
-						}
-						
-						cont->reg = reg;
-						cont->area = area;
-					}
-				}
+				int& start = partStarts[chf.spans[i].reg % nparts];
+				starts[start*2+0] = i;
+				starts[start*2+1] = x+y*w;
+				start++;
 			}
 		}
 	}
+	for (int i = nparts; i > 0; --i)
+		partStarts[i] = partStarts[i-1];
+	partStarts[0] = 0;
+	
+	rcTempVector<rcContourPart> parts(nparts);
+	if ((int)parts.size() != nparts)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'parts' (%d).", nparts);
+		return false;
+	}
+	
+	ctx->startTimer(RC_TIMER_BUILD_CONTOURS_TRACE);
+	rcContourTraceTask traceTask(ctx, chf, flags, starts, &partStarts[0], &parts[0]);
+	ctx->runParallel(traceTask, nparts);
+	ctx->stopTimer(RC_TIMER_BUILD_CONTOURS_TRACE);
+	
+	ctx->startTimer(RC_TIMER_BUILD_CONTOURS_SIMPLIFY);
+	rcContourSimplifyTask simplifyTask(ctx, maxError, maxEdgeLen, buildFlags, &parts[0]);
+	ctx->runParallel(simplifyTask, nparts);
+	ctx->stopTimer(RC_TIMER_BUILD_CONTOURS_SIMPLIFY);
+	
+	// Order the contours of the parts like a serial scan over the spans traces them.
+	int ncontours = 0;
+	for (int i = 0; i < nparts; ++i)
+	{
+		if (!parts[i].ok)
+			return false;
+		for (int j = 0; j < parts[i].contours.size(); ++j)
+		{
+			if (parts[i].contours[j].nverts >= 3)
+				ncontours++;
+		}
+	}
+	rcScopedDelete<rcContourRef> order((rcContourRef*)rcAlloc(sizeof(rcContourRef)*rcMax(ncontours, 1), RC_ALLOC_TEMP));
+	if (!order)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'order' (%d).", ncontours);
+		return false;
+	}
+	ncontours = 0;
+	for (int i = 0; i < nparts; ++i)
+	{
+		for (int j = 0; j < parts[i].contours.size(); ++j)
+		{
+			if (parts[i].contours[j].nverts < 3)
+				continue;
+			rcContourRef& ref = order[ncontours++];
+			ref.span = parts[i].contours[j].span;
+			ref.part = i;
+			ref.index = j;
+		}
+	}
+	qsort(order, ncontours, sizeof(rcContourRef), compareContourRefs);
+	
+	if (ncontours > maxContours)
+	{
+		// Allocate more contours.
+		// This happens when a region has holes.
+		const int oldMax = maxContours;
+		maxContours = ncontours;
+		rcFree(cset.conts);
+		cset.conts = (rcContour*)rcAlloc(sizeof(rcContour)*maxContours, RC_ALLOC_PERM);
+		if (!cset.conts)
+		{
+			ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'conts' (%d).", maxContours);
+			return false;
+		}
+		
+		ctx->log(RC_LOG_WARNING, "rcBuildContours: Expanding max contours from %d to %d.", oldMax, maxContours);
+	}
+	
+	// Create contours.
+	for (int i = 0; i < ncontours; ++i)
+	{
+		const rcContourPart& part = parts[order[i].part];
+		const rcPartContour& src = part.contours[order[i].index];
+		
+		rcContour* cont = &cset.conts[cset.nconts++];
+		cont->verts = 0;
+		cont->rverts = 0;
+		
+		cont->nverts = src.nverts;
+		cont->verts = (int*)rcAlloc(sizeof(int)*cont->nverts*4, RC_ALLOC_PERM);
+		if (!cont->verts)
+		{
+			ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'verts' (%d).", cont->nverts);
+			return false;
+		}
+		memcpy(cont->verts, &part.verts[src.verts*4], sizeof(int)*cont->nverts*4);
+		if (borderSize > 0)
+		{
+			// If the heightfield was build with bordersize, remove the offset.
+			for (int j = 0; j < cont->nverts; ++j)
+			{
+				int* v = &cont->verts[j*4];
+				v[0] -= borderSize;
+				v[2] -= borderSize;
+			}
+		}
+		
+		cont->nrverts = src.nrverts;
+		cont->rverts = static_cast<int*>(rcAlloc(sizeof(int) * cont->nrverts * 4, RC_ALLOC_PERM));
+		if (!cont->rverts)
+		{
+			ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'rverts' (%d).", cont->nrverts);
+			return false;
+		}
+		memcpy(cont->rverts, &part.rverts[src.rverts*4], sizeof(int)*cont->nrverts*4);
+		if (borderSize > 0)
+		{
+			// If the heightfield was build with bordersize, remove the offset.
+			for (int j = 0; j < cont->nrverts; ++j)
+			{
+				int* v = &cont->rverts[j*4];
+				v[0] -= borderSize;
+				v[2] -= borderSize;
+			}
+		}
+		
+		cont->reg = src.reg;
+		cont->area = src.area;
+	}
 	
 	// Merge holes if needed.
 	if (cset.nconts > 0)
@@ -1112,6 +1385,13 @@ bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 			}
 			
 			// Finally merge each regions holes into the outline.
+			rcScopedDelete<int> mergeRegions((int*)rcAlloc(sizeof(int)*nregions, RC_ALLOC_TEMP));
+			if (!mergeRegions)
+			{
+				ctx->log(RC_LOG_ERROR, "rcBuildContours: Out of memory 'mergeRegions' (%d).", nregions);
+				return false;
+			}
+			int nmerge = 0;
 			for (int i = 0; i < nregions; i++)
 			{
 				rcContourRegion& reg = regions[i];
@@ -1119,7 +1399,7 @@ bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 				
 				if (reg.outline)
 				{
-					mergeRegionHoles(ctx, reg);
+					mergeRegions[nmerge++] = i;
 				}
 				else
 				{
@@ -1129,6 +1409,13 @@ bool rcBuildContours(rcContext* ctx, const rcCompactHeightfield& chf,
 					ctx->log(RC_LOG_ERROR, "rcBuildContours: Bad outline for region %d, contour simplification is likely too aggressive.", i);
 				}
 			}
+			
+			const int nmergeParts = rcMin(ctx->getParallelParts(), nmerge);
+			if (nmergeParts > 0)
+			{
+				rcMergeHolesTask mergeTask(ctx, regions, mergeRegions, nmerge, nmergeParts);
+				ctx->runParallel(mergeTask, nmergeParts);
+			}
 		}
 		
 	}
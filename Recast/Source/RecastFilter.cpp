@@ -17,6 +17,7 @@
 //
 
 #include "Recast.h"
+#include "RecastAlloc.h"
 #include "RecastAssert.h"
 
 #include <stdlib.h>
@@ -66,6 +67,128 @@ void rcFilterLowHangingWalkableObstacles(rcContext* context, const int walkableC
 	}
 }
 
+namespace
+{
+/// The number of columns of a row rcFilterLedgeSpans tests at once.
+const int LEDGE_FILTER_BLOCK = 8;
+
+/// The lowest span of each column of a heightfield row, as used by rcFilterLedgeSpans.
+struct LedgeFilterRow
+{
+	unsigned short* bottoms;	///< The minimum of the lowest span, or MAX_HEIGHTFIELD_HEIGHT if the column is empty.
+	unsigned short* floors;		///< The maximum of the lowest span.
+	unsigned short* counts;		///< The number of spans in the column: 0, 1, or 2 for more than one.
+	unsigned short* walkable;	///< 1 if the lowest span is walkable.
+};
+
+void packLedgeFilterRow(const rcHeightfield& heightfield, const int z, LedgeFilterRow& row)
+{
+	const rcSpan* const* spans = &heightfield.spans[z * heightfield.width];
+	for (int x = 0; x < heightfield.width; ++x)
+	{
+		const rcSpan* span = spans[x];
+		if (span)
+		{
+			row.bottoms[x] = (unsigned short)span->smin;
+			row.floors[x] = (unsigned short)span->smax;
+			row.counts[x] = span->next ? 2 : 1;
+			row.walkable[x] = span->area != RC_NULL_AREA ? 1 : 0;
+		}
+		else
+		{
+			row.bottoms[x] = (unsigned short)MAX_HEIGHTFIELD_HEIGHT;
+			row.floors[x] = (unsigned short)MAX_HEIGHTFIELD_HEIGHT;
+			row.counts[x] = 0;
+			row.walkable[x] = 0;
+		}
+	}
+}
+
+// Adds a neighbour column with at most one span to the ledge test of a single span column and
+// returns 1 if the neighbour makes the span a ledge. Both spans are open to the top, so only the
+// gap under the neighbour span and the floor difference matter.
+inline int addLedgeNeighbor(const int floor, const int neighborBottom, const int neighborFloor, const int neighborCount,
+							const int walkableHeight, const int walkableClimb,
+							int& lowestTraversableNeighborFloor, int& highestTraversableNeighborFloor)
+{
+	const int gapBelow = neighborBottom - floor >= walkableHeight;
+	const int open = (neighborCount != 0) & (MAX_HEIGHTFIELD_HEIGHT - rcMax(floor, neighborFloor) >= walkableHeight);
+	const int neighborFloorDifference = neighborFloor - floor;
+	const int traversable = (gapBelow ^ 1) & open & (neighborFloorDifference <= walkableClimb);
+	const int traversableFloor = floor + (neighborFloorDifference & -traversable);
+	lowestTraversableNeighborFloor = rcMin(lowestTraversableNeighborFloor, traversableFloor);
+	highestTraversableNeighborFloor = rcMax(highestTraversableNeighborFloor, traversableFloor);
+	return gapBelow | (open & (neighborFloorDifference < -walkableClimb));
+}
+
+// Returns true if a walkable span of a column that is not on the heightfield border is next
+// to a ledge, following the spans of the neighbour columns.
+bool isLedgeSpan(const rcHeightfield& heightfield, const int column, const rcSpan* span,
+				 const int walkableHeight, const int walkableClimb)
+{
+	const int floor = (int)(span->smax);
+	const int ceiling = span->next ? (int)(span->next->smin) : MAX_HEIGHTFIELD_HEIGHT;
+
+	// Min and max height of accessible neighbours.
+	int lowestTraversableNeighborFloor = floor;
+	int highestTraversableNeighborFloor = floor;
+
+	for (int direction = 0; direction < 4; ++direction)
+	{
+		const int neighbor = column + rcGetDirOffsetX(direction) + rcGetDirOffsetY(direction) * heightfield.width;
+		const rcSpan* neighborSpan = heightfield.spans[neighbor];
+
+		// The most we can step down to the neighbor is the walkableClimb distance.
+		// Start with the area under the neighbor span
+		int neighborCeiling = neighborSpan ? (int)neighborSpan->smin : MAX_HEIGHTFIELD_HEIGHT;
+		if (rcMin(ceiling, neighborCeiling) - floor >= walkableHeight)
+		{
+			return true;
+		}
+
+		// For each span in the neighboring column...
+		for (; neighborSpan != NULL; neighborSpan = neighborSpan->next)
+		{
+			const int neighborFloor = (int)neighborSpan->smax;
+			neighborCeiling = neighborSpan->next ? (int)neighborSpan->next->smin : MAX_HEIGHTFIELD_HEIGHT;
+
+			// Only consider neighboring areas that have enough overlap to be potentially traversable.
+			if (rcMin(ceiling, neighborCeiling) - rcMax(floor, neighborFloor) < walkableHeight)
+			{
+				// No space to traverse between them.
+				continue;
+			}
+
+			// There is a gap that is large enough to let an agent move to the neighbour, but the drop is too large.
+			const int neighborFloorDifference = neighborFloor - floor;
+			if (neighborFloorDifference < -walkableClimb)
+			{
+				return true;
+			}
+
+			// Find min/max accessible neighbor height.
+			// Only consider neighbors that are at most walkableClimb away.
+			if (neighborFloorDifference <= walkableClimb)
+			{
+				lowestTraversableNeighborFloor = rcMin(lowestTraversableNeighborFloor, neighborFloor);
+				highestTraversableNeighborFloor = rcMax(highestTraversableNeighborFloor, neighborFloor);
+			}
+		}
+	}
+
+	// If the difference between all neighbor floors is too large, this is a steep slope.
+	return highestTraversableNeighborFloor - lowestTraversableNeighborFloor > walkableClimb;
+}
+}
+
+/// @par
+///
+/// Most columns hold a single span. The lowest span of the columns of three consecutive rows
+/// is packed into arrays, and the ledge test of the single span columns whose neighbours have
+/// at most one span is computed without branches for blocks of columns along the row, skipping
+/// the blocks without walkable spans. The other columns follow the spans of their neighbours.
+/// All the walkable spans of the border columns have an out of bounds neighbour and are marked
+/// unwalkable.
 void rcFilterLedgeSpans(rcContext* context, const int walkableHeight, const int walkableClimb, rcHeightfield& heightfield)
 {
 	rcAssert(context);
@@ -74,105 +197,121 @@ void rcFilterLedgeSpans(rcContext* context, const int walkableHeight, const int
 
 	const int xSize = heightfield.width;
 	const int zSize = heightfield.height;
-	
-	// Mark spans that are adjacent to a ledge as unwalkable..
+
+	// Spans next to the bounds drop off the heightfield.
 	for (int z = 0; z < zSize; ++z)
 	{
-		for (int x = 0; x < xSize; ++x)
+		const int step = (z == 0 || z == zSize - 1) ? 1 : rcMax(xSize - 1, 1);
+		for (int x = 0; x < xSize; x += step)
 		{
 			for (rcSpan* span = heightfield.spans[x + z * xSize]; span; span = span->next)
 			{
-				// Skip non-walkable spans.
-				if (span->area == RC_NULL_AREA)
-				{
-					continue;
-				}
-
-				const int floor = (int)(span->smax);
-				const int ceiling = span->next ? (int)(span->next->smin) : MAX_HEIGHTFIELD_HEIGHT;
-
-				// The difference between this walkable area and the lowest neighbor walkable area.
-				// This is the difference between the current span and all neighbor spans that have
-				// enough space for an agent to move between, but not accounting at all for surface slope.
-				int lowestNeighborFloorDifference = MAX_HEIGHTFIELD_HEIGHT;
-
-				// Min and max height of accessible neighbours.
-				int lowestTraversableNeighborFloor = span->smax;
-				int highestTraversableNeighborFloor = span->smax;
+				span->area = RC_NULL_AREA;
+			}
+		}
+	}
+	if (xSize < 3 || zSize < 3)
+	{
+		return;
+	}
 
-				for (int direction = 0; direction < 4; ++direction)
-				{
-					const int neighborX = x + rcGetDirOffsetX(direction);
-					const int neighborZ = z + rcGetDirOffsetY(direction);
+	// Three rows of packed columns and the per column result of a row.
+	unsigned short* buffer = (unsigned short*)rcAlloc(sizeof(unsigned short) * xSize * 13, RC_ALLOC_TEMP);
+	if (!buffer)
+	{
+		context->log(RC_LOG_ERROR, "rcFilterLedgeSpans: Out of memory 'buffer' (%d).", xSize * 13);
+		return;
+	}
+	LedgeFilterRow rows[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		rows[i].bottoms = buffer + xSize * (i * 4);
+		rows[i].floors = buffer + xSize * (i * 4 + 1);
+		rows[i].counts = buffer + xSize * (i * 4 + 2);
+		rows[i].walkable = buffer + xSize * (i * 4 + 3);
+	}
+	unsigned short* results = buffer + xSize * 12;
+	enum { MARK = 1, FOLLOW = 2 };
 
-					// Skip neighbours which are out of bounds.
-					if (neighborX < 0 || neighborZ < 0 || neighborX >= xSize || neighborZ >= zSize)
-					{
-						lowestNeighborFloorDifference = -walkableClimb - 1;
-						break;
-					}
+	packLedgeFilterRow(heightfield, 0, rows[0]);
+	packLedgeFilterRow(heightfield, 1, rows[1]);
 
-					const rcSpan* neighborSpan = heightfield.spans[neighborX + neighborZ * xSize];
+	// Mark spans that are adjacent to a ledge as unwalkable..
+	for (int z = 1; z < zSize - 1; ++z)
+	{
+		const LedgeFilterRow& prev = rows[(z - 1) % 3];
+		const LedgeFilterRow& row = rows[z % 3];
+		const LedgeFilterRow& next = rows[(z + 1) % 3];
+		packLedgeFilterRow(heightfield, z + 1, rows[(z + 1) % 3]);
+
+		const unsigned short* bottoms = row.bottoms;
+		const unsigned short* floors = row.floors;
+		const unsigned short* counts = row.counts;
+		const unsigned short* walkable = row.walkable;
+		const unsigned short* prevBottoms = prev.bottoms;
+		const unsigned short* prevFloors = prev.floors;
+		const unsigned short* prevCounts = prev.counts;
+		const unsigned short* nextBottoms = next.bottoms;
+		const unsigned short* nextFloors = next.floors;
+		const unsigned short* nextCounts = next.counts;
+		rcSpan** spans = &heightfield.spans[z * xSize];
+		for (int blockStart = 1; blockStart < xSize - 1; blockStart += LEDGE_FILTER_BLOCK)
+		{
+			const int blockEnd = rcMin(blockStart + LEDGE_FILTER_BLOCK, xSize - 1);
 
-					// The most we can step down to the neighbor is the walkableClimb distance.
-					// Start with the area under the neighbor span
-					int neighborCeiling = neighborSpan ? (int)neighborSpan->smin : MAX_HEIGHTFIELD_HEIGHT;
+			// Skip the blocks without walkable spans.
+			int active = 0;
+			for (int x = blockStart; x < blockEnd; ++x)
+			{
+				active |= walkable[x] | (counts[x] >> 1);
+			}
+			if (!active)
+			{
+				continue;
+			}
 
-					// Skip neighbour if the gap between the spans is too small.
-					if (rcMin(ceiling, neighborCeiling) - floor >= walkableHeight)
-					{
-						lowestNeighborFloorDifference = (-walkableClimb - 1);
-						break;
-					}
+			for (int x = blockStart; x < blockEnd; ++x)
+			{
+				const int floor = floors[x];
+				int lowestTraversableNeighborFloor = floor;
+				int highestTraversableNeighborFloor = floor;
+				int ledge = addLedgeNeighbor(floor, bottoms[x - 1], floors[x - 1], counts[x - 1], walkableHeight, walkableClimb,
+											 lowestTraversableNeighborFloor, highestTraversableNeighborFloor);
+				ledge |= addLedgeNeighbor(floor, bottoms[x + 1], floors[x + 1], counts[x + 1], walkableHeight, walkableClimb,
+										  lowestTraversableNeighborFloor, highestTraversableNeighborFloor);
+				ledge |= addLedgeNeighbor(floor, prevBottoms[x], prevFloors[x], prevCounts[x], walkableHeight, walkableClimb,
+										  lowestTraversableNeighborFloor, highestTraversableNeighborFloor);
+				ledge |= addLedgeNeighbor(floor, nextBottoms[x], nextFloors[x], nextCounts[x], walkableHeight, walkableClimb,
+										  lowestTraversableNeighborFloor, highestTraversableNeighborFloor);
+				ledge |= highestTraversableNeighborFloor - lowestTraversableNeighborFloor > walkableClimb;
+
+				// Columns with more than one span, or next to one, follow the spans.
+				const int multipleNeighbors = (counts[x - 1] | counts[x + 1] | prevCounts[x] | nextCounts[x]) >> 1;
+				results[x] = (unsigned short)((walkable[x] * (ledge * MARK | multipleNeighbors * FOLLOW)) | (counts[x] >> 1) * FOLLOW);
+			}
 
-					// For each span in the neighboring column...
-					for (; neighborSpan != NULL; neighborSpan = neighborSpan->next)
+			for (int x = blockStart; x < blockEnd; ++x)
+			{
+				if (results[x] == MARK)
+				{
+					spans[x]->area = RC_NULL_AREA;
+				}
+				else if (results[x] & FOLLOW)
+				{
+					for (rcSpan* span = spans[x]; span; span = span->next)
 					{
-						const int neighborFloor = (int)neighborSpan->smax;
-						neighborCeiling = neighborSpan->next ? (int)neighborSpan->next->smin : MAX_HEIGHTFIELD_HEIGHT;
-
-						// Only consider neighboring areas that have enough overlap to be potentially traversable.
-						if (rcMin(ceiling, neighborCeiling) - rcMax(floor, neighborFloor) < walkableHeight)
-						{
-							// No space to traverse between them.
-							continue;
-						}
-
-						const int neighborFloorDifference = neighborFloor - floor;
-						lowestNeighborFloorDifference = rcMin(lowestNeighborFloorDifference, neighborFloorDifference);
-
-						// Find min/max accessible neighbor height.
-						// Only consider neighbors that are at most walkableClimb away.
-						if (rcAbs(neighborFloorDifference) <= walkableClimb)
-						{
-							// There is space to move to the neighbor cell and the slope isn't too much.
-							lowestTraversableNeighborFloor = rcMin(lowestTraversableNeighborFloor, neighborFloor);
-							highestTraversableNeighborFloor = rcMax(highestTraversableNeighborFloor, neighborFloor);
-						}
-						else if (neighborFloorDifference < -walkableClimb)
+						// Skip non-walkable spans.
+						if (span->area != RC_NULL_AREA && isLedgeSpan(heightfield, x + z * xSize, span, walkableHeight, walkableClimb))
 						{
-							// We already know this will be considered a ledge span so we can early-out
-							break;
+							span->area = RC_NULL_AREA;
 						}
 					}
 				}
-
-				// The current span is close to a ledge if the magnitude of the drop to any neighbour span is greater than the walkableClimb distance.
-				// That is, there is a gap that is large enough to let an agent move between them, but the drop (surface slope) is too large to allow it.
-				// (If this is the case, then biggestNeighborStepDown will be negative, so compare against the negative walkableClimb as a means of checking
-				// the magnitude of the delta)
-				if (lowestNeighborFloorDifference < -walkableClimb)
-				{
-					span->area = RC_NULL_AREA;
-				}
-				// If the difference between all neighbor floors is too large, this is a steep slope, so mark the span as an unwalkable ledge.
-				else if (highestTraversableNeighborFloor - lowestTraversableNeighborFloor > walkableClimb)
-				{
-					span->area = RC_NULL_AREA;
-				}
 			}
 		}
 	}
+
+	rcFree(buffer);
 }
 
 void rcFilterWalkableLowHeightSpans(rcContext* context, const int walkableHeight, rcHeightfield& heightfield)
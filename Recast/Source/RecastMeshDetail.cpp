@@ -165,22 +165,6 @@ static float distancePtSeg2d(const float* pt, const float* p, const float* q)
 	return dx*dx + dz*dz;
 }
 
-static float distToTriMesh(const float* p, const float* verts, const int /*nverts*/, const int* tris, const int ntris)
-{
-	float dmin = FLT_MAX;
-	for (int i = 0; i < ntris; ++i)
-	{
-		const float* va = &verts[tris[i*4+0]*3];
-		const float* vb = &verts[tris[i*4+1]*3];
-		const float* vc = &verts[tris[i*4+2]*3];
-		float d = distPtTri(p, va,vb,vc);
-		if (d < dmin)
-			dmin = d;
-	}
-	if (dmin == FLT_MAX) return -1;
-	return dmin;
-}
-
 static float distToPoly(int nvert, const float* verts, const float* p)
 {
 	
@@ -286,18 +270,50 @@ enum EdgeValues
 	EV_HULL = -2
 };
 
-static int findEdge(const int* edges, int nedges, int s, int t)
+inline unsigned int edgeHash(int s, int t)
+{
+	if (s > t)
+		rcSwap(s, t);
+	return (unsigned int)s * 73856093u ^ (unsigned int)t * 19349663u;
+}
+
+// Finds the edge s-t in either direction using the open addressing table of edge indices.
+static int findEdge(const int* edges, const rcTempVector<int>& edgeSlots, int s, int t)
 {
-	for (int i = 0; i < nedges; i++)
+	const unsigned int mask = (unsigned int)edgeSlots.size() - 1;
+	for (unsigned int slot = edgeHash(s, t) & mask; ; slot = (slot + 1) & mask)
 	{
+		const int i = edgeSlots[slot];
+		if (i == EV_UNDEF)
+			return EV_UNDEF;
 		const int* e = &edges[i*4];
 		if ((e[0] == s && e[1] == t) || (e[0] == t && e[1] == s))
 			return i;
 	}
-	return EV_UNDEF;
 }
 
-static int addEdge(rcContext* ctx, int* edges, int& nedges, const int maxEdges, int s, int t, int l, int r)
+static void insertEdgeSlot(const int* edges, rcTempVector<int>& edgeSlots, int i)
+{
+	const unsigned int mask = (unsigned int)edgeSlots.size() - 1;
+	unsigned int slot = edgeHash(edges[i*4+0], edges[i*4+1]) & mask;
+	while (edgeSlots[slot] != EV_UNDEF)
+		slot = (slot + 1) & mask;
+	edgeSlots[slot] = i;
+}
+
+// Resizes the edge table to hold at least maxEdges edges at half load, and adds the existing edges.
+static void resetEdgeSlots(const int* edges, const int nedges, rcTempVector<int>& edgeSlots, const int maxEdges)
+{
+	int size = 16;
+	while (size < maxEdges*2)
+		size *= 2;
+	edgeSlots.assign(size, EV_UNDEF);
+	for (int i = 0; i < nedges; ++i)
+		insertEdgeSlot(edges, edgeSlots, i);
+}
+
+static int addEdge(rcContext* ctx, int* edges, int& nedges, const int maxEdges, rcTempVector<int>& edgeSlots,
+				   int s, int t, int l, int r)
 {
 	if (nedges >= maxEdges)
 	{
@@ -306,7 +322,7 @@ static int addEdge(rcContext* ctx, int* edges, int& nedges, const int maxEdges,
 	}
 	
 	// Add edge if not already in the triangulation.
-	int e = findEdge(edges, nedges, s, t);
+	int e = findEdge(edges, edgeSlots, s, t);
 	if (e == EV_UNDEF)
 	{
 		int* edge = &edges[nedges*4];
@@ -314,6 +330,9 @@ static int addEdge(rcContext* ctx, int* edges, int& nedges, const int maxEdges,
 		edge[1] = t;
 		edge[2] = l;
 		edge[3] = r;
+		if ((nedges+1)*2 > (int)edgeSlots.size())
+			resetEdgeSlots(edges, nedges, edgeSlots, (nedges+1)*2);
+		insertEdgeSlot(edges, edgeSlots, nedges);
 		return nedges++;
 	}
 	else
@@ -359,7 +378,8 @@ static bool overlapEdges(const float* pts, const int* edges, int nedges, int s1,
 	return false;
 }
 
-static void completeFacet(rcContext* ctx, const float* pts, int npts, int* edges, int& nedges, const int maxEdges, int& nfaces, int e)
+static void completeFacet(rcContext* ctx, const float* pts, int npts, int* edges, int& nedges, const int maxEdges,
+						  rcTempVector<int>& edgeSlots, int& nfaces, int e)
 {
 	static const float EPS = 1e-5f;
 	
@@ -434,16 +454,16 @@ static void completeFacet(rcContext* ctx, const float* pts, int npts, int* edges
 		updateLeftFace(&edges[e*4], s, t, nfaces);
 		
 		// Add new edge or update face info of old edge.
-		e = findEdge(edges, nedges, pt, s);
+		e = findEdge(edges, edgeSlots, pt, s);
 		if (e == EV_UNDEF)
-		    addEdge(ctx, edges, nedges, maxEdges, pt, s, nfaces, EV_UNDEF);
+		    addEdge(ctx, edges, nedges, maxEdges, edgeSlots, pt, s, nfaces, EV_UNDEF);
 		else
 		    updateLeftFace(&edges[e*4], pt, s, nfaces);
 		
 		// Add new edge or update face info of old edge.
-		e = findEdge(edges, nedges, t, pt);
+		e = findEdge(edges, edgeSlots, t, pt);
 		if (e == EV_UNDEF)
-		    addEdge(ctx, edges, nedges, maxEdges, t, pt, nfaces, EV_UNDEF);
+		    addEdge(ctx, edges, nedges, maxEdges, edgeSlots, t, pt, nfaces, EV_UNDEF);
 		else
 		    updateLeftFace(&edges[e*4], t, pt, nfaces);
 		
@@ -457,23 +477,26 @@ static void completeFacet(rcContext* ctx, const float* pts, int npts, int* edges
 
 static void delaunayHull(rcContext* ctx, const int npts, const float* pts,
 						 const int nhull, const int* hull,
-						 rcTempVector<int>& tris, rcTempVector<int>& edges)
+						 rcTempVector<int>& tris, rcTempVector<int>& edges, rcTempVector<int>& edgeSlots)
 {
 	int nfaces = 0;
 	int nedges = 0;
 	const int maxEdges = npts*10;
 	edges.resize(maxEdges*4);
 	
+	// A triangulation has less than 3 edges per point.
+	resetEdgeSlots(&edges[0], 0, edgeSlots, npts*3);
+	
 	for (int i = 0, j = nhull-1; i < nhull; j=i++)
-		addEdge(ctx, &edges[0], nedges, maxEdges, hull[j],hull[i], EV_HULL, EV_UNDEF);
+		addEdge(ctx, &edges[0], nedges, maxEdges, edgeSlots, hull[j],hull[i], EV_HULL, EV_UNDEF);
 	
 	int currentEdge = 0;
 	while (currentEdge < nedges)
 	{
 		if (edges[currentEdge*4+2] == EV_UNDEF)
-			completeFacet(ctx, pts, npts, &edges[0], nedges, maxEdges, nfaces, currentEdge);
+			completeFacet(ctx, pts, npts, &edges[0], nedges, maxEdges, edgeSlots, nfaces, currentEdge);
 		if (edges[currentEdge*4+3] == EV_UNDEF)
-			completeFacet(ctx, pts, npts, &edges[0], nedges, maxEdges, nfaces, currentEdge);
+			completeFacet(ctx, pts, npts, &edges[0], nedges, maxEdges, edgeSlots, nfaces, currentEdge);
 		currentEdge++;
 	}
 	
@@ -668,11 +691,64 @@ static void setTriFlags(rcTempVector<int>& tris, int nhull, int* hull)
 	}
 }
 
+// Distances from the samples to the detail triangles. After each triangulation only the triangles
+// which were not in the previous triangulation need to be tested.
+struct rcSampleCache
+{
+	rcTempVector<float> dists;		// Distance to the closest triangle per sample, FLT_MAX if none.
+	rcTempVector<int> closest;		// Key of the closest triangle per sample, -1 if none.
+	rcTempVector<int> keys;			// Open addressing set of the triangle keys.
+	rcTempVector<int> prevKeys;		// Set of the triangle keys of the previous triangulation.
+	rcTempVector<int> newTris;		// Triangles which were not in the previous triangulation.
+};
+
+// The detail vertex indices fit in a byte.
+inline int triKey(const int* t)
+{
+	return t[0] | (t[1] << 8) | (t[2] << 16);
+}
+
+inline unsigned int triKeyHash(const int key)
+{
+	const unsigned int h = (unsigned int)key * 2654435761u;
+	return h ^ (h >> 16);
+}
+
+static bool hasTriKey(const rcTempVector<int>& keys, const int key)
+{
+	const unsigned int mask = (unsigned int)keys.size() - 1;
+	for (unsigned int slot = triKeyHash(key) & mask; keys[slot] != -1; slot = (slot + 1) & mask)
+	{
+		if (keys[slot] == key)
+			return true;
+	}
+	return false;
+}
+
+static void buildTriKeys(const rcTempVector<int>& tris, rcTempVector<int>& keys)
+{
+	const int ntris = static_cast<int>(tris.size()) / 4;
+	int size = 16;
+	while (size < ntris*2)
+		size *= 2;
+	keys.assign(size, -1);
+	const unsigned int mask = (unsigned int)size - 1;
+	for (int i = 0; i < ntris; ++i)
+	{
+		const int key = triKey(&tris[i*4]);
+		unsigned int slot = triKeyHash(key) & mask;
+		while (keys[slot] != -1 && keys[slot] != key)
+			slot = (slot + 1) & mask;
+		keys[slot] = key;
+	}
+}
+
 static bool buildPolyDetail(rcContext* ctx, const float* in, const int nin,
 							const float sampleDist, const float sampleMaxError,
 							const int heightSearchRadius, const rcCompactHeightfield& chf,
 							const rcHeightPatch& hp, float* verts, int& nverts,
-							rcTempVector<int>& tris, rcTempVector<int>& edges, rcTempVector<int>& samples)
+							rcTempVector<int>& tris, rcTempVector<int>& edges, rcTempVector<int>& samples,
+							rcTempVector<int>& edgeSlots, rcSampleCache& cache)
 {
 	static const int MAX_VERTS = 127;
 	static const int MAX_TRIS = 255;	// Max tris for delaunay is 2n-2-k (n=num verts, k=num hull verts).
@@ -859,11 +935,25 @@ static bool buildPolyDetail(rcContext* ctx, const float* in, const int nin,
 		// error. The procedure stops when all samples are added
 		// or when the max error is within treshold.
 		const int nsamples = static_cast<int>(samples.size()) / 4;
+		cache.dists.assign(nsamples, FLT_MAX);
+		cache.closest.assign(nsamples, -1);
+		cache.prevKeys.assign(1, -1);
 		for (int iter = 0; iter < nsamples; ++iter)
 		{
 			if (nverts >= MAX_VERTS)
 				break;
 			
+			// Find the triangles added since the previous iteration.
+			const int ntris = static_cast<int>(tris.size()) / 4;
+			buildTriKeys(tris, cache.keys);
+			cache.newTris.clear();
+			for (int i = 0; i < ntris; ++i)
+			{
+				if (!hasTriKey(cache.prevKeys, triKey(&tris[i*4])))
+					cache.newTris.push_back(i);
+			}
+			const int nnew = static_cast<int>(cache.newTris.size());
+			
 			// Find sample with most error.
 			float bestpt[3] = {0,0,0};
 			float bestd = 0;
@@ -878,8 +968,27 @@ static bool buildPolyDetail(rcContext* ctx, const float* in, const int nin,
 				pt[0] = s[0]*sampleDist + getJitterX(i)*cs*0.1f;
 				pt[1] = s[1]*chf.ch;
 				pt[2] = s[2]*sampleDist + getJitterY(i)*cs*0.1f;
-				float d = distToTriMesh(pt, verts, nverts, &tris[0], static_cast<int>(tris.size()) / 4);
-				if (d < 0) continue; // did not hit the mesh.
+				// The distance changes only if the closest triangle was removed,
+				// or if one of the new triangles is closer.
+				const bool removed = cache.closest[i] != -1 && !hasTriKey(cache.keys, cache.closest[i]);
+				if (removed)
+				{
+					cache.dists[i] = FLT_MAX;
+					cache.closest[i] = -1;
+				}
+				const int ntest = removed ? ntris : nnew;
+				for (int j = 0; j < ntest; ++j)
+				{
+					const int* t = &tris[(removed ? j : cache.newTris[j])*4];
+					const float d = distPtTri(pt, &verts[t[0]*3], &verts[t[1]*3], &verts[t[2]*3]);
+					if (d < cache.dists[i])
+					{
+						cache.dists[i] = d;
+						cache.closest[i] = triKey(t);
+					}
+				}
+				const float d = cache.dists[i];
+				if (d == FLT_MAX) continue; // did not hit the mesh.
 				if (d > bestd)
 				{
 					bestd = d;
@@ -887,6 +996,7 @@ static bool buildPolyDetail(rcContext* ctx, const float* in, const int nin,
 					rcVcopy(bestpt,pt);
 				}
 			}
+			cache.prevKeys.swap(cache.keys);
 			// If the max error is within accepted threshold, stop tesselating.
 			if (bestd <= sampleMaxError || besti == -1)
 				break;
@@ -900,7 +1010,7 @@ static bool buildPolyDetail(rcContext* ctx, const float* in, const int nin,
 			// TODO: Incremental add instead of full rebuild.
 			edges.clear();
 			tris.clear();
-			delaunayHull(ctx, nverts, verts, nhull, hull, tris, edges);
+			delaunayHull(ctx, nverts, verts, nhull, hull, tris, edges, edgeSlots);
 		}
 	}
 	
@@ -1174,10 +1284,177 @@ static void getHeightData(rcContext* ctx, const rcCompactHeightfield& chf,
 	}
 }
 
+// The detail meshes of a range of polygons, built by one part of rcDetailMeshTask.
+struct rcDetailMeshPart
+{
+	inline rcDetailMeshPart() : ok(false) {}
+	rcTempVector<float> verts;
+	rcTempVector<unsigned char> tris;
+	bool ok;
+};
+
+// Appends items to a vector, growing its capacity geometrically.
+template<typename T>
+static bool appendItems(rcTempVector<T>& vec, const int count)
+{
+	const rcSizeType size = vec.size() + count;
+	if (size > vec.capacity() && !vec.reserve(rcMax(size, vec.capacity()*2)))
+		return false;
+	vec.resize(size);
+	return true;
+}
+
+// Builds the detail meshes of the polygons in parts. Each part builds a contiguous range of
+// polygons into its own buffers, and the parts are concatenated in order afterwards, so the
+// result does not depend on the number of parts.
+class rcDetailMeshTask : public rcParallelTask
+{
+public:
+	rcDetailMeshTask(rcContext* ctx, const rcPolyMesh& mesh, const rcCompactHeightfield& chf,
+					 const float sampleDist, const float sampleMaxError,
+					 const int* bounds, const int maxhw, const int maxhh,
+					 unsigned int* meshes, rcDetailMeshPart* parts, const int nparts) :
+		m_ctx(ctx), m_mesh(mesh), m_chf(chf), m_sampleDist(sampleDist), m_sampleMaxError(sampleMaxError),
+		m_bounds(bounds), m_maxhw(maxhw), m_maxhh(maxhh), m_meshes(meshes), m_parts(parts), m_nparts(nparts)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		rcDetailMeshPart& out = m_parts[part];
+		out.ok = buildPolys(m_mesh.npolys*part/m_nparts, m_mesh.npolys*(part+1)/m_nparts, out);
+	}
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	rcDetailMeshTask(const rcDetailMeshTask&);
+	rcDetailMeshTask& operator=(const rcDetailMeshTask&);
+
+	bool buildPolys(const int first, const int last, rcDetailMeshPart& out)
+	{
+		rcContext* ctx = m_ctx;
+		const rcPolyMesh& mesh = m_mesh;
+		const rcCompactHeightfield& chf = m_chf;
+		const int nvp = mesh.nvp;
+		const float cs = mesh.cs;
+		const float ch = mesh.ch;
+		const float* orig = mesh.bmin;
+		const int borderSize = mesh.borderSize;
+		const int heightSearchRadius = rcMax(1, (int)ceilf(mesh.maxEdgeError));
+
+		rcTempVector<int> edges(64);
+		rcTempVector<int> tris(512);
+		rcTempVector<int> arr(512);
+		rcTempVector<int> samples(512);
+		rcTempVector<int> edgeSlots(64);
+		rcSampleCache cache;
+		float verts[256*3];
+		rcHeightPatch hp;
+
+		rcScopedDelete<float> poly((float*)rcAlloc(sizeof(float)*nvp*3, RC_ALLOC_TEMP));
+		if (!poly)
+		{
+			ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'poly' (%d).", nvp*3);
+			return false;
+		}
+		hp.data = (unsigned short*)rcAlloc(sizeof(unsigned short)*m_maxhw*m_maxhh, RC_ALLOC_TEMP);
+		if (!hp.data)
+		{
+			ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'hp.data' (%d).", m_maxhw*m_maxhh);
+			return false;
+		}
+
+		for (int i = first; i < last; ++i)
+		{
+			const unsigned short* p = &mesh.polys[i*nvp*2];
+			
+			// Store polygon vertices for processing.
+			int npoly = 0;
+			for (int j = 0; j < nvp; ++j)
+			{
+				if(p[j] == RC_MESH_NULL_IDX) break;
+				const unsigned short* v = &mesh.verts[p[j]*3];
+				poly[j*3+0] = v[0]*cs;
+				poly[j*3+1] = v[1]*ch;
+				poly[j*3+2] = v[2]*cs;
+				npoly++;
+			}
+			
+			// Get the height data from the area of the polygon.
+			hp.xmin = m_bounds[i*4+0];
+			hp.ymin = m_bounds[i*4+2];
+			hp.width = m_bounds[i*4+1]-m_bounds[i*4+0];
+			hp.height = m_bounds[i*4+3]-m_bounds[i*4+2];
+			getHeightData(ctx, chf, p, npoly, mesh.verts, borderSize, hp, arr, mesh.regs[i]);
+			
+			// Build detail mesh.
+			int nverts = 0;
+			if (!buildPolyDetail(ctx, poly, npoly,
+								 m_sampleDist, m_sampleMaxError,
+								 heightSearchRadius, chf, hp,
+								 verts, nverts, tris,
+								 edges, samples, edgeSlots, cache))
+			{
+				return false;
+			}
+			
+			// Move detail verts to world space.
+			for (int j = 0; j < nverts; ++j)
+			{
+				verts[j*3+0] += orig[0];
+				verts[j*3+1] += orig[1] + chf.ch; // Is this offset necessary?
+				verts[j*3+2] += orig[2];
+			}
+			
+			// Store detail submesh, relative to the part.
+			const int ntris = static_cast<int>(tris.size()) / 4;
+			const int vbase = static_cast<int>(out.verts.size()) / 3;
+			const int tbase = static_cast<int>(out.tris.size()) / 4;
+			
+			m_meshes[i*4+0] = (unsigned int)vbase;
+			m_meshes[i*4+1] = (unsigned int)nverts;
+			m_meshes[i*4+2] = (unsigned int)tbase;
+			m_meshes[i*4+3] = (unsigned int)ntris;
+			
+			// Store vertices and triangles, allocate more memory if necessary.
+			if (!appendItems(out.verts, nverts*3))
+			{
+				ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'verts' (%d).", (vbase+nverts)*3);
+				return false;
+			}
+			memcpy(&out.verts[vbase*3], verts, sizeof(float)*3*nverts);
+			
+			if (!appendItems(out.tris, ntris*4))
+			{
+				ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'tris' (%d).", (tbase+ntris)*4);
+				return false;
+			}
+			for (int j = 0; j < ntris*4; ++j)
+				out.tris[tbase*4+j] = (unsigned char)tris[j];
+		}
+		
+		return true;
+	}
+
+	rcContext* m_ctx;
+	const rcPolyMesh& m_mesh;
+	const rcCompactHeightfield& m_chf;
+	const float m_sampleDist;
+	const float m_sampleMaxError;
+	const int* m_bounds;
+	const int m_maxhw, m_maxhh;
+	unsigned int* m_meshes;
+	rcDetailMeshPart* m_parts;
+	const int m_nparts;
+};
+
 /// @par
 ///
 /// See the #rcConfig documentation for more information on the configuration parameters.
 ///
+/// The polygons are split into rcContext::getParallelParts() parts that are built with
+/// rcContext::runParallel. The result is the same for any number of parts.
+///
 /// @see rcAllocPolyMeshDetail, rcPolyMesh, rcCompactHeightfield, rcPolyMeshDetail, rcConfig
 bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompactHeightfield& chf,
 						   const float sampleDist, const float sampleMaxError,
@@ -1191,19 +1468,6 @@ bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompa
 		return true;
 	
 	const int nvp = mesh.nvp;
-	const float cs = mesh.cs;
-	const float ch = mesh.ch;
-	const float* orig = mesh.bmin;
-	const int borderSize = mesh.borderSize;
-	const int heightSearchRadius = rcMax(1, (int)ceilf(mesh.maxEdgeError));
-	
-	rcTempVector<int> edges(64);
-	rcTempVector<int> tris(512);
-	rcTempVector<int> arr(512);
-	rcTempVector<int> samples(512);
-	float verts[256*3];
-	rcHeightPatch hp;
-	int nPolyVerts = 0;
 	int maxhw = 0, maxhh = 0;
 	
 	rcScopedDelete<int> bounds((int*)rcAlloc(sizeof(int)*mesh.npolys*4, RC_ALLOC_TEMP));
@@ -1212,12 +1476,6 @@ bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompa
 		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'bounds' (%d).", mesh.npolys*4);
 		return false;
 	}
-	rcScopedDelete<float> poly((float*)rcAlloc(sizeof(float)*nvp*3, RC_ALLOC_TEMP));
-	if (!poly)
-	{
-		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'poly' (%d).", nvp*3);
-		return false;
-	}
 	
 	// Find max size for a polygon area.
 	for (int i = 0; i < mesh.npolys; ++i)
@@ -1239,7 +1497,6 @@ bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompa
 			xmax = rcMax(xmax, (int)v[0]);
 			ymin = rcMin(ymin, (int)v[2]);
 			ymax = rcMax(ymax, (int)v[2]);
-			nPolyVerts++;
 		}
 		xmin = rcMax(0,xmin-1);
 		xmax = rcMin(chf.width,xmax+1);
@@ -1250,13 +1507,6 @@ bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompa
 		maxhh = rcMax(maxhh, ymax-ymin);
 	}
 	
-	hp.data = (unsigned short*)rcAlloc(sizeof(unsigned short)*maxhw*maxhh, RC_ALLOC_TEMP);
-	if (!hp.data)
-	{
-		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'hp.data' (%d).", maxhw*maxhh);
-		return false;
-	}
-	
 	dmesh.nmeshes = mesh.npolys;
 	dmesh.nverts = 0;
 	dmesh.ntris = 0;
@@ -1267,131 +1517,55 @@ bool rcBuildPolyMeshDetail(rcContext* ctx, const rcPolyMesh& mesh, const rcCompa
 		return false;
 	}
 	
-	int vcap = nPolyVerts+nPolyVerts/2;
-	int tcap = vcap*2;
+	// Build the detail meshes.
+	const int nparts = rcMin(ctx->getParallelParts(), mesh.npolys);
+	rcTempVector<rcDetailMeshPart> parts(nparts);
+	if ((int)parts.size() != nparts)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'parts' (%d).", nparts);
+		return false;
+	}
+	rcDetailMeshTask task(ctx, mesh, chf, sampleDist, sampleMaxError, bounds, maxhw, maxhh, dmesh.meshes, &parts[0], nparts);
+	ctx->runParallel(task, nparts);
 	
-	dmesh.nverts = 0;
-	dmesh.verts = (float*)rcAlloc(sizeof(float)*vcap*3, RC_ALLOC_PERM);
+	int nverts = 0, ntris = 0;
+	for (int i = 0; i < nparts; ++i)
+	{
+		if (!parts[i].ok)
+			return false;
+		nverts += static_cast<int>(parts[i].verts.size()) / 3;
+		ntris += static_cast<int>(parts[i].tris.size()) / 4;
+	}
+	
+	// Concatenate the parts in order.
+	dmesh.verts = (float*)rcAlloc(sizeof(float)*rcMax(nverts, 1)*3, RC_ALLOC_PERM);
 	if (!dmesh.verts)
 	{
-		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'dmesh.verts' (%d).", vcap*3);
+		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'dmesh.verts' (%d).", nverts*3);
 		return false;
 	}
-	dmesh.ntris = 0;
-	dmesh.tris = (unsigned char*)rcAlloc(sizeof(unsigned char)*tcap*4, RC_ALLOC_PERM);
+	dmesh.tris = (unsigned char*)rcAlloc(sizeof(unsigned char)*rcMax(ntris, 1)*4, RC_ALLOC_PERM);
 	if (!dmesh.tris)
 	{
-		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'dmesh.tris' (%d).", tcap*4);
+		ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'dmesh.tris' (%d).", ntris*4);
 		return false;
 	}
-	
-	for (int i = 0; i < mesh.npolys; ++i)
+	for (int i = 0; i < nparts; ++i)
 	{
-		const unsigned short* p = &mesh.polys[i*nvp*2];
-		
-		// Store polygon vertices for processing.
-		int npoly = 0;
-		for (int j = 0; j < nvp; ++j)
-		{
-			if(p[j] == RC_MESH_NULL_IDX) break;
-			const unsigned short* v = &mesh.verts[p[j]*3];
-			poly[j*3+0] = v[0]*cs;
-			poly[j*3+1] = v[1]*ch;
-			poly[j*3+2] = v[2]*cs;
-			npoly++;
-		}
-		
-		// Get the height data from the area of the polygon.
-		hp.xmin = bounds[i*4+0];
-		hp.ymin = bounds[i*4+2];
-		hp.width = bounds[i*4+1]-bounds[i*4+0];
-		hp.height = bounds[i*4+3]-bounds[i*4+2];
-		getHeightData(ctx, chf, p, npoly, mesh.verts, borderSize, hp, arr, mesh.regs[i]);
-		
-		// Build detail mesh.
-		int nverts = 0;
-		if (!buildPolyDetail(ctx, poly, npoly,
-							 sampleDist, sampleMaxError,
-							 heightSearchRadius, chf, hp,
-							 verts, nverts, tris,
-							 edges, samples))
-		{
-			return false;
-		}
-		
-		// Move detail verts to world space.
-		for (int j = 0; j < nverts; ++j)
-		{
-			verts[j*3+0] += orig[0];
-			verts[j*3+1] += orig[1] + chf.ch; // Is this offset necessary?
-			verts[j*3+2] += orig[2];
-		}
-		// Offset poly too, will be used to flag checking.
-		for (int j = 0; j < npoly; ++j)
-		{
-			poly[j*3+0] += orig[0];
-			poly[j*3+1] += orig[1];
-			poly[j*3+2] += orig[2];
-		}
-		
-		// Store detail submesh.
-		const int ntris = static_cast<int>(tris.size()) / 4;
-		
-		dmesh.meshes[i*4+0] = (unsigned int)dmesh.nverts;
-		dmesh.meshes[i*4+1] = (unsigned int)nverts;
-		dmesh.meshes[i*4+2] = (unsigned int)dmesh.ntris;
-		dmesh.meshes[i*4+3] = (unsigned int)ntris;
-		
-		// Store vertices, allocate more memory if necessary.
-		if (dmesh.nverts+nverts > vcap)
-		{
-			while (dmesh.nverts+nverts > vcap)
-				vcap += 256;
-			
-			float* newv = (float*)rcAlloc(sizeof(float)*vcap*3, RC_ALLOC_PERM);
-			if (!newv)
-			{
-				ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'newv' (%d).", vcap*3);
-				return false;
-			}
-			if (dmesh.nverts)
-				memcpy(newv, dmesh.verts, sizeof(float)*3*dmesh.nverts);
-			rcFree(dmesh.verts);
-			dmesh.verts = newv;
-		}
-		for (int j = 0; j < nverts; ++j)
-		{
-			dmesh.verts[dmesh.nverts*3+0] = verts[j*3+0];
-			dmesh.verts[dmesh.nverts*3+1] = verts[j*3+1];
-			dmesh.verts[dmesh.nverts*3+2] = verts[j*3+2];
-			dmesh.nverts++;
-		}
-		
-		// Store triangles, allocate more memory if necessary.
-		if (dmesh.ntris+ntris > tcap)
-		{
-			while (dmesh.ntris+ntris > tcap)
-				tcap += 256;
-			unsigned char* newt = (unsigned char*)rcAlloc(sizeof(unsigned char)*tcap*4, RC_ALLOC_PERM);
-			if (!newt)
-			{
-				ctx->log(RC_LOG_ERROR, "rcBuildPolyMeshDetail: Out of memory 'newt' (%d).", tcap*4);
-				return false;
-			}
-			if (dmesh.ntris)
-				memcpy(newt, dmesh.tris, sizeof(unsigned char)*4*dmesh.ntris);
-			rcFree(dmesh.tris);
-			dmesh.tris = newt;
-		}
-		for (int j = 0; j < ntris; ++j)
+		const rcDetailMeshPart& part = parts[i];
+		const int first = mesh.npolys*i/nparts;
+		const int last = mesh.npolys*(i+1)/nparts;
+		for (int j = first; j < last; ++j)
 		{
-			const int* t = &tris[j*4];
-			dmesh.tris[dmesh.ntris*4+0] = (unsigned char)t[0];
-			dmesh.tris[dmesh.ntris*4+1] = (unsigned char)t[1];
-			dmesh.tris[dmesh.ntris*4+2] = (unsigned char)t[2];
-			dmesh.tris[dmesh.ntris*4+3] = (unsigned char)t[3];
-			dmesh.ntris++;
+			dmesh.meshes[j*4+0] += (unsigned int)dmesh.nverts;
+			dmesh.meshes[j*4+2] += (unsigned int)dmesh.ntris;
 		}
+		if (!part.verts.empty())
+			memcpy(&dmesh.verts[dmesh.nverts*3], part.verts.data(), sizeof(float)*part.verts.size());
+		if (!part.tris.empty())
+			memcpy(&dmesh.tris[dmesh.ntris*4], part.tris.data(), sizeof(unsigned char)*part.tris.size());
+		dmesh.nverts += static_cast<int>(part.verts.size()) / 3;
+		dmesh.ntris += static_cast<int>(part.tris.size()) / 4;
 	}
 	
 	return true;
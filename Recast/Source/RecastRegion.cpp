@@ -36,45 +36,79 @@ struct LevelStackEntry
 };
 }  // namespace
 
-static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* src, unsigned short& maxDist)
+// Finds the cell of each span, so that the neighbours of a span can be found from its connections
+// without its coordinates.
+static void buildSpanCells(const rcCompactHeightfield& chf, int* spanCells)
 {
 	const int w = chf.width;
 	const int h = chf.height;
-	
-	// Init distance and points.
-	for (int i = 0; i < chf.spanCount; ++i)
-		src[i] = 0xffff;
-	
-	// Mark boundary cells.
+
 	for (int y = 0; y < h; ++y)
 	{
 		for (int x = 0; x < w; ++x)
 		{
 			const rcCompactCell& c = chf.cells[x+y*w];
 			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
-			{
-				const rcCompactSpan& s = chf.spans[i];
-				const unsigned char area = chf.areas[i];
-				
-				int nc = 0;
-				for (int dir = 0; dir < 4; ++dir)
-				{
-					if (rcGetCon(s, dir) != RC_NOT_CONNECTED)
-					{
-						const int ax = x + rcGetDirOffsetX(dir);
-						const int ay = y + rcGetDirOffsetY(dir);
-						const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, dir);
-						if (area == chf.areas[ai])
-							nc++;
-					}
-				}
-				if (nc != 4)
-					src[i] = 0;
-			}
+				spanCells[i] = x+y*w;
 		}
 	}
-	
-			
+}
+
+// Returns the index of the connected neighbour span of span i in direction dir, or -1 if the
+// span is not connected in the direction.
+static inline int getNeighbor(const rcCompactHeightfield& chf, const int* spanCells, const int i, const int dir)
+{
+	const int con = rcGetCon(chf.spans[i], dir);
+	if (con == RC_NOT_CONNECTED)
+		return -1;
+	const int ac = spanCells[i] + rcGetDirOffsetX(dir) + rcGetDirOffsetY(dir)*chf.width;
+	return (int)chf.cells[ac].index + con;
+}
+
+// Relaxes the distance of a span from its neighbour in direction dir and the diagonal
+// neighbour reached by turning to dir2 from there.
+static inline int relaxDistance(const rcCompactHeightfield& chf, const int* spanCells, const unsigned short* dist,
+								const int i, const int dir, const int dir2, int d)
+{
+	const int ai = getNeighbor(chf, spanCells, i, dir);
+	if (ai >= 0)
+	{
+		d = rcMin(d, (int)dist[ai]+2);
+		const int aai = getNeighbor(chf, spanCells, ai, dir2);
+		if (aai >= 0)
+			d = rcMin(d, (int)dist[aai]+3);
+	}
+	return d;
+}
+
+static void calcBoundaryDistance(const rcCompactHeightfield& chf, const int boundaryType, const int* spanCells,
+								 unsigned short* dist, unsigned short& maxDist)
+{
+	const int w = chf.width;
+	const int h = chf.height;
+
+	// Mark boundary cells.
+	for (int i = 0; i < chf.spanCount; ++i)
+	{
+		const unsigned char area = chf.areas[i];
+		if (boundaryType == RC_BOUNDARY_WALKABLE && area == RC_NULL_AREA)
+		{
+			dist[i] = 0;
+			continue;
+		}
+
+		int nc = 0;
+		for (int dir = 0; dir < 4; ++dir)
+		{
+			const int ai = getNeighbor(chf, spanCells, i, dir);
+			if (ai < 0)
+				continue;
+			if (boundaryType == RC_BOUNDARY_WALKABLE ? chf.areas[ai] != RC_NULL_AREA : chf.areas[ai] == area)
+				nc++;
+		}
+		dist[i] = nc != 4 ? 0 : 0xffff;
+	}
+
 	// Pass 1
 	for (int y = 0; y < h; ++y)
 	{
@@ -83,52 +117,14 @@ static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* sr
 			const rcCompactCell& c = chf.cells[x+y*w];
 			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
 			{
-				const rcCompactSpan& s = chf.spans[i];
-				
-				if (rcGetCon(s, 0) != RC_NOT_CONNECTED)
-				{
-					// (-1,0)
-					const int ax = x + rcGetDirOffsetX(0);
-					const int ay = y + rcGetDirOffsetY(0);
-					const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, 0);
-					const rcCompactSpan& as = chf.spans[ai];
-					if (src[ai]+2 < src[i])
-						src[i] = src[ai]+2;
-					
-					// (-1,-1)
-					if (rcGetCon(as, 3) != RC_NOT_CONNECTED)
-					{
-						const int aax = ax + rcGetDirOffsetX(3);
-						const int aay = ay + rcGetDirOffsetY(3);
-						const int aai = (int)chf.cells[aax+aay*w].index + rcGetCon(as, 3);
-						if (src[aai]+3 < src[i])
-							src[i] = src[aai]+3;
-					}
-				}
-				if (rcGetCon(s, 3) != RC_NOT_CONNECTED)
-				{
-					// (0,-1)
-					const int ax = x + rcGetDirOffsetX(3);
-					const int ay = y + rcGetDirOffsetY(3);
-					const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, 3);
-					const rcCompactSpan& as = chf.spans[ai];
-					if (src[ai]+2 < src[i])
-						src[i] = src[ai]+2;
-					
-					// (1,-1)
-					if (rcGetCon(as, 2) != RC_NOT_CONNECTED)
-					{
-						const int aax = ax + rcGetDirOffsetX(2);
-						const int aay = ay + rcGetDirOffsetY(2);
-						const int aai = (int)chf.cells[aax+aay*w].index + rcGetCon(as, 2);
-						if (src[aai]+3 < src[i])
-							src[i] = src[aai]+3;
-					}
-				}
+				// (-1,0), (-1,-1), (0,-1), (1,-1)
+				int d = relaxDistance(chf, spanCells, dist, i, 0, 3, dist[i]);
+				d = relaxDistance(chf, spanCells, dist, i, 3, 2, d);
+				dist[i] = (unsigned short)d;
 			}
 		}
 	}
-	
+
 	// Pass 2
 	for (int y = h-1; y >= 0; --y)
 	{
@@ -137,113 +133,84 @@ static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* sr
 			const rcCompactCell& c = chf.cells[x+y*w];
 			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
 			{
-				const rcCompactSpan& s = chf.spans[i];
-				
-				if (rcGetCon(s, 2) != RC_NOT_CONNECTED)
-				{
-					// (1,0)
-					const int ax = x + rcGetDirOffsetX(2);
-					const int ay = y + rcGetDirOffsetY(2);
-					const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, 2);
-					const rcCompactSpan& as = chf.spans[ai];
-					if (src[ai]+2 < src[i])
-						src[i] = src[ai]+2;
-					
-					// (1,1)
-					if (rcGetCon(as, 1) != RC_NOT_CONNECTED)
-					{
-						const int aax = ax + rcGetDirOffsetX(1);
-						const int aay = ay + rcGetDirOffsetY(1);
-						const int aai = (int)chf.cells[aax+aay*w].index + rcGetCon(as, 1);
-						if (src[aai]+3 < src[i])
-							src[i] = src[aai]+3;
-					}
-				}
-				if (rcGetCon(s, 1) != RC_NOT_CONNECTED)
-				{
-					// (0,1)
-					const int ax = x + rcGetDirOffsetX(1);
-					const int ay = y + rcGetDirOffsetY(1);
-					const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, 1);
-					const rcCompactSpan& as = chf.spans[ai];
-					if (src[ai]+2 < src[i])
-						src[i] = src[ai]+2;
-					
-					// (-1,1)
-					if (rcGetCon(as, 0) != RC_NOT_CONNECTED)
-					{
-						const int aax = ax + rcGetDirOffsetX(0);
-						const int aay = ay + rcGetDirOffsetY(0);
-						const int aai = (int)chf.cells[aax+aay*w].index + rcGetCon(as, 0);
-						if (src[aai]+3 < src[i])
-							src[i] = src[aai]+3;
-					}
-				}
+				// (1,0), (1,1), (0,1), (-1,1)
+				int d = relaxDistance(chf, spanCells, dist, i, 2, 1, dist[i]);
+				d = relaxDistance(chf, spanCells, dist, i, 1, 0, d);
+				dist[i] = (unsigned short)d;
 			}
 		}
-	}	
-	
+	}
+
 	maxDist = 0;
 	for (int i = 0; i < chf.spanCount; ++i)
-		maxDist = rcMax(src[i], maxDist);
-	
+		maxDist = rcMax(dist[i], maxDist);
+}
+
+/// @par
+///
+/// The distance is a chamfer distance of 2 per step along the axes and 3 per diagonal step,
+/// following the connections of the spans, so a distance of 2 * n is n cells away from the boundary.
+/// #rcErodeWalkableArea uses the distances to the #RC_BOUNDARY_WALKABLE boundary and
+/// #rcBuildDistanceField blurs the distances to the #RC_BOUNDARY_AREA boundary.
+///
+/// @see rcCompactHeightfield, rcBoundaryType
+bool rcCalcBoundaryDistance(rcContext* ctx, const rcCompactHeightfield& chf, const int boundaryType,
+							unsigned short* distances, unsigned short* maxDistance)
+{
+	rcAssert(ctx);
+
+	int* spanCells = (int*)rcAlloc(sizeof(int)*chf.spanCount, RC_ALLOC_TEMP);
+	if (!spanCells)
+	{
+		ctx->log(RC_LOG_ERROR, "rcCalcBoundaryDistance: Out of memory 'spanCells' (%d).", chf.spanCount);
+		return false;
+	}
+
+	unsigned short maxDist = 0;
+	buildSpanCells(chf, spanCells);
+	calcBoundaryDistance(chf, boundaryType, spanCells, distances, maxDist);
+	if (maxDistance)
+		*maxDistance = maxDist;
+
+	rcFree(spanCells);
+
+	return true;
 }
 
-static unsigned short* boxBlur(rcCompactHeightfield& chf, int thr,
+static unsigned short* boxBlur(const rcCompactHeightfield& chf, const int* spanCells, int thr,
 							   unsigned short* src, unsigned short* dst)
 {
-	const int w = chf.width;
-	const int h = chf.height;
-	
 	thr *= 2;
 	
-	for (int y = 0; y < h; ++y)
+	for (int i = 0; i < chf.spanCount; ++i)
 	{
-		for (int x = 0; x < w; ++x)
+		const unsigned short cd = src[i];
+		if (cd <= thr)
 		{
-			const rcCompactCell& c = chf.cells[x+y*w];
-			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
-			{
-				const rcCompactSpan& s = chf.spans[i];
-				const unsigned short cd = src[i];
-				if (cd <= thr)
-				{
-					dst[i] = cd;
-					continue;
-				}
+			dst[i] = cd;
+			continue;
+		}
 
-				int d = (int)cd;
-				for (int dir = 0; dir < 4; ++dir)
-				{
-					if (rcGetCon(s, dir) != RC_NOT_CONNECTED)
-					{
-						const int ax = x + rcGetDirOffsetX(dir);
-						const int ay = y + rcGetDirOffsetY(dir);
-						const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, dir);
-						d += (int)src[ai];
-						
-						const rcCompactSpan& as = chf.spans[ai];
-						const int dir2 = (dir+1) & 0x3;
-						if (rcGetCon(as, dir2) != RC_NOT_CONNECTED)
-						{
-							const int ax2 = ax + rcGetDirOffsetX(dir2);
-							const int ay2 = ay + rcGetDirOffsetY(dir2);
-							const int ai2 = (int)chf.cells[ax2+ay2*w].index + rcGetCon(as, dir2);
-							d += (int)src[ai2];
-						}
-						else
-						{
-							d += cd;
-						}
-					}
-					else
-					{
-						d += cd*2;
-					}
-				}
-				dst[i] = (unsigned short)((d+5)/9);
+		int d = (int)cd;
+		for (int dir = 0; dir < 4; ++dir)
+		{
+			const int ai = getNeighbor(chf, spanCells, i, dir);
+			if (ai >= 0)
+			{
+				d += (int)src[ai];
+				
+				const int ai2 = getNeighbor(chf, spanCells, ai, (dir+1) & 0x3);
+				if (ai2 >= 0)
+					d += (int)src[ai2];
+				else
+					d += cd;
+			}
+			else
+			{
+				d += cd*2;
 			}
 		}
+		dst[i] = (unsigned short)((d+5)/9);
 	}
 	return dst;
 }
@@ -1258,6 +1225,9 @@ static bool mergeAndFilterLayerRegions(rcContext* ctx, int minRegionArea,
 /// After this step, the distance data is available via the rcCompactHeightfield::maxDistance
 /// and rcCompactHeightfield::dist fields.
 ///
+/// The cells of the spans are looked up once for both the distances and the blur, which takes
+/// 4 bytes of temporary memory per span.
+///
 /// @see rcCompactHeightfield, rcBuildRegions, rcBuildRegionsMonotone
 bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf)
 {
@@ -1284,13 +1254,22 @@ bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf)
 		rcFree(src);
 		return false;
 	}
+	int* spanCells = (int*)rcAlloc(sizeof(int)*chf.spanCount, RC_ALLOC_TEMP);
+	if (!spanCells)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildDistanceField: Out of memory 'spanCells' (%d).", chf.spanCount);
+		rcFree(src);
+		rcFree(dst);
+		return false;
+	}
 	
 	unsigned short maxDist = 0;
 
 	{
 		rcScopedTimer timerDist(ctx, RC_TIMER_BUILD_DISTANCEFIELD_DIST);
 
-		calculateDistanceField(chf, src, maxDist);
+		buildSpanCells(chf, spanCells);
+		calcBoundaryDistance(chf, RC_BOUNDARY_AREA, spanCells, src, maxDist);
 		chf.maxDistance = maxDist;
 	}
 
@@ -1298,7 +1277,7 @@ bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf)
 		rcScopedTimer timerBlur(ctx, RC_TIMER_BUILD_DISTANCEFIELD_BLUR);
 
 		// Blur
-		if (boxBlur(chf, 1, src, dst) != src)
+		if (boxBlur(chf, spanCells, 1, src, dst) != src)
 			rcSwap(src, dst);
 
 		// Store distance.
@@ -1306,6 +1285,7 @@ bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf)
 	}
 	
 	rcFree(dst);
+	rcFree(spanCells);
 	
 	return true;
 }
@@ -0,0 +1,790 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#include <float.h>
+#include <string.h>
+#include "Recast.h"
+#include "RecastAlloc.h"
+#include "RecastAssert.h"
+
+static void clearBounds(float* bmin, float* bmax)
+{
+	bmin[0] = bmin[1] = bmin[2] = FLT_MAX;
+	bmax[0] = bmax[1] = bmax[2] = -FLT_MAX;
+}
+
+static void addBounds(float* bmin, float* bmax, const float* omin, const float* omax)
+{
+	rcVmin(bmin, omin);
+	rcVmax(bmax, omax);
+}
+
+static void calcTriBounds(const float* verts, const int* t, float* bmin, float* bmax)
+{
+	rcVcopy(bmin, &verts[t[0]*3]);
+	rcVcopy(bmax, &verts[t[0]*3]);
+	rcVmin(bmin, &verts[t[1]*3]);
+	rcVmax(bmax, &verts[t[1]*3]);
+	rcVmin(bmin, &verts[t[2]*3]);
+	rcVmax(bmax, &verts[t[2]*3]);
+}
+
+// Half of the surface area of the bounds, zero for empty bounds.
+static float boundsArea(const float* bmin, const float* bmax)
+{
+	if (bmin[0] > bmax[0])
+		return 0.0f;
+	const float dx = bmax[0] - bmin[0];
+	const float dy = bmax[1] - bmin[1];
+	const float dz = bmax[2] - bmin[2];
+	return dx*dy + dy*dz + dz*dx;
+}
+
+// The increase of the surface area of the node bounds if the item is added to them.
+static float areaGrowth(const rcTriMeshBVHNode& node, const rcTriMeshBVHItem& item)
+{
+	float bmin[3], bmax[3];
+	rcVcopy(bmin, node.bmin);
+	rcVcopy(bmax, node.bmax);
+	addBounds(bmin, bmax, item.bmin, item.bmax);
+	return boundsArea(bmin, bmax) - boundsArea(node.bmin, node.bmax);
+}
+
+static bool overlapBounds(const float* amin, const float* amax, const float* bmin, const float* bmax)
+{
+	return amin[0] <= bmax[0] && amax[0] >= bmin[0] &&
+		amin[1] <= bmax[1] && amax[1] >= bmin[1] &&
+		amin[2] <= bmax[2] && amax[2] >= bmin[2];
+}
+
+// Returns true if the part of the segment sp + t*dir with 0 <= t <= tmax overlaps the bounds.
+static bool overlapSegmentBounds(const float* sp, const float* dir, const float tmax,
+								 const float* bmin, const float* bmax)
+{
+	static const float EPS = 1e-6f;
+	float t0 = 0.0f;
+	float t1 = tmax;
+	for (int i = 0; i < 3; i++)
+	{
+		if (rcAbs(dir[i]) < EPS)
+		{
+			if (sp[i] < bmin[i] || sp[i] > bmax[i])
+				return false;
+			continue;
+		}
+		const float ood = 1.0f / dir[i];
+		float ta = (bmin[i] - sp[i]) * ood;
+		float tb = (bmax[i] - sp[i]) * ood;
+		if (ta > tb)
+			rcSwap(ta, tb);
+		if (ta > t0) t0 = ta;
+		if (tb < t1) t1 = tb;
+		if (t0 > t1)
+			return false;
+	}
+	return true;
+}
+
+// Double sided segment triangle intersection, returns the parametric distance along the segment.
+static bool intersectSegmentTriangle(const float* sp, const float* sq,
+									 const float* a, const float* b, const float* c, float& t)
+{
+	float ab[3], ac[3], qp[3], ap[3], norm[3], e[3];
+	rcVsub(ab, b, a);
+	rcVsub(ac, c, a);
+	rcVsub(qp, sp, sq);
+	rcVcross(norm, ab, ac);
+
+	float d = rcVdot(qp, norm);
+	if (d == 0.0f)
+		return false;
+
+	rcVsub(ap, sp, a);
+	float tn = rcVdot(ap, norm);
+	rcVcross(e, qp, ap);
+	float v = rcVdot(ac, e);
+	float w = -rcVdot(ab, e);
+	if (d < 0.0f)
+	{
+		d = -d;
+		tn = -tn;
+		v = -v;
+		w = -w;
+	}
+	if (tn < 0.0f || tn > d)
+		return false;
+	if (v < 0.0f || w < 0.0f || v + w > d)
+		return false;
+
+	t = tn / d;
+	return true;
+}
+
+static float itemCenter(const rcTriMeshBVHItem& item, const int axis)
+{
+	return item.bmin[axis] + item.bmax[axis];
+}
+
+// Orders the items by their center on the axis, and by their triangle index for equal centers.
+static bool itemLess(const rcTriMeshBVHItem& a, const rcTriMeshBVHItem& b, const int axis)
+{
+	const float ca = itemCenter(a, axis);
+	const float cb = itemCenter(b, axis);
+	if (ca != cb)
+		return ca < cb;
+	return a.tri < b.tri;
+}
+
+// Returns the axis along which the centers of the items are spread the most.
+static int longestCenterAxis(const rcTriMeshBVHItem* items, const int* order, const int first, const int last)
+{
+	float cmin[3], cmax[3];
+	clearBounds(cmin, cmax);
+	for (int i = first; i < last; ++i)
+	{
+		const rcTriMeshBVHItem& item = items[order[i]];
+		for (int j = 0; j < 3; ++j)
+		{
+			const float c = itemCenter(item, j);
+			cmin[j] = rcMin(cmin[j], c);
+			cmax[j] = rcMax(cmax[j], c);
+		}
+	}
+	int axis = 0;
+	if (cmax[1] - cmin[1] > cmax[axis] - cmin[axis]) axis = 1;
+	if (cmax[2] - cmin[2] > cmax[axis] - cmin[axis]) axis = 2;
+	return axis;
+}
+
+// Partially sorts order[first, last) so that the item at 'nth' is in its sorted position, the items
+// before it are smaller and the items after it are larger.
+static void selectNth(const rcTriMeshBVHItem* items, int* order, int first, int last, const int nth, const int axis)
+{
+	while (last - first > 2)
+	{
+		// Median of three pivot.
+		int a = order[first], b = order[first + (last-first)/2], c = order[last-1];
+		if (itemLess(items[b], items[a], axis)) rcSwap(a, b);
+		if (itemLess(items[c], items[b], axis)) rcSwap(b, c);
+		if (itemLess(items[b], items[a], axis)) rcSwap(a, b);
+		const rcTriMeshBVHItem& pivot = items[b];
+
+		int i = first, j = last-1;
+		while (i <= j)
+		{
+			while (itemLess(items[order[i]], pivot, axis)) i++;
+			while (itemLess(pivot, items[order[j]], axis)) j--;
+			if (i <= j)
+			{
+				rcSwap(order[i], order[j]);
+				i++;
+				j--;
+			}
+		}
+		if (nth <= j)
+			last = j+1;
+		else if (nth >= i)
+			first = i;
+		else
+			return;
+	}
+	if (last - first == 2 && itemLess(items[order[first+1]], items[order[first]], axis))
+		rcSwap(order[first], order[first+1]);
+}
+
+// The number of nodes and leaves of a subtree built from 'ntris' triangles, which is split in
+// half at every node.
+static int countNodes(const int ntris, const int trisPerLeaf)
+{
+	if (ntris <= trisPerLeaf)
+		return 1;
+	return 1 + countNodes(ntris/2, trisPerLeaf) + countNodes(ntris - ntris/2, trisPerLeaf);
+}
+
+static int countLeaves(const int ntris, const int trisPerLeaf)
+{
+	if (ntris <= trisPerLeaf)
+		return 1;
+	return countLeaves(ntris/2, trisPerLeaf) + countLeaves(ntris - ntris/2, trisPerLeaf);
+}
+
+static void calcLeafBounds(rcTriMeshBVH& bvh, const int node)
+{
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	clearBounds(n.bmin, n.bmax);
+	for (int i = 0; i < n.count; ++i)
+		addBounds(n.bmin, n.bmax, bvh.items[n.first + i].bmin, bvh.items[n.first + i].bmax);
+}
+
+static void calcNodeBounds(rcTriMeshBVH& bvh, const int node)
+{
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	const rcTriMeshBVHNode& a = bvh.nodes[n.child];
+	const rcTriMeshBVHNode& b = bvh.nodes[n.child+1];
+	rcVcopy(n.bmin, a.bmin);
+	rcVcopy(n.bmax, a.bmax);
+	addBounds(n.bmin, n.bmax, b.bmin, b.bmax);
+}
+
+static void initLeaf(rcTriMeshBVH& bvh, const int node, const int parent, const int block)
+{
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	n.parent = parent;
+	n.child = -1;
+	n.first = block * bvh.trisPerLeaf;
+	n.count = 0;
+	clearBounds(n.bmin, n.bmax);
+	bvh.blockLeaf[block] = node;
+}
+
+static void addLeafItem(rcTriMeshBVH& bvh, const int node, const rcTriMeshBVHItem& item)
+{
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	const int slot = n.first + n.count;
+	bvh.items[slot] = item;
+	bvh.triSlots[item.tri] = slot;
+	n.count++;
+	addBounds(n.bmin, n.bmax, item.bmin, item.bmax);
+}
+
+// Returns the node that follows 'node' in depth first order, skipping the children of 'node'.
+static int skipNode(const rcTriMeshBVH& bvh, int node)
+{
+	while (node != 0)
+	{
+		const int parent = bvh.nodes[node].parent;
+		if (node == bvh.nodes[parent].child)
+			return node + 1;
+		node = parent;
+	}
+	return -1;
+}
+
+// A subtree whose nodes and blocks are reserved by the serial top of the build.
+struct rcTriMeshBVHSubtree
+{
+	int first, last;		// The range of the triangle order.
+	int node, parent;
+	int nextNode, nextBlock;
+};
+
+struct rcTriMeshBVHBuilder
+{
+	rcTriMeshBVH* bvh;
+	const rcTriMeshBVHItem* triItems;
+	int* order;
+	int subtreeDepth;						// The depth of the subtrees that are built in parallel, or -1.
+	rcTempVector<rcTriMeshBVHSubtree>* subtrees;
+};
+
+static void subdivide(const rcTriMeshBVHBuilder& builder, const int first, const int last,
+					  const int node, const int parent, const int depth, int& nextNode, int& nextBlock)
+{
+	rcTriMeshBVH& bvh = *builder.bvh;
+	const int ntris = last - first;
+
+	if (ntris <= bvh.trisPerLeaf)
+	{
+		initLeaf(bvh, node, parent, nextBlock++);
+		for (int i = first; i < last; ++i)
+			addLeafItem(bvh, node, builder.triItems[builder.order[i]]);
+		return;
+	}
+
+	if (depth == builder.subtreeDepth)
+	{
+		rcTriMeshBVHSubtree subtree;
+		subtree.first = first;
+		subtree.last = last;
+		subtree.node = node;
+		subtree.parent = parent;
+		subtree.nextNode = nextNode;
+		subtree.nextBlock = nextBlock;
+		builder.subtrees->push_back(subtree);
+		nextNode += countNodes(ntris, bvh.trisPerLeaf) - 1;
+		nextBlock += countLeaves(ntris, bvh.trisPerLeaf);
+		return;
+	}
+
+	// Split at the median of the triangle centers along the axis they are spread the most.
+	const int axis = longestCenterAxis(builder.triItems, builder.order, first, last);
+	const int mid = first + ntris/2;
+	selectNth(builder.triItems, builder.order, first, last, mid, axis);
+
+	const int child = nextNode;
+	nextNode += 2;
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	n.parent = parent;
+	n.child = child;
+	n.first = 0;
+	n.count = 0;
+	subdivide(builder, first, mid, child, node, depth+1, nextNode, nextBlock);
+	subdivide(builder, mid, last, child+1, node, depth+1, nextNode, nextBlock);
+}
+
+// Calculates the triangle bounds in parts of the triangle range.
+class rcTriBoundsTask : public rcParallelTask
+{
+public:
+	rcTriBoundsTask(const float* verts, const int* tris, const int ntris, rcTriMeshBVHItem* items, const int nparts) :
+		m_verts(verts), m_tris(tris), m_ntris(ntris), m_items(items), m_nparts(nparts)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		const int first = (int)((long long)m_ntris*part/m_nparts);
+		const int last = (int)((long long)m_ntris*(part+1)/m_nparts);
+		for (int i = first; i < last; ++i)
+		{
+			calcTriBounds(m_verts, &m_tris[i*3], m_items[i].bmin, m_items[i].bmax);
+			m_items[i].tri = i;
+		}
+	}
+
+private:
+	const float* m_verts;
+	const int* m_tris;
+	int m_ntris;
+	rcTriMeshBVHItem* m_items;
+	int m_nparts;
+};
+
+// Builds the subtrees reserved by the top of the build, one subtree per part.
+class rcTriMeshBVHSubtreeTask : public rcParallelTask
+{
+public:
+	rcTriMeshBVHSubtreeTask(const rcTriMeshBVHBuilder& builder, const rcTriMeshBVHSubtree* subtrees) :
+		m_builder(builder), m_subtrees(subtrees)
+	{
+	}
+
+	virtual void runPart(const int part)
+	{
+		const rcTriMeshBVHSubtree& subtree = m_subtrees[part];
+		int nextNode = subtree.nextNode;
+		int nextBlock = subtree.nextBlock;
+		subdivide(m_builder, subtree.first, subtree.last, subtree.node, subtree.parent, 0, nextNode, nextBlock);
+	}
+
+private:
+	const rcTriMeshBVHBuilder& m_builder;
+	const rcTriMeshBVHSubtree* m_subtrees;
+};
+
+static void freeTriMeshBVHData(rcTriMeshBVH& bvh)
+{
+	rcFree(bvh.nodes);
+	rcFree(bvh.items);
+	rcFree(bvh.blockLeaf);
+	rcFree(bvh.triSlots);
+	bvh.nodes = 0;
+	bvh.items = 0;
+	bvh.blockLeaf = 0;
+	bvh.triSlots = 0;
+	bvh.nnodes = bvh.maxNodes = 0;
+	bvh.nblocks = bvh.maxBlocks = 0;
+	bvh.maxTris = bvh.ntris = 0;
+}
+
+static bool growNodes(rcTriMeshBVH& bvh, const int count)
+{
+	if (count <= bvh.maxNodes)
+		return true;
+	const int maxNodes = rcMax(count, bvh.maxNodes*2);
+	rcTriMeshBVHNode* nodes = (rcTriMeshBVHNode*)rcAlloc(sizeof(rcTriMeshBVHNode)*maxNodes, RC_ALLOC_PERM);
+	if (!nodes)
+		return false;
+	if (bvh.nnodes)
+		memcpy(nodes, bvh.nodes, sizeof(rcTriMeshBVHNode)*bvh.nnodes);
+	rcFree(bvh.nodes);
+	bvh.nodes = nodes;
+	bvh.maxNodes = maxNodes;
+	return true;
+}
+
+static bool growBlocks(rcTriMeshBVH& bvh, const int count)
+{
+	if (count <= bvh.maxBlocks)
+		return true;
+	const int maxBlocks = rcMax(count, bvh.maxBlocks*2);
+	rcTriMeshBVHItem* items = (rcTriMeshBVHItem*)rcAlloc(sizeof(rcTriMeshBVHItem)*maxBlocks*bvh.trisPerLeaf, RC_ALLOC_PERM);
+	int* blockLeaf = (int*)rcAlloc(sizeof(int)*maxBlocks, RC_ALLOC_PERM);
+	if (!items || !blockLeaf)
+	{
+		rcFree(items);
+		rcFree(blockLeaf);
+		return false;
+	}
+	if (bvh.nblocks)
+	{
+		memcpy(items, bvh.items, sizeof(rcTriMeshBVHItem)*bvh.nblocks*bvh.trisPerLeaf);
+		memcpy(blockLeaf, bvh.blockLeaf, sizeof(int)*bvh.nblocks);
+	}
+	rcFree(bvh.items);
+	rcFree(bvh.blockLeaf);
+	bvh.items = items;
+	bvh.blockLeaf = blockLeaf;
+	bvh.maxBlocks = maxBlocks;
+	return true;
+}
+
+static bool growTriSlots(rcTriMeshBVH& bvh, const int count)
+{
+	if (count <= bvh.maxTris)
+		return true;
+	const int maxTris = rcMax(count, bvh.maxTris*2);
+	int* triSlots = (int*)rcAlloc(sizeof(int)*maxTris, RC_ALLOC_PERM);
+	if (!triSlots)
+		return false;
+	if (bvh.maxTris)
+		memcpy(triSlots, bvh.triSlots, sizeof(int)*bvh.maxTris);
+	memset(&triSlots[bvh.maxTris], 0xff, sizeof(int)*(maxTris - bvh.maxTris));
+	rcFree(bvh.triSlots);
+	bvh.triSlots = triSlots;
+	bvh.maxTris = maxTris;
+	return true;
+}
+
+/// @par
+///
+/// The nodes are split at the median of the triangle centers along the axis the centers are spread
+/// the most, so the tree is balanced. The top levels are split on the calling thread, and the
+/// subtrees below them are built in parallel parts.
+///
+/// @see rcAllocTriMeshBVH, rcTriMeshBVH, rcQueryTriMeshBVHBox
+bool rcBuildTriMeshBVH(rcContext* ctx, const float* verts, const int* tris, const int ntris,
+					   const int trisPerLeaf, rcTriMeshBVH& bvh)
+{
+	rcAssert(ctx);
+
+	rcScopedTimer timer(ctx, RC_TIMER_BUILD_TRIMESHBVH);
+
+	freeTriMeshBVHData(bvh);
+	if (trisPerLeaf <= 0 || ntris < 0 || (ntris > 0 && (!verts || !tris)))
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildTriMeshBVH: Invalid input (%d triangles, %d per leaf).", ntris, trisPerLeaf);
+		return false;
+	}
+	bvh.trisPerLeaf = trisPerLeaf;
+
+	const int nnodes = ntris > 0 ? countNodes(ntris, trisPerLeaf) : 1;
+	const int nblocks = ntris > 0 ? countLeaves(ntris, trisPerLeaf) : 1;
+	if (!growNodes(bvh, nnodes) || !growBlocks(bvh, nblocks) || !growTriSlots(bvh, rcMax(ntris, 1)))
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildTriMeshBVH: Out of memory (%d nodes, %d leaves).", nnodes, nblocks);
+		freeTriMeshBVHData(bvh);
+		return false;
+	}
+	bvh.nnodes = nnodes;
+	bvh.nblocks = nblocks;
+	bvh.ntris = ntris;
+
+	if (ntris == 0)
+	{
+		initLeaf(bvh, 0, -1, 0);
+		return true;
+	}
+
+	rcTempVector<rcTriMeshBVHItem> triItems;
+	rcTempVector<int> order;
+	rcTempVector<rcTriMeshBVHSubtree> subtrees;
+	if (!triItems.reserve(ntris) || !order.reserve(ntris))
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildTriMeshBVH: Out of memory 'triItems' (%d).", ntris);
+		freeTriMeshBVHData(bvh);
+		return false;
+	}
+	triItems.resize(ntris);
+	order.resize(ntris);
+	for (int i = 0; i < ntris; ++i)
+		order[i] = i;
+
+	const int nparts = rcMin(ctx->getParallelParts(), ntris);
+	rcTriBoundsTask boundsTask(verts, tris, ntris, &triItems[0], nparts);
+	ctx->runParallel(boundsTask, nparts);
+
+	// Split the top levels until there are a few subtrees per part.
+	rcTriMeshBVHBuilder builder;
+	builder.bvh = &bvh;
+	builder.triItems = &triItems[0];
+	builder.order = &order[0];
+	builder.subtreeDepth = -1;
+	builder.subtrees = &subtrees;
+	if (nparts > 1)
+	{
+		builder.subtreeDepth = 0;
+		while ((1 << builder.subtreeDepth) < nparts*4)
+			builder.subtreeDepth++;
+	}
+	int nextNode = 1;
+	int nextBlock = 0;
+	subdivide(builder, 0, ntris, 0, -1, 0, nextNode, nextBlock);
+	rcAssert(nextNode == nnodes && nextBlock == nblocks);
+
+	builder.subtreeDepth = -1;
+	if (!subtrees.empty())
+	{
+		rcTriMeshBVHSubtreeTask subtreeTask(builder, &subtrees[0]);
+		ctx->runParallel(subtreeTask, (int)subtrees.size());
+	}
+
+	// The children have larger indices than their parents.
+	for (int i = nnodes-1; i >= 0; --i)
+	{
+		if (bvh.nodes[i].child != -1)
+			calcNodeBounds(bvh, i);
+	}
+
+	return true;
+}
+
+/// @par
+///
+/// The triangle is added to the leaf found by descending to the child whose bounds grow the least.
+/// A full leaf is split in two at the median of its triangle centers.
+bool rcInsertTriMeshBVH(rcContext* ctx, const float* verts, const int* tris, const int tri, rcTriMeshBVH& bvh)
+{
+	rcAssert(ctx);
+
+	if (tri < 0 || bvh.nnodes == 0)
+	{
+		ctx->log(RC_LOG_ERROR, "rcInsertTriMeshBVH: Invalid triangle %d or hierarchy.", tri);
+		return false;
+	}
+	if (tri < bvh.maxTris && bvh.triSlots[tri] != -1)
+		return false;
+	if (!growTriSlots(bvh, tri+1))
+	{
+		ctx->log(RC_LOG_ERROR, "rcInsertTriMeshBVH: Out of memory 'triSlots' (%d).", tri+1);
+		return false;
+	}
+
+	rcTriMeshBVHItem item;
+	calcTriBounds(verts, &tris[tri*3], item.bmin, item.bmax);
+	item.tri = tri;
+
+	// Find the leaf, growing the bounds on the way down.
+	int node = 0;
+	while (bvh.nodes[node].child != -1)
+	{
+		rcTriMeshBVHNode& n = bvh.nodes[node];
+		addBounds(n.bmin, n.bmax, item.bmin, item.bmax);
+		const float growthA = areaGrowth(bvh.nodes[n.child], item);
+		const float growthB = areaGrowth(bvh.nodes[n.child+1], item);
+		node = growthB < growthA ? n.child+1 : n.child;
+	}
+
+	const int trisPerLeaf = bvh.trisPerLeaf;
+	if (bvh.nodes[node].count < trisPerLeaf)
+	{
+		addLeafItem(bvh, node, item);
+		bvh.ntris++;
+		return true;
+	}
+
+	// Split the full leaf.
+	rcTempVector<rcTriMeshBVHItem> splitItems;
+	rcTempVector<int> order;
+	if (!growNodes(bvh, bvh.nnodes+2) || !growBlocks(bvh, bvh.nblocks+1) ||
+		!splitItems.reserve(trisPerLeaf+1) || !order.reserve(trisPerLeaf+1))
+	{
+		ctx->log(RC_LOG_ERROR, "rcInsertTriMeshBVH: Out of memory splitting a leaf.");
+		return false;
+	}
+	const int first = bvh.nodes[node].first;
+	for (int i = 0; i < trisPerLeaf; ++i)
+		splitItems.push_back(bvh.items[first + i]);
+	splitItems.push_back(item);
+	for (int i = 0; i <= trisPerLeaf; ++i)
+		order.push_back(i);
+
+	const int axis = longestCenterAxis(&splitItems[0], &order[0], 0, trisPerLeaf+1);
+	const int mid = (trisPerLeaf+1)/2;
+	selectNth(&splitItems[0], &order[0], 0, trisPerLeaf+1, mid, axis);
+
+	const int child = bvh.nnodes;
+	bvh.nnodes += 2;
+	const int newBlock = bvh.nblocks++;
+	initLeaf(bvh, child, node, first / trisPerLeaf);
+	initLeaf(bvh, child+1, node, newBlock);
+	for (int i = 0; i <= trisPerLeaf; ++i)
+		addLeafItem(bvh, i < mid ? child : child+1, splitItems[order[i]]);
+
+	rcTriMeshBVHNode& n = bvh.nodes[node];
+	n.child = child;
+	n.first = 0;
+	n.count = 0;
+	calcNodeBounds(bvh, node);
+
+	bvh.ntris++;
+	return true;
+}
+
+bool rcRemoveTriMeshBVH(const int tri, rcTriMeshBVH& bvh)
+{
+	if (tri < 0 || tri >= bvh.maxTris || bvh.triSlots[tri] == -1)
+		return false;
+
+	// Move the last triangle of the leaf to the removed slot.
+	const int slot = bvh.triSlots[tri];
+	const int leaf = bvh.blockLeaf[slot / bvh.trisPerLeaf];
+	rcTriMeshBVHNode& n = bvh.nodes[leaf];
+	const int last = n.first + n.count - 1;
+	if (slot != last)
+	{
+		bvh.items[slot] = bvh.items[last];
+		bvh.triSlots[bvh.items[slot].tri] = slot;
+	}
+	bvh.triSlots[tri] = -1;
+	n.count--;
+	bvh.ntris--;
+
+	calcLeafBounds(bvh, leaf);
+	for (int i = n.parent; i != -1; i = bvh.nodes[i].parent)
+		calcNodeBounds(bvh, i);
+
+	return true;
+}
+
+void rcRefitTriMeshBVH(const float* verts, const int* tris, rcTriMeshBVH& bvh)
+{
+	// The children have larger indices than their parents.
+	for (int i = bvh.nnodes-1; i >= 0; --i)
+	{
+		const rcTriMeshBVHNode& n = bvh.nodes[i];
+		if (n.child != -1)
+		{
+			calcNodeBounds(bvh, i);
+			continue;
+		}
+		for (int j = 0; j < n.count; ++j)
+		{
+			rcTriMeshBVHItem& item = bvh.items[n.first + j];
+			calcTriBounds(verts, &tris[item.tri*3], item.bmin, item.bmax);
+		}
+		calcLeafBounds(bvh, i);
+	}
+}
+
+int rcQueryTriMeshBVHBox(const rcTriMeshBVH& bvh, const float* bmin, const float* bmax, int* tris, const int maxTris)
+{
+	int n = 0;
+	int node = bvh.nnodes > 0 ? 0 : -1;
+	while (node != -1)
+	{
+		const rcTriMeshBVHNode& cur = bvh.nodes[node];
+		if (overlapBounds(cur.bmin, cur.bmax, bmin, bmax))
+		{
+			if (cur.child != -1)
+			{
+				node = cur.child;
+				continue;
+			}
+			for (int i = 0; i < cur.count; ++i)
+			{
+				const rcTriMeshBVHItem& item = bvh.items[cur.first + i];
+				if (!overlapBounds(item.bmin, item.bmax, bmin, bmax))
+					continue;
+				if (n < maxTris)
+					tris[n] = item.tri;
+				n++;
+			}
+		}
+		node = skipNode(bvh, node);
+	}
+	return n;
+}
+
+int rcQueryTriMeshBVHSegment(const rcTriMeshBVH& bvh, const float* sp, const float* sq, int* tris, const int maxTris)
+{
+	float dir[3];
+	rcVsub(dir, sq, sp);
+
+	int n = 0;
+	int node = bvh.nnodes > 0 ? 0 : -1;
+	while (node != -1)
+	{
+		const rcTriMeshBVHNode& cur = bvh.nodes[node];
+		if (overlapSegmentBounds(sp, dir, 1.0f, cur.bmin, cur.bmax))
+		{
+			if (cur.child != -1)
+			{
+				node = cur.child;
+				continue;
+			}
+			for (int i = 0; i < cur.count; ++i)
+			{
+				const rcTriMeshBVHItem& item = bvh.items[cur.first + i];
+				if (!overlapSegmentBounds(sp, dir, 1.0f, item.bmin, item.bmax))
+					continue;
+				if (n < maxTris)
+					tris[n] = item.tri;
+				n++;
+			}
+		}
+		node = skipNode(bvh, node);
+	}
+	return n;
+}
+
+bool rcRaycastTriMeshBVH(const rcTriMeshBVH& bvh, const float* verts, const int* tris,
+						 const float* sp, const float* sq, float& hitTime, int& hitTri)
+{
+	float dir[3];
+	rcVsub(dir, sq, sp);
+
+	// Only visit the nodes in front of the nearest hit so far.
+	float tmax = 1.0f;
+	int hit = -1;
+	int node = bvh.nnodes > 0 ? 0 : -1;
+	while (node != -1)
+	{
+		const rcTriMeshBVHNode& cur = bvh.nodes[node];
+		if (overlapSegmentBounds(sp, dir, tmax, cur.bmin, cur.bmax))
+		{
+			if (cur.child != -1)
+			{
+				node = cur.child;
+				continue;
+			}
+			for (int i = 0; i < cur.count; ++i)
+			{
+				const rcTriMeshBVHItem& item = bvh.items[cur.first + i];
+				if (!overlapSegmentBounds(sp, dir, tmax, item.bmin, item.bmax))
+					continue;
+				const int* t = &tris[item.tri*3];
+				float th = 0.0f;
+				if (intersectSegmentTriangle(sp, sq, &verts[t[0]*3], &verts[t[1]*3], &verts[t[2]*3], th) &&
+					(th < tmax || hit == -1 || (th == tmax && item.tri < hit)))
+				{
+					tmax = th;
+					hit = item.tri;
+				}
+			}
+		}
+		node = skipNode(bvh, node);
+	}
+
+	if (hit == -1)
+		return false;
+	hitTime = tmax;
+	hitTri = hit;
+	return true;
+}
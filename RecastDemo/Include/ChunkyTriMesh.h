@@ -49,6 +49,10 @@ private:
 bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
 						   int trisPerChunk, rcChunkyTriMesh* cm);
 
+/// Recalculates the bounds of the nodes after the vertices of the mesh have moved.
+/// The triangles stay in their chunks, so the tree is valid but can get looser.
+void rcRefitChunkyTriMesh(const float* verts, rcChunkyTriMesh* cm);
+
 /// Returns the chunk indices which overlap the input rectable.
 int rcGetChunksOverlappingRect(const rcChunkyTriMesh* cm, float bmin[2], float bmax[2], int* ids, const int maxIds);
 
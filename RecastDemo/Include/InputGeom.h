@@ -96,6 +96,13 @@ class InputGeom
 	int m_volumeCount;
 	///@}
 	
+	/// @name Changes since the navmesh was last built.
+	///@{
+	static const int MAX_CHANGES = 64;
+	float m_changeBounds[MAX_CHANGES*4];
+	int m_changeCount;
+	///@}
+	
 	bool loadMesh(class rcContext* ctx, const std::string& filepath);
 	bool loadGeomSet(class rcContext* ctx, const std::string& filepath);
 public:
@@ -115,6 +122,9 @@ public:
 	const rcChunkyTriMesh* getChunkyMesh() const { return m_chunkyMesh; }
 	const BuildSettings* getBuildSettings() const { return m_hasBuildSettings ? &m_buildSettings : 0; }
 	bool raycastMesh(float* src, float* dst, float& tmin);
+	
+	/// Moves the vertices of the triangles by delta and records the change.
+	void moveMeshTris(const int* tris, const int ntris, const float* delta);
 
 	/// @name Off-Mesh connections.
 	///@{
@@ -141,6 +151,18 @@ public:
 	void drawConvexVolumes(struct duDebugDraw* dd, bool hilight = false);
 	///@}
 	
+	/// @name Changes.
+	/// The edits of the mesh, the off-mesh connections and the convex volumes record the xz-bounds
+	/// of the input they changed, so that only the tiles overlapping the changes need to be rebuilt.
+	///@{
+	/// Records a change of the input within the bounds, for edits made outside of InputGeom.
+	void markChanged(const float* bmin, const float* bmax);
+	int getChangeCount() const { return m_changeCount; }
+	/// The xz-bounds of the changes. [(minx, minz, maxx, maxz) * getChangeCount()]
+	const float* getChangeBounds() const { return m_changeBounds; }
+	void clearChanges() { m_changeCount = 0; }
+	///@}
+	
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
 	InputGeom(const InputGeom&);
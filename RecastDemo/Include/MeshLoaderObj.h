@@ -36,6 +36,10 @@ public:
 	int getTriCount() const { return m_triCount; }
 	const std::string& getFileName() const { return m_filename; }
 
+	/// Moves the vertices by delta and updates the normals of the triangles using them.
+	/// Each vertex is listed once.
+	void moveVerts(const int* verts, const int nverts, const float* delta);
+
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
 	rcMeshLoaderObj(const rcMeshLoaderObj&);
@@ -43,6 +47,7 @@ private:
 	
 	void addVertex(float x, float y, float z, int& cap);
 	void addTriangle(int a, int b, int c, int& cap);
+	void calcNormal(const int tri);
 	
 	std::string m_filename;
 	float m_scale;	
@@ -23,13 +23,16 @@
 #include "DetourNavMesh.h"
 #include "Recast.h"
 #include "ChunkyTriMesh.h"
+#include "TileBuildCache.h"
 
 class Sample_TileMesh : public Sample
 {
 protected:
 	bool m_keepInterResults;
 	bool m_buildAll;
+	bool m_useBuildCache;
 	float m_totalBuildTimeMs;
+	TileBuildCache m_buildCache;
 
 	unsigned char* m_triareas;
 	rcHeightfield* m_solid;
@@ -68,6 +71,11 @@ protected:
 	int m_maxPolysPerTile;
 	float m_tileSize;
 	
+	/// The tile grid of the navigation mesh. Moving the input can grow its bounds, so the grid
+	/// is kept from when the navigation mesh was created.
+	int m_tileGridWidth;
+	int m_tileGridHeight;
+	
 	unsigned int m_tileCol;
 	float m_lastBuiltTileBmin[3];
 	float m_lastBuiltTileBmax[3];
@@ -76,8 +84,12 @@ protected:
 	int m_tileTriCount;
 
 	unsigned char* buildTileMesh(const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize);
+	/// Hashes everything the tile build reads: the build config, the triangles in the chunks,
+	/// and the convex volumes and off-mesh connections that overlap the tile bounds.
+	uint64_t calcTileInputHash(const int tx, const int ty, const int* cid, const int ncid) const;
 	
 	void cleanup();
+	void updateTileGrid();
 	
 	void saveAll(const char* path, const dtNavMesh* mesh);
 	dtNavMesh* loadAll(const char* path);
@@ -101,6 +113,10 @@ public:
 	void removeTile(const float* pos);
 	void buildAllTiles();
 	void removeAllTiles();
+	/// Moves the input triangles around the position up or down, and rebuilds the tiles they touch.
+	void moveInputTris(const float* pos, const float radius, const float dy);
+	/// Rebuilds the tiles touched by the input changes recorded in InputGeom.
+	void rebuildChangedTiles();
 
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#ifndef TILEBUILDCACHE_H
+#define TILEBUILDCACHE_H
+
+#include <stdint.h>
+#include <string>
+
+/// 64-bit FNV-1a hash of the inputs of a tile build.
+class TileBuildHash
+{
+	uint64_t m_hash;
+
+public:
+	TileBuildHash() : m_hash(14695981039346656037ULL) {}
+
+	void add(const void* data, const int size);
+	void addInt(const int v) { add(&v, sizeof(v)); }
+	void addFloat(const float v) { add(&v, sizeof(v)); }
+	uint64_t get() const { return m_hash; }
+};
+
+/// On-disk store of built tile data, addressed by the hash of the tile build inputs.
+/// Each entry is a file named after the hash in the cache directory. An entry can be
+/// empty, which records that the inputs build no tile.
+class TileBuildCache
+{
+	std::string m_path;
+	int m_hitCount;
+	int m_missCount;
+
+	std::string getEntryPath(const uint64_t key) const;
+
+public:
+	TileBuildCache();
+
+	/// Sets the directory of the cache files. It is created on the first store.
+	void setPath(const char* path) { m_path = path; }
+	const char* getPath() const { return m_path.c_str(); }
+
+	/// Loads the entry for the key.
+	///  @param[in]		key			The hash of the tile build inputs.
+	///  @param[out]	data		The tile data allocated with dtAlloc, or null if the entry is empty.
+	///  @param[out]	dataSize	The size of the tile data.
+	/// @return True if the entry was found.
+	bool load(const uint64_t key, unsigned char** data, int* dataSize);
+
+	/// Stores the tile data, or an empty entry if @p data is null, under the key.
+	bool store(const uint64_t key, const unsigned char* data, const int dataSize);
+
+	int getHitCount() const { return m_hitCount; }
+	int getMissCount() const { return m_missCount; }
+	void resetStats() { m_hitCount = m_missCount = 0; }
+};
+
+#endif // TILEBUILDCACHE_H
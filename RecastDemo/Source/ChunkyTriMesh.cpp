@@ -200,6 +200,49 @@ bool rcCreateChunkyTriMesh(const float* verts, const int* tris, int ntris,
 	return true;
 }
 
+void rcRefitChunkyTriMesh(const float* verts, rcChunkyTriMesh* cm)
+{
+	// The children are stored after their parent, update the nodes bottom up.
+	for (int i = cm->nnodes-1; i >= 0; --i)
+	{
+		rcChunkyTriMeshNode& node = cm->nodes[i];
+		if (node.i >= 0)
+		{
+			// Leaf
+			const int* tris = &cm->tris[node.i*3];
+			node.bmin[0] = node.bmax[0] = verts[tris[0]*3+0];
+			node.bmin[1] = node.bmax[1] = verts[tris[0]*3+2];
+			for (int j = 1; j < node.n*3; ++j)
+			{
+				const float* v = &verts[tris[j]*3];
+				if (v[0] < node.bmin[0]) node.bmin[0] = v[0];
+				if (v[2] < node.bmin[1]) node.bmin[1] = v[2];
+				
+				if (v[0] > node.bmax[0]) node.bmax[0] = v[0];
+				if (v[2] > node.bmax[1]) node.bmax[1] = v[2];
+			}
+		}
+		else
+		{
+			// The right child follows the subtree of the left child.
+			const rcChunkyTriMeshNode& left = cm->nodes[i+1];
+			const int right = i+1 + (left.i >= 0 ? 1 : -left.i);
+			node.bmin[0] = left.bmin[0];
+			node.bmin[1] = left.bmin[1];
+			node.bmax[0] = left.bmax[0];
+			node.bmax[1] = left.bmax[1];
+			if (right < cm->nnodes)
+			{
+				const rcChunkyTriMeshNode& it = cm->nodes[right];
+				if (it.bmin[0] < node.bmin[0]) node.bmin[0] = it.bmin[0];
+				if (it.bmin[1] < node.bmin[1]) node.bmin[1] = it.bmin[1];
+				
+				if (it.bmax[0] > node.bmax[0]) node.bmax[0] = it.bmax[0];
+				if (it.bmax[1] > node.bmax[1]) node.bmax[1] = it.bmax[1];
+			}
+		}
+	}
+}
 
 inline bool checkOverlapRect(const float amin[2], const float amax[2],
 							 const float bmin[2], const float bmax[2])
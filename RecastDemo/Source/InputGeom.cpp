@@ -16,11 +16,13 @@
 // 3. This notice may not be removed or altered from any source distribution.
 //
 
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
 #include <algorithm>
+#include <vector>
 #include "Recast.h"
 #include "InputGeom.h"
 #include "ChunkyTriMesh.h"
@@ -111,7 +113,8 @@ InputGeom::InputGeom() :
 	m_mesh(0),
 	m_hasBuildSettings(false),
 	m_offMeshConCount(0),
-	m_volumeCount(0)
+	m_volumeCount(0),
+	m_changeCount(0)
 {
 }
 
@@ -132,6 +135,7 @@ bool InputGeom::loadMesh(rcContext* ctx, const std::string& filepath)
 	}
 	m_offMeshConCount = 0;
 	m_volumeCount = 0;
+	m_changeCount = 0;
 	
 	m_mesh = new rcMeshLoaderObj;
 	if (!m_mesh)
@@ -203,6 +207,7 @@ bool InputGeom::loadGeomSet(rcContext* ctx, const std::string& filepath)
 	
 	m_offMeshConCount = 0;
 	m_volumeCount = 0;
+	m_changeCount = 0;
 	delete m_mesh;
 	m_mesh = 0;
 
@@ -479,10 +484,17 @@ void InputGeom::addOffMeshConnection(const float* spos, const float* epos, const
 	rcVcopy(&v[0], spos);
 	rcVcopy(&v[3], epos);
 	m_offMeshConCount++;
+	
+	// The connection is stored in the tile of its start point, and linked from the tile of its end point.
+	markChanged(spos, spos);
+	markChanged(epos, epos);
 }
 
 void InputGeom::deleteOffMeshConnection(int i)
 {
+	const float* v = &m_offMeshConVerts[i*3*2];
+	markChanged(&v[0], &v[0]);
+	markChanged(&v[3], &v[3]);
 	m_offMeshConCount--;
 	float* src = &m_offMeshConVerts[m_offMeshConCount*3*2];
 	float* dst = &m_offMeshConVerts[i*3*2];
@@ -536,10 +548,18 @@ void InputGeom::addConvexVolume(const float* verts, const int nverts,
 	vol->hmax = maxh;
 	vol->nverts = nverts;
 	vol->area = area;
+	
+	float bmin[3], bmax[3];
+	rcCalcBounds(vol->verts, vol->nverts, bmin, bmax);
+	markChanged(bmin, bmax);
 }
 
 void InputGeom::deleteConvexVolume(int i)
 {
+	float bmin[3], bmax[3];
+	rcCalcBounds(m_volumes[i].verts, m_volumes[i].nverts, bmin, bmax);
+	markChanged(bmin, bmax);
+	
 	m_volumeCount--;
 	m_volumes[i] = m_volumes[m_volumeCount];
 }
@@ -611,3 +631,77 @@ void InputGeom::drawConvexVolumes(struct duDebugDraw* dd, bool /*hilight*/)
 	
 	dd->depthMask(true);
 }
+
+void InputGeom::markChanged(const float* bmin, const float* bmax)
+{
+	// Grow the last change when out of space.
+	if (m_changeCount >= MAX_CHANGES)
+	{
+		float* b = &m_changeBounds[(MAX_CHANGES-1)*4];
+		b[0] = rcMin(b[0], bmin[0]);
+		b[1] = rcMin(b[1], bmin[2]);
+		b[2] = rcMax(b[2], bmax[0]);
+		b[3] = rcMax(b[3], bmax[2]);
+		return;
+	}
+	float* b = &m_changeBounds[m_changeCount*4];
+	b[0] = bmin[0];
+	b[1] = bmin[2];
+	b[2] = bmax[0];
+	b[3] = bmax[2];
+	m_changeCount++;
+}
+
+void InputGeom::moveMeshTris(const int* tris, const int ntris, const float* delta)
+{
+	if (!m_mesh || !m_chunkyMesh)
+		return;
+	
+	const float* verts = m_mesh->getVerts();
+	const int* meshTris = m_mesh->getTris();
+	const int nverts = m_mesh->getVertCount();
+	const int nmeshTris = m_mesh->getTriCount();
+	
+	// Collect the vertices to move.
+	std::vector<bool> moved(nverts, false);
+	std::vector<int> movedVerts;
+	for (int i = 0; i < ntris; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			const int v = meshTris[tris[i]*3+j];
+			if (!moved[v])
+			{
+				moved[v] = true;
+				movedVerts.push_back(v);
+			}
+		}
+	}
+	if (movedVerts.empty())
+		return;
+	
+	// The triangles sharing a moved vertex change too, they are covered by
+	// their bounds before and after the move.
+	float bmin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float bmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+			m_mesh->moveVerts(&movedVerts[0], (int)movedVerts.size(), delta);
+		for (int i = 0; i < nmeshTris; ++i)
+		{
+			const int* t = &meshTris[i*3];
+			if (!moved[t[0]] && !moved[t[1]] && !moved[t[2]])
+				continue;
+			for (int j = 0; j < 3; ++j)
+			{
+				rcVmin(bmin, &verts[t[j]*3]);
+				rcVmax(bmax, &verts[t[j]*3]);
+			}
+		}
+	}
+	markChanged(bmin, bmax);
+	
+	rcRefitChunkyTriMesh(verts, m_chunkyMesh);
+	rcCalcBounds(verts, nverts, m_meshBMin, m_meshBMax);
+}
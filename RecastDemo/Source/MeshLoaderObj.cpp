@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <cstring>
 #include <math.h>
+#include <vector>
 
 rcMeshLoaderObj::rcMeshLoaderObj() :
 	m_scale(1.0f),
@@ -214,31 +215,57 @@ bool rcMeshLoaderObj::load(const std::string& filename)
 
 	// Calculate normals.
 	m_normals = new float[m_triCount*3];
-	for (int i = 0; i < m_triCount*3; i += 3)
-	{
-		const float* v0 = &m_verts[m_tris[i]*3];
-		const float* v1 = &m_verts[m_tris[i+1]*3];
-		const float* v2 = &m_verts[m_tris[i+2]*3];
-		float e0[3], e1[3];
-		for (int j = 0; j < 3; ++j)
-		{
-			e0[j] = v1[j] - v0[j];
-			e1[j] = v2[j] - v0[j];
-		}
-		float* n = &m_normals[i];
-		n[0] = e0[1]*e1[2] - e0[2]*e1[1];
-		n[1] = e0[2]*e1[0] - e0[0]*e1[2];
-		n[2] = e0[0]*e1[1] - e0[1]*e1[0];
-		float d = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
-		if (d > 0)
-		{
-			d = 1.0f/d;
-			n[0] *= d;
-			n[1] *= d;
-			n[2] *= d;
-		}
-	}
+	for (int i = 0; i < m_triCount; ++i)
+		calcNormal(i);
 	
 	m_filename = filename;
 	return true;
 }
+
+void rcMeshLoaderObj::calcNormal(const int tri)
+{
+	const int i = tri*3;
+	const float* v0 = &m_verts[m_tris[i]*3];
+	const float* v1 = &m_verts[m_tris[i+1]*3];
+	const float* v2 = &m_verts[m_tris[i+2]*3];
+	float e0[3], e1[3];
+	for (int j = 0; j < 3; ++j)
+	{
+		e0[j] = v1[j] - v0[j];
+		e1[j] = v2[j] - v0[j];
+	}
+	float* n = &m_normals[i];
+	n[0] = e0[1]*e1[2] - e0[2]*e1[1];
+	n[1] = e0[2]*e1[0] - e0[0]*e1[2];
+	n[2] = e0[0]*e1[1] - e0[1]*e1[0];
+	float d = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+	if (d > 0)
+	{
+		d = 1.0f/d;
+		n[0] *= d;
+		n[1] *= d;
+		n[2] *= d;
+	}
+}
+
+void rcMeshLoaderObj::moveVerts(const int* verts, const int nverts, const float* delta)
+{
+	for (int i = 0; i < nverts; ++i)
+	{
+		float* v = &m_verts[verts[i]*3];
+		v[0] += delta[0];
+		v[1] += delta[1];
+		v[2] += delta[2];
+	}
+	
+	// Triangles sharing a moved vertex change shape too.
+	std::vector<bool> moved(m_vertCount, false);
+	for (int i = 0; i < nverts; ++i)
+		moved[verts[i]] = true;
+	for (int i = 0; i < m_triCount; ++i)
+	{
+		const int* t = &m_tris[i*3];
+		if (moved[t[0]] || moved[t[1]] || moved[t[2]])
+			calcNormal(i);
+	}
+}
@@ -19,6 +19,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #include "SDL.h"
 #include "SDL_opengl.h"
 #include "imgui.h"
@@ -514,8 +515,24 @@ bool Sample_SoloMesh::handleBuild()
 
 	// (Optional) Mark areas.
 	const ConvexVolume* vols = m_geom->getConvexVolumes();
-	for (int i  = 0; i < m_geom->getConvexVolumeCount(); ++i)
-		rcMarkConvexPolyArea(m_ctx, vols[i].verts, vols[i].nverts, vols[i].hmin, vols[i].hmax, (unsigned char)vols[i].area, *m_chf);
+	const int nvols = m_geom->getConvexVolumeCount();
+	if (nvols > 0)
+	{
+		std::vector<rcConvexPolyVolume> volumes(nvols);
+		for (int i = 0; i < nvols; ++i)
+		{
+			volumes[i].verts = vols[i].verts;
+			volumes[i].numVerts = vols[i].nverts;
+			volumes[i].minY = vols[i].hmin;
+			volumes[i].maxY = vols[i].hmax;
+			volumes[i].areaId = (unsigned char)vols[i].area;
+		}
+		if (!rcMarkConvexPolyAreas(m_ctx, &volumes[0], nvols, *m_chf))
+		{
+			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not mark areas.");
+			return false;
+		}
+	}
 
 	
 	// Partition the heightfield so that we can use simple algorithm later to triangulate the walkable areas.
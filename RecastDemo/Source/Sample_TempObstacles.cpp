@@ -19,6 +19,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #include <float.h>
 #include <new>
 #include "SDL.h"
@@ -402,11 +403,23 @@ int Sample_TempObstacles::rasterizeTileLayers(
 	
 	// (Optional) Mark areas.
 	const ConvexVolume* vols = m_geom->getConvexVolumes();
-	for (int i  = 0; i < m_geom->getConvexVolumeCount(); ++i)
+	const int nvols = m_geom->getConvexVolumeCount();
+	if (nvols > 0)
 	{
-		rcMarkConvexPolyArea(m_ctx, vols[i].verts, vols[i].nverts,
-							 vols[i].hmin, vols[i].hmax,
-							 (unsigned char)vols[i].area, *rc.chf);
+		std::vector<rcConvexPolyVolume> volumes(nvols);
+		for (int i = 0; i < nvols; ++i)
+		{
+			volumes[i].verts = vols[i].verts;
+			volumes[i].numVerts = vols[i].nverts;
+			volumes[i].minY = vols[i].hmin;
+			volumes[i].maxY = vols[i].hmax;
+			volumes[i].areaId = (unsigned char)vols[i].area;
+		}
+		if (!rcMarkConvexPolyAreas(m_ctx, &volumes[0], nvols, *rc.chf))
+		{
+			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not mark areas.");
+			return 0;
+		}
 	}
 	
 	rc.lset = rcAllocHeightfieldLayerSet();
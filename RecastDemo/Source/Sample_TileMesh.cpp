@@ -19,6 +19,8 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
 #include "SDL.h"
 #include "SDL_opengl.h"
 #ifdef __APPLE__
@@ -76,12 +78,18 @@ class NavMeshTileTool : public SampleTool
 	Sample_TileMesh* m_sample;
 	float m_hitPos[3];
 	bool m_hitPosSet;
+	bool m_moveInput;
+	float m_moveRadius;
+	float m_moveHeight;
 	
 public:
 
 	NavMeshTileTool() :
 		m_sample(0),
-		m_hitPosSet(false)
+		m_hitPosSet(false),
+		m_moveInput(false),
+		m_moveRadius(2.0f),
+		m_moveHeight(0.5f)
 	{
 		m_hitPos[0] = m_hitPos[1] = m_hitPos[2] = 0;
 	}
@@ -110,6 +118,17 @@ public:
 			if (m_sample)
 				m_sample->removeAllTiles();
 		}
+		
+		imguiSeparator();
+		if (imguiCheck("Move Input", m_moveInput))
+			m_moveInput = !m_moveInput;
+		if (m_moveInput)
+		{
+			imguiSlider("Radius", &m_moveRadius, 0.5f, 20.0f, 0.5f);
+			imguiSlider("Height", &m_moveHeight, 0.1f, 5.0f, 0.1f);
+			imguiValue("Click LMB to raise the input.");
+			imguiValue("Shift+LMB to lower the input.");
+		}
 	}
 
 	virtual void handleClick(const float* /*s*/, const float* p, bool shift)
@@ -118,7 +137,9 @@ public:
 		rcVcopy(m_hitPos,p);
 		if (m_sample)
 		{
-			if (shift)
+			if (m_moveInput)
+				m_sample->moveInputTris(m_hitPos, m_moveRadius, shift ? -m_moveHeight : m_moveHeight);
+			else if (shift)
 				m_sample->removeTile(m_hitPos);
 			else
 				m_sample->buildTile(m_hitPos);
@@ -177,6 +198,7 @@ NavMeshTileTool::~NavMeshTileTool()
 Sample_TileMesh::Sample_TileMesh() :
 	m_keepInterResults(false),
 	m_buildAll(true),
+	m_useBuildCache(false),
 	m_totalBuildTimeMs(0),
 	m_triareas(0),
 	m_solid(0),
@@ -188,6 +210,8 @@ Sample_TileMesh::Sample_TileMesh() :
 	m_maxTiles(0),
 	m_maxPolysPerTile(0),
 	m_tileSize(32),
+	m_tileGridWidth(0),
+	m_tileGridHeight(0),
 	m_tileCol(duRGBA(0,0,0,32)),
 	m_tileBuildTime(0),
 	m_tileMemUsage(0),
@@ -233,6 +257,9 @@ void Sample_TileMesh::handleSettings()
 	if (imguiCheck("Build All Tiles", m_buildAll))
 		m_buildAll = !m_buildAll;
 	
+	if (imguiCheck("Use Build Cache", m_useBuildCache, !m_keepInterResults))
+		m_useBuildCache = !m_useBuildCache;
+	
 	imguiLabel("Tiling");
 	imguiSlider("TileSize", &m_tileSize, 16.0f, 1024.0f, 16.0f);
 	
@@ -272,6 +299,12 @@ void Sample_TileMesh::handleSettings()
 	imguiIndent();
 	imguiIndent();
 	
+	if (m_geom && m_navMesh && m_geom->getChangeCount() > 0)
+	{
+		if (imguiButton("Rebuild Changed Tiles"))
+			rebuildChangedTiles();
+	}
+	
 	if (imguiButton("Save"))
 	{
 		Sample::saveAll("all_tiles_navmesh.bin", m_navMesh);
@@ -282,6 +315,7 @@ void Sample_TileMesh::handleSettings()
 		dtFreeNavMesh(m_navMesh);
 		m_navMesh = Sample::loadAll("all_tiles_navmesh.bin");
 		m_navQuery->init(m_navMesh, 2048);
+		updateTileGrid();
 	}
 
 	imguiUnindent();
@@ -291,6 +325,12 @@ void Sample_TileMesh::handleSettings()
 	snprintf(msg, 64, "Build Time: %.1fms", m_totalBuildTimeMs);
 	imguiLabel(msg);
 	
+	if (m_useBuildCache && !m_keepInterResults)
+	{
+		snprintf(msg, 64, "Cache Hits: %d  Misses: %d", m_buildCache.getHitCount(), m_buildCache.getMissCount());
+		imguiLabel(msg);
+	}
+	
 	imguiSeparator();
 	
 	imguiSeparator();
@@ -626,8 +666,11 @@ bool Sample_TileMesh::handleBuild()
 		return false;
 	}
 	
+	updateTileGrid();
+	
 	if (m_buildAll)
 		buildAllTiles();
+	m_geom->clearChanges();
 	
 	if (m_tool)
 		m_tool->init(this);
@@ -738,6 +781,7 @@ void Sample_TileMesh::buildAllTiles()
 	
 	// Start the build process.
 	m_ctx->startTimer(RC_TIMER_TEMP);
+	m_buildCache.resetStats();
 
 	for (int y = 0; y < th; ++y)
 	{
@@ -790,6 +834,116 @@ void Sample_TileMesh::removeAllTiles()
 			m_navMesh->removeTile(m_navMesh->getTileRefAt(x,y,0),0,0);
 }
 
+void Sample_TileMesh::updateTileGrid()
+{
+	m_tileGridWidth = 0;
+	m_tileGridHeight = 0;
+	if (!m_geom || !m_navMesh) return;
+	
+	int gw = 0, gh = 0;
+	rcCalcGridSize(m_navMesh->getParams()->orig, m_geom->getNavMeshBoundsMax(), m_cellSize, &gw, &gh);
+	const int ts = (int)m_tileSize;
+	m_tileGridWidth = (gw + ts-1) / ts;
+	m_tileGridHeight = (gh + ts-1) / ts;
+}
+
+void Sample_TileMesh::moveInputTris(const float* pos, const float radius, const float dy)
+{
+	if (!m_geom || !m_geom->getMesh()) return;
+	
+	const float* verts = m_geom->getMesh()->getVerts();
+	const int* meshTris = m_geom->getMesh()->getTris();
+	const int ntris = m_geom->getMesh()->getTriCount();
+	
+	// Move the triangles whose center is within the square around the position.
+	std::vector<int> tris;
+	for (int i = 0; i < ntris; ++i)
+	{
+		const int* t = &meshTris[i*3];
+		const float cx = (verts[t[0]*3+0] + verts[t[1]*3+0] + verts[t[2]*3+0]) / 3.0f;
+		const float cz = (verts[t[0]*3+2] + verts[t[1]*3+2] + verts[t[2]*3+2]) / 3.0f;
+		if (rcAbs(cx - pos[0]) <= radius && rcAbs(cz - pos[2]) <= radius)
+			tris.push_back(i);
+	}
+	if (tris.empty())
+		return;
+	
+	const float delta[3] = { 0, dy, 0 };
+	m_geom->moveMeshTris(&tris[0], (int)tris.size(), delta);
+	rebuildChangedTiles();
+}
+
+void Sample_TileMesh::rebuildChangedTiles()
+{
+	if (!m_geom) return;
+	if (!m_navMesh) return;
+	
+	// Stay on the tile grid of the navigation mesh. Changes outside of it are skipped.
+	const float* bmin = m_navMesh->getParams()->orig;
+	const float* bmax = m_geom->getNavMeshBoundsMax();
+	const float ymin = m_geom->getNavMeshBoundsMin()[1];
+	const int tw = m_tileGridWidth;
+	const int th = m_tileGridHeight;
+	const float tcs = m_navMesh->getParams()->tileWidth;
+	
+	// A tile is built from the input within its bounds expanded by the border size, see buildTileMesh().
+	const float border = ((int)ceilf(m_agentRadius / m_cellSize) + 3) * m_cellSize;
+	
+	// Collect the tiles whose expanded bounds overlap the changes.
+	std::vector<int> tiles;
+	const float* changes = m_geom->getChangeBounds();
+	for (int i = 0; i < m_geom->getChangeCount(); ++i)
+	{
+		const float* c = &changes[i*4];
+		const int x0 = rcMax((int)ceilf((c[0] - border - bmin[0]) / tcs) - 1, 0);
+		const int x1 = rcMin((int)floorf((c[2] + border - bmin[0]) / tcs), tw-1);
+		const int y0 = rcMax((int)ceilf((c[1] - border - bmin[2]) / tcs) - 1, 0);
+		const int y1 = rcMin((int)floorf((c[3] + border - bmin[2]) / tcs), th-1);
+		for (int y = y0; y <= y1; ++y)
+			for (int x = x0; x <= x1; ++x)
+				tiles.push_back(x + y*tw);
+	}
+	std::sort(tiles.begin(), tiles.end());
+	tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+	
+	// Start the build process.
+	m_ctx->startTimer(RC_TIMER_TEMP);
+	
+	for (size_t i = 0; i < tiles.size(); ++i)
+	{
+		const int x = tiles[i] % tw;
+		const int y = tiles[i] / tw;
+		
+		m_lastBuiltTileBmin[0] = bmin[0] + x*tcs;
+		m_lastBuiltTileBmin[1] = ymin;
+		m_lastBuiltTileBmin[2] = bmin[2] + y*tcs;
+		
+		m_lastBuiltTileBmax[0] = bmin[0] + (x+1)*tcs;
+		m_lastBuiltTileBmax[1] = bmax[1];
+		m_lastBuiltTileBmax[2] = bmin[2] + (y+1)*tcs;
+		
+		int dataSize = 0;
+		unsigned char* data = buildTileMesh(x, y, m_lastBuiltTileBmin, m_lastBuiltTileBmax, dataSize);
+		
+		// Remove any previous data (navmesh owns and deletes the data).
+		m_navMesh->removeTile(m_navMesh->getTileRefAt(x,y,0),0,0);
+		
+		// Add tile, or leave the location empty.
+		if (data)
+		{
+			// Let the navmesh own the data.
+			dtStatus status = m_navMesh->addTile(data,dataSize,DT_TILE_FREE_DATA,0,0);
+			if (dtStatusFailed(status))
+				dtFree(data);
+		}
+	}
+	
+	m_ctx->stopTimer(RC_TIMER_TEMP);
+	
+	m_totalBuildTimeMs = m_ctx->getAccumulatedTime(RC_TIMER_TEMP)/1000.0f;
+	
+	m_geom->clearChanges();
+}
 
 unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize)
 {
@@ -867,6 +1021,41 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 	m_ctx->log(RC_LOG_PROGRESS, " - %d x %d cells", m_cfg.width, m_cfg.height);
 	m_ctx->log(RC_LOG_PROGRESS, " - %.1fK verts, %.1fK tris", nverts/1000.0f, ntris/1000.0f);
 	
+	float tbmin[2], tbmax[2];
+	tbmin[0] = m_cfg.bmin[0];
+	tbmin[1] = m_cfg.bmin[2];
+	tbmax[0] = m_cfg.bmax[0];
+	tbmax[1] = m_cfg.bmax[2];
+	int cid[512];// TODO: Make grow when returning too many items.
+	const int ncid = rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid, 512);
+	if (!ncid)
+		return 0;
+	
+	m_tileTriCount = 0;
+	
+	for (int i = 0; i < ncid; ++i)
+		m_tileTriCount += chunkyMesh->nodes[cid[i]].n;
+	
+	// Reuse the tile from the build cache if none of its inputs changed.
+	// The intermediate results are only available from a real build.
+	const bool useCache = m_useBuildCache && !m_keepInterResults;
+	uint64_t cacheKey = 0;
+	if (useCache)
+	{
+		cacheKey = calcTileInputHash(tx, ty, cid, ncid);
+		unsigned char* cachedData = 0;
+		int cachedDataSize = 0;
+		if (m_buildCache.load(cacheKey, &cachedData, &cachedDataSize))
+		{
+			m_ctx->stopTimer(RC_TIMER_TOTAL);
+			m_ctx->log(RC_LOG_PROGRESS, ">> Tile from build cache: %d bytes", cachedDataSize);
+			m_tileMemUsage = cachedDataSize/1024.0f;
+			m_tileBuildTime = m_ctx->getAccumulatedTime(RC_TIMER_TOTAL)/1000.0f;
+			dataSize = cachedDataSize;
+			return cachedData;
+		}
+	}
+	
 	// Allocate voxel heightfield where we rasterize our input data to.
 	m_solid = rcAllocHeightfield();
 	if (!m_solid)
@@ -890,26 +1079,12 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 		return 0;
 	}
 	
-	float tbmin[2], tbmax[2];
-	tbmin[0] = m_cfg.bmin[0];
-	tbmin[1] = m_cfg.bmin[2];
-	tbmax[0] = m_cfg.bmax[0];
-	tbmax[1] = m_cfg.bmax[2];
-	int cid[512];// TODO: Make grow when returning too many items.
-	const int ncid = rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid, 512);
-	if (!ncid)
-		return 0;
-	
-	m_tileTriCount = 0;
-	
 	for (int i = 0; i < ncid; ++i)
 	{
 		const rcChunkyTriMeshNode& node = chunkyMesh->nodes[cid[i]];
 		const int* ctris = &chunkyMesh->tris[node.i*3];
 		const int nctris = node.n;
 		
-		m_tileTriCount += nctris;
-		
 		memset(m_triareas, 0, nctris*sizeof(unsigned char));
 		rcMarkWalkableTriangles(m_ctx, m_cfg.walkableSlopeAngle,
 								verts, nverts, ctris, nctris, m_triareas);
@@ -964,8 +1139,24 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 
 	// (Optional) Mark areas.
 	const ConvexVolume* vols = m_geom->getConvexVolumes();
-	for (int i  = 0; i < m_geom->getConvexVolumeCount(); ++i)
-		rcMarkConvexPolyArea(m_ctx, vols[i].verts, vols[i].nverts, vols[i].hmin, vols[i].hmax, (unsigned char)vols[i].area, *m_chf);
+	const int nvols = m_geom->getConvexVolumeCount();
+	if (nvols > 0)
+	{
+		std::vector<rcConvexPolyVolume> volumes(nvols);
+		for (int i = 0; i < nvols; ++i)
+		{
+			volumes[i].verts = vols[i].verts;
+			volumes[i].numVerts = vols[i].nverts;
+			volumes[i].minY = vols[i].hmin;
+			volumes[i].maxY = vols[i].hmax;
+			volumes[i].areaId = (unsigned char)vols[i].area;
+		}
+		if (!rcMarkConvexPolyAreas(m_ctx, &volumes[0], nvols, *m_chf))
+		{
+			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not mark areas.");
+			return 0;
+		}
+	}
 	
 	
 	// Partition the heightfield so that we can use simple algorithm later to triangulate the walkable areas.
@@ -1045,6 +1236,8 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 	
 	if (m_cset->nconts == 0)
 	{
+		if (useCache)
+			m_buildCache.store(cacheKey, 0, 0);
 		return 0;
 	}
 	
@@ -1159,6 +1352,9 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 	}
 	m_tileMemUsage = navDataSize/1024.0f;
 	
+	if (useCache && !m_buildCache.store(cacheKey, navData, navDataSize))
+		m_ctx->log(RC_LOG_WARNING, "Could not store tile in build cache '%s'.", m_buildCache.getPath());
+	
 	m_ctx->stopTimer(RC_TIMER_TOTAL);
 	
 	// Show performance stats.
@@ -1170,3 +1366,72 @@ unsigned char* Sample_TileMesh::buildTileMesh(const int tx, const int ty, const
 	dataSize = navDataSize;
 	return navData;
 }
+
+uint64_t Sample_TileMesh::calcTileInputHash(const int tx, const int ty, const int* cid, const int ncid) const
+{
+	TileBuildHash hash;
+	
+	// Build settings. The config is cleared before it is set, so its bytes are deterministic.
+	hash.addInt(DT_NAVMESH_VERSION);
+	hash.add(&m_cfg, sizeof(m_cfg));
+	hash.addInt(m_partitionType);
+	hash.addInt(m_filterLowHangingObstacles ? 1 : 0);
+	hash.addInt(m_filterLedgeSpans ? 1 : 0);
+	hash.addInt(m_filterWalkableLowHeightSpans ? 1 : 0);
+	hash.addFloat(m_agentHeight);
+	hash.addFloat(m_agentRadius);
+	hash.addFloat(m_agentMaxClimb);
+	hash.addInt(tx);
+	hash.addInt(ty);
+	
+	// Triangles in the order they are rasterized.
+	const float* verts = m_geom->getMesh()->getVerts();
+	const rcChunkyTriMesh* chunkyMesh = m_geom->getChunkyMesh();
+	for (int i = 0; i < ncid; ++i)
+	{
+		const rcChunkyTriMeshNode& node = chunkyMesh->nodes[cid[i]];
+		const int* ctris = &chunkyMesh->tris[node.i*3];
+		hash.addInt(node.n);
+		for (int j = 0; j < node.n*3; ++j)
+			hash.add(&verts[ctris[j]*3], sizeof(float)*3);
+	}
+	
+	// Convex volumes overlapping the tile, in marking order.
+	const ConvexVolume* vols = m_geom->getConvexVolumes();
+	for (int i = 0; i < m_geom->getConvexVolumeCount(); ++i)
+	{
+		const ConvexVolume& vol = vols[i];
+		float vmin[3], vmax[3];
+		rcCalcBounds(vol.verts, vol.nverts, vmin, vmax);
+		if (vmin[0] > m_cfg.bmax[0] || vmax[0] < m_cfg.bmin[0] ||
+			vmin[2] > m_cfg.bmax[2] || vmax[2] < m_cfg.bmin[2])
+			continue;
+		hash.addInt(vol.nverts);
+		hash.add(vol.verts, sizeof(float)*3*vol.nverts);
+		hash.addFloat(vol.hmin);
+		hash.addFloat(vol.hmax);
+		hash.addInt(vol.area);
+	}
+	
+	// Off-mesh connections that start or end inside the tile. Only the ones that start inside
+	// are stored in its data, but the tile also allocates links for the end points inside it.
+	const float* conVerts = m_geom->getOffMeshConnectionVerts();
+	for (int i = 0; i < m_geom->getOffMeshConnectionCount(); ++i)
+	{
+		const float* v = &conVerts[i*6];
+		const bool startInside = v[0] >= m_cfg.bmin[0] && v[0] <= m_cfg.bmax[0] &&
+								 v[2] >= m_cfg.bmin[2] && v[2] <= m_cfg.bmax[2];
+		const bool endInside = v[3] >= m_cfg.bmin[0] && v[3] <= m_cfg.bmax[0] &&
+							   v[5] >= m_cfg.bmin[2] && v[5] <= m_cfg.bmax[2];
+		if (!startInside && !endInside)
+			continue;
+		hash.add(v, sizeof(float)*6);
+		hash.addFloat(m_geom->getOffMeshConnectionRads()[i]);
+		hash.addInt(m_geom->getOffMeshConnectionDirs()[i]);
+		hash.addInt(m_geom->getOffMeshConnectionAreas()[i]);
+		hash.addInt(m_geom->getOffMeshConnectionFlags()[i]);
+		hash.addInt((int)m_geom->getOffMeshConnectionId()[i]);
+	}
+	
+	return hash.get();
+}
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+
+#include "TileBuildCache.h"
+
+#include <stdio.h>
+#ifdef WIN32
+#	include <direct.h>
+#else
+#	include <sys/stat.h>
+#endif
+
+#include "DetourAlloc.h"
+#include "DetourNavMesh.h"
+
+static const int TILE_CACHE_FILE_MAGIC = 'T'<<24 | 'B'<<16 | 'C'<<8 | 'F'; //'TBCF';
+static const int TILE_CACHE_FILE_VERSION = 1;
+
+struct TileCacheFileHeader
+{
+	int magic;
+	int version;
+	uint64_t key;
+	int dataSize;
+};
+
+static void makeDirectory(const char* path)
+{
+#ifdef WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+}
+
+void TileBuildHash::add(const void* data, const int size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	for (int i = 0; i < size; ++i)
+	{
+		m_hash ^= p[i];
+		m_hash *= 1099511628211ULL;
+	}
+}
+
+TileBuildCache::TileBuildCache() :
+	m_path("TileCache"),
+	m_hitCount(0),
+	m_missCount(0)
+{
+}
+
+std::string TileBuildCache::getEntryPath(const uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%08x%08x.bin", (unsigned int)(key >> 32), (unsigned int)key);
+	return m_path + name;
+}
+
+bool TileBuildCache::load(const uint64_t key, unsigned char** data, int* dataSize)
+{
+	*data = 0;
+	*dataSize = 0;
+
+	const std::string path = getEntryPath(key);
+	FILE* fp = fopen(path.c_str(), "rb");
+	if (!fp)
+	{
+		m_missCount++;
+		return false;
+	}
+
+	// Entries that do not match are treated as missing, and overwritten by the next store.
+	TileCacheFileHeader header;
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1
+		&& header.magic == TILE_CACHE_FILE_MAGIC
+		&& header.version == TILE_CACHE_FILE_VERSION
+		&& header.key == key
+		&& header.dataSize >= 0;
+	unsigned char* tileData = 0;
+	if (ok && header.dataSize > 0)
+	{
+		tileData = (unsigned char*)dtAlloc(header.dataSize, DT_ALLOC_PERM);
+		ok = tileData && fread(tileData, header.dataSize, 1, fp) == 1;
+		if (ok)
+		{
+			const dtMeshHeader* tileHeader = (const dtMeshHeader*)tileData;
+			ok = header.dataSize >= (int)sizeof(dtMeshHeader)
+				&& tileHeader->magic == DT_NAVMESH_MAGIC
+				&& tileHeader->version == DT_NAVMESH_VERSION;
+		}
+	}
+	fclose(fp);
+
+	if (!ok)
+	{
+		dtFree(tileData);
+		m_missCount++;
+		return false;
+	}
+
+	*data = tileData;
+	*dataSize = header.dataSize;
+	m_hitCount++;
+	return true;
+}
+
+bool TileBuildCache::store(const uint64_t key, const unsigned char* data, const int dataSize)
+{
+	TileCacheFileHeader header;
+	header.magic = TILE_CACHE_FILE_MAGIC;
+	header.version = TILE_CACHE_FILE_VERSION;
+	header.key = key;
+	header.dataSize = data ? dataSize : 0;
+
+	// Write to a temporary file first, so that an interrupted store does not leave a partial entry.
+	const std::string path = getEntryPath(key);
+	const std::string tempPath = path + ".tmp";
+	FILE* fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+	{
+		makeDirectory(m_path.c_str());
+		fp = fopen(tempPath.c_str(), "wb");
+		if (!fp)
+			return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+	if (ok && header.dataSize > 0)
+		ok = fwrite(data, header.dataSize, 1, fp) == 1;
+	ok = fclose(fp) == 0 && ok;
+
+	remove(path.c_str());
+	if (!ok || rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
@@ -78,6 +78,7 @@ project "Detour"
 	}
 	files { 
 		"../Detour/Include/*.h", 
+		"../Detour/Include/*.inl", 
 		"../Detour/Source/*.cpp" 
 	}
 	-- linux library cflags and libs
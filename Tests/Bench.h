@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdio.h>
+
+// Benchmark harness shared by the Bench_*.cpp files.
+//
+// BM(name, iterations) { body } registers a test case that runs the body the given number of
+// times and prints the CPU time taken. Benchmarks are tagged hidden so the default test run
+// skips them; run them with `Tests "[bench]"`. BENCH_SUPPORTED is defined when the platform has
+// a timer the harness can use.
+
+// TODO: Implement benchmarking for platforms other than posix.
+#ifdef __unix__
+#include <unistd.h>
+#ifdef _POSIX_TIMERS
+#include <time.h>
+#include <stdint.h>
+
+#define BENCH_SUPPORTED 1
+
+inline int64_t NowNanos() {
+	struct timespec tp;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
+	return tp.tv_nsec + 1000000000LL * tp.tv_sec;
+}
+
+#define BM(name, iterations) \
+	struct BM_ ## name { \
+		static void Run() { \
+			int64_t begin_time = NowNanos(); \
+			for (int i = 0 ; i < iterations; i++) { \
+				Body(); \
+			} \
+			int64_t nanos = NowNanos() - begin_time; \
+			printf("BM_%-35s %ld iterations in %10ld nanos: %10.2f nanos/it\n", #name ":", (int64_t)iterations, nanos, double(nanos) / iterations); \
+		} \
+		static void Body(); \
+	}; \
+	TEST_CASE(#name, "[.bench]") { \
+		BM_ ## name::Run(); \
+	} \
+	void BM_ ## name::Body()
+
+#endif  // _POSIX_TIMERS
+#endif  // __unix__
@@ -0,0 +1,833 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourLandmarks.h"
+#include "DetourAreaSampler.h"
+#include "DetourCommon.h"
+#include "DetourCrowd.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourNavMeshQueryTemplate.inl"
+#include "DetourNode.h"
+#include "DetourStraightPath.h"
+#include "DetourPathCorridor.h"
+
+#include "TestNavMesh.h"
+
+#include "../Bench.h"
+
+#ifdef BENCH_SUPPORTED
+
+namespace
+{
+// Custom filters with virtual and statically bound calls.
+class BenchFilter
+{
+public:
+	virtual ~BenchFilter() {}
+	virtual bool passFilter(const dtPolyRef, const dtMeshTile*, const dtPoly* poly) const = 0;
+	virtual float getCost(const float* pa, const float* pb,
+						  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+						  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+						  const dtPolyRef, const dtMeshTile*, const dtPoly*) const = 0;
+};
+
+class BenchFlagFilter final : public BenchFilter
+{
+public:
+	bool passFilter(const dtPolyRef, const dtMeshTile*, const dtPoly* poly) const override
+	{
+		return (poly->flags & 1) != 0;
+	}
+	float getCost(const float* pa, const float* pb,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*) const override
+	{
+		return dtVdist(pa, pb);
+	}
+};
+
+// Shared maze level used by all the path finding benchmarks.
+struct BenchMaze
+{
+	dtNavMesh* nav;
+	dtNavMeshQuery* query;
+	dtNavMeshLandmarks* landmarks;
+	dtQueryFilter filter;
+	float startPos[3];
+	float endPos[3];
+	float islandPos[3];
+	dtPolyRef startRef;
+	dtPolyRef endRef;
+	dtPolyRef islandRef;
+
+	BenchMaze() : nav(0), query(0), landmarks(0), startRef(0), endRef(0), islandRef(0)
+	{
+		// Maze with a small unreachable island next to it.
+		const TestGrid maze = makeMazeGrid(81, 81, 1.0f, 42);
+		TestGrid grid = makeOpenGrid(85, 81, 1.0f);
+		for (int z = 0; z < grid.height; ++z)
+			for (int x = 0; x < grid.width; ++x)
+				grid.open[z * grid.width + x] = maze.isOpen(x, z) || (x >= 82 && x <= 83 && z >= 40 && z <= 41);
+
+		nav = buildTestNavMesh(grid, 64);
+		query = dtAllocNavMeshQuery();
+		query->init(nav, 65535);
+		const float halfExtents[3] = { 0.5f, 1.0f, 0.5f };
+		float pos[3];
+		grid.cellCenter(1, 1, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &startRef, startPos);
+		grid.cellCenter(79, 79, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &endRef, endPos);
+		grid.cellCenter(83, 41, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &islandRef, islandPos);
+
+		landmarks = dtAllocNavMeshLandmarks();
+		landmarks->init(nav, 8);
+	}
+
+	~BenchMaze()
+	{
+		dtFreeNavMeshLandmarks(landmarks);
+		dtFreeNavMeshQuery(query);
+		dtFreeNavMesh(nav);
+	}
+
+	int run(const unsigned int options, const float weight, const bool unreachable = false, const bool useLandmarks = false)
+	{
+		query->setLandmarks(useLandmarks ? landmarks : 0);
+		dtPolyRef path[4096];
+		int npath = 0;
+		query->findPath(startRef, unreachable ? islandRef : endRef, startPos, unreachable ? islandPos : endPos,
+						&filter, path, &npath, 4096, options, weight);
+		return query->getNodePool()->getNodeCount();
+	}
+
+	template <class Filter>
+	void runFiltered(const BenchFlagFilter& flagFilter)
+	{
+		dtPolyRef path[4096];
+		int npath = 0;
+		query->setLandmarks(0);
+		query->findPath<Filter>(startRef, endRef, startPos, endPos, &flagFilter, path, &npath, 4096);
+	}
+};
+
+BenchMaze& getBenchMaze()
+{
+	static BenchMaze maze;
+	return maze;
+}
+
+// Corridor states of an agent walking the maze path, used by the corner benchmarks.
+struct BenchWalk
+{
+	static const int MAX_STEPS = 200;
+	static const int MAX_PATH = 4096;
+	float pos[MAX_STEPS][3];
+	dtPolyRef* paths[MAX_STEPS];
+	int npaths[MAX_STEPS];
+	int nsteps;
+
+	BenchWalk() : nsteps(0)
+	{
+		BenchMaze& maze = getBenchMaze();
+		maze.query->setLandmarks(0);
+		dtPolyRef path[MAX_PATH];
+		int npath = 0;
+		maze.query->findPath(maze.startRef, maze.endRef, maze.startPos, maze.endPos, &maze.filter, path, &npath, MAX_PATH);
+
+		dtPathCorridor corridor;
+		corridor.init(MAX_PATH);
+		corridor.reset(maze.startRef, maze.startPos);
+		corridor.setCorridor(maze.endPos, path, npath);
+		for (; nsteps < MAX_STEPS; ++nsteps)
+		{
+			dtVcopy(pos[nsteps], corridor.getPos());
+			npaths[nsteps] = corridor.getPathCount();
+			paths[nsteps] = new dtPolyRef[npaths[nsteps]];
+			memcpy(paths[nsteps], corridor.getPath(), sizeof(dtPolyRef)*npaths[nsteps]);
+
+			float corners[4*3];
+			unsigned char flags[4];
+			dtPolyRef polys[4];
+			const int ncorners = corridor.findCorners(corners, flags, polys, 4, maze.query, &maze.filter);
+			if (!ncorners)
+				break;
+			float dir[3], npos[3];
+			dtVsub(dir, corners, corridor.getPos());
+			const float dist = dtVlen(dir);
+			dtVmad(npos, corridor.getPos(), dir, dtMin(0.25f, dist) / dist);
+			corridor.movePosition(npos, maze.query, &maze.filter);
+		}
+	}
+
+	~BenchWalk()
+	{
+		for (int i = 0; i < nsteps; ++i)
+			delete [] paths[i];
+	}
+
+	void run(dtStraightPathIterator* it)
+	{
+		BenchMaze& maze = getBenchMaze();
+		float corners[4*3];
+		unsigned char flags[4];
+		dtPolyRef polys[4];
+		int ncorners = 0;
+		for (int i = 0; i < nsteps; ++i)
+		{
+			if (it)
+			{
+				it->begin(maze.query, pos[i], maze.endPos, paths[i], npaths[i]);
+				it->getStraightPath(corners, flags, polys, &ncorners, 4);
+			}
+			else
+			{
+				maze.query->findStraightPath(pos[i], maze.endPos, paths[i], npaths[i], corners, flags, polys, &ncorners, 4);
+			}
+		}
+	}
+};
+
+BenchWalk& getBenchWalk()
+{
+	static BenchWalk walk;
+	return walk;
+}
+
+// Maze tiles built with each bounding volume tree layout, queried with the same boxes.
+// Median and SAH binary trees, then 4-wide and 8-wide SAH trees.
+struct BenchBVTree
+{
+	static const int NUM_TREES = 4;
+	static const int NUM_BOXES = 256;
+	dtNavMesh* navs[NUM_TREES];
+	dtNavMeshQuery* queries[NUM_TREES];
+	dtQueryFilter filter;
+	float centers[NUM_BOXES][3];
+
+	BenchBVTree()
+	{
+		const TestGrid grid = makeMazeGrid(81, 81, 1.0f, 42);
+		const int widths[NUM_TREES] = { 2, 2, 4, 8 };
+		for (int i = 0; i < NUM_TREES; ++i)
+		{
+			navs[i] = buildTestNavMesh(grid, 128, i == 0 ? DT_BVTREE_SPLIT_MEDIAN : DT_BVTREE_SPLIT_SAH, widths[i]);
+			queries[i] = dtAllocNavMeshQuery();
+			queries[i]->init(navs[i], 128);
+		}
+		unsigned int seed = 7;
+		for (int i = 0; i < NUM_BOXES; ++i)
+		{
+			seed = seed * 1103515245u + 12345u;
+			centers[i][0] = (float)(seed % 8100) / 100.0f;
+			centers[i][1] = 0.0f;
+			centers[i][2] = (float)((seed >> 12) % 8100) / 100.0f;
+		}
+	}
+
+	~BenchBVTree()
+	{
+		for (int i = 0; i < NUM_TREES; ++i)
+		{
+			dtFreeNavMeshQuery(queries[i]);
+			dtFreeNavMesh(navs[i]);
+		}
+	}
+
+	void queryPolygons(const int tree)
+	{
+		const float halfExtents[3] = { 1.5f, 1.0f, 1.5f };
+		dtPolyRef polys[256];
+		int npolys = 0;
+		for (int i = 0; i < NUM_BOXES; ++i)
+			queries[tree]->queryPolygons(centers[i], halfExtents, &filter, polys, &npolys, 256);
+	}
+
+	void findNearestPoly(const int tree)
+	{
+		const float halfExtents[3] = { 0.5f, 1.0f, 0.5f };
+		dtPolyRef ref = 0;
+		float pt[3];
+		for (int i = 0; i < NUM_BOXES; ++i)
+			queries[tree]->findNearestPoly(centers[i], halfExtents, &filter, &ref, pt);
+	}
+};
+
+BenchBVTree& getBenchBVTree()
+{
+	static BenchBVTree bvtree;
+	return bvtree;
+}
+
+// Small open ground tiles found through the hash table and the dense grid lookups.
+struct BenchTileLookup
+{
+	dtNavMesh* navs[2];
+	int tw, th;
+
+	BenchTileLookup()
+	{
+		const TestGrid grid = makeOpenGrid(160, 160, 1.0f);
+		getTestTileCounts(grid, 16, &tw, &th);
+		dtTileLookupParams lookup;
+		memset(&lookup, 0, sizeof(lookup));
+		lookup.type = DT_TILE_LOOKUP_GRID;
+		lookup.width = tw;
+		lookup.height = th;
+		navs[0] = buildTestNavMesh(grid, 16);
+		navs[1] = buildTestNavMesh(grid, 16, DT_BVTREE_SPLIT_MEDIAN, 2, &lookup);
+	}
+
+	~BenchTileLookup()
+	{
+		dtFreeNavMesh(navs[0]);
+		dtFreeNavMesh(navs[1]);
+	}
+
+	// Finds the tiles around every location, as when connecting a tile.
+	int run(const int lookup)
+	{
+		const dtNavMesh* nav = navs[lookup];
+		const dtMeshTile* tiles[4];
+		int n = 0;
+		for (int y = 0; y < th; ++y)
+			for (int x = 0; x < tw; ++x)
+				for (int dy = -1; dy <= 1; ++dy)
+					for (int dx = -1; dx <= 1; ++dx)
+						n += nav->getTilesAt(x + dx, y + dy, tiles, 4);
+		return n;
+	}
+};
+
+BenchTileLookup& getBenchTileLookup()
+{
+	static BenchTileLookup lookup;
+	return lookup;
+}
+
+// Large tiles of narrow maze corridors, which have many polygon edges on their borders.
+struct BenchTileStitch
+{
+	dtNavMesh* nav;
+	unsigned char* data;
+	int dataSize;
+	dtTileRef ref;
+
+	BenchTileStitch() : data(0), dataSize(0), ref(0)
+	{
+		const TestGrid grid = makeMazeGrid(97, 97, 1.0f, 3);
+		nav = buildTestNavMesh(grid, 128);
+
+		// Replace a tile surrounded by neighbours with one whose data is kept between the runs.
+		nav->removeTile(nav->getTileRefAt(1, 1, 0), 0, 0);
+		buildTestTileData(grid, 128, 1, 1, &data, &dataSize);
+		nav->addTile(data, dataSize, 0, 0, &ref);
+	}
+
+	~BenchTileStitch()
+	{
+		dtFreeNavMesh(nav);
+		dtFree(data);
+	}
+
+	// Removes the tile and adds it back, which connects it to the neighbours.
+	void run()
+	{
+		nav->removeTile(ref, 0, 0);
+		nav->addTile(data, dataSize, 0, ref, 0);
+	}
+};
+
+BenchTileStitch& getBenchTileStitch()
+{
+	static BenchTileStitch stitch;
+	return stitch;
+}
+
+// A 3x3 block of tiles in the middle of the maze, removed and added back in a run.
+struct BenchTileBlock
+{
+	static const int kBlockSize = 3;
+	dtNavMesh* nav;
+	unsigned char* data[kBlockSize*kBlockSize];
+	int dataSize[kBlockSize*kBlockSize];
+	dtTileRef refs[kBlockSize*kBlockSize];
+
+	BenchTileBlock()
+	{
+		const TestGrid grid = makeMazeGrid(97, 97, 1.0f, 3);
+		nav = buildTestNavMesh(grid, 32);
+		for (int i = 0; i < kBlockSize*kBlockSize; ++i)
+		{
+			const int x = 3 + i % kBlockSize;
+			const int y = 3 + i / kBlockSize;
+			nav->removeTile(nav->getTileRefAt(x, y, 0), 0, 0);
+			data[i] = 0;
+			dataSize[i] = 0;
+			refs[i] = 0;
+			buildTestTileData(grid, 32, x, y, &data[i], &dataSize[i]);
+			nav->addTile(data[i], dataSize[i], 0, 0, &refs[i]);
+		}
+	}
+
+	~BenchTileBlock()
+	{
+		dtFreeNavMesh(nav);
+		for (int i = 0; i < kBlockSize*kBlockSize; ++i)
+			dtFree(data[i]);
+	}
+
+	void run(const bool batch)
+	{
+		if (batch)
+			nav->beginTileBatch();
+		for (int i = 0; i < kBlockSize*kBlockSize; ++i)
+			nav->removeTile(refs[i], 0, 0);
+		for (int i = 0; i < kBlockSize*kBlockSize; ++i)
+			nav->addTile(data[i], dataSize[i], 0, refs[i], 0);
+		if (batch)
+			nav->commitTileBatch();
+	}
+};
+
+BenchTileBlock& getBenchTileBlock()
+{
+	static BenchTileBlock block;
+	return block;
+}
+
+float benchRand()
+{
+	static unsigned int seed = 1;
+	seed = seed * 1664525u + 1013904223u;
+	return (float)(seed >> 8) / 16777216.0f;
+}
+
+// Open level with small tiles, where finding a random point visits many tiles.
+struct BenchRandomPoints
+{
+	dtNavMesh* nav;
+	dtNavMeshQuery* query;
+	dtNavMeshAreaSampler* sampler;
+	dtQueryFilter filter;
+
+	BenchRandomPoints()
+	{
+		const TestGrid grid = makeOpenGrid(200, 200, 1.0f);
+		nav = buildTestNavMesh(grid, 16);
+		query = dtAllocNavMeshQuery();
+		query->init(nav, 2048);
+		sampler = dtAllocNavMeshAreaSampler();
+		sampler->init(nav, &filter);
+	}
+
+	~BenchRandomPoints()
+	{
+		dtFreeNavMeshAreaSampler(sampler);
+		dtFreeNavMeshQuery(query);
+		dtFreeNavMesh(nav);
+	}
+
+	void run(const bool useSampler)
+	{
+		query->setAreaSampler(useSampler ? sampler : 0);
+		for (int i = 0; i < 100; ++i)
+		{
+			dtPolyRef ref;
+			float pt[3];
+			query->findRandomPoint(&filter, benchRand, &ref, pt);
+		}
+	}
+};
+
+BenchRandomPoints& getBenchRandomPoints()
+{
+	static BenchRandomPoints points;
+	return points;
+}
+
+// Moves of a given length from random points of the open level.
+struct BenchMoves
+{
+	static const int kMoveCount = 100;
+	dtPolyRef refs[kMoveCount];
+	float startPos[kMoveCount*3];
+	float endPos[kMoveCount*3];
+
+	explicit BenchMoves(const float length)
+	{
+		BenchRandomPoints& points = getBenchRandomPoints();
+		points.query->setAreaSampler(points.sampler);
+		for (int i = 0; i < kMoveCount; ++i)
+		{
+			points.query->findRandomPoint(&points.filter, benchRand, &refs[i], &startPos[i*3]);
+			const float angle = benchRand() * 6.2831853f;
+			endPos[i*3+0] = startPos[i*3+0] + cosf(angle) * length;
+			endPos[i*3+1] = startPos[i*3+1];
+			endPos[i*3+2] = startPos[i*3+2] + sinf(angle) * length;
+		}
+	}
+
+	void run()
+	{
+		BenchRandomPoints& points = getBenchRandomPoints();
+		for (int i = 0; i < kMoveCount; ++i)
+		{
+			float resultPos[3];
+			dtPolyRef visited[256];
+			int nvisited = 0;
+			points.query->moveAlongSurface(refs[i], &startPos[i*3], &endPos[i*3], &points.filter,
+										   resultPos, visited, &nvisited, 256);
+		}
+	}
+};
+
+// Line of sight checks from observers at random points of the maze, cast one at a time and
+// in a batch. The rays of the observers are interleaved.
+struct BenchRaycasts
+{
+	static const int kObserverCount = 32;
+	static const int kRayCount = 256;
+	static const int kMaxPath = 32;
+	dtPolyRef refs[kRayCount];
+	float startPos[kRayCount*3];
+	float endPos[kRayCount*3];
+	dtPolyRef paths[kRayCount*kMaxPath];
+	dtRaycastHit hits[kRayCount];
+
+	BenchRaycasts()
+	{
+		BenchMaze& maze = getBenchMaze();
+		for (int i = 0; i < kRayCount; ++i)
+		{
+			if (i < kObserverCount)
+			{
+				maze.query->findRandomPoint(&maze.filter, benchRand, &refs[i], &startPos[i*3]);
+			}
+			else
+			{
+				refs[i] = refs[i % kObserverCount];
+				dtVcopy(&startPos[i*3], &startPos[(i % kObserverCount)*3]);
+			}
+			const float angle = benchRand() * 6.2831853f;
+			endPos[i*3+0] = startPos[i*3+0] + cosf(angle) * 6.0f;
+			endPos[i*3+1] = startPos[i*3+1];
+			endPos[i*3+2] = startPos[i*3+2] + sinf(angle) * 6.0f;
+			memset(&hits[i], 0, sizeof(dtRaycastHit));
+			hits[i].path = &paths[i*kMaxPath];
+			hits[i].maxPath = kMaxPath;
+		}
+	}
+
+	int run(const bool batch)
+	{
+		BenchMaze& maze = getBenchMaze();
+		if (batch)
+		{
+			maze.query->raycastBatch(refs, startPos, endPos, kRayCount, &maze.filter, 0, hits);
+		}
+		else
+		{
+			for (int i = 0; i < kRayCount; ++i)
+				maze.query->raycast(refs[i], &startPos[i*3], &endPos[i*3], &maze.filter, 0, &hits[i]);
+		}
+		int n = 0;
+		for (int i = 0; i < kRayCount; ++i)
+			n += hits[i].pathCount;
+		return n;
+	}
+};
+
+BenchRaycasts& getBenchRaycasts()
+{
+	static BenchRaycasts raycasts;
+	return raycasts;
+}
+
+// Agents of a crowd walking to far targets of the open level, optimizing their corridors.
+struct BenchCrowd
+{
+	static const int kAgentCount = 200;
+	dtCrowd* crowd;
+
+	BenchCrowd()
+	{
+		BenchRandomPoints& points = getBenchRandomPoints();
+		points.query->setAreaSampler(points.sampler);
+		crowd = dtAllocCrowd();
+		crowd->init(kAgentCount, 0.6f, points.nav);
+
+		dtCrowdAgentParams params;
+		memset(&params, 0, sizeof(params));
+		params.radius = 0.6f;
+		params.height = 2.0f;
+		params.maxAcceleration = 8.0f;
+		params.maxSpeed = 3.5f;
+		params.collisionQueryRange = params.radius * 12.0f;
+		params.pathOptimizationRange = params.radius * 30.0f;
+		params.updateFlags = DT_CROWD_ANTICIPATE_TURNS | DT_CROWD_OPTIMIZE_VIS | DT_CROWD_OPTIMIZE_TOPO;
+		for (int i = 0; i < kAgentCount; ++i)
+		{
+			dtPolyRef ref, targetRef;
+			float pos[3], target[3];
+			points.query->findRandomPoint(&points.filter, benchRand, &ref, pos);
+			points.query->findRandomPoint(&points.filter, benchRand, &targetRef, target);
+			const int idx = crowd->addAgent(pos, &params);
+			crowd->requestMoveTarget(idx, targetRef, target);
+		}
+	}
+
+	~BenchCrowd()
+	{
+		dtFreeCrowd(crowd);
+	}
+};
+
+BenchCrowd& getBenchCrowd()
+{
+	static BenchCrowd crowd;
+	return crowd;
+}
+}
+
+const int64_t kNumQueries = 200;
+
+BM(dtNavMeshLandmarks_init, 5)
+{
+	BenchMaze& maze = getBenchMaze();
+	maze.landmarks->init(maze.nav, 8);
+}
+
+TEST_CASE("findPath_NodesExpanded", "[.bench]")
+{
+	BenchMaze& maze = getBenchMaze();
+	printf("findPath nodes expanded: default %d, weighted(2) %d, bidirectional %d, first path %d, bidirectional first path %d\n",
+		   maze.run(0, 1.0f), maze.run(0, 2.0f), maze.run(DT_FINDPATH_BIDIRECTIONAL, 1.0f),
+		   maze.run(DT_FINDPATH_FIRST_PATH, 1.0f), maze.run(DT_FINDPATH_BIDIRECTIONAL | DT_FINDPATH_FIRST_PATH, 1.0f));
+	printf("findPath nodes expanded, unreachable end: default %d, bidirectional %d\n",
+		   maze.run(0, 1.0f, true), maze.run(DT_FINDPATH_BIDIRECTIONAL, 1.0f, true));
+	printf("findPath nodes expanded with landmarks: default %d, bidirectional %d\n",
+		   maze.run(0, 1.0f, false, true), maze.run(DT_FINDPATH_BIDIRECTIONAL, 1.0f, false, true));
+}
+
+BM(findPath_Default, kNumQueries)
+{
+	getBenchMaze().run(0, 1.0f);
+}
+BM(findPath_Weighted, kNumQueries)
+{
+	getBenchMaze().run(0, 2.0f);
+}
+BM(findPath_Bidirectional, kNumQueries)
+{
+	getBenchMaze().run(DT_FINDPATH_BIDIRECTIONAL, 1.0f);
+}
+BM(findPath_FirstPath, kNumQueries)
+{
+	getBenchMaze().run(DT_FINDPATH_FIRST_PATH, 1.0f);
+}
+BM(findPath_BidirectionalFirstPath, kNumQueries)
+{
+	getBenchMaze().run(DT_FINDPATH_BIDIRECTIONAL | DT_FINDPATH_FIRST_PATH, 1.0f);
+}
+BM(findPath_Landmarks, kNumQueries)
+{
+	getBenchMaze().run(0, 1.0f, false, true);
+}
+BM(findPath_LandmarksBidirectional, kNumQueries)
+{
+	getBenchMaze().run(DT_FINDPATH_BIDIRECTIONAL, 1.0f, false, true);
+}
+BM(findPath_VirtualFilter, kNumQueries)
+{
+	static const BenchFlagFilter filter;
+	getBenchMaze().runFiltered<BenchFilter>(filter);
+}
+BM(findPath_StaticFilter, kNumQueries)
+{
+	static const BenchFlagFilter filter;
+	getBenchMaze().runFiltered<BenchFlagFilter>(filter);
+}
+BM(findCorners_FindStraightPath, kNumQueries)
+{
+	getBenchWalk().run(0);
+}
+BM(findCorners_StraightPathIterator, kNumQueries)
+{
+	static dtStraightPathIterator it;
+	static bool initialized = it.init(32);
+	(void)initialized;
+	getBenchWalk().run(&it);
+}
+TEST_CASE("bvTree_Depth", "[.bench]")
+{
+	BenchBVTree& bvtree = getBenchBVTree();
+	int depthSum[2] = { 0, 0 };
+	int leafCount[2] = { 0, 0 };
+	for (int n = 0; n < 2; ++n)
+	{
+		const dtNavMesh* nav = bvtree.navs[n];
+		for (int t = 0; t < nav->getMaxTiles(); ++t)
+		{
+			const dtMeshTile* tile = nav->getTile(t);
+			if (!tile->header)
+				continue;
+			// Walk the tree keeping the escape index of each ancestor.
+			int stack[64];
+			int depth = 0;
+			const int nodeCount = tile->header->bvNodeCount;
+			for (int i = 0; i < nodeCount; ++i)
+			{
+				while (depth > 0 && i >= stack[depth-1])
+					depth--;
+				const dtBVNode& node = tile->bvTree[i];
+				if (node.i >= 0)
+				{
+					depthSum[n] += depth;
+					leafCount[n]++;
+				}
+				else if (depth < 64)
+				{
+					stack[depth++] = i - node.i;
+				}
+			}
+		}
+	}
+	printf("bvTree average leaf depth: median %.2f, sah %.2f\n",
+		   (float)depthSum[0] / dtMax(leafCount[0], 1), (float)depthSum[1] / dtMax(leafCount[1], 1));
+}
+
+BM(queryPolygons_MedianBVTree, kNumQueries)
+{
+	getBenchBVTree().queryPolygons(0);
+}
+BM(queryPolygons_SAHBVTree, kNumQueries)
+{
+	getBenchBVTree().queryPolygons(1);
+}
+BM(queryPolygons_Wide4BVTree, kNumQueries)
+{
+	getBenchBVTree().queryPolygons(2);
+}
+BM(queryPolygons_Wide8BVTree, kNumQueries)
+{
+	getBenchBVTree().queryPolygons(3);
+}
+BM(findNearestPoly_MedianBVTree, kNumQueries)
+{
+	getBenchBVTree().findNearestPoly(0);
+}
+BM(findNearestPoly_SAHBVTree, kNumQueries)
+{
+	getBenchBVTree().findNearestPoly(1);
+}
+BM(findNearestPoly_Wide4BVTree, kNumQueries)
+{
+	getBenchBVTree().findNearestPoly(2);
+}
+BM(findNearestPoly_Wide8BVTree, kNumQueries)
+{
+	getBenchBVTree().findNearestPoly(3);
+}
+TEST_CASE("tileLookup_Tiles", "[.bench]")
+{
+	BenchTileLookup& lookup = getBenchTileLookup();
+	printf("tile lookup: %d x %d tiles, %d neighbours found\n", lookup.tw, lookup.th, lookup.run(0));
+}
+
+BM(getTilesAt_HashLookup, kNumQueries)
+{
+	getBenchTileLookup().run(0);
+}
+BM(getTilesAt_GridLookup, kNumQueries)
+{
+	getBenchTileLookup().run(1);
+}
+TEST_CASE("tileStitch_Tiles", "[.bench]")
+{
+	const dtNavMesh* nav = getBenchTileStitch().nav;
+	const dtMeshTile* tile = nav->getTileAt(1, 1, 0);
+	printf("tile stitch: %d polygons, %d border edges\n", tile->header->polyCount, tile->header->borderEdgeCount);
+	printf("tile block: %d tiles\n", BenchTileBlock::kBlockSize * BenchTileBlock::kBlockSize);
+	getBenchTileBlock();
+}
+
+BM(addTile_Stitch, kNumQueries)
+{
+	getBenchTileStitch().run();
+}
+TEST_CASE("findRandomPoint_Tiles", "[.bench]")
+{
+	const dtNavMesh* nav = getBenchRandomPoints().nav;
+	int tileCount = 0;
+	for (int i = 0; i < nav->getMaxTiles(); ++i)
+		tileCount += nav->getTile(i)->header ? 1 : 0;
+	printf("random points: %d tiles\n", tileCount);
+}
+
+BM(findRandomPoint_Linear, 20)
+{
+	getBenchRandomPoints().run(false);
+}
+BM(findRandomPoint_AreaSampler, 20)
+{
+	getBenchRandomPoints().run(true);
+}
+BM(moveAlongSurface_Short, kNumQueries)
+{
+	static BenchMoves moves(0.5f);
+	moves.run();
+}
+BM(moveAlongSurface_Long, kNumQueries)
+{
+	static BenchMoves moves(8.0f);
+	moves.run();
+}
+BM(addTile_Block, kNumQueries)
+{
+	getBenchTileBlock().run(false);
+}
+BM(addTile_BlockBatch, kNumQueries)
+{
+	getBenchTileBlock().run(true);
+}
+TEST_CASE("crowd_Agents", "[.bench]")
+{
+	printf("crowd: %d agents\n", getBenchCrowd().crowd->getAgentCount());
+}
+
+BM(crowd_Update, kNumQueries)
+{
+	getBenchCrowd().crowd->update(0.1f, 0);
+}
+TEST_CASE("raycast_Rays", "[.bench]")
+{
+	BenchRaycasts& raycasts = getBenchRaycasts();
+	printf("raycast: %d rays, %d polygons crossed\n", BenchRaycasts::kRayCount, raycasts.run(false));
+}
+
+BM(raycast_Single, kNumQueries)
+{
+	getBenchRaycasts().run(false);
+}
+BM(raycast_Batch, kNumQueries)
+{
+	getBenchRaycasts().run(true);
+}
+BM(findPath_Unreachable, kNumQueries)
+{
+	getBenchMaze().run(0, 1.0f, true);
+}
+BM(findPath_UnreachableBidirectional, kNumQueries)
+{
+	getBenchMaze().run(DT_FINDPATH_BIDIRECTIONAL, 1.0f, true);
+}
+
+#undef BM
+#endif  // BENCH_SUPPORTED
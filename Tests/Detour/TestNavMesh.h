@@ -0,0 +1,314 @@
+#pragma once
+
+#include <string.h>
+#include <vector>
+
+#include "Recast.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+
+// Helpers for building small procedural navigation meshes in tests.
+//
+// The level is a grid of square cells of size 'cellSize' on the xz-plane, described by a
+// row-major array of booleans where true marks a walkable floor cell. Blocked cells produce
+// holes, so the resulting navmesh walls follow the cell grid. The mesh is built tile by tile
+// through the regular Recast pipeline.
+
+struct TestGrid
+{
+	int width;
+	int height;
+	float cellSize;
+	std::vector<unsigned char> open;
+	// Off-mesh connections between cell centers. [(start, end) * count]
+	std::vector<float> offMeshVerts;
+	std::vector<unsigned char> offMeshDirs;
+
+	bool isOpen(int x, int z) const
+	{
+		if (x < 0 || z < 0 || x >= width || z >= height)
+			return false;
+		return open[z * width + x] != 0;
+	}
+
+	void cellCenter(int x, int z, float* pos) const
+	{
+		pos[0] = (x + 0.5f) * cellSize;
+		pos[1] = 0.0f;
+		pos[2] = (z + 0.5f) * cellSize;
+	}
+
+	void addOffMeshConnection(int sx, int sz, int ex, int ez, bool bidirectional)
+	{
+		float pos[6];
+		cellCenter(sx, sz, &pos[0]);
+		cellCenter(ex, ez, &pos[3]);
+		offMeshVerts.insert(offMeshVerts.end(), pos, pos + 6);
+		offMeshDirs.push_back(bidirectional ? DT_OFFMESH_CON_BIDIR : 0);
+	}
+};
+
+// Fully open grid.
+inline TestGrid makeOpenGrid(int width, int height, float cellSize)
+{
+	TestGrid grid;
+	grid.width = width;
+	grid.height = height;
+	grid.cellSize = cellSize;
+	grid.open.assign(width * height, 1);
+	return grid;
+}
+
+// Perfect maze carved with a deterministic recursive backtracker. Maze rooms are at odd
+// cell coordinates, walls are one cell thick. The dimensions should be odd.
+inline TestGrid makeMazeGrid(int width, int height, float cellSize, unsigned int seed)
+{
+	TestGrid grid;
+	grid.width = width;
+	grid.height = height;
+	grid.cellSize = cellSize;
+	grid.open.assign(width * height, 0);
+
+	unsigned int state = seed;
+	std::vector<int> stack;
+	grid.open[1 * width + 1] = 1;
+	stack.push_back(1 * width + 1);
+	static const int dirs[4][2] = { {2,0}, {-2,0}, {0,2}, {0,-2} };
+	while (!stack.empty())
+	{
+		const int cur = stack.back();
+		const int cx = cur % width;
+		const int cz = cur / width;
+		int cand[4];
+		int ncand = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			const int nx = cx + dirs[i][0];
+			const int nz = cz + dirs[i][1];
+			if (nx <= 0 || nz <= 0 || nx >= width-1 || nz >= height-1)
+				continue;
+			if (!grid.open[nz * width + nx])
+				cand[ncand++] = i;
+		}
+		if (!ncand)
+		{
+			stack.pop_back();
+			continue;
+		}
+		state = state * 1103515245u + 12345u;
+		const int d = cand[(state >> 16) % ncand];
+		const int nx = cx + dirs[d][0];
+		const int nz = cz + dirs[d][1];
+		grid.open[(cz + dirs[d][1]/2) * width + (cx + dirs[d][0]/2)] = 1;
+		grid.open[nz * width + nx] = 1;
+		stack.push_back(nz * width + nx);
+	}
+	return grid;
+}
+
+// Builds the Recast settings used for every test tile.
+inline void initTestConfig(rcConfig& cfg, int tileSize)
+{
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.cs = 0.25f;
+	cfg.ch = 0.2f;
+	cfg.walkableSlopeAngle = 45.0f;
+	cfg.walkableHeight = 10;
+	cfg.walkableClimb = 4;
+	cfg.walkableRadius = 0;
+	cfg.maxEdgeLen = 48;
+	cfg.maxSimplificationError = 1.3f;
+	cfg.minRegionArea = 0;
+	cfg.mergeRegionArea = 400;
+	cfg.maxVertsPerPoly = 6;
+	cfg.tileSize = tileSize;
+	cfg.borderSize = cfg.walkableRadius + 3;
+	cfg.width = cfg.tileSize + cfg.borderSize*2;
+	cfg.height = cfg.tileSize + cfg.borderSize*2;
+	cfg.detailSampleDist = cfg.cs * 6.0f;
+	cfg.detailSampleMaxError = cfg.ch;
+}
+
+// Builds the navmesh data for a single tile, returns false if the tile is empty.
+inline bool buildTestTileData(const TestGrid& grid, int tileSize, int tx, int ty,
+							  unsigned char** outData, int* outDataSize,
+							  int bvTreeSplit = DT_BVTREE_SPLIT_MEDIAN, int bvTreeWidth = 2)
+{
+	*outData = 0;
+	*outDataSize = 0;
+
+	rcConfig cfg;
+	initTestConfig(cfg, tileSize);
+
+	const float tileWorld = tileSize * cfg.cs;
+	cfg.bmin[0] = tx * tileWorld - cfg.borderSize * cfg.cs;
+	cfg.bmin[1] = -1.0f;
+	cfg.bmin[2] = ty * tileWorld - cfg.borderSize * cfg.cs;
+	cfg.bmax[0] = (tx + 1) * tileWorld + cfg.borderSize * cfg.cs;
+	cfg.bmax[1] = 1.0f;
+	cfg.bmax[2] = (ty + 1) * tileWorld + cfg.borderSize * cfg.cs;
+
+	// Floor triangles for the open cells overlapping the padded tile.
+	std::vector<float> verts;
+	std::vector<int> tris;
+	for (int z = 0; z < grid.height; ++z)
+	{
+		for (int x = 0; x < grid.width; ++x)
+		{
+			if (!grid.isOpen(x, z))
+				continue;
+			const float x0 = x * grid.cellSize, x1 = (x + 1) * grid.cellSize;
+			const float z0 = z * grid.cellSize, z1 = (z + 1) * grid.cellSize;
+			if (x1 < cfg.bmin[0] || x0 > cfg.bmax[0] || z1 < cfg.bmin[2] || z0 > cfg.bmax[2])
+				continue;
+			const int base = (int)verts.size() / 3;
+			const float v[12] = { x0,0,z0, x0,0,z1, x1,0,z1, x1,0,z0 };
+			verts.insert(verts.end(), v, v + 12);
+			const int t[6] = { base+0, base+1, base+2, base+0, base+2, base+3 };
+			tris.insert(tris.end(), t, t + 6);
+		}
+	}
+	if (tris.empty())
+		return false;
+
+	rcContext ctx(false);
+	const int ntris = (int)tris.size() / 3;
+	std::vector<unsigned char> areas(ntris, RC_WALKABLE_AREA);
+
+	rcHeightfield* solid = rcAllocHeightfield();
+	rcCompactHeightfield* chf = rcAllocCompactHeightfield();
+	rcContourSet* cset = rcAllocContourSet();
+	rcPolyMesh* pmesh = rcAllocPolyMesh();
+	rcPolyMeshDetail* dmesh = rcAllocPolyMeshDetail();
+
+	bool ok = rcCreateHeightfield(&ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)
+		&& rcRasterizeTriangles(&ctx, &verts[0], (int)verts.size() / 3, &tris[0], &areas[0], ntris, *solid, cfg.walkableClimb);
+	if (ok)
+	{
+		rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *solid);
+		rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
+		rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *solid);
+		ok = rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf)
+			&& rcBuildDistanceField(&ctx, *chf)
+			&& rcBuildRegions(&ctx, *chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea)
+			&& rcBuildContours(&ctx, *chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *cset)
+			&& rcBuildPolyMesh(&ctx, *cset, cfg.maxVertsPerPoly, *pmesh)
+			&& rcBuildPolyMeshDetail(&ctx, *pmesh, *chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *dmesh);
+	}
+
+	if (ok && pmesh->npolys > 0)
+	{
+		for (int i = 0; i < pmesh->npolys; ++i)
+			pmesh->flags[i] = 1;
+
+		dtNavMeshCreateParams params;
+		memset(&params, 0, sizeof(params));
+		params.verts = pmesh->verts;
+		params.vertCount = pmesh->nverts;
+		params.polys = pmesh->polys;
+		params.polyAreas = pmesh->areas;
+		params.polyFlags = pmesh->flags;
+		params.polyCount = pmesh->npolys;
+		params.nvp = pmesh->nvp;
+		params.detailMeshes = dmesh->meshes;
+		params.detailVerts = dmesh->verts;
+		params.detailVertsCount = dmesh->nverts;
+		params.detailTris = dmesh->tris;
+		params.detailTriCount = dmesh->ntris;
+		const int offMeshConCount = (int)grid.offMeshDirs.size();
+		const std::vector<float> offMeshConRad(offMeshConCount, grid.cellSize * 0.5f);
+		const std::vector<unsigned short> offMeshConFlags(offMeshConCount, 1);
+		const std::vector<unsigned char> offMeshConAreas(offMeshConCount, 0);
+		std::vector<unsigned int> offMeshConUserID(offMeshConCount);
+		for (int i = 0; i < offMeshConCount; ++i)
+			offMeshConUserID[i] = (unsigned int)i;
+		if (offMeshConCount > 0)
+		{
+			params.offMeshConVerts = &grid.offMeshVerts[0];
+			params.offMeshConRad = &offMeshConRad[0];
+			params.offMeshConFlags = &offMeshConFlags[0];
+			params.offMeshConAreas = &offMeshConAreas[0];
+			params.offMeshConDir = &grid.offMeshDirs[0];
+			params.offMeshConUserID = &offMeshConUserID[0];
+			params.offMeshConCount = offMeshConCount;
+		}
+		params.walkableHeight = cfg.walkableHeight * cfg.ch;
+		params.walkableRadius = 0.0f;
+		params.walkableClimb = cfg.walkableClimb * cfg.ch;
+		params.tileX = tx;
+		params.tileY = ty;
+		params.tileLayer = 0;
+		rcVcopy(params.bmin, pmesh->bmin);
+		rcVcopy(params.bmax, pmesh->bmax);
+		params.cs = cfg.cs;
+		params.ch = cfg.ch;
+		params.buildBvTree = true;
+		params.bvTreeSplit = bvTreeSplit;
+		params.bvTreeWidth = bvTreeWidth;
+		ok = dtCreateNavMeshData(&params, outData, outDataSize);
+	}
+	else
+	{
+		ok = false;
+	}
+
+	rcFreeHeightField(solid);
+	rcFreeCompactHeightfield(chf);
+	rcFreeContourSet(cset);
+	rcFreePolyMesh(pmesh);
+	rcFreePolyMeshDetail(dmesh);
+
+	return ok;
+}
+
+// Number of tiles along each axis needed to cover the grid.
+inline void getTestTileCounts(const TestGrid& grid, int tileSize, int* tw, int* th)
+{
+	const float tileWorld = tileSize * 0.25f;
+	*tw = (int)((grid.width * grid.cellSize + tileWorld - 0.001f) / tileWorld);
+	*th = (int)((grid.height * grid.cellSize + tileWorld - 0.001f) / tileWorld);
+}
+
+// Builds a tiled navmesh covering the whole grid. Returns null on failure.
+inline dtNavMesh* buildTestNavMesh(const TestGrid& grid, int tileSize, int bvTreeSplit = DT_BVTREE_SPLIT_MEDIAN,
+								   int bvTreeWidth = 2, const dtTileLookupParams* lookup = 0)
+{
+	int tw = 0, th = 0;
+	getTestTileCounts(grid, tileSize, &tw, &th);
+
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	params.orig[0] = 0.0f;
+	params.orig[1] = 0.0f;
+	params.orig[2] = 0.0f;
+	params.tileWidth = tileSize * 0.25f;
+	params.tileHeight = tileSize * 0.25f;
+	params.maxTiles = tw * th;
+	params.maxPolys = 1 << 10;
+
+	dtNavMesh* nav = dtAllocNavMesh();
+	if (!nav || dtStatusFailed(lookup ? nav->init(&params, lookup) : nav->init(&params)))
+	{
+		dtFreeNavMesh(nav);
+		return 0;
+	}
+
+	for (int ty = 0; ty < th; ++ty)
+	{
+		for (int tx = 0; tx < tw; ++tx)
+		{
+			unsigned char* data = 0;
+			int dataSize = 0;
+			if (!buildTestTileData(grid, tileSize, tx, ty, &data, &dataSize, bvTreeSplit, bvTreeWidth))
+				continue;
+			if (dtStatusFailed(nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, 0)))
+			{
+				dtFree(data);
+				dtFreeNavMesh(nav);
+				return 0;
+			}
+		}
+	}
+
+	return nav;
+}
@@ -1,6 +1,7 @@
 #include "catch2/catch_all.hpp"
 
 #include "DetourCommon.h"
+#include "DetourNode.h"
 
 TEST_CASE("dtRandomPointInConvexPoly")
 {
@@ -31,3 +32,65 @@ TEST_CASE("dtRandomPointInConvexPoly")
 		REQUIRE(out[2] == Catch::Approx(0));
 	}
 }
+
+TEST_CASE("dtNodePool")
+{
+	static const int MAX_NODES = 100000;
+	dtNodePool pool(MAX_NODES, 1024);
+	REQUIRE(pool.getHashSize() >= MAX_NODES * 2);
+
+	SECTION("Holds more than 65535 nodes")
+	{
+		for (int i = 0; i < MAX_NODES; ++i)
+		{
+			dtNode* node = pool.getNode((dtPolyRef)(i * 7 + 1));
+			REQUIRE(node != 0);
+			REQUIRE(pool.getNodeAtIdx(pool.getNodeIdx(node)) == node);
+			pool.getNodePos(node)[0] = (float)i;
+		}
+		REQUIRE(pool.getNodeCount() == MAX_NODES);
+		REQUIRE(pool.getNode((dtPolyRef)(MAX_NODES * 7 + 1)) == 0);
+
+		for (int i = 0; i < MAX_NODES; i += 997)
+		{
+			dtNode* node = pool.findNode((dtPolyRef)(i * 7 + 1), 0);
+			REQUIRE(node != 0);
+			CHECK(node->id == (dtPolyRef)(i * 7 + 1));
+			CHECK(pool.getNodePos(node)[0] == (float)i);
+			CHECK(pool.getNode((dtPolyRef)(i * 7 + 1)) == node);
+		}
+	}
+
+	SECTION("Keeps separate nodes per state")
+	{
+		dtNode* a = pool.getNode(42, 0);
+		dtNode* b = pool.getNode(42, 1);
+		REQUIRE(a != b);
+		CHECK(pool.findNode(42, 0) == a);
+		CHECK(pool.findNode(42, 1) == b);
+		CHECK(pool.findNode(42, 2) == 0);
+
+		dtNode* nodes[DT_MAX_STATES_PER_NODE];
+		CHECK(pool.findNodes(42, nodes, DT_MAX_STATES_PER_NODE) == 2);
+		CHECK(pool.findNodes(42, nodes, 1) == 1);
+	}
+
+	SECTION("Clear empties the pool")
+	{
+		for (int i = 1; i <= 1000; ++i)
+			pool.getNode((dtPolyRef)i);
+		for (int n = 0; n < 3; ++n)
+		{
+			pool.clear();
+			CHECK(pool.getNodeCount() == 0);
+			CHECK(pool.findNode(1, 0) == 0);
+			CHECK(pool.getFirst(0) == DT_NULL_IDX);
+			dtNode* node = pool.getNode(500);
+			REQUIRE(node != 0);
+			CHECK(node->flags == 0);
+			CHECK(node->pidx == 0);
+			CHECK(pool.findNode(500, 0) == node);
+			CHECK(pool.getNodeCount() == 1);
+		}
+	}
+}
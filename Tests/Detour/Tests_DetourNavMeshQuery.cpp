@@ -0,0 +1,1644 @@
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourCommon.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshBuilder.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourNavMeshQueryTemplate.inl"
+#include "DetourNode.h"
+#include "DetourStraightPath.h"
+
+#include "TestNavMesh.h"
+
+namespace
+{
+struct TestQuery
+{
+	dtNavMesh* nav;
+	dtNavMeshQuery* query;
+	dtQueryFilter filter;
+	float startPos[3];
+	float endPos[3];
+	dtPolyRef startRef;
+	dtPolyRef endRef;
+
+	TestQuery(const TestGrid& grid, int tileSize, int sx, int sz, int ex, int ez)
+		: nav(buildTestNavMesh(grid, tileSize))
+		, query(dtAllocNavMeshQuery())
+		, startRef(0)
+		, endRef(0)
+	{
+		REQUIRE(nav != 0);
+		REQUIRE(dtStatusSucceed(query->init(nav, 4096)));
+		const float halfExtents[3] = { 0.5f, 1.0f, 0.5f };
+		float pos[3];
+		grid.cellCenter(sx, sz, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &startRef, startPos);
+		grid.cellCenter(ex, ez, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &endRef, endPos);
+		REQUIRE(startRef != 0);
+		REQUIRE(endRef != 0);
+	}
+
+	~TestQuery()
+	{
+		dtFreeNavMeshQuery(query);
+		dtFreeNavMesh(nav);
+	}
+
+	bool isConnected(const dtPolyRef* path, const int npath) const
+	{
+		for (int i = 0; i + 1 < npath; ++i)
+		{
+			const dtMeshTile* tile = 0;
+			const dtPoly* poly = 0;
+			if (dtStatusFailed(nav->getTileAndPolyByRef(path[i], &tile, &poly)))
+				return false;
+			bool found = false;
+			for (unsigned int j = poly->firstLink; j != DT_NULL_LINK; j = tile->links[j].next)
+			{
+				if (tile->links[j].ref == path[i+1])
+					found = true;
+			}
+			if (!found)
+				return false;
+		}
+		return true;
+	}
+
+	float straightPathLength(const dtPolyRef* path, const int npath) const
+	{
+		float straight[256*3];
+		int nstraight = 0;
+		query->findStraightPath(startPos, endPos, path, npath, straight, 0, 0, &nstraight, 256);
+		float len = 0.0f;
+		for (int i = 0; i + 1 < nstraight; ++i)
+			len += dtVdist(&straight[i*3], &straight[(i+1)*3]);
+		return len;
+	}
+};
+
+// Filter that does not derive from dtQueryFilter, excludes polygons without the first flag.
+struct StaticFilter
+{
+	float areaCost;
+
+	bool passFilter(const dtPolyRef, const dtMeshTile*, const dtPoly* poly) const
+	{
+		return (poly->flags & 1) != 0;
+	}
+
+	float getCost(const float* pa, const float* pb,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*,
+				  const dtPolyRef, const dtMeshTile*, const dtPoly*) const
+	{
+		return dtVdist(pa, pb) * areaCost;
+	}
+};
+}
+
+TEST_CASE("dtNavMeshQuery::findPath search strategies", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	TestQuery t(grid, 32, 1, 1, 39, 39);
+
+	static const int MAX_PATH = 1024;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+
+	dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+	REQUIRE(status == DT_SUCCESS);
+	REQUIRE(path[0] == t.startRef);
+	REQUIRE(path[npath-1] == t.endRef);
+	const int defaultNodes = t.query->getNodePool()->getNodeCount();
+	const float defaultLength = t.straightPathLength(path, npath);
+
+	SECTION("Default options match the plain overload")
+	{
+		dtPolyRef path2[MAX_PATH];
+		int npath2 = 0;
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path2, &npath2, MAX_PATH, 0, 1.0f);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(npath2 == npath);
+		for (int i = 0; i < npath; ++i)
+			CHECK(path2[i] == path[i]);
+	}
+
+	SECTION("Weighted search expands fewer nodes")
+	{
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH, 0, 3.0f);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.query->getNodePool()->getNodeCount() <= defaultNodes);
+		CHECK(t.straightPathLength(path, npath) <= defaultLength * 3.0f);
+	}
+
+	SECTION("Bidirectional search finds an equivalent path")
+	{
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+								   DT_FINDPATH_BIDIRECTIONAL);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.05));
+	}
+
+	SECTION("Bidirectional search fills truncated paths from the start")
+	{
+		dtPolyRef shortPath[4];
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, shortPath, &npath, 4,
+								   DT_FINDPATH_BIDIRECTIONAL);
+		CHECK(dtStatusSucceed(status));
+		CHECK(dtStatusDetail(status, DT_BUFFER_TOO_SMALL));
+		REQUIRE(npath == 4);
+		for (int i = 0; i < 4; ++i)
+			CHECK(shortPath[i] == path[i]);
+	}
+
+	SECTION("First path stops when the end is reached")
+	{
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+								   DT_FINDPATH_FIRST_PATH | DT_FINDPATH_BIDIRECTIONAL, 2.0f);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+	}
+
+	SECTION("Sliced search supports weights and early out")
+	{
+		status = t.query->initSlicedFindPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter,
+											 DT_FINDPATH_FIRST_PATH, 2.0f);
+		REQUIRE(status == DT_IN_PROGRESS);
+		while (dtStatusInProgress(status))
+			status = t.query->updateSlicedFindPath(64, 0);
+		REQUIRE(status == DT_SUCCESS);
+		status = t.query->finalizeSlicedFindPath(path, &npath, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+	}
+
+	SECTION("Sliced search rejects bidirectional search and invalid weights")
+	{
+		status = t.query->initSlicedFindPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter,
+											 DT_FINDPATH_BIDIRECTIONAL);
+		CHECK(dtStatusDetail(status, DT_INVALID_PARAM));
+		status = t.query->initSlicedFindPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, 0, -1.0f);
+		CHECK(dtStatusDetail(status, DT_INVALID_PARAM));
+	}
+}
+
+TEST_CASE("dtNavMeshQuery::findPath bidirectional on open ground", "[detour]")
+{
+	const TestGrid grid = makeOpenGrid(24, 24, 1.0f);
+	TestQuery t(grid, 32, 2, 3, 21, 19);
+
+	static const int MAX_PATH = 256;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+	dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+	REQUIRE(status == DT_SUCCESS);
+	const float defaultLength = t.straightPathLength(path, npath);
+	CHECK(defaultLength == Catch::Approx(dtVdist(t.startPos, t.endPos)).epsilon(0.01));
+
+	status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+							   DT_FINDPATH_BIDIRECTIONAL);
+	REQUIRE(status == DT_SUCCESS);
+	REQUIRE(path[0] == t.startRef);
+	REQUIRE(path[npath-1] == t.endRef);
+	REQUIRE(t.isConnected(path, npath));
+	CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.01));
+}
+
+TEST_CASE("dtNavMeshQuery::findPath bidirectional over a one-way connection", "[detour]")
+{
+	// A maze and a small island to the right of it, joined only by a one-way off-mesh
+	// connection from the maze to the island. The backward search runs out of polygons on
+	// the island long before the forward search gets through the maze.
+	const TestGrid maze = makeMazeGrid(21, 21, 1.0f, 1234);
+	TestGrid grid = makeOpenGrid(26, 21, 1.0f);
+	for (int z = 0; z < grid.height; ++z)
+	{
+		for (int x = 0; x < grid.width; ++x)
+			grid.open[z * grid.width + x] = x < maze.width ? maze.isOpen(x, z) : (x >= 23 && z >= 17 && z < 20);
+	}
+	grid.addOffMeshConnection(19, 19, 24, 18, false);
+
+	static const int MAX_PATH = 256;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+
+	SECTION("Along the connection")
+	{
+		TestQuery t(grid, 32, 1, 1, 25, 18);
+		dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		const int defaultCount = npath;
+
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+								   DT_FINDPATH_BIDIRECTIONAL);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(npath == defaultCount);
+	}
+
+	SECTION("Against the connection")
+	{
+		TestQuery t(grid, 32, 25, 18, 1, 1);
+		const dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+												  DT_FINDPATH_BIDIRECTIONAL);
+		CHECK(dtStatusSucceed(status));
+		CHECK(dtStatusDetail(status, DT_PARTIAL_RESULT));
+		REQUIRE(npath > 0);
+		CHECK(path[0] == t.startRef);
+		CHECK(path[npath-1] != t.endRef);
+	}
+}
+
+TEST_CASE("dtNavMeshQuery::findPath with landmarks", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	TestQuery t(grid, 32, 1, 1, 39, 39);
+
+	static const int MAX_PATH = 1024;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+
+	dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+	REQUIRE(status == DT_SUCCESS);
+	const int defaultNodes = t.query->getNodePool()->getNodeCount();
+	const float defaultLength = t.straightPathLength(path, npath);
+
+	dtNavMeshLandmarks* landmarks = dtAllocNavMeshLandmarks();
+	REQUIRE(landmarks != 0);
+	REQUIRE(dtStatusSucceed(landmarks->init(t.nav, 4)));
+	REQUIRE(landmarks->getLandmarkCount() == 4);
+	t.query->setLandmarks(landmarks);
+
+	SECTION("Landmark bounds are admissible")
+	{
+		float endBounds[DT_MAX_LANDMARKS*2];
+		REQUIRE(landmarks->getPolyBounds(t.endRef, endBounds));
+		const float bound = landmarks->getCostBound(t.startRef, endBounds);
+		CHECK(bound > dtVdist(t.startPos, t.endPos));
+		CHECK(bound <= defaultLength);
+	}
+
+	SECTION("Landmarks expand fewer nodes and find an equally short path")
+	{
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[0] == t.startRef);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.query->getNodePool()->getNodeCount() < defaultNodes);
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.01));
+
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH,
+								   DT_FINDPATH_BIDIRECTIONAL);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.05));
+
+		status = t.query->initSlicedFindPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter);
+		while (dtStatusInProgress(status))
+			status = t.query->updateSlicedFindPath(64, 0);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(t.query->finalizeSlicedFindPath(path, &npath, MAX_PATH) == DT_SUCCESS);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.01));
+	}
+
+	SECTION("Replaced tiles are updated incrementally")
+	{
+		// Rebuild a tile in the middle of the maze.
+		const dtMeshTile* tile = t.nav->getTileAt(2, 2, 0);
+		REQUIRE(tile != 0);
+		const dtTileRef oldRef = t.nav->getTileRef(tile);
+		REQUIRE(dtStatusSucceed(t.nav->removeTile(oldRef, 0, 0)));
+		landmarks->removeTile(oldRef);
+
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+		REQUIRE(dtStatusSucceed(status));
+
+		unsigned char* data = 0;
+		int dataSize = 0;
+		REQUIRE(buildTestTileData(grid, 32, 2, 2, &data, &dataSize));
+		dtTileRef newRef = 0;
+		REQUIRE(dtStatusSucceed(t.nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &newRef)));
+		REQUIRE(dtStatusSucceed(landmarks->addTile(newRef)));
+
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.query->getNodePool()->getNodeCount() < defaultNodes);
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.01));
+	}
+
+	SECTION("Tiles replaced in a batch update the landmarks through the listener")
+	{
+		REQUIRE(dtStatusSucceed(t.nav->addListener(landmarks)));
+		REQUIRE(dtStatusSucceed(t.nav->beginTileBatch()));
+		for (int y = 1; y <= 2; ++y)
+		{
+			const dtTileRef oldRef = t.nav->getTileRefAt(2, y, 0);
+			REQUIRE(dtStatusSucceed(t.nav->removeTile(oldRef, 0, 0)));
+			unsigned char* data = 0;
+			int dataSize = 0;
+			REQUIRE(buildTestTileData(grid, 32, 2, y, &data, &dataSize));
+			REQUIRE(dtStatusSucceed(t.nav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, 0)));
+		}
+		REQUIRE(dtStatusSucceed(t.nav->commitTileBatch()));
+
+		status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path[npath-1] == t.endRef);
+		REQUIRE(t.isConnected(path, npath));
+		CHECK(t.query->getNodePool()->getNodeCount() < defaultNodes);
+		CHECK(t.straightPathLength(path, npath) == Catch::Approx(defaultLength).epsilon(0.01));
+		t.nav->removeListener(landmarks);
+	}
+
+	t.query->setLandmarks(0);
+	dtFreeNavMeshLandmarks(landmarks);
+}
+
+TEST_CASE("dtNavMeshQuery::findPath with a compile time filter", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	TestQuery t(grid, 32, 1, 1, 39, 39);
+
+	static const int MAX_PATH = 1024;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+	dtStatus status = t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH);
+	REQUIRE(status == DT_SUCCESS);
+
+	StaticFilter filter;
+	filter.areaCost = 1.0f;
+	dtPolyRef path2[MAX_PATH];
+	int npath2 = 0;
+
+	SECTION("Matches the dtQueryFilter search")
+	{
+		status = t.query->findPath<StaticFilter>(t.startRef, t.endRef, t.startPos, t.endPos, &filter, path2, &npath2, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(npath2 == npath);
+		for (int i = 0; i < npath; ++i)
+			CHECK(path2[i] == path[i]);
+
+		status = t.query->findPath<dtQueryFilter>(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path2, &npath2, MAX_PATH);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(npath2 == npath);
+	}
+
+	SECTION("Supports the search options")
+	{
+		status = t.query->findPath<StaticFilter>(t.startRef, t.endRef, t.startPos, t.endPos, &filter, path2, &npath2, MAX_PATH,
+												 DT_FINDPATH_BIDIRECTIONAL);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(path2[0] == t.startRef);
+		REQUIRE(path2[npath2-1] == t.endRef);
+		REQUIRE(t.isConnected(path2, npath2));
+	}
+
+	SECTION("Applies the filter")
+	{
+		// Exclude a polygon in the middle of the only path through the maze.
+		const dtMeshTile* tile = 0;
+		const dtPoly* poly = 0;
+		REQUIRE(dtStatusSucceed(t.nav->getTileAndPolyByRef(path[npath/2], &tile, &poly)));
+		const unsigned short flags = poly->flags;
+		t.nav->setPolyFlags(path[npath/2], 0);
+
+		status = t.query->findPath<StaticFilter>(t.startRef, t.endRef, t.startPos, t.endPos, &filter, path2, &npath2, MAX_PATH);
+		CHECK(dtStatusDetail(status, DT_PARTIAL_RESULT));
+		for (int i = 0; i < npath2; ++i)
+			CHECK(path2[i] != path[npath/2]);
+
+		t.nav->setPolyFlags(path[npath/2], flags);
+	}
+}
+
+TEST_CASE("dtStraightPathIterator", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	TestQuery t(grid, 32, 1, 1, 39, 39);
+
+	static const int MAX_PATH = 1024;
+	dtPolyRef path[MAX_PATH];
+	int npath = 0;
+	REQUIRE(t.query->findPath(t.startRef, t.endRef, t.startPos, t.endPos, &t.filter, path, &npath, MAX_PATH) == DT_SUCCESS);
+
+	dtStraightPathIterator it;
+	REQUIRE(it.init(16));
+
+	static const int MAX_STRAIGHT = 256;
+	float expected[MAX_STRAIGHT*3], verts[MAX_STRAIGHT*3];
+	unsigned char expectedFlags[MAX_STRAIGHT], flags[MAX_STRAIGHT];
+	dtPolyRef expectedRefs[MAX_STRAIGHT], refs[MAX_STRAIGHT];
+
+	SECTION("Matches findStraightPath")
+	{
+		const int sizes[] = { 1, 2, 3, 7, MAX_STRAIGHT };
+		for (int s = 0; s < 5; ++s)
+		{
+			// Start from further along the path each time to exercise the portal cache.
+			const int first = s * 3;
+			int nexpected = 0;
+			const dtStatus expectedStatus = t.query->findStraightPath(t.startPos, t.endPos, path + first, npath - first,
+																	  expected, expectedFlags, expectedRefs, &nexpected, sizes[s]);
+			REQUIRE(dtStatusSucceed(it.begin(t.query, t.startPos, t.endPos, path + first, npath - first)));
+			int nverts = 0;
+			const dtStatus status = it.getStraightPath(verts, flags, refs, &nverts, sizes[s]);
+			CHECK(status == expectedStatus);
+			REQUIRE(nverts == nexpected);
+			for (int i = 0; i < nverts; ++i)
+			{
+				CHECK(dtVequal(&verts[i*3], &expected[i*3]));
+				CHECK(flags[i] == expectedFlags[i]);
+				CHECK(refs[i] == expectedRefs[i]);
+			}
+		}
+	}
+
+	SECTION("Returns the vertices one at a time")
+	{
+		int nexpected = 0;
+		t.query->findStraightPath(t.startPos, t.endPos, path, npath, expected, expectedFlags, expectedRefs, &nexpected, MAX_STRAIGHT);
+
+		REQUIRE(dtStatusSucceed(it.begin(t.query, t.startPos, t.endPos, path, npath)));
+		int nverts = 0;
+		dtStatus status = DT_IN_PROGRESS;
+		while (dtStatusInProgress(status))
+		{
+			float pos[3];
+			unsigned char vertFlags = 0;
+			dtPolyRef ref = 0;
+			status = it.next(pos, &vertFlags, &ref);
+			REQUIRE(!dtStatusFailed(status));
+			if (nverts > 0 && dtVequal(pos, &verts[(nverts-1)*3]))
+				continue;
+			REQUIRE(nverts < MAX_STRAIGHT);
+			dtVcopy(&verts[nverts*3], pos);
+			nverts++;
+		}
+		CHECK(status == DT_SUCCESS);
+		CHECK(it.isDone());
+		CHECK(dtStatusFailed(it.next(verts, 0, 0)));
+		REQUIRE(nverts == nexpected);
+		for (int i = 0; i < nverts; ++i)
+			CHECK(dtVequal(&verts[i*3], &expected[i*3]));
+	}
+
+	SECTION("Ends at an invalid polygon")
+	{
+		path[npath/2] = 0;
+		int nexpected = 0;
+		const dtStatus expectedStatus = t.query->findStraightPath(t.startPos, t.endPos, path, npath,
+																  expected, expectedFlags, expectedRefs, &nexpected, MAX_STRAIGHT);
+		REQUIRE(dtStatusDetail(expectedStatus, DT_PARTIAL_RESULT));
+
+		REQUIRE(dtStatusSucceed(it.begin(t.query, t.startPos, t.endPos, path, npath)));
+		int nverts = 0;
+		CHECK(it.getStraightPath(verts, flags, refs, &nverts, MAX_STRAIGHT) == expectedStatus);
+		REQUIRE(nverts == nexpected);
+		CHECK(dtVequal(&verts[(nverts-1)*3], &expected[(nverts-1)*3]));
+		CHECK(refs[nverts-1] == expectedRefs[nverts-1]);
+	}
+}
+
+namespace
+{
+// Checks that the tree has one leaf per polygon and that every node contains its children.
+bool isValidBVTree(const dtMeshTile* tile)
+{
+	std::vector<int> leafCount(tile->header->polyCount, 0);
+	const int nodeCount = tile->header->bvNodeCount;
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		const dtBVNode& node = tile->bvTree[i];
+		if (node.i >= 0)
+		{
+			if (node.i >= tile->header->polyCount)
+				return false;
+			leafCount[node.i]++;
+			continue;
+		}
+		const int end = i - node.i;
+		if (end > nodeCount)
+			return false;
+		for (int j = i + 1; j < end; ++j)
+		{
+			const dtBVNode& child = tile->bvTree[j];
+			for (int k = 0; k < 3; ++k)
+			{
+				if (child.bmin[k] < node.bmin[k] || child.bmax[k] > node.bmax[k])
+					return false;
+			}
+		}
+	}
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		if (leafCount[i] != 1)
+			return false;
+	}
+	return true;
+}
+}
+
+TEST_CASE("dtCreateNavMeshData bounding volume tree splits", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	dtNavMesh* medianNav = buildTestNavMesh(grid, 64, DT_BVTREE_SPLIT_MEDIAN);
+	dtNavMesh* sahNav = buildTestNavMesh(grid, 64, DT_BVTREE_SPLIT_SAH);
+	REQUIRE(medianNav != 0);
+	REQUIRE(sahNav != 0);
+
+	const dtNavMesh* navs[2] = { medianNav, sahNav };
+	for (int n = 0; n < 2; ++n)
+	{
+		for (int i = 0; i < navs[n]->getMaxTiles(); ++i)
+		{
+			const dtMeshTile* tile = navs[n]->getTile(i);
+			if (!tile->header)
+				continue;
+			CHECK(isValidBVTree(tile));
+		}
+	}
+
+	// Both trees find the same polygons.
+	dtNavMeshQuery* medianQuery = dtAllocNavMeshQuery();
+	dtNavMeshQuery* sahQuery = dtAllocNavMeshQuery();
+	REQUIRE(dtStatusSucceed(medianQuery->init(medianNav, 128)));
+	REQUIRE(dtStatusSucceed(sahQuery->init(sahNav, 128)));
+	dtQueryFilter filter;
+	unsigned int seed = 1;
+	for (int i = 0; i < 200; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const float center[3] = { (float)(seed % 4100) / 100.0f, 0.0f, (float)((seed >> 12) % 4100) / 100.0f };
+		const float halfExtents[3] = { (float)(i % 7) * 0.5f + 0.1f, 1.0f, (float)(i % 5) * 0.5f + 0.1f };
+
+		static const int MAX_POLYS = 512;
+		dtPolyRef medianPolys[MAX_POLYS], sahPolys[MAX_POLYS];
+		int medianCount = 0, sahCount = 0;
+		medianQuery->queryPolygons(center, halfExtents, &filter, medianPolys, &medianCount, MAX_POLYS);
+		sahQuery->queryPolygons(center, halfExtents, &filter, sahPolys, &sahCount, MAX_POLYS);
+		REQUIRE(medianCount == sahCount);
+		std::sort(medianPolys, medianPolys + medianCount);
+		std::sort(sahPolys, sahPolys + sahCount);
+		for (int j = 0; j < medianCount; ++j)
+			CHECK(medianPolys[j] == sahPolys[j]);
+	}
+
+	dtFreeNavMeshQuery(sahQuery);
+	dtFreeNavMeshQuery(medianQuery);
+	dtFreeNavMesh(sahNav);
+	dtFreeNavMesh(medianNav);
+}
+
+namespace
+{
+// Checks that the wide tree has one leaf per polygon and that every node is inside its parent's bounds.
+template <int Width, class Node>
+bool isValidWideBVTree(const dtMeshTile* tile, const Node* nodes)
+{
+	std::vector<int> leafCount(tile->header->polyCount, 0);
+	std::vector<int> parentCount(tile->header->bvNodeCount, 0);
+	for (int i = 0; i < tile->header->bvNodeCount; ++i)
+	{
+		const Node& node = nodes[i];
+		for (int j = 0; j < Width; ++j)
+		{
+			if (node.child[j] < 0)
+			{
+				const int poly = ~node.child[j];
+				if (poly >= tile->header->polyCount)
+					return false;
+				leafCount[poly]++;
+			}
+			else if (node.child[j] > 0)
+			{
+				if (node.child[j] >= tile->header->bvNodeCount)
+					return false;
+				parentCount[node.child[j]]++;
+				const Node& child = nodes[node.child[j]];
+				for (int c = 0; c < Width; ++c)
+				{
+					if (!child.child[c])
+						continue;
+					for (int k = 0; k < 3; ++k)
+					{
+						if (child.bmin[k][c] < node.bmin[k][j] || child.bmax[k][c] > node.bmax[k][j])
+							return false;
+					}
+				}
+			}
+		}
+	}
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		if (leafCount[i] != 1)
+			return false;
+	}
+	for (int i = 1; i < tile->header->bvNodeCount; ++i)
+	{
+		if (parentCount[i] != 1)
+			return false;
+	}
+	return true;
+}
+}
+
+TEST_CASE("dtCreateNavMeshData wide bounding volume trees", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+	dtNavMesh* binaryNav = buildTestNavMesh(grid, 64);
+	REQUIRE(binaryNav != 0);
+	dtNavMeshQuery* binaryQuery = dtAllocNavMeshQuery();
+	REQUIRE(dtStatusSucceed(binaryQuery->init(binaryNav, 128)));
+	dtQueryFilter filter;
+
+	const int widths[] = { 4, 8 };
+	const int splits[] = { DT_BVTREE_SPLIT_MEDIAN, DT_BVTREE_SPLIT_SAH };
+	for (int w = 0; w < 2; ++w)
+	{
+		for (int s = 0; s < 2; ++s)
+		{
+			dtNavMesh* nav = buildTestNavMesh(grid, 64, splits[s], widths[w]);
+			REQUIRE(nav != 0);
+			const dtNavMesh* cnav = nav;
+			for (int i = 0; i < cnav->getMaxTiles(); ++i)
+			{
+				const dtMeshTile* tile = cnav->getTile(i);
+				if (!tile->header)
+					continue;
+				CHECK(tile->header->bvTreeWidth == widths[w]);
+				CHECK(tile->bvTree == 0);
+				if (widths[w] == 4)
+					CHECK(isValidWideBVTree<4>(tile, tile->bvTree4));
+				else
+					CHECK(isValidWideBVTree<8>(tile, tile->bvTree8));
+			}
+
+			// Same polygons as the binary tree.
+			dtNavMeshQuery* query = dtAllocNavMeshQuery();
+			REQUIRE(dtStatusSucceed(query->init(nav, 128)));
+			unsigned int seed = 1;
+			for (int i = 0; i < 200; ++i)
+			{
+				seed = seed * 1103515245u + 12345u;
+				const float center[3] = { (float)(seed % 4100) / 100.0f, 0.0f, (float)((seed >> 12) % 4100) / 100.0f };
+				const float halfExtents[3] = { (float)(i % 7) * 0.5f + 0.1f, 1.0f, (float)(i % 5) * 0.5f + 0.1f };
+
+				static const int MAX_POLYS = 512;
+				dtPolyRef expected[MAX_POLYS], polys[MAX_POLYS];
+				int nexpected = 0, npolys = 0;
+				binaryQuery->queryPolygons(center, halfExtents, &filter, expected, &nexpected, MAX_POLYS);
+				query->queryPolygons(center, halfExtents, &filter, polys, &npolys, MAX_POLYS);
+				REQUIRE(npolys == nexpected);
+				std::sort(expected, expected + nexpected);
+				std::sort(polys, polys + npolys);
+				for (int j = 0; j < npolys; ++j)
+					CHECK(polys[j] == expected[j]);
+			}
+			dtFreeNavMeshQuery(query);
+			dtFreeNavMesh(nav);
+		}
+	}
+
+	SECTION("Endian swap round trip")
+	{
+		unsigned char* data = 0;
+		int dataSize = 0;
+		REQUIRE(buildTestTileData(grid, 64, 0, 0, &data, &dataSize, DT_BVTREE_SPLIT_SAH, 8));
+		std::vector<unsigned char> original(data, data + dataSize);
+		REQUIRE(dtNavMeshDataSwapEndian(data, dataSize));
+		REQUIRE(dtNavMeshHeaderSwapEndian(data, dataSize));
+		CHECK(memcmp(&original[0], data, dataSize) != 0);
+		REQUIRE(dtNavMeshHeaderSwapEndian(data, dataSize));
+		REQUIRE(dtNavMeshDataSwapEndian(data, dataSize));
+		CHECK(memcmp(&original[0], data, dataSize) == 0);
+		dtFree(data);
+	}
+
+	SECTION("Rejects unsupported widths")
+	{
+		unsigned char* data = 0;
+		int dataSize = 0;
+		CHECK(!buildTestTileData(grid, 64, 0, 0, &data, &dataSize, DT_BVTREE_SPLIT_MEDIAN, 3));
+		CHECK(data == 0);
+	}
+
+	dtFreeNavMeshQuery(binaryQuery);
+	dtFreeNavMesh(binaryNav);
+}
+
+namespace
+{
+// Copies tile data to another tile location.
+unsigned char* cloneTileData(const unsigned char* data, int dataSize, int x, int y, int layer)
+{
+	unsigned char* copy = (unsigned char*)dtAlloc(dataSize, DT_ALLOC_PERM);
+	memcpy(copy, data, dataSize);
+	dtMeshHeader* header = (dtMeshHeader*)copy;
+	header->x = x;
+	header->y = y;
+	header->layer = layer;
+	return copy;
+}
+
+dtTileLookupParams makeGridLookup(int minX, int minY, int width, int height)
+{
+	dtTileLookupParams lookup;
+	lookup.type = DT_TILE_LOOKUP_GRID;
+	lookup.minX = minX;
+	lookup.minY = minY;
+	lookup.width = width;
+	lookup.height = height;
+	return lookup;
+}
+}
+
+TEST_CASE("dtNavMesh tile lookup", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 99);
+	int tw = 0, th = 0;
+	getTestTileCounts(grid, 32, &tw, &th);
+
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	params.tileWidth = 8.0f;
+	params.tileHeight = 8.0f;
+	params.maxTiles = 64;
+	params.maxPolys = 1 << 10;
+
+	SECTION("Grid and hash lookups find the same tiles")
+	{
+		const dtTileLookupParams lookup = makeGridLookup(0, 0, tw, th);
+		TestQuery hashQuery(grid, 32, 1, 1, 39, 39);
+		const dtNavMesh* hashNav = hashQuery.nav;
+		dtNavMesh* gridNav = buildTestNavMesh(grid, 32, DT_BVTREE_SPLIT_MEDIAN, 2, &lookup);
+		REQUIRE(gridNav != 0);
+		for (int y = -2; y < th + 2; ++y)
+		{
+			for (int x = -2; x < tw + 2; ++x)
+			{
+				const dtMeshTile* a = hashNav->getTileAt(x, y, 0);
+				const dtMeshTile* b = gridNav->getTileAt(x, y, 0);
+				REQUIRE((a != 0) == (b != 0));
+				if (a)
+				{
+					CHECK(a->header->x == x);
+					CHECK(a->header->y == y);
+					CHECK(hashNav->getTileRefAt(x, y, 0) == gridNav->getTileRefAt(x, y, 0));
+				}
+				const dtMeshTile* tiles[4];
+				CHECK(hashNav->getTilesAt(x, y, tiles, 4) == gridNav->getTilesAt(x, y, tiles, 4));
+			}
+		}
+
+		// Same connections between the tiles.
+		dtNavMeshQuery* gridQuery = dtAllocNavMeshQuery();
+		REQUIRE(dtStatusSucceed(gridQuery->init(gridNav, 2048)));
+		dtPolyRef hashPath[256], gridPath[256];
+		int nhash = 0, ngrid = 0;
+		hashQuery.query->findPath(hashQuery.startRef, hashQuery.endRef, hashQuery.startPos, hashQuery.endPos,
+								  &hashQuery.filter, hashPath, &nhash, 256);
+		gridQuery->findPath(hashQuery.startRef, hashQuery.endRef, hashQuery.startPos, hashQuery.endPos,
+							&hashQuery.filter, gridPath, &ngrid, 256);
+		REQUIRE(nhash > 1);
+		REQUIRE(nhash == ngrid);
+		for (int i = 0; i < nhash; ++i)
+			CHECK(hashPath[i] == gridPath[i]);
+		dtFreeNavMeshQuery(gridQuery);
+		dtFreeNavMesh(gridNav);
+	}
+
+	unsigned char* data = 0;
+	int dataSize = 0;
+	REQUIRE(buildTestTileData(grid, 32, 0, 0, &data, &dataSize, DT_BVTREE_SPLIT_MEDIAN, 2));
+
+	SECTION("Layers at the same location")
+	{
+		for (int type = 0; type < 2; ++type)
+		{
+			const dtTileLookupParams lookup = makeGridLookup(-4, -4, 8, 8);
+			dtNavMesh* nav = dtAllocNavMesh();
+			REQUIRE(dtStatusSucceed(type == 0 ? nav->init(&params) : nav->init(&params, &lookup)));
+			dtTileRef refs[3];
+			for (int layer = 0; layer < 3; ++layer)
+				REQUIRE(dtStatusSucceed(nav->addTile(cloneTileData(data, dataSize, -1, 2, layer), dataSize, DT_TILE_FREE_DATA, 0, &refs[layer])));
+
+			const dtMeshTile* tiles[4];
+			CHECK(nav->getTilesAt(-1, 2, tiles, 4) == 3);
+			CHECK(nav->getTilesAt(-1, 2, tiles, 2) == 2);
+			for (int layer = 0; layer < 3; ++layer)
+				CHECK(nav->getTileRefAt(-1, 2, layer) == refs[layer]);
+
+			REQUIRE(dtStatusSucceed(nav->removeTile(refs[1], 0, 0)));
+			CHECK(nav->getTilesAt(-1, 2, tiles, 4) == 2);
+			CHECK(nav->getTileAt(-1, 2, 1) == 0);
+			CHECK(nav->getTileRefAt(-1, 2, 0) == refs[0]);
+			CHECK(nav->getTileRefAt(-1, 2, 2) == refs[2]);
+
+			REQUIRE(dtStatusSucceed(nav->removeTile(refs[0], 0, 0)));
+			REQUIRE(dtStatusSucceed(nav->removeTile(refs[2], 0, 0)));
+			CHECK(nav->getTilesAt(-1, 2, tiles, 4) == 0);
+			dtFreeNavMesh(nav);
+		}
+	}
+
+	SECTION("Grid rejects tiles outside of the grid")
+	{
+		const dtTileLookupParams lookup = makeGridLookup(1, 0, 4, 4);
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(&params, &lookup)));
+		CHECK(nav->addTile(data, dataSize, 0, 0, 0) == (DT_FAILURE | DT_INVALID_PARAM));
+		CHECK(nav->getTileAt(0, 0, 0) == 0);
+		dtFreeNavMesh(nav);
+
+		const dtTileLookupParams empty = makeGridLookup(0, 0, 0, 4);
+		nav = dtAllocNavMesh();
+		CHECK(nav->init(&params, &empty) == (DT_FAILURE | DT_INVALID_PARAM));
+		dtFreeNavMesh(nav);
+	}
+
+	SECTION("Hash table stays consistent through removals")
+	{
+		// Locations two apart so that the tiles do not connect.
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(&params)));
+		std::vector<dtTileRef> refs(params.maxTiles, 0);
+		unsigned int seed = 7;
+		for (int iter = 0; iter < 2000; ++iter)
+		{
+			seed = seed * 1103515245u + 12345u;
+			const int i = (int)((seed >> 8) % (unsigned int)params.maxTiles);
+			const int x = (i % 8) * 2 - 8, y = (i / 8) * 2 - 8;
+			if (refs[i])
+			{
+				REQUIRE(dtStatusSucceed(nav->removeTile(refs[i], 0, 0)));
+				refs[i] = 0;
+			}
+			else
+			{
+				REQUIRE(dtStatusSucceed(nav->addTile(cloneTileData(data, dataSize, x, y, 0), dataSize, DT_TILE_FREE_DATA, 0, &refs[i])));
+			}
+			if (iter % 100 == 0)
+			{
+				for (int j = 0; j < params.maxTiles; ++j)
+					REQUIRE(nav->getTileRefAt((j % 8) * 2 - 8, (j / 8) * 2 - 8, 0) == refs[j]);
+			}
+		}
+		dtFreeNavMesh(nav);
+	}
+
+	dtFree(data);
+}
+
+TEST_CASE("dtNavMesh polygon reference bits", "[detour]")
+{
+	const TestGrid grid = makeOpenGrid(16, 16, 1.0f);
+	unsigned char* data = 0;
+	int dataSize = 0;
+	REQUIRE(buildTestTileData(grid, 64, 0, 0, &data, &dataSize, DT_BVTREE_SPLIT_MEDIAN, 2));
+
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	params.tileWidth = 16.0f;
+	params.tileHeight = 16.0f;
+	params.maxTiles = 4;
+	params.maxPolys = 64;
+
+	SECTION("Default layout")
+	{
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(&params)));
+		const dtPolyRefBits bits = nav->getPolyRefBits();
+#ifdef DT_POLYREF64
+		CHECK(bits.saltBits == (int)DT_SALT_BITS);
+		CHECK(bits.tileBits == (int)DT_TILE_BITS);
+		CHECK(bits.polyBits == (int)DT_POLY_BITS);
+#else
+		CHECK(bits.tileBits == 2);
+		CHECK(bits.polyBits == 6);
+		CHECK(bits.saltBits == 24);
+#endif
+		dtFreeNavMesh(nav);
+	}
+
+	SECTION("Explicit layout")
+	{
+		dtPolyRefBits bits;
+		bits.saltBits = 10;
+		bits.tileBits = 5;
+		bits.polyBits = 7;
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(&params, 0, &bits)));
+		const dtPolyRefBits navBits = nav->getPolyRefBits();
+		CHECK(navBits.saltBits == 10);
+		CHECK(navBits.tileBits == 5);
+		CHECK(navBits.polyBits == 7);
+
+		// The salt wraps around within its bits and skips zero.
+		dtTileRef ref = 0;
+		for (int i = 0; i < (1 << 10) + 2; ++i)
+		{
+			REQUIRE(dtStatusSucceed(nav->addTile(data, dataSize, 0, 0, &ref)));
+			const unsigned int salt = nav->decodePolyIdSalt((dtPolyRef)ref);
+			CHECK(salt == (unsigned int)(i % ((1 << 10) - 1)) + 1);
+			CHECK(nav->decodePolyIdTile((dtPolyRef)ref) == 0);
+			CHECK((ref >> 12) == salt);
+
+			const dtPolyRef polyRef = nav->getPolyRefBase(nav->getTileByRef(ref)) | 1;
+			const dtMeshTile* tile = 0;
+			const dtPoly* poly = 0;
+			CHECK(dtStatusSucceed(nav->getTileAndPolyByRef(polyRef, &tile, &poly)));
+			REQUIRE(dtStatusSucceed(nav->removeTile(ref, 0, 0)));
+			CHECK(!nav->isValidPolyRef(polyRef));
+		}
+		dtFreeNavMesh(nav);
+	}
+
+	SECTION("Single tile with one polygon")
+	{
+		// A single quad, so that the tile and polygon indices take no bits.
+		const unsigned short verts[] = { 0,0,0, 0,0,4, 4,0,4, 4,0,0 };
+		unsigned short polys[12];
+		memset(polys, 0xff, sizeof(polys));
+		for (unsigned short i = 0; i < 4; ++i)
+			polys[i] = i;
+		unsigned char polyArea = 0;
+		unsigned short polyFlags = 1;
+
+		dtNavMeshCreateParams createParams;
+		memset(&createParams, 0, sizeof(createParams));
+		createParams.verts = verts;
+		createParams.vertCount = 4;
+		createParams.polys = polys;
+		createParams.polyAreas = &polyArea;
+		createParams.polyFlags = &polyFlags;
+		createParams.polyCount = 1;
+		createParams.nvp = 6;
+		createParams.walkableHeight = 2.0f;
+		createParams.walkableClimb = 0.5f;
+		createParams.bmax[0] = 4.0f;
+		createParams.bmax[1] = 1.0f;
+		createParams.bmax[2] = 4.0f;
+		createParams.cs = 1.0f;
+		createParams.ch = 1.0f;
+		createParams.buildBvTree = true;
+		unsigned char* quadData = 0;
+		int quadDataSize = 0;
+		REQUIRE(dtCreateNavMeshData(&createParams, &quadData, &quadDataSize));
+
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(quadData, quadDataSize, DT_TILE_FREE_DATA)));
+		const dtPolyRefBits bits = nav->getPolyRefBits();
+#ifdef DT_POLYREF64
+		CHECK(bits.saltBits == (int)DT_SALT_BITS);
+		CHECK(bits.tileBits == (int)DT_TILE_BITS);
+		CHECK(bits.polyBits == (int)DT_POLY_BITS);
+#else
+		CHECK(bits.tileBits == 0);
+		CHECK(bits.polyBits == 0);
+		CHECK(bits.saltBits == 31);
+#endif
+		const dtPolyRef polyRef = nav->getPolyRefBase(nav->getTileAt(0, 0, 0));
+		CHECK(nav->isValidPolyRef(polyRef));
+		dtFreeNavMesh(nav);
+	}
+
+	SECTION("Rejects layouts that do not fit")
+	{
+		const int layouts[][3] = {
+			{ 9, 2, 6 },	// Too few salt bits.
+			{ 10, 1, 6 },	// Too few tile bits for maxTiles.
+			{ 10, 2, 5 },	// Too few polygon bits for maxPolys.
+			{ 32, 2, 6 },	// Salt does not fit in 31 bits.
+			{ 16, 2, (int)sizeof(dtPolyRef) * 8 - 17 },	// More bits than a reference has.
+		};
+		for (int i = 0; i < 5; ++i)
+		{
+			dtPolyRefBits bits;
+			bits.saltBits = layouts[i][0];
+			bits.tileBits = layouts[i][1];
+			bits.polyBits = layouts[i][2];
+			dtNavMesh* nav = dtAllocNavMesh();
+			CHECK(nav->init(&params, 0, &bits) == (DT_FAILURE | DT_INVALID_PARAM));
+			dtFreeNavMesh(nav);
+		}
+	}
+
+	dtFree(data);
+}
+
+namespace
+{
+// The links of every polygon to polygons of other tiles, sorted.
+std::vector<std::vector<unsigned long long> > collectExternalLinks(const dtNavMesh* nav)
+{
+	std::vector<std::vector<unsigned long long> > links;
+	for (int i = 0; i < nav->getMaxTiles(); ++i)
+	{
+		const dtMeshTile* tile = nav->getTile(i);
+		if (!tile->header)
+			continue;
+		const dtPolyRef base = nav->getPolyRefBase(tile);
+		for (int j = 0; j < tile->header->polyCount; ++j)
+		{
+			std::vector<unsigned long long> polyLinks;
+			for (unsigned int k = tile->polys[j].firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+			{
+				const dtLink& link = tile->links[k];
+				if (nav->decodePolyIdTile(link.ref) == nav->decodePolyIdTile(base))
+					continue;
+				polyLinks.push_back((unsigned long long)link.ref << 32 | (unsigned long long)link.edge << 24 |
+									(unsigned long long)link.side << 16 | (unsigned long long)link.bmin << 8 | link.bmax);
+			}
+			std::sort(polyLinks.begin(), polyLinks.end());
+			links.push_back(polyLinks);
+		}
+	}
+	return links;
+}
+}
+
+TEST_CASE("dtNavMesh border edges", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 5);
+	dtNavMesh* nav = buildTestNavMesh(grid, 16);
+	REQUIRE(nav != 0);
+	const dtNavMesh* constNav = nav;
+
+	SECTION("Every portal edge has a border edge, sorted by side and start")
+	{
+		for (int i = 0; i < constNav->getMaxTiles(); ++i)
+		{
+			const dtMeshTile* tile = constNav->getTile(i);
+			if (!tile->header)
+				continue;
+			int portalCount = 0;
+			for (int j = 0; j < tile->header->polyCount; ++j)
+			{
+				for (int k = 0; k < tile->polys[j].vertCount; ++k)
+				{
+					if (tile->polys[j].neis[k] & DT_EXT_LINK)
+						portalCount++;
+				}
+			}
+			REQUIRE(tile->header->borderEdgeCount == portalCount);
+			for (int j = 0; j < tile->header->borderEdgeCount; ++j)
+			{
+				const dtBorderEdge& edge = tile->borderEdges[j];
+				CHECK(tile->polys[edge.poly].neis[edge.edge] == (DT_EXT_LINK | edge.side));
+				CHECK(edge.bmin[0] <= edge.bmax[0]);
+				if (j > 0)
+				{
+					const dtBorderEdge& prev = tile->borderEdges[j-1];
+					CHECK((prev.side < edge.side || (prev.side == edge.side && prev.bmin[0] <= edge.bmin[0])));
+				}
+			}
+		}
+	}
+
+	SECTION("Links are the same in both directions and for any tile order")
+	{
+		int linkCount = 0;
+		for (int i = 0; i < constNav->getMaxTiles(); ++i)
+		{
+			const dtMeshTile* tile = constNav->getTile(i);
+			if (!tile->header)
+				continue;
+			const dtPolyRef base = nav->getPolyRefBase(tile);
+			for (int j = 0; j < tile->header->polyCount; ++j)
+			{
+				for (unsigned int k = tile->polys[j].firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+				{
+					const dtLink& link = tile->links[k];
+					if (nav->decodePolyIdTile(link.ref) == nav->decodePolyIdTile(base))
+						continue;
+
+					// The neighbour polygon links back.
+					const dtMeshTile* neiTile = 0;
+					const dtPoly* neiPoly = 0;
+					REQUIRE(dtStatusSucceed(nav->getTileAndPolyByRef(link.ref, &neiTile, &neiPoly)));
+					bool found = false;
+					for (unsigned int l = neiPoly->firstLink; l != DT_NULL_LINK; l = neiTile->links[l].next)
+						found = found || neiTile->links[l].ref == (base | (dtPolyRef)j);
+					CHECK(found);
+					linkCount++;
+				}
+			}
+		}
+		CHECK(linkCount > 0);
+
+		// Add the tiles in reverse order.
+		int tw = 0, th = 0;
+		getTestTileCounts(grid, 16, &tw, &th);
+		dtNavMesh* reverseNav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(reverseNav->init(nav->getParams())));
+		for (int i = tw * th - 1; i >= 0; --i)
+		{
+			unsigned char* data = 0;
+			int dataSize = 0;
+			if (!buildTestTileData(grid, 16, i % tw, i / tw, &data, &dataSize))
+				continue;
+			// The tile keeps the same reference as in the forward build.
+			REQUIRE(dtStatusSucceed(reverseNav->addTile(data, dataSize, DT_TILE_FREE_DATA, nav->getTileRefAt(i % tw, i / tw, 0), 0)));
+		}
+		CHECK(collectExternalLinks(reverseNav) == collectExternalLinks(nav));
+		dtFreeNavMesh(reverseNav);
+	}
+
+	dtFreeNavMesh(nav);
+}
+
+namespace
+{
+struct TestTileListener : public dtNavMeshListener
+{
+	int calls;
+	std::vector<dtTileRef> removed;
+	std::vector<dtTileRef> added;
+
+	TestTileListener() : calls(0) {}
+
+	virtual void onTilesChanged(const dtNavMesh*, const dtTileRef* removedRefs, const int nremoved,
+								const dtTileRef* addedRefs, const int nadded)
+	{
+		calls++;
+		removed.assign(removedRefs, removedRefs + nremoved);
+		added.assign(addedRefs, addedRefs + nadded);
+	}
+};
+}
+
+TEST_CASE("dtNavMesh tile batches", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 7);
+	dtNavMesh* nav = buildTestNavMesh(grid, 32);
+	REQUIRE(nav != 0);
+	int tw = 0, th = 0;
+	getTestTileCounts(grid, 32, &tw, &th);
+	int tileCount = 0;
+	for (int i = 0; i < tw * th; ++i)
+		tileCount += nav->getTileRefAt(i % tw, i / tw, 0) ? 1 : 0;
+	for (int i = 0; i < 3; ++i)
+		REQUIRE(nav->getTileRefAt(i, i, 0) != 0);
+
+	dtNavMesh* batchNav = dtAllocNavMesh();
+	REQUIRE(dtStatusSucceed(batchNav->init(nav->getParams())));
+	TestTileListener listener;
+	REQUIRE(dtStatusSucceed(batchNav->addListener(&listener)));
+	REQUIRE(dtStatusSucceed(batchNav->addListener(&listener)));
+
+	SECTION("Tiles added in a batch link like tiles added one by one")
+	{
+		REQUIRE(dtStatusSucceed(batchNav->beginTileBatch()));
+		CHECK(batchNav->isTileBatchOpen());
+		CHECK(dtStatusFailed(batchNav->beginTileBatch()));
+		for (int i = 0; i < tw * th; ++i)
+		{
+			unsigned char* data = 0;
+			int dataSize = 0;
+			if (!buildTestTileData(grid, 32, i % tw, i / tw, &data, &dataSize))
+				continue;
+			REQUIRE(dtStatusSucceed(batchNav->addTile(data, dataSize, DT_TILE_FREE_DATA, nav->getTileRefAt(i % tw, i / tw, 0), 0)));
+		}
+		CHECK(listener.calls == 0);
+		REQUIRE(dtStatusSucceed(batchNav->commitTileBatch()));
+		CHECK(!batchNav->isTileBatchOpen());
+		CHECK(dtStatusFailed(batchNav->commitTileBatch()));
+
+		CHECK(listener.calls == 1);
+		CHECK(listener.removed.empty());
+		CHECK((int)listener.added.size() == tileCount);
+		CHECK(collectExternalLinks(batchNav) == collectExternalLinks(nav));
+	}
+
+	SECTION("Tiles removed and added back in a batch")
+	{
+		for (int i = 0; i < tw * th; ++i)
+		{
+			unsigned char* data = 0;
+			int dataSize = 0;
+			if (!buildTestTileData(grid, 32, i % tw, i / tw, &data, &dataSize))
+				continue;
+			REQUIRE(dtStatusSucceed(batchNav->addTile(data, dataSize, DT_TILE_FREE_DATA, nav->getTileRefAt(i % tw, i / tw, 0), 0)));
+		}
+		CHECK(listener.calls == tileCount);
+		CHECK(listener.added.size() == 1);
+
+		// The reference removes the tile (2,2) one by one.
+		const dtTileRef removedRef = nav->getTileRefAt(2, 2, 0);
+		REQUIRE(dtStatusSucceed(nav->removeTile(removedRef, 0, 0)));
+
+		REQUIRE(dtStatusSucceed(batchNav->beginTileBatch()));
+		const int xs[] = { 1, 0, 2 };
+		const int ys[] = { 1, 0, 2 };
+		dtTileRef refs[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			refs[i] = batchNav->getTileRefAt(xs[i], ys[i], 0);
+			REQUIRE(dtStatusSucceed(batchNav->removeTile(refs[i], 0, 0)));
+			CHECK(batchNav->getTileAt(xs[i], ys[i], 0) == 0);
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			unsigned char* data = 0;
+			int dataSize = 0;
+			REQUIRE(buildTestTileData(grid, 32, xs[i], ys[i], &data, &dataSize));
+			dtTileRef ref = 0;
+			REQUIRE(dtStatusSucceed(batchNav->addTile(data, dataSize, DT_TILE_FREE_DATA, refs[i], &ref)));
+			CHECK(ref == refs[i]);
+		}
+		// A tile added and removed in the same batch is never linked.
+		REQUIRE(dtStatusSucceed(batchNav->removeTile(refs[2], 0, 0)));
+		listener.calls = 0;
+		REQUIRE(dtStatusSucceed(batchNav->commitTileBatch()));
+
+		CHECK(listener.calls == 1);
+		CHECK(listener.removed == std::vector<dtTileRef>(refs, refs + 3));
+		CHECK(listener.added == std::vector<dtTileRef>(refs, refs + 2));
+		CHECK(collectExternalLinks(batchNav) == collectExternalLinks(nav));
+	}
+
+	SECTION("Listeners")
+	{
+		CHECK(dtStatusFailed(batchNav->addListener(0)));
+		TestTileListener others[DT_MAX_NAVMESH_LISTENERS];
+		for (int i = 0; i < DT_MAX_NAVMESH_LISTENERS - 1; ++i)
+			REQUIRE(dtStatusSucceed(batchNav->addListener(&others[i])));
+		CHECK(batchNav->addListener(&others[DT_MAX_NAVMESH_LISTENERS - 1]) == (DT_FAILURE | DT_BUFFER_TOO_SMALL));
+
+		batchNav->removeListener(&listener);
+		unsigned char* data = 0;
+		int dataSize = 0;
+		REQUIRE(buildTestTileData(grid, 32, 0, 0, &data, &dataSize));
+		dtTileRef ref = 0;
+		REQUIRE(dtStatusSucceed(batchNav->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &ref)));
+		CHECK(listener.calls == 0);
+		CHECK(others[0].calls == 1);
+		CHECK(others[0].added == std::vector<dtTileRef>(1, ref));
+
+		// Empty batches are not reported.
+		REQUIRE(dtStatusSucceed(batchNav->beginTileBatch()));
+		REQUIRE(dtStatusSucceed(batchNav->commitTileBatch()));
+		CHECK(others[0].calls == 1);
+
+		REQUIRE(dtStatusSucceed(batchNav->removeTile(ref, 0, 0)));
+		CHECK(others[0].calls == 2);
+		CHECK(others[0].removed == std::vector<dtTileRef>(1, ref));
+		CHECK(others[0].added.empty());
+	}
+
+	dtFreeNavMesh(batchNav);
+	dtFreeNavMesh(nav);
+}
+
+namespace
+{
+unsigned int g_randomSeed = 1;
+
+float testRand()
+{
+	g_randomSeed = g_randomSeed * 1664525u + 1013904223u;
+	return (float)(g_randomSeed >> 8) / 16777216.0f;
+}
+
+float polyArea(const dtMeshTile* tile, const dtPoly* poly)
+{
+	float area = 0.0f;
+	for (int j = 2; j < poly->vertCount; ++j)
+	{
+		area += dtTriArea2D(&tile->verts[poly->verts[0]*3], &tile->verts[poly->verts[j-1]*3],
+							&tile->verts[poly->verts[j]*3]);
+	}
+	return area;
+}
+}
+
+TEST_CASE("dtNavMeshQuery::findRandomPoint with an area sampler", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 9);
+	dtNavMesh* nav = buildTestNavMesh(grid, 32);
+	REQUIRE(nav != 0);
+	const dtNavMesh* constNav = nav;
+	dtNavMeshQuery* query = dtAllocNavMeshQuery();
+	REQUIRE(dtStatusSucceed(query->init(nav, 2048)));
+	dtQueryFilter filter;
+	g_randomSeed = 1;
+
+	dtNavMeshAreaSampler* sampler = dtAllocNavMeshAreaSampler();
+	REQUIRE(sampler != 0);
+	REQUIRE(dtStatusSucceed(sampler->init(nav, &filter)));
+	query->setAreaSampler(sampler);
+
+	std::vector<float> tileAreas(constNav->getMaxTiles(), 0.0f);
+	float totalArea = 0.0f;
+	for (int i = 0; i < constNav->getMaxTiles(); ++i)
+	{
+		const dtMeshTile* tile = constNav->getTile(i);
+		if (!tile->header)
+			continue;
+		for (int j = 0; j < tile->header->polyCount; ++j)
+			tileAreas[i] += polyArea(tile, &tile->polys[j]);
+		totalArea += tileAreas[i];
+	}
+	REQUIRE(sampler->getTotalArea() == Catch::Approx(totalArea).epsilon(0.001));
+
+	SECTION("Points are distributed by area over the whole mesh")
+	{
+		const int sampleCount = 40000;
+		std::vector<int> counts(constNav->getMaxTiles(), 0);
+		for (int i = 0; i < sampleCount; ++i)
+		{
+			dtPolyRef ref = 0;
+			float pt[3];
+			REQUIRE(dtStatusSucceed(query->findRandomPoint(&filter, testRand, &ref, pt)));
+			REQUIRE(constNav->isValidPolyRef(ref));
+			counts[constNav->decodePolyIdTile(ref)]++;
+		}
+		for (int i = 0; i < constNav->getMaxTiles(); ++i)
+		{
+			const float expected = sampleCount * tileAreas[i] / totalArea;
+			CHECK(fabsf(counts[i] - expected) <= 5.0f * sqrtf(expected) + 1.0f);
+		}
+	}
+
+	SECTION("Excluded flags and areas are never sampled")
+	{
+		// Exclude the polygons of one tile by flags, and those of another by area.
+		const dtMeshTile* flagTile = nav->getTileAt(0, 0, 0);
+		const dtMeshTile* areaTile = nav->getTileAt(1, 1, 0);
+		REQUIRE(flagTile != 0);
+		REQUIRE(areaTile != 0);
+		const dtPolyRef flagBase = nav->getPolyRefBase(flagTile);
+		const dtPolyRef areaBase = nav->getPolyRefBase(areaTile);
+		for (int i = 0; i < flagTile->header->polyCount; ++i)
+			nav->setPolyFlags(flagBase | (dtPolyRef)i, 2);
+		for (int i = 0; i < areaTile->header->polyCount; ++i)
+			nav->setPolyArea(areaBase | (dtPolyRef)i, 5);
+
+		float weights[DT_MAX_AREAS];
+		for (int i = 0; i < DT_MAX_AREAS; ++i)
+			weights[i] = 1.0f;
+		weights[5] = 0.0f;
+		filter.setExcludeFlags(2);
+		REQUIRE(dtStatusSucceed(sampler->init(nav, &filter, weights)));
+		CHECK(sampler->getTotalArea() == Catch::Approx(totalArea - tileAreas[nav->decodePolyIdTile(flagBase)] -
+													   tileAreas[nav->decodePolyIdTile(areaBase)]).epsilon(0.001));
+
+		for (int i = 0; i < 5000; ++i)
+		{
+			dtPolyRef ref = 0;
+			float pt[3];
+			REQUIRE(dtStatusSucceed(query->findRandomPoint(&filter, testRand, &ref, pt)));
+			const unsigned int it = nav->decodePolyIdTile(ref);
+			CHECK(it != nav->decodePolyIdTile(flagBase));
+			CHECK(it != nav->decodePolyIdTile(areaBase));
+		}
+
+		// Updating the table of a tile after changing its flags.
+		nav->setPolyFlags(flagBase, 1);
+		REQUIRE(dtStatusSucceed(sampler->addTile(nav->getTileRef(flagTile))));
+		CHECK(sampler->getTotalArea() > totalArea - tileAreas[nav->decodePolyIdTile(flagBase)] -
+									   tileAreas[nav->decodePolyIdTile(areaBase)]);
+
+		// A filter with other flags visits the polygons. The tiles are picked uniformly, so
+		// the tiles without polygons with the flag fail.
+		filter.setExcludeFlags(0);
+		filter.setIncludeFlags(2);
+		CHECK(!sampler->matchesFilter(&filter));
+		int found = 0;
+		for (int i = 0; i < 100; ++i)
+		{
+			dtPolyRef ref = 0;
+			float pt[3];
+			if (dtStatusFailed(query->findRandomPoint(&filter, testRand, &ref, pt)))
+				continue;
+			unsigned short flags = 0;
+			REQUIRE(dtStatusSucceed(nav->getPolyFlags(ref, &flags)));
+			CHECK(flags == 2);
+			found++;
+		}
+		CHECK(found > 0);
+	}
+
+	SECTION("Polygons rejected by the filter are not returned from stale tables")
+	{
+		filter.setExcludeFlags(2);
+		REQUIRE(dtStatusSucceed(sampler->init(nav, &filter)));
+		REQUIRE(sampler->matchesFilter(&filter));
+
+		// Exclude the polygons of a tile without updating the tables.
+		const dtMeshTile* tile = nav->getTileAt(0, 0, 0);
+		REQUIRE(tile != 0);
+		const dtPolyRef base = nav->getPolyRefBase(tile);
+		for (int i = 0; i < tile->header->polyCount; ++i)
+			nav->setPolyFlags(base | (dtPolyRef)i, 2);
+
+		for (int i = 0; i < 5000; ++i)
+		{
+			dtPolyRef ref = 0;
+			float pt[3];
+			REQUIRE(dtStatusSucceed(query->findRandomPoint(&filter, testRand, &ref, pt)));
+			CHECK(nav->decodePolyIdTile(ref) != nav->decodePolyIdTile(base));
+		}
+	}
+
+	SECTION("Tile changes update the tables through the listener")
+	{
+		REQUIRE(dtStatusSucceed(nav->addListener(sampler)));
+		const dtTileRef ref = nav->getTileRefAt(1, 1, 0);
+		const unsigned int it = nav->decodePolyIdTile((dtPolyRef)ref);
+		REQUIRE(dtStatusSucceed(nav->removeTile(ref, 0, 0)));
+		CHECK(sampler->getTotalArea() == Catch::Approx(totalArea - tileAreas[it]).epsilon(0.001));
+		for (int i = 0; i < 5000; ++i)
+		{
+			dtPolyRef polyRef = 0;
+			float pt[3];
+			REQUIRE(dtStatusSucceed(query->findRandomPoint(&filter, testRand, &polyRef, pt)));
+			CHECK(nav->decodePolyIdTile(polyRef) != it);
+		}
+
+		unsigned char* data = 0;
+		int dataSize = 0;
+		REQUIRE(buildTestTileData(grid, 32, 1, 1, &data, &dataSize));
+		REQUIRE(dtStatusSucceed(nav->addTile(data, dataSize, DT_TILE_FREE_DATA, ref, 0)));
+		CHECK(sampler->getTotalArea() == Catch::Approx(totalArea).epsilon(0.001));
+		nav->removeListener(sampler);
+	}
+
+	query->setAreaSampler(0);
+	dtFreeNavMeshAreaSampler(sampler);
+	dtFreeNavMeshQuery(query);
+	dtFreeNavMesh(nav);
+}
+
+TEST_CASE("dtNavMeshQuery local searches over many polygons", "[detour]")
+{
+	// Small tiles, so that the searches cross many polygons.
+	const TestGrid grid = makeOpenGrid(60, 60, 0.5f);
+	TestQuery t(grid, 8, 2, 30, 57, 30);
+
+	SECTION("moveAlongSurface reaches a far end position")
+	{
+		static const int MAX_VISITED = 256;
+		dtPolyRef visited[MAX_VISITED];
+		int nvisited = 0;
+		float resultPos[3];
+		dtStatus status = t.query->moveAlongSurface(t.startRef, t.startPos, t.endPos, &t.filter,
+													resultPos, visited, &nvisited, MAX_VISITED);
+		REQUIRE(status == DT_SUCCESS);
+		CHECK(resultPos[0] == Catch::Approx(t.endPos[0]));
+		CHECK(resultPos[2] == Catch::Approx(t.endPos[2]));
+		REQUIRE(nvisited > 2);
+		CHECK(visited[0] == t.startRef);
+		CHECK(visited[nvisited-1] == t.endRef);
+		CHECK(t.isConnected(visited, nvisited));
+
+		// A short visited array keeps the start of the path.
+		dtPolyRef shortVisited[4];
+		int nshort = 0;
+		status = t.query->moveAlongSurface(t.startRef, t.startPos, t.endPos, &t.filter,
+										   resultPos, shortVisited, &nshort, 4);
+		CHECK(status == (DT_SUCCESS | DT_BUFFER_TOO_SMALL));
+		REQUIRE(nshort == 4);
+		for (int i = 0; i < nshort; ++i)
+			CHECK(shortVisited[i] == visited[i]);
+	}
+
+	SECTION("findLocalNeighbourhood visits the whole circle")
+	{
+		static const int MAX_RESULT = 1024;
+		std::vector<dtPolyRef> refs(MAX_RESULT), parents(MAX_RESULT);
+		int nresult = 0;
+		float center[3];
+		grid.cellCenter(30, 30, center);
+		const float halfExtents[3] = { 0.5f, 1.0f, 0.5f };
+		dtPolyRef centerRef = 0;
+		float centerPos[3];
+		REQUIRE(dtStatusSucceed(t.query->findNearestPoly(center, halfExtents, &t.filter, &centerRef, centerPos)));
+
+		dtStatus status = t.query->findLocalNeighbourhood(centerRef, centerPos, 10.0f, &t.filter,
+														  &refs[0], &parents[0], &nresult, MAX_RESULT);
+		REQUIRE(status == DT_SUCCESS);
+		CHECK(nresult > 64);
+		CHECK(parents[0] == 0);
+		for (int i = 1; i < nresult; ++i)
+			CHECK(std::find(refs.begin(), refs.begin() + i, parents[i]) != refs.begin() + i);
+		std::vector<dtPolyRef> sorted(refs.begin(), refs.begin() + nresult);
+		std::sort(sorted.begin(), sorted.end());
+		CHECK(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+
+		// Caller provided scratch space gives the same result.
+		dtLocalSearchScratch scratch;
+		std::vector<dtPolyRef> scratchRefs(MAX_RESULT);
+		int nscratch = 0;
+		status = t.query->findLocalNeighbourhood(centerRef, centerPos, 10.0f, &t.filter,
+												 &scratchRefs[0], 0, &nscratch, MAX_RESULT, &scratch);
+		REQUIRE(status == DT_SUCCESS);
+		REQUIRE(nscratch == nresult);
+		CHECK(std::equal(refs.begin(), refs.begin() + nresult, scratchRefs.begin()));
+		CHECK(scratch.getCount() >= nresult);
+	}
+}
+
+TEST_CASE("dtNavMeshQuery::raycastBatch", "[detour]")
+{
+	const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 11);
+	TestQuery t(grid, 16, 1, 1, 39, 39);
+
+	static const int RAY_COUNT = 300;
+	static const int MAX_PATH = 64;
+	std::vector<dtPolyRef> startRefs(RAY_COUNT);
+	std::vector<float> startPos(RAY_COUNT*3), endPos(RAY_COUNT*3);
+	g_randomSeed = 5;
+	for (int i = 0; i < RAY_COUNT; ++i)
+	{
+		REQUIRE(dtStatusSucceed(t.query->findRandomPoint(&t.filter, testRand, &startRefs[i], &startPos[i*3])));
+		const float angle = testRand() * 6.2831853f;
+		const float length = testRand() * 12.0f;
+		endPos[i*3+0] = startPos[i*3+0] + cosf(angle) * length;
+		endPos[i*3+1] = startPos[i*3+1];
+		endPos[i*3+2] = startPos[i*3+2] + sinf(angle) * length;
+	}
+	// Rays from the same polygon in a row, and an invalid ray.
+	startRefs[11] = startRefs[10];
+	dtVcopy(&startPos[11*3], &startPos[10*3]);
+	startRefs[RAY_COUNT-1] = 0;
+
+	std::vector<dtPolyRef> paths(RAY_COUNT*MAX_PATH), batchPaths(RAY_COUNT*MAX_PATH);
+	std::vector<dtRaycastHit> hits(RAY_COUNT), batchHits(RAY_COUNT);
+	std::vector<dtStatus> statuses(RAY_COUNT), batchStatuses(RAY_COUNT);
+	const unsigned int options[2] = { 0, DT_RAYCAST_USE_COSTS };
+	for (int o = 0; o < 2; ++o)
+	{
+		for (int i = 0; i < RAY_COUNT; ++i)
+		{
+			// Some of the path buffers are too small.
+			const int maxPath = i % 7 == 0 ? 2 : MAX_PATH;
+			memset(&hits[i], 0, sizeof(dtRaycastHit));
+			memset(&batchHits[i], 0, sizeof(dtRaycastHit));
+			hits[i].path = &paths[i*MAX_PATH];
+			hits[i].maxPath = maxPath;
+			batchHits[i].path = &batchPaths[i*MAX_PATH];
+			batchHits[i].maxPath = maxPath;
+			statuses[i] = t.query->raycast(startRefs[i], &startPos[i*3], &endPos[i*3], &t.filter, options[o], &hits[i]);
+		}
+
+		const dtStatus status = t.query->raycastBatch(&startRefs[0], &startPos[0], &endPos[0], RAY_COUNT, &t.filter,
+													  options[o], &batchHits[0], &batchStatuses[0]);
+		CHECK(dtStatusFailed(status));
+		CHECK(dtStatusDetail(status, DT_BUFFER_TOO_SMALL));
+
+		int walls = 0;
+		for (int i = 0; i < RAY_COUNT; ++i)
+		{
+			REQUIRE(batchStatuses[i] == statuses[i]);
+			const dtRaycastHit& a = hits[i];
+			const dtRaycastHit& b = batchHits[i];
+			CHECK(b.t == a.t);
+			CHECK(b.pathCount == a.pathCount);
+			CHECK(b.pathCost == a.pathCost);
+			CHECK(std::equal(a.path, a.path + a.pathCount, b.path));
+			if (a.t < FLT_MAX && a.pathCount > 0)
+			{
+				CHECK(b.hitEdgeIndex == a.hitEdgeIndex);
+				CHECK(b.hitNormal[0] == a.hitNormal[0]);
+				CHECK(b.hitNormal[2] == a.hitNormal[2]);
+				walls++;
+			}
+		}
+		CHECK(dtStatusFailed(batchStatuses[RAY_COUNT-1]));
+		CHECK(walls > 0);
+		if (options[o] & DT_RAYCAST_USE_COSTS)
+			CHECK(batchHits[0].pathCost > 0.0f);
+	}
+
+	SECTION("Invalid arguments")
+	{
+		CHECK(t.query->raycastBatch(0, 0, 0, 0, &t.filter, 0, 0) == DT_SUCCESS);
+		CHECK(t.query->raycastBatch(&startRefs[0], &startPos[0], &endPos[0], 1, &t.filter, 0, 0) == (DT_FAILURE | DT_INVALID_PARAM));
+		CHECK(t.query->raycastBatch(&startRefs[0], &startPos[0], &endPos[0], 1, 0, 0, &batchHits[0]) == (DT_FAILURE | DT_INVALID_PARAM));
+	}
+}
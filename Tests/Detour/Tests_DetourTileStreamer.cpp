@@ -0,0 +1,397 @@
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+#include "DetourAlloc.h"
+#include "DetourCommon.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include "DetourTileStreamer.h"
+
+#include "TestNavMesh.h"
+
+namespace
+{
+// The tiles of a 4 x 4 tile open grid, each 4 units wide.
+struct TestTileSet
+{
+	std::vector<dtStreamTile> tiles;
+	std::vector<std::vector<unsigned char> > data;
+
+	TestTileSet()
+	{
+		const TestGrid grid = makeOpenGrid(16, 16, 1.0f);
+		for (int y = 0; y < 4; ++y)
+		{
+			for (int x = 0; x < 4; ++x)
+			{
+				unsigned char* tileData = 0;
+				int tileDataSize = 0;
+				REQUIRE(buildTestTileData(grid, 16, x, y, &tileData, &tileDataSize));
+				const dtMeshHeader* header = (const dtMeshHeader*)tileData;
+				dtStreamTile tile;
+				memset(&tile, 0, sizeof(tile));
+				tile.x = x;
+				tile.y = y;
+				dtVcopy(tile.bmin, header->bmin);
+				dtVcopy(tile.bmax, header->bmax);
+				tile.dataSize = tileDataSize;
+				tiles.push_back(tile);
+				data.push_back(std::vector<unsigned char>(tileData, tileData + tileDataSize));
+				dtFree(tileData);
+			}
+		}
+	}
+
+	dtNavMesh* allocNavMesh(int maxTiles = 16) const
+	{
+		dtNavMeshParams params;
+		memset(&params, 0, sizeof(params));
+		params.tileWidth = 4.0f;
+		params.tileHeight = 4.0f;
+		params.maxTiles = maxTiles;
+		params.maxPolys = 1 << 10;
+		dtNavMesh* nav = dtAllocNavMesh();
+		REQUIRE(dtStatusSucceed(nav->init(&params)));
+		return nav;
+	}
+
+	unsigned char* copyData(int index) const
+	{
+		unsigned char* copy = (unsigned char*)dtAlloc((int)data[index].size(), DT_ALLOC_PERM);
+		memcpy(copy, &data[index][0], data[index].size());
+		return copy;
+	}
+};
+
+// Finishes the reads in the order they were started, a limited number at a time.
+class TestMemoryReader : public dtTileStreamReader
+{
+public:
+	TestMemoryReader(const TestTileSet& set, int maxReads) : m_set(set), m_maxReads(maxReads), m_failIndex(-1) {}
+
+	void setFailIndex(int index) { m_failIndex = index; }
+
+	virtual bool beginRead(const int index, const dtStreamTile&)
+	{
+		if ((int)m_reads.size() >= m_maxReads)
+			return false;
+		m_reads.push_back(index);
+		return true;
+	}
+
+	virtual bool pollRead(int* index, unsigned char** data, int* dataSize)
+	{
+		if (m_reads.empty())
+			return false;
+		*index = m_reads.front();
+		m_reads.pop_front();
+		*data = *index == m_failIndex ? 0 : m_set.copyData(*index);
+		*dataSize = (int)m_set.data[*index].size();
+		return true;
+	}
+
+private:
+	const TestTileSet& m_set;
+	std::deque<int> m_reads;
+	int m_maxReads;
+	int m_failIndex;
+};
+
+// Reads the tiles on a background thread.
+class TestThreadReader : public dtTileStreamReader
+{
+public:
+	explicit TestThreadReader(const TestTileSet& set) : m_set(set), m_quit(false)
+	{
+		m_thread = std::thread(&TestThreadReader::run, this);
+	}
+
+	~TestThreadReader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_cond.notify_one();
+		m_thread.join();
+		for (size_t i = 0; i < m_done.size(); ++i)
+			dtFree(m_done[i].second);
+	}
+
+	virtual bool beginRead(const int index, const dtStreamTile&)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests.push_back(index);
+		}
+		m_cond.notify_one();
+		return true;
+	}
+
+	virtual bool pollRead(int* index, unsigned char** data, int* dataSize)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_done.empty())
+			return false;
+		*index = m_done.front().first;
+		*data = m_done.front().second;
+		*dataSize = (int)m_set.data[*index].size();
+		m_done.pop_front();
+		return true;
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;)
+		{
+			m_cond.wait(lock, [this] { return m_quit || !m_requests.empty(); });
+			if (m_quit)
+				return;
+			const int index = m_requests.front();
+			m_requests.pop_front();
+			lock.unlock();
+			unsigned char* data = m_set.copyData(index);
+			lock.lock();
+			m_done.push_back(std::make_pair(index, data));
+		}
+	}
+
+	const TestTileSet& m_set;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::deque<int> m_requests;
+	std::deque<std::pair<int, unsigned char*> > m_done;
+	bool m_quit;
+};
+
+// Updates the streamer until it is up to date, checking the commit and memory limits.
+int updateUntilDone(dtTileStreamer& streamer, int maxCommits, int memoryBudget)
+{
+	int updates = 0;
+	bool upToDate = false;
+	while (!upToDate && updates < 1000)
+	{
+		const int residentBefore = streamer.getResidentTileCount();
+		REQUIRE(dtStatusSucceed(streamer.update(maxCommits, &upToDate)));
+		const int change = streamer.getResidentTileCount() - residentBefore;
+		CHECK((change <= maxCommits && change >= -maxCommits));
+		CHECK(streamer.getUsedMemory() <= memoryBudget);
+		updates++;
+	}
+	REQUIRE(upToDate);
+	return updates;
+}
+
+void tileCenter(int x, int y, float* pos)
+{
+	pos[0] = x * 4.0f + 2.0f;
+	pos[1] = 0.0f;
+	pos[2] = y * 4.0f + 2.0f;
+}
+}
+
+TEST_CASE("dtTileStreamer", "[detour]")
+{
+	const TestTileSet set;
+	dtNavMesh* nav = set.allocNavMesh();
+	dtTileStreamer* streamer = dtAllocTileStreamer();
+	REQUIRE(streamer != 0);
+
+	SECTION("Streams the tiles around the interest points")
+	{
+		TestMemoryReader reader(set, 2);
+		const int budget = 1 << 30;
+		REQUIRE(dtStatusSucceed(streamer->init(nav, &set.tiles[0], (int)set.tiles.size(), &reader, budget)));
+
+		// The tiles within 3 units of the center of tile (0,0).
+		float pos[3];
+		tileCenter(0, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 3.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(streamer->getResidentTileCount() == 4);
+		CHECK(streamer->getPendingReadCount() == 0);
+		for (int i = 0; i < 16; ++i)
+		{
+			const bool near = set.tiles[i].x < 2 && set.tiles[i].y < 2;
+			CHECK(streamer->isTileResident(i) == near);
+			CHECK((nav->getTileAt(set.tiles[i].x, set.tiles[i].y, 0) != 0) == near);
+		}
+
+		// The resident tiles are connected.
+		dtNavMeshQuery* query = dtAllocNavMeshQuery();
+		REQUIRE(dtStatusSucceed(query->init(nav, 512)));
+		dtQueryFilter filter;
+		const float halfExtents[3] = { 0.5f, 1.0f, 0.5f };
+		float startPos[3], endPos[3];
+		dtPolyRef startRef = 0, endRef = 0;
+		tileCenter(0, 0, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &startRef, startPos);
+		tileCenter(1, 1, pos);
+		query->findNearestPoly(pos, halfExtents, &filter, &endRef, endPos);
+		REQUIRE(startRef != 0);
+		REQUIRE(endRef != 0);
+		dtPolyRef path[64];
+		int npath = 0;
+		query->findPath(startRef, endRef, startPos, endPos, &filter, path, &npath, 64);
+		CHECK(npath > 1);
+		CHECK(path[npath-1] == endRef);
+		dtFreeNavMeshQuery(query);
+
+		// Without a memory limit the tiles stay resident after the interest points move.
+		tileCenter(3, 3, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 2, budget);
+		CHECK(streamer->getResidentTileCount() == 5);
+		CHECK(streamer->isTileResident(15));
+	}
+
+	SECTION("Removes the least recently used tiles to stay within the memory budget")
+	{
+		TestMemoryReader reader(set, 4);
+		const int budget = set.tiles[0].dataSize + set.tiles[1].dataSize + set.tiles[2].dataSize - 1;
+		REQUIRE(dtStatusSucceed(streamer->init(nav, &set.tiles[0], (int)set.tiles.size(), &reader, budget)));
+
+		float pos[3];
+		tileCenter(0, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		tileCenter(1, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(streamer->isTileResident(0));
+		CHECK(streamer->isTileResident(1));
+
+		// A query uses tile (0,0) after tile (1,0) was last around an interest point.
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(0, 0, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		const dtMeshTile* tile0 = nav->getTileAt(0, 0, 0);
+		REQUIRE(tile0 != 0);
+		const dtTileRef tileRef0 = nav->getTileRef(tile0);
+		const dtPolyRef polyRef0 = nav->getPolyRefBase(tile0);
+		streamer->touchPoly(polyRef0);
+		REQUIRE(dtStatusSucceed(nav->setPolyFlags(polyRef0, 0x8)));
+
+		// Tile (2,0) does not fit with both, so tile (1,0) is removed.
+		tileCenter(2, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(streamer->isTileResident(0));
+		CHECK(!streamer->isTileResident(1));
+		CHECK(streamer->isTileResident(2));
+
+		// Tile (0,0) is removed for tile (1,0), and comes back with the same reference and state.
+		tileCenter(1, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(!streamer->isTileResident(0));
+		CHECK(nav->getTileAt(0, 0, 0) == 0);
+		tileCenter(0, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		REQUIRE(streamer->isTileResident(0));
+		CHECK(nav->getTileRefAt(0, 0, 0) == tileRef0);
+		unsigned short flags = 0;
+		REQUIRE(dtStatusSucceed(nav->getPolyFlags(polyRef0, &flags)));
+		CHECK(flags == 0x8);
+
+		// The nearest tiles that fit the budget are resident.
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 100.0f)));
+		updateUntilDone(*streamer, 3, budget);
+		CHECK(streamer->getResidentTileCount() == 2);
+		CHECK(streamer->isTileResident(0));
+	}
+
+	SECTION("Removes the least recently used tiles when the navigation mesh is full")
+	{
+		dtNavMesh* smallNav = set.allocNavMesh(4);
+		TestMemoryReader reader(set, 4);
+		const int budget = 1 << 30;
+		REQUIRE(dtStatusSucceed(streamer->init(smallNav, &set.tiles[0], (int)set.tiles.size(), &reader, budget)));
+
+		float pos[3];
+		tileCenter(0, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 3.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(streamer->getResidentTileCount() == 4);
+
+		// The tiles around (3,3) replace the tiles around (0,0).
+		tileCenter(3, 3, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 3.0f)));
+		updateUntilDone(*streamer, 2, budget);
+		CHECK(streamer->getResidentTileCount() == 4);
+		for (int i = 0; i < 16; ++i)
+		{
+			const bool near = set.tiles[i].x >= 2 && set.tiles[i].y >= 2;
+			CHECK(streamer->isTileResident(i) == near);
+			CHECK((smallNav->getTileAt(set.tiles[i].x, set.tiles[i].y, 0) != 0) == near);
+		}
+
+		// The nearest tiles that fit the navigation mesh are resident.
+		tileCenter(0, 0, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 100.0f)));
+		updateUntilDone(*streamer, 2, budget);
+		CHECK(streamer->getResidentTileCount() == 4);
+		for (int i = 0; i < 16; ++i)
+			CHECK(streamer->isTileResident(i) == (set.tiles[i].x < 2 && set.tiles[i].y < 2));
+
+		dtFreeTileStreamer(streamer);
+		streamer = 0;
+		dtFreeNavMesh(smallNav);
+	}
+
+	SECTION("Failed reads are retried when the interest points change")
+	{
+		TestMemoryReader reader(set, 1);
+		const int budget = 1 << 30;
+		REQUIRE(dtStatusSucceed(streamer->init(nav, &set.tiles[0], (int)set.tiles.size(), &reader, budget)));
+		reader.setFailIndex(5);
+
+		float pos[3];
+		tileCenter(1, 1, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(!streamer->isTileResident(5));
+		CHECK(streamer->getUsedMemory() == 0);
+
+		reader.setFailIndex(-1);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 0.0f)));
+		updateUntilDone(*streamer, 1, budget);
+		CHECK(streamer->isTileResident(5));
+		CHECK(streamer->getUsedMemory() == set.tiles[5].dataSize);
+	}
+
+	SECTION("Reads on a background thread")
+	{
+		TestThreadReader reader(set);
+		const int budget = 1 << 30;
+		REQUIRE(dtStatusSucceed(streamer->init(nav, &set.tiles[0], (int)set.tiles.size(), &reader, budget)));
+
+		float pos[3];
+		tileCenter(2, 2, pos);
+		REQUIRE(dtStatusSucceed(streamer->setInterestPoints(pos, 1, 100.0f)));
+		bool upToDate = false;
+		for (int i = 0; i < 10000 && !upToDate; ++i)
+		{
+			REQUIRE(dtStatusSucceed(streamer->update(4, &upToDate)));
+			if (!upToDate)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		CHECK(upToDate);
+		CHECK(streamer->getResidentTileCount() == 16);
+		dtFreeTileStreamer(streamer);
+		streamer = 0;
+	}
+
+	dtFreeTileStreamer(streamer);
+	dtFreeNavMesh(nav);
+}
@@ -1,7 +1,13 @@
+#include <stdlib.h>
+#include <algorithm>
+
 #include "catch2/catch_all.hpp"
 
+#include "DetourCommon.h"
 #include "DetourPathCorridor.h"
 
+#include "../Detour/TestNavMesh.h"
+
 TEST_CASE("dtMergeCorridorStartMoved")
 {
     SECTION("Should handle empty input")
@@ -117,3 +123,217 @@ TEST_CASE("dtMergeCorridorStartMoved")
         CHECK_THAT(path, Catch::Matchers::RangeEquals(expectedPath));
     }
 }
+
+TEST_CASE("dtPathCorridor::findCorners", "[detour]")
+{
+    const TestGrid grid = makeMazeGrid(41, 41, 1.0f, 1234);
+    dtNavMesh* nav = buildTestNavMesh(grid, 32);
+    REQUIRE(nav != nullptr);
+    dtNavMeshQuery* query = dtAllocNavMeshQuery();
+    REQUIRE(dtStatusSucceed(query->init(nav, 4096)));
+    dtQueryFilter filter;
+
+    const float halfExtents[3] = {0.5f, 1.0f, 0.5f};
+    float startPos[3], endPos[3], pos[3];
+    dtPolyRef startRef = 0, endRef = 0;
+    grid.cellCenter(1, 1, pos);
+    query->findNearestPoly(pos, halfExtents, &filter, &startRef, startPos);
+    grid.cellCenter(39, 39, pos);
+    query->findNearestPoly(pos, halfExtents, &filter, &endRef, endPos);
+    REQUIRE(startRef != 0);
+    REQUIRE(endRef != 0);
+
+    static const int MAX_PATH = 1024;
+    dtPolyRef path[MAX_PATH];
+    int npath = 0;
+    REQUIRE(query->findPath(startRef, endRef, startPos, endPos, &filter, path, &npath, MAX_PATH) == DT_SUCCESS);
+
+    dtPathCorridor corridor;
+    REQUIRE(corridor.init(MAX_PATH));
+    corridor.reset(startRef, startPos);
+    corridor.setCorridor(endPos, path, npath);
+
+    SECTION("Results do not change when the cached portals are reused")
+    {
+        static const int MAX_CORNERS = 4;
+        float verts[MAX_CORNERS*3], expectedVerts[MAX_CORNERS*3];
+        unsigned char flags[MAX_CORNERS], expectedFlags[MAX_CORNERS];
+        dtPolyRef polys[MAX_CORNERS], expectedPolys[MAX_CORNERS];
+
+        int steps = 0;
+        for (; steps < 1000; ++steps)
+        {
+            const int ncorners = corridor.findCorners(verts, flags, polys, MAX_CORNERS, query, &filter);
+
+            // A new corridor at the same position does not have cached portals.
+            dtPathCorridor fresh;
+            REQUIRE(fresh.init(MAX_PATH));
+            fresh.reset(corridor.getFirstPoly(), corridor.getPos());
+            fresh.setCorridor(corridor.getTarget(), corridor.getPath(), corridor.getPathCount());
+            const int nexpected = fresh.findCorners(expectedVerts, expectedFlags, expectedPolys, MAX_CORNERS, query, &filter);
+
+            REQUIRE(ncorners == nexpected);
+            for (int i = 0; i < ncorners; ++i)
+            {
+                CHECK(dtVequal(&verts[i*3], &expectedVerts[i*3]));
+                CHECK(flags[i] == expectedFlags[i]);
+                CHECK(polys[i] == expectedPolys[i]);
+            }
+            if (ncorners == 0)
+                break;
+
+            // Step toward the first corner.
+            float dir[3];
+            dtVsub(dir, &verts[0], corridor.getPos());
+            const float dist = dtVlen(dir);
+            float npos[3];
+            dtVmad(npos, corridor.getPos(), dir, dtMin(0.3f, dist) / dist);
+            corridor.movePosition(npos, query, &filter);
+        }
+        CHECK(steps < 1000);
+        CHECK(corridor.getFirstPoly() == endRef);
+    }
+
+    dtFreeNavMeshQuery(query);
+    dtFreeNavMesh(nav);
+}
+
+namespace
+{
+int allocCount = 0;
+
+void* countingAlloc(size_t size, dtAllocHint)
+{
+    allocCount++;
+    return malloc(size);
+}
+}
+
+TEST_CASE("dtPathCorridor with a shared path buffer", "[detour]")
+{
+    const TestGrid grid = makeOpenGrid(16, 16, 1.0f);
+    dtNavMesh* nav = buildTestNavMesh(grid, 8);
+    REQUIRE(nav != nullptr);
+    dtNavMeshQuery* query = dtAllocNavMeshQuery();
+    REQUIRE(dtStatusSucceed(query->init(nav, 4096)));
+    dtQueryFilter filter;
+    dtQueryFilter excludeAll;
+    excludeAll.setIncludeFlags(0);
+
+    const float halfExtents[3] = {0.5f, 1.0f, 0.5f};
+    float startPos[3], midPos[3], endPos[3], pos[3];
+    dtPolyRef startRef = 0, midRef = 0, endRef = 0;
+    grid.cellCenter(2, 2, pos);
+    query->findNearestPoly(pos, halfExtents, &filter, &startRef, startPos);
+    grid.cellCenter(8, 14, pos);
+    query->findNearestPoly(pos, halfExtents, &filter, &midRef, midPos);
+    grid.cellCenter(14, 2, pos);
+    query->findNearestPoly(pos, halfExtents, &filter, &endRef, endPos);
+    REQUIRE(startRef != 0);
+    REQUIRE(midRef != 0);
+    REQUIRE(endRef != 0);
+
+    // A detour through the middle point.
+    static const int MAX_PATH = 256;
+    dtPolyRef path[MAX_PATH], second[MAX_PATH];
+    int npath = 0, nsecond = 0;
+    REQUIRE(dtStatusSucceed(query->findPath(startRef, midRef, startPos, midPos, &filter, path, &npath, MAX_PATH)));
+    REQUIRE(dtStatusSucceed(query->findPath(midRef, endRef, midPos, endPos, &filter, second, &nsecond, MAX_PATH)));
+    REQUIRE(npath + nsecond - 1 <= MAX_PATH);
+    for (int i = 1; i < nsecond; ++i)
+        path[npath++] = second[i];
+
+    // Corridors using parts of one path buffer and one portal buffer.
+    static const int CORRIDOR_COUNT = 3;
+    static const int MAX_PORTALS = DT_PATHCORRIDOR_MAX_CACHED_PORTALS;
+    dtPolyRef* pool = (dtPolyRef*)dtAlloc(sizeof(dtPolyRef) * MAX_PATH * CORRIDOR_COUNT, DT_ALLOC_PERM);
+    dtStraightPathPortal* portalPool = (dtStraightPathPortal*)dtAlloc(sizeof(dtStraightPathPortal) * MAX_PORTALS * CORRIDOR_COUNT, DT_ALLOC_PERM);
+    REQUIRE(pool != nullptr);
+    REQUIRE(portalPool != nullptr);
+    {
+        dtPathCorridor corridors[CORRIDOR_COUNT];
+        allocCount = 0;
+        dtAllocSetCustom(countingAlloc, nullptr);
+        for (int i = 0; i < CORRIDOR_COUNT; ++i)
+        {
+            REQUIRE(corridors[i].init(&pool[i * MAX_PATH], MAX_PATH, &portalPool[i * MAX_PORTALS], MAX_PORTALS));
+            corridors[i].reset(startRef, startPos);
+            corridors[i].setCorridor(endPos, path, npath);
+            CHECK(corridors[i].getPath() == &pool[i * MAX_PATH]);
+        }
+        dtAllocSetCustom(nullptr, nullptr);
+        CHECK(allocCount == 0);
+        dtPathCorridor invalid;
+        CHECK(!invalid.init(nullptr, MAX_PATH));
+
+        SECTION("Corners with a shared portal cache")
+        {
+            dtPathCorridor owning;
+            REQUIRE(owning.init(MAX_PATH));
+            owning.reset(startRef, startPos);
+            owning.setCorridor(endPos, path, npath);
+
+            static const int MAX_CORNERS = 4;
+            float verts[MAX_CORNERS * 3], expectedVerts[MAX_CORNERS * 3];
+            unsigned char flags[MAX_CORNERS], expectedFlags[MAX_CORNERS];
+            dtPolyRef polys[MAX_CORNERS], expectedPolys[MAX_CORNERS];
+            const int nexpected = owning.findCorners(expectedVerts, expectedFlags, expectedPolys, MAX_CORNERS, query, &filter);
+            REQUIRE(nexpected > 0);
+
+            // The second call uses the cached portals.
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                const int ncorners = corridors[2].findCorners(verts, flags, polys, MAX_CORNERS, query, &filter);
+                REQUIRE(ncorners == nexpected);
+                for (int i = 0; i < ncorners; ++i)
+                {
+                    CHECK(dtVequal(&verts[i * 3], &expectedVerts[i * 3]));
+                    CHECK(flags[i] == expectedFlags[i]);
+                    CHECK(polys[i] == expectedPolys[i]);
+                }
+            }
+        }
+
+        SECTION("Visibility optimization skips unchanged corners")
+        {
+            dtPathCorridor& corridor = corridors[0];
+
+            // A search that fails is not repeated for the same corner.
+            corridor.optimizePathVisibility(endPos, 12.5f, query, &excludeAll, true);
+            CHECK(corridor.getPathCount() == npath);
+            corridor.optimizePathVisibility(endPos, 12.5f, query, &filter, true);
+            CHECK(corridor.getPathCount() == npath);
+
+            // Another corner, or not skipping, searches again.
+            corridor.optimizePathVisibility(endPos, 12.5f, query, &filter);
+            CHECK(corridor.getPathCount() < npath);
+            CHECK(corridor.getFirstPoly() == startRef);
+            CHECK(corridor.getLastPoly() == endRef);
+
+            // Loading a corridor allows the next search.
+            dtPathCorridor& other = corridors[1];
+            other.optimizePathVisibility(endPos, 12.5f, query, &excludeAll, true);
+            other.setCorridor(endPos, path, npath);
+            other.optimizePathVisibility(endPos, 12.5f, query, &filter, true);
+            CHECK(other.getPathCount() == corridor.getPathCount());
+
+            // The other corridors are not touched.
+            CHECK(corridors[2].getPathCount() == npath);
+            CHECK(std::equal(path, path + npath, corridors[2].getPath()));
+        }
+
+        SECTION("Topology optimization within an iteration budget")
+        {
+            CHECK(corridors[0].optimizePathTopology(query, &filter, 256));
+            CHECK(corridors[0].getPathCount() < npath);
+            CHECK(corridors[0].getLastPoly() == endRef);
+            CHECK(corridors[1].optimizePathTopology(query, &filter, 1));
+            CHECK(corridors[1].getPathCount() >= corridors[0].getPathCount());
+        }
+    }
+    dtFree(pool);
+    dtFree(portalPool);
+
+    dtFreeNavMeshQuery(query);
+    dtFreeNavMesh(nav);
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+
+#include "TestTerrain.h"
+
+#include "../Bench.h"
+
+#ifdef BENCH_SUPPORTED
+
+namespace
+{
+// Steep terrain rasterized into a heightfield, with the areas of the rasterized spans.
+struct BenchHeightfield
+{
+	rcHeightfield* solid;
+	std::vector<unsigned char> spanAreas;
+	int walkableHeight;
+	int walkableClimb;
+
+	BenchHeightfield() : solid(rcAllocHeightfield()), walkableHeight(20), walkableClimb(4)
+	{
+		rcContext ctx(false);
+		const TestTerrain terrain = makeTestTerrain(64, 6.0f);
+		const float cs = 0.1f, ch = 0.1f;
+		int width = 0, height = 0;
+		rcCalcGridSize(terrain.bmin, terrain.bmax, cs, &width, &height);
+
+		const int nverts = (int)terrain.verts.size() / 3;
+		const int ntris = (int)terrain.tris.size() / 3;
+		std::vector<unsigned char> areas(ntris, 0);
+		rcMarkWalkableTriangles(&ctx, 60.0f, &terrain.verts[0], nverts, &terrain.tris[0], ntris, &areas[0]);
+		rcCreateHeightfield(&ctx, *solid, width, height, terrain.bmin, terrain.bmax, cs, ch);
+		rcRasterizeTriangles(&ctx, &terrain.verts[0], nverts, &terrain.tris[0], &areas[0], ntris, *solid, walkableClimb);
+
+		for (int i = 0; i < solid->width * solid->height; ++i)
+		{
+			for (const rcSpan* span = solid->spans[i]; span; span = span->next)
+				spanAreas.push_back((unsigned char)span->area);
+		}
+	}
+
+	~BenchHeightfield()
+	{
+		rcFreeHeightField(solid);
+	}
+
+	// Restores the areas of the rasterized spans.
+	void resetAreas()
+	{
+		int n = 0;
+		for (int i = 0; i < solid->width * solid->height; ++i)
+		{
+			for (rcSpan* span = solid->spans[i]; span; span = span->next)
+				span->area = spanAreas[n++];
+		}
+	}
+};
+
+BenchHeightfield& benchHeightfield()
+{
+	static BenchHeightfield heightfield;
+	return heightfield;
+}
+}
+
+TEST_CASE("filter_Heightfield", "[.bench]")
+{
+	printf("filter_Heightfield: %d x %d cells, %d spans\n", benchHeightfield().solid->width,
+		   benchHeightfield().solid->height, (int)benchHeightfield().spanAreas.size());
+}
+
+BM(FilterLedgeSpans, 20)
+{
+	BenchHeightfield& hf = benchHeightfield();
+	rcContext ctx(false);
+	hf.resetAreas();
+	rcFilterLedgeSpans(&ctx, hf.walkableHeight, hf.walkableClimb, *hf.solid);
+}
+
+#endif  // BENCH_SUPPORTED
@@ -0,0 +1,77 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+
+#include "TestTerrain.h"
+
+#include "../Bench.h"
+
+#ifdef BENCH_SUPPORTED
+
+namespace
+{
+// Polygon mesh of a small terrain, shared by the benchmarks.
+struct BenchDetailMesh
+{
+	TestTerrainBuild build;
+	float avgPolyArea;
+
+	BenchDetailMesh() : avgPolyArea(0)
+	{
+		rcContext ctx(false);
+		build.build(&ctx, makeTestTerrain(12, 0.5f), 0.3f);
+		const rcPolyMesh& pmesh = *build.pmesh;
+		for (int i = 0; i < pmesh.npolys; ++i)
+		{
+			const unsigned short* p = &pmesh.polys[i*pmesh.nvp*2];
+			int nv = 0;
+			while (nv < pmesh.nvp && p[nv] != RC_MESH_NULL_IDX)
+				nv++;
+			float area = 0;
+			for (int j = 0, k = nv-1; j < nv; k = j++)
+			{
+				const unsigned short* va = &pmesh.verts[p[k]*3];
+				const unsigned short* vb = &pmesh.verts[p[j]*3];
+				area += ((float)va[2]*vb[0] - (float)va[0]*vb[2]) * 0.5f;
+			}
+			avgPolyArea += fabsf(area) * pmesh.cs * pmesh.cs / pmesh.npolys;
+		}
+	}
+
+	// Builds the detail mesh sampling about the given number of points per polygon.
+	void buildDetail(const int samplesPerPoly)
+	{
+		rcContext ctx(false);
+		const float sampleDist = sqrtf(avgPolyArea / samplesPerPoly);
+		rcPolyMeshDetail* dmesh = rcAllocPolyMeshDetail();
+		rcBuildPolyMeshDetail(&ctx, *build.pmesh, *build.chf, sampleDist, 0.01f, *dmesh);
+		rcFreePolyMeshDetail(dmesh);
+	}
+};
+
+BenchDetailMesh& benchDetailMesh()
+{
+	static BenchDetailMesh mesh;
+	return mesh;
+}
+}
+
+BM(BuildPolyMeshDetail_1kSamples, 4)
+{
+	benchDetailMesh().buildDetail(1000);
+}
+
+BM(BuildPolyMeshDetail_4kSamples, 2)
+{
+	benchDetailMesh().buildDetail(4000);
+}
+
+BM(BuildPolyMeshDetail_10kSamples, 1)
+{
+	benchDetailMesh().buildDetail(10000);
+}
+
+#endif  // BENCH_SUPPORTED
@@ -0,0 +1,145 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+
+#include "TestTerrain.h"
+
+#include "../Bench.h"
+
+#ifdef BENCH_SUPPORTED
+
+namespace
+{
+// Compact heightfield of a terrain, with the areas before erosion.
+struct BenchCompactHeightfield
+{
+	TestTerrainBuild build;
+	std::vector<unsigned char> areas;
+
+	BenchCompactHeightfield()
+	{
+		rcContext ctx(false);
+		build.build(&ctx, makeTestTerrain(48, 2.0f), 0.1f);
+		areas.assign(build.chf->areas, build.chf->areas + build.chf->spanCount);
+	}
+
+	void resetAreas()
+	{
+		memcpy(build.chf->areas, &areas[0], areas.size());
+	}
+};
+
+BenchCompactHeightfield& benchCompactHeightfield()
+{
+	static BenchCompactHeightfield chf;
+	return chf;
+}
+
+// Small convex volumes scattered over the compact heightfield.
+struct BenchConvexVolumes
+{
+	std::vector<float> verts;
+	std::vector<rcConvexPolyVolume> volumes;
+
+	BenchConvexVolumes()
+	{
+		static const int numVolumes = 2000;
+		static const int numVerts = 6;
+		const rcCompactHeightfield& chf = *benchCompactHeightfield().build.chf;
+		const float sizeX = chf.bmax[0] - chf.bmin[0];
+		const float sizeZ = chf.bmax[2] - chf.bmin[2];
+
+		verts.resize(numVolumes * numVerts * 3);
+		volumes.resize(numVolumes);
+		unsigned int seed = 1;
+		for (int i = 0; i < numVolumes; ++i)
+		{
+			seed = seed * 1103515245u + 12345u;
+			const float centerX = chf.bmin[0] + (float)((seed >> 8) % 1024) / 1024.0f * sizeX;
+			seed = seed * 1103515245u + 12345u;
+			const float centerZ = chf.bmin[2] + (float)((seed >> 8) % 1024) / 1024.0f * sizeZ;
+			const float radius = 0.5f + (float)(i % 8) * 0.25f;
+			float* polyVerts = &verts[i * numVerts * 3];
+			for (int j = 0; j < numVerts; ++j)
+			{
+				const float angle = (float)j / (float)numVerts * 6.2831853f;
+				polyVerts[j * 3 + 0] = centerX + cosf(angle) * radius;
+				polyVerts[j * 3 + 1] = 0;
+				polyVerts[j * 3 + 2] = centerZ + sinf(angle) * radius;
+			}
+
+			rcConvexPolyVolume& volume = volumes[i];
+			volume.verts = polyVerts;
+			volume.numVerts = numVerts;
+			volume.minY = chf.bmin[1];
+			volume.maxY = chf.bmax[1];
+			volume.areaId = (unsigned char)(1 + i % 8);
+		}
+	}
+};
+
+BenchConvexVolumes& benchConvexVolumes()
+{
+	static BenchConvexVolumes volumes;
+	return volumes;
+}
+}
+
+TEST_CASE("region_CompactHeightfield", "[.bench]")
+{
+	const rcCompactHeightfield& chf = *benchCompactHeightfield().build.chf;
+	printf("region_CompactHeightfield: %d x %d cells, %d spans\n", chf.width, chf.height, chf.spanCount);
+}
+
+BM(ErodeWalkableArea, 20)
+{
+	BenchCompactHeightfield& chf = benchCompactHeightfield();
+	rcContext ctx(false);
+	chf.resetAreas();
+	rcErodeWalkableArea(&ctx, 4, *chf.build.chf);
+}
+
+BM(BuildDistanceField, 20)
+{
+	BenchCompactHeightfield& chf = benchCompactHeightfield();
+	rcContext ctx(false);
+	chf.resetAreas();
+	rcBuildDistanceField(&ctx, *chf.build.chf);
+}
+
+BM(BuildContours, 20)
+{
+	BenchCompactHeightfield& chf = benchCompactHeightfield();
+	rcContext ctx(false);
+	rcContourSet cset;
+	rcBuildContours(&ctx, *chf.build.chf, chf.build.cfg.maxSimplificationError, chf.build.cfg.maxEdgeLen, cset);
+}
+
+BM(MarkConvexPolyArea, 10)
+{
+	BenchCompactHeightfield& chf = benchCompactHeightfield();
+	const BenchConvexVolumes& volumes = benchConvexVolumes();
+	rcContext ctx(false);
+	chf.resetAreas();
+	for (size_t i = 0; i < volumes.volumes.size(); ++i)
+	{
+		const rcConvexPolyVolume& volume = volumes.volumes[i];
+		rcMarkConvexPolyArea(&ctx, volume.verts, volume.numVerts, volume.minY, volume.maxY, volume.areaId, *chf.build.chf);
+	}
+}
+
+BM(MarkConvexPolyAreas, 10)
+{
+	BenchCompactHeightfield& chf = benchCompactHeightfield();
+	const BenchConvexVolumes& volumes = benchConvexVolumes();
+	rcContext ctx(false);
+	chf.resetAreas();
+	rcMarkConvexPolyAreas(&ctx, &volumes.volumes[0], (int)volumes.volumes.size(), *chf.build.chf);
+}
+
+#endif  // BENCH_SUPPORTED
@@ -8,35 +8,9 @@
 #include "RecastAssert.h"
 #include <vector>
 
-// TODO: Implement benchmarking for platforms other than posix.
-#ifdef __unix__
-#include <unistd.h>
-#ifdef _POSIX_TIMERS
-#include <time.h>
-#include <stdint.h>
+#include "../Bench.h"
 
-int64_t NowNanos() {
-	struct timespec tp;
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
-	return tp.tv_nsec + 1000000000LL * tp.tv_sec;
-}
-
-#define BM(name, iterations) \
-	struct BM_ ## name { \
-		static void Run() { \
-			int64_t begin_time = NowNanos(); \
-			for (int i = 0 ; i < iterations; i++) { \
-				Body(); \
-			} \
-			int64_t nanos = NowNanos() - begin_time; \
-			printf("BM_%-35s %ld iterations in %10ld nanos: %10.2f nanos/it\n", #name ":", (int64_t)iterations, nanos, double(nanos) / iterations); \
-		} \
-		static void Body(); \
-	}; \
-	TEST_CASE(#name) { \
-		BM_ ## name::Run(); \
-	} \
-	void BM_ ## name::Body()
+#ifdef BENCH_SUPPORTED
 
 const int64_t kNumLoops = 100;
 const int64_t kNumInserts = 100000;
@@ -164,5 +138,4 @@ BM(stdvector_Resize, kNumLoops)
 }
 
 #undef BM
-#endif  // _POSIX_TIMERS
-#endif  // __unix__
+#endif  // BENCH_SUPPORTED
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Recast.h"
+
+// Rolling terrain with a few walls, as a triangle soup.
+struct TestTerrain
+{
+	std::vector<float> verts;
+	std::vector<int> tris;
+	float bmin[3];
+	float bmax[3];
+};
+
+// Builds a size x size terrain of unit quads whose height follows a few sine waves.
+inline TestTerrain makeTestTerrain(int size, float amplitude)
+{
+	TestTerrain terrain;
+	for (int z = 0; z <= size; ++z)
+	{
+		for (int x = 0; x <= size; ++x)
+		{
+			const float y = amplitude * (sinf(x * 0.21f) * cosf(z * 0.17f) + 0.5f * sinf((x + z) * 0.53f));
+			terrain.verts.push_back((float)x);
+			terrain.verts.push_back(y);
+			terrain.verts.push_back((float)z);
+		}
+	}
+	for (int z = 0; z < size; ++z)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			const int i = x + z * (size + 1);
+			const int t[6] = { i, i + size + 1, i + size + 2, i, i + size + 2, i + 1 };
+			terrain.tris.insert(terrain.tris.end(), t, t + 6);
+		}
+	}
+
+	// Walls that split the terrain into regions.
+	for (int w = 1; w < 4; ++w)
+	{
+		const float x0 = size * w / 4.0f, x1 = x0 + 0.5f;
+		const float z0 = size * 0.1f * w, z1 = size * (0.5f + 0.1f * w);
+		const int base = (int)terrain.verts.size() / 3;
+		const float v[24] = { x0,-10,z0, x1,-10,z0, x1,-10,z1, x0,-10,z1, x0,10,z0, x1,10,z0, x1,10,z1, x0,10,z1 };
+		terrain.verts.insert(terrain.verts.end(), v, v + 24);
+		const int t[24] = { 4,5,6, 4,6,7, 0,4,7, 0,7,3, 1,2,6, 1,6,5, 0,1,5, 0,5,4 };
+		for (int i = 0; i < 24; ++i)
+			terrain.tris.push_back(base + t[i]);
+	}
+
+	rcCalcBounds(&terrain.verts[0], (int)terrain.verts.size() / 3, terrain.bmin, terrain.bmax);
+	return terrain;
+}
+
+// The Recast build products of a terrain, up to the polygon mesh.
+struct TestTerrainBuild
+{
+	rcConfig cfg;
+	rcCompactHeightfield* chf;
+	rcContourSet* cset;
+	rcPolyMesh* pmesh;
+
+	TestTerrainBuild() : chf(rcAllocCompactHeightfield()), cset(rcAllocContourSet()), pmesh(rcAllocPolyMesh())
+	{
+		memset(&cfg, 0, sizeof(cfg));
+	}
+
+	~TestTerrainBuild()
+	{
+		rcFreeCompactHeightfield(chf);
+		rcFreeContourSet(cset);
+		rcFreePolyMesh(pmesh);
+	}
+
+	bool build(rcContext* ctx, const TestTerrain& terrain, float cellSize)
+	{
+		cfg.cs = cellSize;
+		cfg.ch = 0.1f;
+		cfg.walkableSlopeAngle = 50.0f;
+		cfg.walkableHeight = (int)ceilf(2.0f / cfg.ch);
+		cfg.walkableClimb = (int)floorf(0.9f / cfg.ch);
+		cfg.walkableRadius = 1;
+		cfg.maxEdgeLen = (int)(12.0f / cellSize);
+		cfg.maxSimplificationError = 1.3f;
+		cfg.minRegionArea = 8;
+		cfg.mergeRegionArea = 20;
+		cfg.maxVertsPerPoly = 6;
+		cfg.detailSampleDist = cellSize * 2.0f;
+		cfg.detailSampleMaxError = cfg.ch;
+		rcVcopy(cfg.bmin, terrain.bmin);
+		rcVcopy(cfg.bmax, terrain.bmax);
+		rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+
+		const int nverts = (int)terrain.verts.size() / 3;
+		const int ntris = (int)terrain.tris.size() / 3;
+		std::vector<unsigned char> areas(ntris, 0);
+		rcMarkWalkableTriangles(ctx, cfg.walkableSlopeAngle, &terrain.verts[0], nverts, &terrain.tris[0], ntris, &areas[0]);
+
+		rcHeightfield* solid = rcAllocHeightfield();
+		bool ok = rcCreateHeightfield(ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)
+			&& rcRasterizeTriangles(ctx, &terrain.verts[0], nverts, &terrain.tris[0], &areas[0], ntris, *solid, cfg.walkableClimb);
+		if (ok)
+		{
+			rcFilterLowHangingWalkableObstacles(ctx, cfg.walkableClimb, *solid);
+			rcFilterLedgeSpans(ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
+			rcFilterWalkableLowHeightSpans(ctx, cfg.walkableHeight, *solid);
+			ok = rcBuildCompactHeightfield(ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf)
+				&& rcErodeWalkableArea(ctx, cfg.walkableRadius, *chf)
+				&& rcBuildDistanceField(ctx, *chf)
+				&& rcBuildRegions(ctx, *chf, 0, cfg.minRegionArea, cfg.mergeRegionArea)
+				&& rcBuildContours(ctx, *chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *cset)
+				&& rcBuildPolyMesh(ctx, *cset, cfg.maxVertsPerPoly, *pmesh);
+		}
+		rcFreeHeightField(solid);
+		return ok;
+	}
+};
+
+// Runs the parallel parts of the build steps on threads, one thread per part.
+class TestThreadContext : public rcContext
+{
+public:
+	explicit TestThreadContext(int parts) : rcContext(false), m_parts(parts) {}
+
+protected:
+	virtual int doGetParallelParts() const { return m_parts; }
+
+	virtual void doRunParallel(rcParallelTask& task, const int partCount)
+	{
+		std::vector<std::thread> threads;
+		for (int i = 0; i < partCount; ++i)
+			threads.push_back(std::thread(&rcParallelTask::runPart, &task, i));
+		for (size_t i = 0; i < threads.size(); ++i)
+			threads[i].join();
+	}
+
+private:
+	int m_parts;
+};
+
+// Runs the parallel parts of the build steps on the calling thread, last part first.
+class TestReverseContext : public rcContext
+{
+public:
+	explicit TestReverseContext(int parts) : rcContext(false), m_parts(parts) {}
+
+protected:
+	virtual int doGetParallelParts() const { return m_parts; }
+
+	virtual void doRunParallel(rcParallelTask& task, const int partCount)
+	{
+		for (int i = partCount - 1; i >= 0; --i)
+			task.runPart(i);
+	}
+
+private:
+	int m_parts;
+};
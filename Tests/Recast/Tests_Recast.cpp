@@ -1,5 +1,7 @@
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 
 #include "catch2/catch_all.hpp"
 
@@ -935,3 +937,147 @@ TEST_CASE("rcRasterizeTriangles", "[recast]")
 		REQUIRE(!solid.spans[1 + 2 * width]->next);
 	}
 }
+
+TEST_CASE("rcCalcBoundaryDistance", "[recast]")
+{
+	rcContext ctx;
+
+	// A flat square of walkable spans, with an area of another type in the middle.
+	const int size = 300;
+	const float bmin[3] = { 0, 0, 0 };
+	const float bmax[3] = { (float)size, 10, (float)size };
+	rcHeightfield solid;
+	REQUIRE(rcCreateHeightfield(&ctx, solid, size, size, bmin, bmax, 1, 1));
+	for (int z = 0; z < size; ++z)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			const bool inner = x >= 140 && x < 160 && z >= 140 && z < 160;
+			REQUIRE(rcAddSpan(&ctx, solid, x, z, 0, 1, inner ? 2 : RC_WALKABLE_AREA, 1));
+		}
+	}
+	rcCompactHeightfield chf;
+	REQUIRE(rcBuildCompactHeightfield(&ctx, 2, 1, solid, chf));
+	REQUIRE(chf.spanCount == size * size);
+
+	SECTION("Distances to the walkable boundary are two per cell from the edge")
+	{
+		unsigned short maxDistance = 0;
+		std::vector<unsigned short> distances(chf.spanCount);
+		REQUIRE(rcCalcBoundaryDistance(&ctx, chf, RC_BOUNDARY_WALKABLE, &distances[0], &maxDistance));
+		for (int z = 0; z < size; ++z)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const int edge = rcMin(rcMin(x, size - 1 - x), rcMin(z, size - 1 - z));
+				REQUIRE(distances[chf.cells[x + z * size].index] == edge * 2);
+			}
+		}
+		REQUIRE(maxDistance == (size / 2 - 1) * 2);
+	}
+
+	SECTION("Distances to the area boundary stop at the other area")
+	{
+		std::vector<unsigned short> distances(chf.spanCount);
+		REQUIRE(rcCalcBoundaryDistance(&ctx, chf, RC_BOUNDARY_AREA, &distances[0]));
+		REQUIRE(distances[chf.cells[140 + 140 * size].index] == 0);
+		REQUIRE(distances[chf.cells[139 + 150 * size].index] == 0);
+		REQUIRE(distances[chf.cells[135 + 150 * size].index] == 8);
+		REQUIRE(distances[chf.cells[150 + 150 * size].index] == 18);
+	}
+
+	SECTION("Erosion with a radius above 127 cells")
+	{
+		REQUIRE(rcErodeWalkableArea(&ctx, 130, chf));
+		for (int z = 0; z < size; ++z)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const int edge = rcMin(rcMin(x, size - 1 - x), rcMin(z, size - 1 - z));
+				const unsigned char area = chf.areas[chf.cells[x + z * size].index];
+				REQUIRE((area != RC_NULL_AREA) == (edge >= 130));
+			}
+		}
+	}
+}
+
+TEST_CASE("rcMarkConvexPolyAreas", "[recast]")
+{
+	rcContext ctx;
+
+	// Two layers of spans, with a few spans removed.
+	const int width = 64;
+	const int height = 48;
+	const float cellSize = 0.5f;
+	const float bmin[3] = { -3, 0, 5 };
+	const float bmax[3] = { bmin[0] + width * cellSize, 20, bmin[2] + height * cellSize };
+	rcHeightfield solid;
+	REQUIRE(rcCreateHeightfield(&ctx, solid, width, height, bmin, bmax, cellSize, 0.5f));
+	for (int z = 0; z < height; ++z)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			const unsigned char area = (x * 7 + z * 3) % 11 == 0 ? RC_NULL_AREA : RC_WALKABLE_AREA;
+			REQUIRE(rcAddSpan(&ctx, solid, x, z, 0, 2, area, 1));
+			REQUIRE(rcAddSpan(&ctx, solid, x, z, 18, 20, RC_WALKABLE_AREA, 1));
+		}
+	}
+	rcCompactHeightfield expected;
+	rcCompactHeightfield actual;
+	REQUIRE(rcBuildCompactHeightfield(&ctx, 4, 1, solid, expected));
+	REQUIRE(rcBuildCompactHeightfield(&ctx, 4, 1, solid, actual));
+
+	// Random polygons snapped to a quarter cell so that edges pass through cell centers,
+	// every fourth one a non-convex star, some of them reaching outside the heightfield.
+	const int numVolumes = 200;
+	const int maxVerts = 12;
+	std::vector<float> verts(numVolumes * maxVerts * 3);
+	std::vector<rcConvexPolyVolume> volumes(numVolumes);
+	unsigned int seed = 12345;
+	for (int i = 0; i < numVolumes; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const float centerX = bmin[0] - 4.0f + (float)((seed >> 8) % 160) * 0.25f;
+		seed = seed * 1103515245u + 12345u;
+		const float centerZ = bmin[2] - 4.0f + (float)((seed >> 8) % 128) * 0.25f;
+		seed = seed * 1103515245u + 12345u;
+		const float radius = 0.5f + (float)((seed >> 8) % 32) * 0.25f;
+		const bool star = i % 4 == 0;
+		const int numVerts = star ? maxVerts : 3 + i % 6;
+
+		float* polyVerts = &verts[i * maxVerts * 3];
+		for (int j = 0; j < numVerts; ++j)
+		{
+			const float angle = (float)j / (float)numVerts * 6.2831853f;
+			const float r = star && (j & 1) ? radius * 0.4f : radius;
+			polyVerts[j * 3 + 0] = floorf((centerX + cosf(angle) * r) * 4.0f) * 0.25f;
+			polyVerts[j * 3 + 1] = 0;
+			polyVerts[j * 3 + 2] = floorf((centerZ + sinf(angle) * r) * 4.0f) * 0.25f;
+		}
+
+		rcConvexPolyVolume& volume = volumes[i];
+		volume.verts = polyVerts;
+		volume.numVerts = numVerts;
+		volume.minY = i % 3 == 0 ? 5.0f : -1.0f;
+		volume.maxY = i % 3 == 1 ? 5.0f : 15.0f;
+		volume.areaId = i % 17 == 0 ? RC_NULL_AREA : (unsigned char)(1 + i % 40);
+	}
+
+	for (int i = 0; i < numVolumes; ++i)
+	{
+		const rcConvexPolyVolume& volume = volumes[i];
+		rcMarkConvexPolyArea(&ctx, volume.verts, volume.numVerts, volume.minY, volume.maxY, volume.areaId, expected);
+	}
+	REQUIRE(rcMarkConvexPolyAreas(&ctx, &volumes[0], numVolumes, actual));
+
+	int numMarked = 0;
+	for (int i = 0; i < expected.spanCount; ++i)
+	{
+		REQUIRE(actual.areas[i] == expected.areas[i]);
+		if (expected.areas[i] != RC_NULL_AREA && expected.areas[i] != RC_WALKABLE_AREA)
+		{
+			numMarked++;
+		}
+	}
+	REQUIRE(numMarked > 0);
+}
@@ -0,0 +1,109 @@
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+
+#include "TestTerrain.h"
+
+namespace
+{
+bool equalContourSets(const rcContourSet& a, const rcContourSet& b)
+{
+	if (a.nconts != b.nconts)
+		return false;
+	for (int i = 0; i < a.nconts; ++i)
+	{
+		const rcContour& ca = a.conts[i];
+		const rcContour& cb = b.conts[i];
+		if (ca.nverts != cb.nverts || ca.nrverts != cb.nrverts || ca.reg != cb.reg || ca.area != cb.area
+			|| memcmp(ca.verts, cb.verts, sizeof(int) * 4 * ca.nverts) != 0
+			|| memcmp(ca.rverts, cb.rverts, sizeof(int) * 4 * ca.nrverts) != 0)
+			return false;
+	}
+	return true;
+}
+
+// A flat square with randomly placed pillars, which leave holes in the regions around them.
+void buildPillarField(rcContext* ctx, const int size, rcCompactHeightfield& chf)
+{
+	const float bmin[3] = { 0, 0, 0 };
+	const float bmax[3] = { (float)size, 10, (float)size };
+	rcHeightfield solid;
+	REQUIRE(rcCreateHeightfield(ctx, solid, size, size, bmin, bmax, 1, 1));
+	unsigned int seed = 7;
+	for (int z = 0; z < size; ++z)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			seed = seed * 1103515245u + 12345u;
+			const bool pillar = (seed >> 16) % 100 < 3;
+			REQUIRE(rcAddSpan(ctx, solid, x, z, 0, 1, pillar ? RC_NULL_AREA : RC_WALKABLE_AREA, 1));
+		}
+	}
+	REQUIRE(rcBuildCompactHeightfield(ctx, 2, 1, solid, chf));
+	REQUIRE(rcBuildDistanceField(ctx, chf));
+	REQUIRE(rcBuildRegions(ctx, chf, 0, 8, 20));
+}
+}
+
+TEST_CASE("rcBuildContours parallel parts", "[recast]")
+{
+	rcContext ctx(false);
+	rcCompactHeightfield chf;
+	buildPillarField(&ctx, 100, chf);
+
+	rcContourSet serial;
+	REQUIRE(rcBuildContours(&ctx, chf, 1.3f, 12, serial));
+	REQUIRE(serial.nconts > 8);
+
+	// Some regions have holes.
+	int nholes = 0;
+	for (int i = 0; i < serial.nconts; ++i)
+	{
+		for (int j = 0; j < serial.nconts; ++j)
+		{
+			if (i != j && serial.conts[i].reg == serial.conts[j].reg)
+			{
+				nholes++;
+				break;
+			}
+		}
+	}
+	REQUIRE(nholes > 0);
+
+	SECTION("Parts run out of order")
+	{
+		const int partCounts[] = { 2, 3, 7, 1000 };
+		for (int i = 0; i < 4; ++i)
+		{
+			TestReverseContext reverseCtx(partCounts[i]);
+			rcContourSet cset;
+			REQUIRE(rcBuildContours(&reverseCtx, chf, 1.3f, 12, cset));
+			CHECK(equalContourSets(serial, cset));
+		}
+	}
+
+	SECTION("Parts run on threads")
+	{
+		TestThreadContext threadCtx(4);
+		rcContourSet cset;
+		REQUIRE(rcBuildContours(&threadCtx, chf, 1.3f, 12, cset));
+		CHECK(equalContourSets(serial, cset));
+	}
+
+	SECTION("Terrain with a border")
+	{
+		const TestTerrain terrain = makeTestTerrain(32, 6.0f);
+		TestTerrainBuild build;
+		REQUIRE(build.build(&ctx, terrain, 0.1f));
+		REQUIRE(rcBuildRegions(&ctx, *build.chf, 8, build.cfg.minRegionArea, build.cfg.mergeRegionArea));
+
+		rcContourSet serialTerrain;
+		REQUIRE(rcBuildContours(&ctx, *build.chf, 1.3f, 12, serialTerrain));
+		TestThreadContext threadCtx(3);
+		rcContourSet cset;
+		REQUIRE(rcBuildContours(&threadCtx, *build.chf, 1.3f, 12, cset));
+		CHECK(equalContourSets(serialTerrain, cset));
+	}
+}
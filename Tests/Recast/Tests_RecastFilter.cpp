@@ -253,6 +253,145 @@ TEST_CASE("rcFilterLedgeSpans", "[recast, filtering]")
 	}
 }
 
+namespace
+{
+// The ledge filter as it was before the spans were packed into columns, following the span links.
+void filterLedgeSpansReference(const int walkableHeight, const int walkableClimb, rcHeightfield& heightfield)
+{
+	const int xSize = heightfield.width;
+	const int zSize = heightfield.height;
+	for (int z = 0; z < zSize; ++z)
+	{
+		for (int x = 0; x < xSize; ++x)
+		{
+			for (rcSpan* span = heightfield.spans[x + z * xSize]; span; span = span->next)
+			{
+				if (span->area == RC_NULL_AREA)
+				{
+					continue;
+				}
+				const int floor = (int)span->smax;
+				const int ceiling = span->next ? (int)span->next->smin : 0xffff;
+				int lowestNeighborFloorDifference = 0xffff;
+				int lowestTraversableNeighborFloor = span->smax;
+				int highestTraversableNeighborFloor = span->smax;
+				for (int direction = 0; direction < 4; ++direction)
+				{
+					const int neighborX = x + rcGetDirOffsetX(direction);
+					const int neighborZ = z + rcGetDirOffsetY(direction);
+					if (neighborX < 0 || neighborZ < 0 || neighborX >= xSize || neighborZ >= zSize)
+					{
+						lowestNeighborFloorDifference = -walkableClimb - 1;
+						break;
+					}
+					const rcSpan* neighborSpan = heightfield.spans[neighborX + neighborZ * xSize];
+					int neighborCeiling = neighborSpan ? (int)neighborSpan->smin : 0xffff;
+					if (rcMin(ceiling, neighborCeiling) - floor >= walkableHeight)
+					{
+						lowestNeighborFloorDifference = -walkableClimb - 1;
+						break;
+					}
+					for (; neighborSpan != NULL; neighborSpan = neighborSpan->next)
+					{
+						const int neighborFloor = (int)neighborSpan->smax;
+						neighborCeiling = neighborSpan->next ? (int)neighborSpan->next->smin : 0xffff;
+						if (rcMin(ceiling, neighborCeiling) - rcMax(floor, neighborFloor) < walkableHeight)
+						{
+							continue;
+						}
+						const int neighborFloorDifference = neighborFloor - floor;
+						lowestNeighborFloorDifference = rcMin(lowestNeighborFloorDifference, neighborFloorDifference);
+						if (rcAbs(neighborFloorDifference) <= walkableClimb)
+						{
+							lowestTraversableNeighborFloor = rcMin(lowestTraversableNeighborFloor, neighborFloor);
+							highestTraversableNeighborFloor = rcMax(highestTraversableNeighborFloor, neighborFloor);
+						}
+						else if (neighborFloorDifference < -walkableClimb)
+						{
+							break;
+						}
+					}
+				}
+				if (lowestNeighborFloorDifference < -walkableClimb ||
+					highestTraversableNeighborFloor - lowestTraversableNeighborFloor > walkableClimb)
+				{
+					span->area = RC_NULL_AREA;
+				}
+			}
+		}
+	}
+}
+
+void collectSpans(const rcHeightfield& heightfield, std::vector<int>& spans)
+{
+	spans.clear();
+	for (int i = 0; i < heightfield.width * heightfield.height; ++i)
+	{
+		for (const rcSpan* span = heightfield.spans[i]; span; span = span->next)
+		{
+			spans.push_back(i);
+			spans.push_back(span->smin);
+			spans.push_back(span->smax);
+			spans.push_back(span->area);
+		}
+	}
+}
+}
+
+TEST_CASE("rcFilterLedgeSpans matches the linked span filter", "[recast, filtering]")
+{
+	rcContext context;
+	const float bmin[3] = { 0, 0, 0 };
+	const float bmax[3] = { 24, 10, 16 };
+	unsigned int seed = 12345;
+
+	for (int iteration = 0; iteration < 20; ++iteration)
+	{
+		rcHeightfield* heightfields[2] = { rcAllocHeightfield(), rcAllocHeightfield() };
+		for (int h = 0; h < 2; ++h)
+		{
+			REQUIRE(rcCreateHeightfield(&context, *heightfields[h], 24, 16, bmin, bmax, 1, 1));
+		}
+
+		// Columns of up to four spans with random heights, the same in both heightfields.
+		// Every other heightfield has mostly single span columns.
+		for (int z = 0; z < 16; ++z)
+		{
+			for (int x = 0; x < 24; ++x)
+			{
+				seed = seed * 1103515245 + 12345;
+				const int spanCount = (iteration % 2 && (seed >> 8) % 8) ? 1 : (int)((seed >> 16) % 5);
+				int bottom = 0;
+				for (int i = 0; i < spanCount; ++i)
+				{
+					seed = seed * 1103515245 + 12345;
+					const int smin = bottom + (int)((seed >> 8) % 24);
+					const int smax = smin + 1 + (int)((seed >> 16) % 6);
+					const unsigned char area = (seed >> 24) % 4 ? RC_WALKABLE_AREA : RC_NULL_AREA;
+					for (int h = 0; h < 2; ++h)
+					{
+						REQUIRE(rcAddSpan(&context, *heightfields[h], x, z, (unsigned short)smin, (unsigned short)smax, area, 1));
+					}
+					bottom = smax;
+				}
+			}
+		}
+
+		const int walkableHeight = 3 + iteration % 8;
+		const int walkableClimb = iteration % 5;
+		filterLedgeSpansReference(walkableHeight, walkableClimb, *heightfields[0]);
+		rcFilterLedgeSpans(&context, walkableHeight, walkableClimb, *heightfields[1]);
+
+		std::vector<int> expected, spans;
+		collectSpans(*heightfields[0], expected);
+		collectSpans(*heightfields[1], spans);
+		REQUIRE(spans == expected);
+
+		rcFreeHeightField(heightfields[0]);
+		rcFreeHeightField(heightfields[1]);
+	}
+}
+
 TEST_CASE("rcFilterWalkableLowHeightSpans", "[recast, filtering]")
 {
 	rcContext context;
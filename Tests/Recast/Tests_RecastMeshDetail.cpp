@@ -0,0 +1,115 @@
+#include <string.h>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+#include "RecastAlloc.h"
+
+#include "TestTerrain.h"
+
+namespace
+{
+bool equalDetailMeshes(const rcPolyMeshDetail& a, const rcPolyMeshDetail& b)
+{
+	return a.nmeshes == b.nmeshes && a.nverts == b.nverts && a.ntris == b.ntris
+		&& memcmp(a.meshes, b.meshes, sizeof(unsigned int) * 4 * a.nmeshes) == 0
+		&& memcmp(a.verts, b.verts, sizeof(float) * 3 * a.nverts) == 0
+		&& memcmp(a.tris, b.tris, sizeof(unsigned char) * 4 * a.ntris) == 0;
+}
+}
+
+TEST_CASE("rcBuildPolyMeshDetail parallel parts", "[recast]")
+{
+	rcContext ctx(false);
+	const TestTerrain terrain = makeTestTerrain(48, 2.0f);
+	TestTerrainBuild build;
+	REQUIRE(build.build(&ctx, terrain, 0.3f));
+	REQUIRE(build.pmesh->npolys > 8);
+
+	rcPolyMeshDetail* serial = rcAllocPolyMeshDetail();
+	REQUIRE(rcBuildPolyMeshDetail(&ctx, *build.pmesh, *build.chf, build.cfg.detailSampleDist,
+								  build.cfg.detailSampleMaxError, *serial));
+	REQUIRE(serial->nmeshes == build.pmesh->npolys);
+	REQUIRE(serial->ntris > serial->nmeshes);
+
+	// Consecutive sub meshes.
+	for (int i = 1; i < serial->nmeshes; ++i)
+	{
+		CHECK(serial->meshes[i*4+0] == serial->meshes[(i-1)*4+0] + serial->meshes[(i-1)*4+1]);
+		CHECK(serial->meshes[i*4+2] == serial->meshes[(i-1)*4+2] + serial->meshes[(i-1)*4+3]);
+	}
+
+	SECTION("Parts run out of order")
+	{
+		const int partCounts[] = { 2, 3, 7, 1000 };
+		for (int i = 0; i < 4; ++i)
+		{
+			TestReverseContext reverseCtx(partCounts[i]);
+			rcPolyMeshDetail* dmesh = rcAllocPolyMeshDetail();
+			REQUIRE(rcBuildPolyMeshDetail(&reverseCtx, *build.pmesh, *build.chf, build.cfg.detailSampleDist,
+										  build.cfg.detailSampleMaxError, *dmesh));
+			CHECK(equalDetailMeshes(*serial, *dmesh));
+			rcFreePolyMeshDetail(dmesh);
+		}
+	}
+
+	SECTION("Parts run on threads")
+	{
+		TestThreadContext threadCtx(4);
+		rcPolyMeshDetail* dmesh = rcAllocPolyMeshDetail();
+		REQUIRE(rcBuildPolyMeshDetail(&threadCtx, *build.pmesh, *build.chf, build.cfg.detailSampleDist,
+									  build.cfg.detailSampleMaxError, *dmesh));
+		CHECK(equalDetailMeshes(*serial, *dmesh));
+		rcFreePolyMeshDetail(dmesh);
+	}
+
+	rcFreePolyMeshDetail(serial);
+}
+
+TEST_CASE("rcBuildPolyMeshDetail dense samples", "[recast]")
+{
+	rcContext ctx(false);
+	const TestTerrain terrain = makeTestTerrain(12, 0.5f);
+	TestTerrainBuild build;
+	REQUIRE(build.build(&ctx, terrain, 0.3f));
+	const rcPolyMesh& pmesh = *build.pmesh;
+
+	// Samples every 0.05 units, over a thousand per polygon.
+	rcPolyMeshDetail* dmesh = rcAllocPolyMeshDetail();
+	REQUIRE(rcBuildPolyMeshDetail(&ctx, pmesh, *build.chf, 0.05f, 0.01f, *dmesh));
+	REQUIRE(dmesh->nmeshes == pmesh.npolys);
+
+	for (int i = 0; i < pmesh.npolys; ++i)
+	{
+		const unsigned short* p = &pmesh.polys[i*pmesh.nvp*2];
+		int nv = 0;
+		while (nv < pmesh.nvp && p[nv] != RC_MESH_NULL_IDX)
+			nv++;
+		float polyArea = 0;
+		for (int j = 0, k = nv-1; j < nv; k = j++)
+		{
+			const unsigned short* va = &pmesh.verts[p[k]*3];
+			const unsigned short* vb = &pmesh.verts[p[j]*3];
+			polyArea += ((float)va[2]*vb[0] - (float)va[0]*vb[2]) * 0.5f * pmesh.cs * pmesh.cs;
+		}
+
+		// The triangles have the same winding and cover the polygon.
+		const unsigned int* m = &dmesh->meshes[i*4];
+		CHECK(m[1] <= 127);
+		float triArea = 0;
+		for (unsigned int j = 0; j < m[3]; ++j)
+		{
+			const unsigned char* t = &dmesh->tris[(m[2]+j)*4];
+			CHECK((t[0] < m[1] && t[1] < m[1] && t[2] < m[1]));
+			const float* va = &dmesh->verts[(m[0]+t[0])*3];
+			const float* vb = &dmesh->verts[(m[0]+t[1])*3];
+			const float* vc = &dmesh->verts[(m[0]+t[2])*3];
+			const float area = ((vc[0]-va[0])*(vb[2]-va[2]) - (vb[0]-va[0])*(vc[2]-va[2])) * 0.5f;
+			CHECK(area > 0.0f);
+			triArea += area;
+		}
+		CHECK(triArea == Catch::Approx(polyArea).epsilon(0.02));
+	}
+
+	rcFreePolyMeshDetail(dmesh);
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+#include "Recast.h"
+
+#include "TestTerrain.h"
+
+namespace
+{
+void triBounds(const TestTerrain& terrain, int tri, float* bmin, float* bmax)
+{
+	const int* t = &terrain.tris[tri*3];
+	rcVcopy(bmin, &terrain.verts[t[0]*3]);
+	rcVcopy(bmax, &terrain.verts[t[0]*3]);
+	for (int i = 1; i < 3; ++i)
+	{
+		rcVmin(bmin, &terrain.verts[t[i]*3]);
+		rcVmax(bmax, &terrain.verts[t[i]*3]);
+	}
+}
+
+std::vector<int> bruteForceBox(const TestTerrain& terrain, const std::vector<bool>& present, const float* bmin, const float* bmax)
+{
+	std::vector<int> result;
+	for (int i = 0; i < (int)present.size(); ++i)
+	{
+		float tmin[3], tmax[3];
+		triBounds(terrain, i, tmin, tmax);
+		if (present[i] &&
+			tmin[0] <= bmax[0] && tmax[0] >= bmin[0] &&
+			tmin[1] <= bmax[1] && tmax[1] >= bmin[1] &&
+			tmin[2] <= bmax[2] && tmax[2] >= bmin[2])
+		{
+			result.push_back(i);
+		}
+	}
+	return result;
+}
+
+std::vector<int> queryBox(const rcTriMeshBVH& bvh, const float* bmin, const float* bmax)
+{
+	const int n = rcQueryTriMeshBVHBox(bvh, bmin, bmax, 0, 0);
+	std::vector<int> result(n + 1);
+	CHECK(rcQueryTriMeshBVHBox(bvh, bmin, bmax, &result[0], n) == n);
+	result.resize(n);
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+// Checks the box queries of a grid of boxes against testing every triangle.
+void checkBoxQueries(const rcTriMeshBVH& bvh, const TestTerrain& terrain, const std::vector<bool>& present)
+{
+	for (int z = 0; z < 6; ++z)
+	{
+		for (int x = 0; x < 6; ++x)
+		{
+			const float bmin[3] = { terrain.bmin[0] + x * 5.3f, -1.0f, terrain.bmin[2] + z * 4.7f };
+			const float bmax[3] = { bmin[0] + 6.1f, 1.5f, bmin[2] + 3.2f };
+			CHECK(queryBox(bvh, bmin, bmax) == bruteForceBox(terrain, present, bmin, bmax));
+		}
+	}
+}
+
+bool equalNodes(const rcTriMeshBVH& a, const rcTriMeshBVH& b)
+{
+	if (a.nnodes != b.nnodes || a.nblocks != b.nblocks
+		|| memcmp(a.nodes, b.nodes, sizeof(rcTriMeshBVHNode) * a.nnodes) != 0)
+		return false;
+	// The unused slots of the leaves are not initialized.
+	for (int i = 0; i < a.nnodes; ++i)
+	{
+		const rcTriMeshBVHNode& n = a.nodes[i];
+		if (n.child == -1 && memcmp(&a.items[n.first], &b.items[n.first], sizeof(rcTriMeshBVHItem) * n.count) != 0)
+			return false;
+	}
+	return true;
+}
+}
+
+TEST_CASE("rcTriMeshBVH queries", "[recast]")
+{
+	rcContext ctx(false);
+	const TestTerrain terrain = makeTestTerrain(32, 2.0f);
+	const int ntris = (int)terrain.tris.size() / 3;
+	const std::vector<bool> present(ntris, true);
+
+	rcTriMeshBVH* bvh = rcAllocTriMeshBVH();
+	REQUIRE(rcBuildTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], ntris, 8, *bvh));
+	REQUIRE(bvh->ntris == ntris);
+	REQUIRE(bvh->nnodes > 1);
+
+	SECTION("Box")
+	{
+		checkBoxQueries(*bvh, terrain, present);
+
+		// A box around everything returns every triangle once.
+		std::vector<int> all = queryBox(*bvh, terrain.bmin, terrain.bmax);
+		REQUIRE((int)all.size() == ntris);
+		for (int i = 0; i < ntris; ++i)
+			CHECK(all[i] == i);
+	}
+
+	SECTION("Segment and raycast")
+	{
+		for (int i = 0; i < 40; ++i)
+		{
+			const float sp[3] = { 1.3f + i * 0.7f, 8.0f, 0.7f + i * 0.4f };
+			const float sq[3] = { 30.1f - i * 0.5f, -8.0f + i * 0.3f, 29.3f - i * 0.6f };
+
+			// The triangles hit by the segment are among the ones the segment query returns.
+			int candidates[4096];
+			const int ncandidates = rcQueryTriMeshBVHSegment(*bvh, sp, sq, candidates, 4096);
+			REQUIRE(ncandidates <= 4096);
+			std::sort(candidates, candidates + ncandidates);
+
+			float bestTime = 2.0f;
+			int bestTri = -1;
+			for (int j = 0; j < ntris; ++j)
+			{
+				const int* t = &terrain.tris[j*3];
+				const float* a = &terrain.verts[t[0]*3];
+				const float* b = &terrain.verts[t[1]*3];
+				const float* c = &terrain.verts[t[2]*3];
+				float ab[3], ac[3], qp[3], ap[3], norm[3], e[3];
+				rcVsub(ab, b, a);
+				rcVsub(ac, c, a);
+				rcVsub(qp, sp, sq);
+				rcVsub(ap, sp, a);
+				rcVcross(norm, ab, ac);
+				float d = rcVdot(qp, norm);
+				if (d == 0.0f)
+					continue;
+				rcVcross(e, qp, ap);
+				float tn = rcVdot(ap, norm), v = rcVdot(ac, e), w = -rcVdot(ab, e);
+				if (d < 0.0f) { d = -d; tn = -tn; v = -v; w = -w; }
+				if (tn < 0.0f || tn > d || v < 0.0f || w < 0.0f || v + w > d)
+					continue;
+				CHECK(std::binary_search(candidates, candidates + ncandidates, j));
+				if (tn / d < bestTime)
+				{
+					bestTime = tn / d;
+					bestTri = j;
+				}
+			}
+
+			float hitTime = 0.0f;
+			int hitTri = -1;
+			const bool hit = rcRaycastTriMeshBVH(*bvh, &terrain.verts[0], &terrain.tris[0], sp, sq, hitTime, hitTri);
+			CHECK(hit == (bestTri != -1));
+			if (hit && bestTri != -1)
+				CHECK(hitTime == Catch::Approx(bestTime).margin(1e-5));
+		}
+	}
+
+	rcFreeTriMeshBVH(bvh);
+}
+
+TEST_CASE("rcTriMeshBVH parallel parts", "[recast]")
+{
+	rcContext ctx(false);
+	const TestTerrain terrain = makeTestTerrain(48, 2.0f);
+	const int ntris = (int)terrain.tris.size() / 3;
+
+	rcTriMeshBVH* serial = rcAllocTriMeshBVH();
+	REQUIRE(rcBuildTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], ntris, 4, *serial));
+
+	SECTION("Parts run out of order")
+	{
+		const int partCounts[] = { 2, 3, 7, 1000 };
+		for (int i = 0; i < 4; ++i)
+		{
+			TestReverseContext reverseCtx(partCounts[i]);
+			rcTriMeshBVH* bvh = rcAllocTriMeshBVH();
+			REQUIRE(rcBuildTriMeshBVH(&reverseCtx, &terrain.verts[0], &terrain.tris[0], ntris, 4, *bvh));
+			CHECK(equalNodes(*serial, *bvh));
+			rcFreeTriMeshBVH(bvh);
+		}
+	}
+
+	SECTION("Parts run on threads")
+	{
+		TestThreadContext threadCtx(4);
+		rcTriMeshBVH* bvh = rcAllocTriMeshBVH();
+		REQUIRE(rcBuildTriMeshBVH(&threadCtx, &terrain.verts[0], &terrain.tris[0], ntris, 4, *bvh));
+		CHECK(equalNodes(*serial, *bvh));
+		rcFreeTriMeshBVH(bvh);
+	}
+
+	rcFreeTriMeshBVH(serial);
+}
+
+TEST_CASE("rcTriMeshBVH updates", "[recast]")
+{
+	rcContext ctx(false);
+	TestTerrain terrain = makeTestTerrain(24, 2.0f);
+	const int ntris = (int)terrain.tris.size() / 3;
+	std::vector<bool> present(ntris, true);
+
+	rcTriMeshBVH* bvh = rcAllocTriMeshBVH();
+
+	SECTION("Remove and insert")
+	{
+		REQUIRE(rcBuildTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], ntris, 6, *bvh));
+
+		for (int i = 0; i < ntris; i += 3)
+		{
+			CHECK(rcRemoveTriMeshBVH(i, *bvh));
+			present[i] = false;
+		}
+		CHECK_FALSE(rcRemoveTriMeshBVH(0, *bvh));
+		checkBoxQueries(*bvh, terrain, present);
+
+		for (int i = 0; i < ntris; i += 6)
+		{
+			CHECK(rcInsertTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], i, *bvh));
+			present[i] = true;
+		}
+		CHECK_FALSE(rcInsertTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], 0, *bvh));
+		checkBoxQueries(*bvh, terrain, present);
+	}
+
+	SECTION("Insert into an empty hierarchy")
+	{
+		REQUIRE(rcBuildTriMeshBVH(&ctx, 0, 0, 0, 2, *bvh));
+		CHECK(bvh->nnodes == 1);
+		const float bmin[3] = { -1000, -1000, -1000 };
+		const float bmax[3] = { 1000, 1000, 1000 };
+		CHECK(rcQueryTriMeshBVHBox(*bvh, bmin, bmax, 0, 0) == 0);
+
+		// Leaves split as they fill up.
+		for (int i = ntris-1; i >= 0; --i)
+			REQUIRE(rcInsertTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], i, *bvh));
+		CHECK(bvh->ntris == ntris);
+		CHECK(bvh->nnodes > ntris / 2);
+		checkBoxQueries(*bvh, terrain, present);
+	}
+
+	SECTION("Refit")
+	{
+		REQUIRE(rcBuildTriMeshBVH(&ctx, &terrain.verts[0], &terrain.tris[0], ntris, 6, *bvh));
+
+		// Lift a part of the terrain.
+		for (int i = 0; i < (int)terrain.verts.size() / 3; ++i)
+		{
+			if (terrain.verts[i*3+0] < 10.0f)
+				terrain.verts[i*3+1] += 5.0f;
+		}
+		rcCalcBounds(&terrain.verts[0], (int)terrain.verts.size() / 3, terrain.bmin, terrain.bmax);
+		rcRefitTriMeshBVH(&terrain.verts[0], &terrain.tris[0], *bvh);
+		checkBoxQueries(*bvh, terrain, present);
+
+		const float bmin[3] = { 0.0f, 5.5f, 0.0f };
+		const float bmax[3] = { 24.0f, 100.0f, 24.0f };
+		CHECK(queryBox(*bvh, bmin, bmax) == bruteForceBox(terrain, present, bmin, bmax));
+	}
+
+	rcFreeTriMeshBVH(bvh);
+}
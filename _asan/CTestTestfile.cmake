@@ -0,0 +1,12 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_asan
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("DebugUtils")
+subdirs("Detour")
+subdirs("DetourCrowd")
+subdirs("DetourTileCache")
+subdirs("Recast")
+subdirs("Tests")
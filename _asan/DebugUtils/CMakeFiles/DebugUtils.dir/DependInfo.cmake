@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/DebugUtils/Source/DebugDraw.cpp" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/DebugDraw.cpp.o" "gcc" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/DebugDraw.cpp.o.d"
+  "/root/repo/DebugUtils/Source/DetourDebugDraw.cpp" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/DetourDebugDraw.cpp.o" "gcc" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/DetourDebugDraw.cpp.o.d"
+  "/root/repo/DebugUtils/Source/RecastDebugDraw.cpp" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/RecastDebugDraw.cpp.o" "gcc" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/RecastDebugDraw.cpp.o.d"
+  "/root/repo/DebugUtils/Source/RecastDump.cpp" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/RecastDump.cpp.o" "gcc" "DebugUtils/CMakeFiles/DebugUtils.dir/Source/RecastDump.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_asan/Recast/CMakeFiles/Recast.dir/DependInfo.cmake"
+  "/root/repo/_asan/Detour/CMakeFiles/Detour.dir/DependInfo.cmake"
+  "/root/repo/_asan/DetourTileCache/CMakeFiles/DetourTileCache.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
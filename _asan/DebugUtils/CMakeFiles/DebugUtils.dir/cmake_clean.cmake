@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/DebugUtils.dir/Source/DebugDraw.cpp.o"
+  "CMakeFiles/DebugUtils.dir/Source/DebugDraw.cpp.o.d"
+  "CMakeFiles/DebugUtils.dir/Source/DetourDebugDraw.cpp.o"
+  "CMakeFiles/DebugUtils.dir/Source/DetourDebugDraw.cpp.o.d"
+  "CMakeFiles/DebugUtils.dir/Source/RecastDebugDraw.cpp.o"
+  "CMakeFiles/DebugUtils.dir/Source/RecastDebugDraw.cpp.o.d"
+  "CMakeFiles/DebugUtils.dir/Source/RecastDump.cpp.o"
+  "CMakeFiles/DebugUtils.dir/Source/RecastDump.cpp.o.d"
+  "libDebugUtils-d.a"
+  "libDebugUtils-d.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/DebugUtils.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
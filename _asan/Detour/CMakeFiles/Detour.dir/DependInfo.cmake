@@ -0,0 +1,29 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Detour/Source/DetourAlloc.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourAlloc.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourAlloc.cpp.o.d"
+  "/root/repo/Detour/Source/DetourAreaSampler.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourAreaSampler.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourAreaSampler.cpp.o.d"
+  "/root/repo/Detour/Source/DetourAssert.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourAssert.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourAssert.cpp.o.d"
+  "/root/repo/Detour/Source/DetourCommon.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourCommon.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourCommon.cpp.o.d"
+  "/root/repo/Detour/Source/DetourLandmarks.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourLandmarks.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourLandmarks.cpp.o.d"
+  "/root/repo/Detour/Source/DetourNavMesh.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMesh.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMesh.cpp.o.d"
+  "/root/repo/Detour/Source/DetourNavMeshBuilder.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMeshBuilder.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMeshBuilder.cpp.o.d"
+  "/root/repo/Detour/Source/DetourNavMeshQuery.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMeshQuery.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourNavMeshQuery.cpp.o.d"
+  "/root/repo/Detour/Source/DetourNode.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourNode.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourNode.cpp.o.d"
+  "/root/repo/Detour/Source/DetourStraightPath.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourStraightPath.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourStraightPath.cpp.o.d"
+  "/root/repo/Detour/Source/DetourTileStreamer.cpp" "Detour/CMakeFiles/Detour.dir/Source/DetourTileStreamer.cpp.o" "gcc" "Detour/CMakeFiles/Detour.dir/Source/DetourTileStreamer.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,31 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Detour.dir/Source/DetourAlloc.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourAlloc.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourAreaSampler.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourAreaSampler.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourAssert.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourAssert.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourCommon.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourCommon.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourLandmarks.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourLandmarks.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourNavMesh.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourNavMesh.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourNavMeshBuilder.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourNavMeshBuilder.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourNavMeshQuery.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourNavMeshQuery.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourNode.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourNode.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourStraightPath.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourStraightPath.cpp.o.d"
+  "CMakeFiles/Detour.dir/Source/DetourTileStreamer.cpp.o"
+  "CMakeFiles/Detour.dir/Source/DetourTileStreamer.cpp.o.d"
+  "libDetour-d.a"
+  "libDetour-d.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Detour.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/DetourCrowd/Source/DetourCrowd.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourCrowd.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourCrowd.cpp.o.d"
+  "/root/repo/DetourCrowd/Source/DetourLocalBoundary.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourLocalBoundary.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourLocalBoundary.cpp.o.d"
+  "/root/repo/DetourCrowd/Source/DetourObstacleAvoidance.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourObstacleAvoidance.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourObstacleAvoidance.cpp.o.d"
+  "/root/repo/DetourCrowd/Source/DetourPathCorridor.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourPathCorridor.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourPathCorridor.cpp.o.d"
+  "/root/repo/DetourCrowd/Source/DetourPathQueue.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourPathQueue.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourPathQueue.cpp.o.d"
+  "/root/repo/DetourCrowd/Source/DetourProximityGrid.cpp" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourProximityGrid.cpp.o" "gcc" "DetourCrowd/CMakeFiles/DetourCrowd.dir/Source/DetourProximityGrid.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_asan/Detour/CMakeFiles/Detour.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
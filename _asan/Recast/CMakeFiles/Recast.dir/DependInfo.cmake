@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Recast/Source/Recast.cpp" "Recast/CMakeFiles/Recast.dir/Source/Recast.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/Recast.cpp.o.d"
+  "/root/repo/Recast/Source/RecastAlloc.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastAlloc.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastAlloc.cpp.o.d"
+  "/root/repo/Recast/Source/RecastArea.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastArea.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastArea.cpp.o.d"
+  "/root/repo/Recast/Source/RecastAssert.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastAssert.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastAssert.cpp.o.d"
+  "/root/repo/Recast/Source/RecastContour.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastContour.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastContour.cpp.o.d"
+  "/root/repo/Recast/Source/RecastFilter.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastFilter.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastFilter.cpp.o.d"
+  "/root/repo/Recast/Source/RecastLayers.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastLayers.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastLayers.cpp.o.d"
+  "/root/repo/Recast/Source/RecastMesh.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastMesh.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastMesh.cpp.o.d"
+  "/root/repo/Recast/Source/RecastMeshDetail.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastMeshDetail.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastMeshDetail.cpp.o.d"
+  "/root/repo/Recast/Source/RecastRasterization.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastRasterization.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastRasterization.cpp.o.d"
+  "/root/repo/Recast/Source/RecastRegion.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastRegion.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastRegion.cpp.o.d"
+  "/root/repo/Recast/Source/RecastTriMeshBVH.cpp" "Recast/CMakeFiles/Recast.dir/Source/RecastTriMeshBVH.cpp.o" "gcc" "Recast/CMakeFiles/Recast.dir/Source/RecastTriMeshBVH.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
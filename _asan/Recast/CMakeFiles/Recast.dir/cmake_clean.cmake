@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Recast.dir/Source/Recast.cpp.o"
+  "CMakeFiles/Recast.dir/Source/Recast.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastAlloc.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastAlloc.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastArea.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastArea.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastAssert.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastAssert.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastContour.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastContour.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastFilter.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastFilter.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastLayers.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastLayers.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastMesh.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastMesh.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastMeshDetail.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastMeshDetail.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastRasterization.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastRasterization.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastRegion.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastRegion.cpp.o.d"
+  "CMakeFiles/Recast.dir/Source/RecastTriMeshBVH.cpp.o"
+  "CMakeFiles/Recast.dir/Source/RecastTriMeshBVH.cpp.o.d"
+  "libRecast-d.a"
+  "libRecast-d.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Recast.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,37 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/Tests/Contrib/catch2/catch_amalgamated.cpp" "Tests/CMakeFiles/Tests.dir/Contrib/catch2/catch_amalgamated.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Contrib/catch2/catch_amalgamated.cpp.o.d"
+  "/root/repo/Tests/Detour/Bench_DetourNavMeshQuery.cpp" "Tests/CMakeFiles/Tests.dir/Detour/Bench_DetourNavMeshQuery.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Detour/Bench_DetourNavMeshQuery.cpp.o.d"
+  "/root/repo/Tests/Detour/Tests_Detour.cpp" "Tests/CMakeFiles/Tests.dir/Detour/Tests_Detour.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Detour/Tests_Detour.cpp.o.d"
+  "/root/repo/Tests/Detour/Tests_DetourNavMeshQuery.cpp" "Tests/CMakeFiles/Tests.dir/Detour/Tests_DetourNavMeshQuery.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Detour/Tests_DetourNavMeshQuery.cpp.o.d"
+  "/root/repo/Tests/Detour/Tests_DetourTileStreamer.cpp" "Tests/CMakeFiles/Tests.dir/Detour/Tests_DetourTileStreamer.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Detour/Tests_DetourTileStreamer.cpp.o.d"
+  "/root/repo/Tests/DetourCrowd/Tests_DetourPathCorridor.cpp" "Tests/CMakeFiles/Tests.dir/DetourCrowd/Tests_DetourPathCorridor.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/DetourCrowd/Tests_DetourPathCorridor.cpp.o.d"
+  "/root/repo/Tests/Recast/Bench_RecastFilter.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastFilter.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastFilter.cpp.o.d"
+  "/root/repo/Tests/Recast/Bench_RecastMeshDetail.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastMeshDetail.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastMeshDetail.cpp.o.d"
+  "/root/repo/Tests/Recast/Bench_RecastRegion.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastRegion.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Bench_RecastRegion.cpp.o.d"
+  "/root/repo/Tests/Recast/Bench_rcVector.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Bench_rcVector.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Bench_rcVector.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_Alloc.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_Alloc.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_Alloc.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_Recast.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_Recast.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_Recast.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_RecastContour.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastContour.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastContour.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_RecastFilter.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastFilter.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastFilter.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_RecastMeshDetail.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastMeshDetail.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastMeshDetail.cpp.o.d"
+  "/root/repo/Tests/Recast/Tests_RecastTriMeshBVH.cpp" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastTriMeshBVH.cpp.o" "gcc" "Tests/CMakeFiles/Tests.dir/Recast/Tests_RecastTriMeshBVH.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_asan/Recast/CMakeFiles/Recast.dir/DependInfo.cmake"
+  "/root/repo/_asan/Detour/CMakeFiles/Detour.dir/DependInfo.cmake"
+  "/root/repo/_asan/DetourCrowd/CMakeFiles/DetourCrowd.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
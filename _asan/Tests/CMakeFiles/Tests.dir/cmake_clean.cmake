@@ -0,0 +1,41 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Tests.dir/Contrib/catch2/catch_amalgamated.cpp.o"
+  "CMakeFiles/Tests.dir/Contrib/catch2/catch_amalgamated.cpp.o.d"
+  "CMakeFiles/Tests.dir/Detour/Bench_DetourNavMeshQuery.cpp.o"
+  "CMakeFiles/Tests.dir/Detour/Bench_DetourNavMeshQuery.cpp.o.d"
+  "CMakeFiles/Tests.dir/Detour/Tests_Detour.cpp.o"
+  "CMakeFiles/Tests.dir/Detour/Tests_Detour.cpp.o.d"
+  "CMakeFiles/Tests.dir/Detour/Tests_DetourNavMeshQuery.cpp.o"
+  "CMakeFiles/Tests.dir/Detour/Tests_DetourNavMeshQuery.cpp.o.d"
+  "CMakeFiles/Tests.dir/Detour/Tests_DetourTileStreamer.cpp.o"
+  "CMakeFiles/Tests.dir/Detour/Tests_DetourTileStreamer.cpp.o.d"
+  "CMakeFiles/Tests.dir/DetourCrowd/Tests_DetourPathCorridor.cpp.o"
+  "CMakeFiles/Tests.dir/DetourCrowd/Tests_DetourPathCorridor.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastFilter.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastFilter.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastMeshDetail.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastMeshDetail.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastRegion.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Bench_RecastRegion.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Bench_rcVector.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Bench_rcVector.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_Alloc.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_Alloc.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_Recast.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_Recast.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastContour.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastContour.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastFilter.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastFilter.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastMeshDetail.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastMeshDetail.cpp.o.d"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastTriMeshBVH.cpp.o"
+  "CMakeFiles/Tests.dir/Recast/Tests_RecastTriMeshBVH.cpp.o.d"
+  "Tests"
+  "Tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/Tests
+# Build directory: /root/repo/_asan/Tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(Tests "Tests")
+set_tests_properties(Tests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/Tests/CMakeLists.txt;38;add_test;/root/repo/Tests/CMakeLists.txt;0;")
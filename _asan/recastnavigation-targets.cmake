@@ -0,0 +1,129 @@
+# Generated by CMake
+
+if("${CMAKE_MAJOR_VERSION}.${CMAKE_MINOR_VERSION}" LESS 2.8)
+   message(FATAL_ERROR "CMake >= 2.8.0 required")
+endif()
+if(CMAKE_VERSION VERSION_LESS "2.8.3")
+   message(FATAL_ERROR "CMake >= 2.8.3 required")
+endif()
+cmake_policy(PUSH)
+cmake_policy(VERSION 2.8.3...3.23)
+#----------------------------------------------------------------
+# Generated CMake target import file.
+#----------------------------------------------------------------
+
+# Commands may need to know the format version.
+set(CMAKE_IMPORT_FILE_VERSION 1)
+
+# Protect against multiple inclusion, which would fail when already imported targets are added once more.
+set(_cmake_targets_defined "")
+set(_cmake_targets_not_defined "")
+set(_cmake_expected_targets "")
+foreach(_cmake_expected_target IN ITEMS RecastNavigation::DebugUtils RecastNavigation::Detour RecastNavigation::DetourCrowd RecastNavigation::DetourTileCache RecastNavigation::Recast)
+  list(APPEND _cmake_expected_targets "${_cmake_expected_target}")
+  if(TARGET "${_cmake_expected_target}")
+    list(APPEND _cmake_targets_defined "${_cmake_expected_target}")
+  else()
+    list(APPEND _cmake_targets_not_defined "${_cmake_expected_target}")
+  endif()
+endforeach()
+unset(_cmake_expected_target)
+if(_cmake_targets_defined STREQUAL _cmake_expected_targets)
+  unset(_cmake_targets_defined)
+  unset(_cmake_targets_not_defined)
+  unset(_cmake_expected_targets)
+  unset(CMAKE_IMPORT_FILE_VERSION)
+  cmake_policy(POP)
+  return()
+endif()
+if(NOT _cmake_targets_defined STREQUAL "")
+  string(REPLACE ";" ", " _cmake_targets_defined_text "${_cmake_targets_defined}")
+  string(REPLACE ";" ", " _cmake_targets_not_defined_text "${_cmake_targets_not_defined}")
+  message(FATAL_ERROR "Some (but not all) targets in this export set were already defined.\nTargets Defined: ${_cmake_targets_defined_text}\nTargets not yet defined: ${_cmake_targets_not_defined_text}\n")
+endif()
+unset(_cmake_targets_defined)
+unset(_cmake_targets_not_defined)
+unset(_cmake_expected_targets)
+
+
+# Create imported target RecastNavigation::DebugUtils
+add_library(RecastNavigation::DebugUtils STATIC IMPORTED)
+
+set_target_properties(RecastNavigation::DebugUtils PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/DebugUtils/Include"
+  INTERFACE_LINK_LIBRARIES "RecastNavigation::Recast;RecastNavigation::Detour;RecastNavigation::DetourTileCache"
+)
+
+# Create imported target RecastNavigation::Detour
+add_library(RecastNavigation::Detour STATIC IMPORTED)
+
+set_target_properties(RecastNavigation::Detour PROPERTIES
+  INTERFACE_COMPILE_DEFINITIONS "RC_DISABLE_ASSERTS"
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/Detour/Include"
+)
+
+# Create imported target RecastNavigation::DetourCrowd
+add_library(RecastNavigation::DetourCrowd STATIC IMPORTED)
+
+set_target_properties(RecastNavigation::DetourCrowd PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/DetourCrowd/Include"
+  INTERFACE_LINK_LIBRARIES "RecastNavigation::Detour"
+)
+
+# Create imported target RecastNavigation::DetourTileCache
+add_library(RecastNavigation::DetourTileCache STATIC IMPORTED)
+
+set_target_properties(RecastNavigation::DetourTileCache PROPERTIES
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/DetourTileCache/Include"
+  INTERFACE_LINK_LIBRARIES "RecastNavigation::Detour"
+)
+
+# Create imported target RecastNavigation::Recast
+add_library(RecastNavigation::Recast STATIC IMPORTED)
+
+set_target_properties(RecastNavigation::Recast PROPERTIES
+  INTERFACE_COMPILE_DEFINITIONS "RC_DISABLE_ASSERTS"
+  INTERFACE_INCLUDE_DIRECTORIES "/root/repo/Recast/Include"
+)
+
+# Import target "RecastNavigation::DebugUtils" for configuration "Debug"
+set_property(TARGET RecastNavigation::DebugUtils APPEND PROPERTY IMPORTED_CONFIGURATIONS DEBUG)
+set_target_properties(RecastNavigation::DebugUtils PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_DEBUG "CXX"
+  IMPORTED_LOCATION_DEBUG "/root/repo/_asan/DebugUtils/libDebugUtils-d.a"
+  )
+
+# Import target "RecastNavigation::Detour" for configuration "Debug"
+set_property(TARGET RecastNavigation::Detour APPEND PROPERTY IMPORTED_CONFIGURATIONS DEBUG)
+set_target_properties(RecastNavigation::Detour PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_DEBUG "CXX"
+  IMPORTED_LOCATION_DEBUG "/root/repo/_asan/Detour/libDetour-d.a"
+  )
+
+# Import target "RecastNavigation::DetourCrowd" for configuration "Debug"
+set_property(TARGET RecastNavigation::DetourCrowd APPEND PROPERTY IMPORTED_CONFIGURATIONS DEBUG)
+set_target_properties(RecastNavigation::DetourCrowd PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_DEBUG "CXX"
+  IMPORTED_LOCATION_DEBUG "/root/repo/_asan/DetourCrowd/libDetourCrowd-d.a"
+  )
+
+# Import target "RecastNavigation::DetourTileCache" for configuration "Debug"
+set_property(TARGET RecastNavigation::DetourTileCache APPEND PROPERTY IMPORTED_CONFIGURATIONS DEBUG)
+set_target_properties(RecastNavigation::DetourTileCache PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_DEBUG "CXX"
+  IMPORTED_LOCATION_DEBUG "/root/repo/_asan/DetourTileCache/libDetourTileCache-d.a"
+  )
+
+# Import target "RecastNavigation::Recast" for configuration "Debug"
+set_property(TARGET RecastNavigation::Recast APPEND PROPERTY IMPORTED_CONFIGURATIONS DEBUG)
+set_target_properties(RecastNavigation::Recast PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_DEBUG "CXX"
+  IMPORTED_LOCATION_DEBUG "/root/repo/_asan/Recast/libRecast-d.a"
+  )
+
+# This file does not depend on other imported targets which have
+# been exported from the same project but in a separate export set.
+
+# Commands beyond this point should not need to know the version.
+set(CMAKE_IMPORT_FILE_VERSION)
+cmake_policy(POP)
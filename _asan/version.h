@@ -0,0 +1,3 @@
+/* Define to the library version */
+#define RECASTNAV_VERSION "1.6.0"
+#define RECASTNAV_VERSION_NUM 1,6,0,0